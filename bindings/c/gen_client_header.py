@@ -71,6 +71,20 @@ struct hyperdex_client_map_attribute
     enum hyperdatatype value_datatype;
 };
 
+struct hyperdex_client_key
+{
+    const char* key;
+    size_t key_sz;
+};
+
+struct hyperdex_client_object
+{
+    const char* key;
+    size_t key_sz;
+    const struct hyperdex_client_attribute* attrs;
+    size_t attrs_sz;
+};
+
 struct hyperdex_client_attribute_check
 {
     const char* attr; /* NULL-terminated */
@@ -80,6 +94,12 @@ struct hyperdex_client_attribute_check
     enum hyperpredicate predicate;
 };
 
+struct hyperdex_client_aggregate_spec
+{
+    const char* attr; /* NULL-terminated; ignored for HYPERAGGREGATE_COUNT */
+    enum hyperaggregate op;
+};
+
 /* HyperClient returncode occupies [8448, 8576) */
 enum hyperdex_client_returncode
 {
@@ -135,6 +155,8 @@ hyperdex_client_attribute_type(struct hyperdex_client* client,
 
 const char*
 hyperdex_client_error_message(struct hyperdex_client* client);
+const char*
+hyperdex_client_error_location(struct hyperdex_client* client);
 
 const char*
 hyperdex_client_returncode_to_string(enum hyperdex_client_returncode);
@@ -31,6 +31,10 @@ class SpaceName(object):
     args = (('const char*', 'space'),)
 class Key(object):
     args = (('const char*', 'key'), ('size_t', 'key_sz'))
+class Keys(object):
+    args = (('const struct hyperdex_client_key*', 'keys'), ('size_t', 'keys_sz'))
+class Objects(object):
+    args = (('const struct hyperdex_client_object*', 'objects'), ('size_t', 'objects_sz'))
 class Predicates(object):
     args = (('const struct hyperdex_client_attribute_check*', 'checks'),
             ('size_t', 'checks_sz'))
@@ -40,6 +44,8 @@ class Attributes(object):
 class MapAttributes(object):
     args = (('const struct hyperdex_client_map_attribute*', 'mapattrs'),
             ('size_t', 'mapattrs_sz'))
+class AttributeNames(object):
+    args = (('const char**', 'attrnames'), ('size_t', 'attrnames_sz'))
 class Status(object):
     args = (('enum hyperdex_client_returncode', 'status'),)
 class Description(object):
@@ -52,6 +58,11 @@ class Count(object):
     args = (('uint64_t', 'count'),)
 class MaxMin(object):
     args = (('int', 'maxmin'),)
+class Aggregates(object):
+    args = (('const struct hyperdex_client_aggregate_spec*', 'aggs'),
+            ('size_t', 'aggs_sz'))
+class GroupBy(object):
+    args = (('const char*', 'group_by'),)
 
 class Method(object):
 
@@ -63,7 +74,10 @@ class Method(object):
 
 Client = [
     Method('get', AsyncCall, (SpaceName, Key), (Status, Attributes)),
+    Method('get_partial', AsyncCall, (SpaceName, Key, AttributeNames), (Status, Attributes)),
+    Method('get_many', Iterator, (SpaceName, Keys), (Status, Attributes)),
     Method('put', AsyncCall, (SpaceName, Key, Attributes), (Status,)),
+    Method('bulk_put', AsyncCall, (SpaceName, Objects), (Status,)),
     Method('cond_put', AsyncCall, (SpaceName, Key, Predicates, Attributes), (Status,)),
     Method('put_if_not_exist', AsyncCall, (SpaceName, Key, Attributes), (Status,)),
     Method('del', AsyncCall, (SpaceName, Key), (Status,)),
@@ -125,8 +139,14 @@ Client = [
     Method('map_string_append', AsyncCall, (SpaceName, Key, MapAttributes), (Status,)),
     Method('cond_map_string_append', AsyncCall, (SpaceName, Key, Predicates, MapAttributes), (Status,)),
     Method('search', Iterator, (SpaceName, Predicates), (Status, Attributes)),
+    Method('search_partial', Iterator, (SpaceName, Predicates, AttributeNames), (Status, Attributes)),
     Method('search_describe', AsyncCall, (SpaceName, Predicates), (Status, Description)),
     Method('sorted_search', Iterator, (SpaceName, Predicates, SortBy, Limit, MaxMin), (Status, Attributes)),
+    Method('sorted_search_partial', Iterator, (SpaceName, Predicates, AttributeNames, SortBy, Limit, MaxMin), (Status, Attributes)),
     Method('group_del', AsyncCall, (SpaceName, Predicates), (Status,)),
+    Method('group_put', AsyncCall, (SpaceName, Predicates, Attributes), (Status, Count)),
+    Method('group_atomic_add', AsyncCall, (SpaceName, Predicates, Attributes), (Status, Count)),
+    Method('group_atomic_sub', AsyncCall, (SpaceName, Predicates, Attributes), (Status, Count)),
     Method('count', AsyncCall, (SpaceName, Predicates), (Status, Count)),
+    Method('aggregate', Iterator, (SpaceName, Predicates, Aggregates, GroupBy), (Status, Attributes)),
     None][:-1]
@@ -86,6 +86,13 @@ cdef extern from "hyperdex.h":
         HYPERPREDICATE_LENGTH_LESS_EQUAL    = 9735
         HYPERPREDICATE_CONTAINS      = 9737
 
+    cdef enum hyperaggregate:
+        HYPERAGGREGATE_COUNT = 9856
+        HYPERAGGREGATE_SUM   = 9857
+        HYPERAGGREGATE_MIN   = 9858
+        HYPERAGGREGATE_MAX   = 9859
+        HYPERAGGREGATE_AVG   = 9860
+
 cdef extern from "hyperdex/client.h":
 
     cdef struct hyperdex_client
@@ -105,6 +112,16 @@ cdef extern from "hyperdex/client.h":
         size_t value_sz
         hyperdatatype value_datatype
 
+    cdef struct hyperdex_client_key:
+        char* key
+        size_t key_sz
+
+    cdef struct hyperdex_client_object:
+        char* key
+        size_t key_sz
+        hyperdex_client_attribute* attrs
+        size_t attrs_sz
+
     cdef struct hyperdex_client_attribute_check:
         char* attr
         char* value
@@ -112,6 +129,10 @@ cdef extern from "hyperdex/client.h":
         hyperdatatype datatype
         hyperpredicate predicate
 
+    cdef struct hyperdex_client_aggregate_spec:
+        char* attr
+        hyperaggregate op
+
     cdef enum hyperdex_client_returncode:
         HYPERDEX_CLIENT_SUCCESS      = 8448
         HYPERDEX_CLIENT_NOTFOUND     = 8449
@@ -143,7 +164,9 @@ cdef extern from "hyperdex/client.h":
     hyperdex_client* hyperdex_client_create(char* coordinator, uint16_t port)
     void hyperdex_client_destroy(hyperdex_client* client)
     int64_t hyperdex_client_get(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+    int64_t hyperdex_client_get_partial(hyperdex_client* client, char* space, char* key, size_t key_sz, char** attrnames, size_t attrnames_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
     int64_t hyperdex_client_put(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_attribute* attrs, size_t attrs_sz, hyperdex_client_returncode* status)
+    int64_t hyperdex_client_bulk_put(hyperdex_client* client, char* space, hyperdex_client_object* objects, size_t objects_sz, hyperdex_client_returncode* status)
     int64_t hyperdex_client_cond_put(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_attribute_check* condattrs, size_t condattrs_sz, hyperdex_client_attribute* attrs, size_t attrs_sz, hyperdex_client_returncode* status)
     int64_t hyperdex_client_put_if_not_exist(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_attribute* attrs, size_t attrs_sz, hyperdex_client_returncode* status)
     int64_t hyperdex_client_del(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_returncode* status)
@@ -204,14 +227,22 @@ cdef extern from "hyperdex/client.h":
     int64_t hyperdex_client_cond_map_string_prepend(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_attribute_check* condattrs, size_t condattrs_sz, hyperdex_client_map_attribute* attrs, size_t attrs_sz, hyperdex_client_returncode* status)
     int64_t hyperdex_client_map_string_append(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_map_attribute* attrs, size_t attrs_sz, hyperdex_client_returncode* status)
     int64_t hyperdex_client_cond_map_string_append(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_attribute_check* condattrs, size_t condattrs_sz, hyperdex_client_map_attribute* attrs, size_t attrs_sz, hyperdex_client_returncode* status)
+    int64_t hyperdex_client_get_many(hyperdex_client* client, char* space, hyperdex_client_key* keys, size_t keys_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
     int64_t hyperdex_client_search(hyperdex_client* client, char* space, hyperdex_client_attribute_check* chks, size_t chks_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+    int64_t hyperdex_client_search_partial(hyperdex_client* client, char* space, hyperdex_client_attribute_check* chks, size_t chks_sz, char** attrnames, size_t attrnames_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
     int64_t hyperdex_client_search_describe(hyperdex_client* client, char* space, hyperdex_client_attribute_check* chks, size_t chks_sz, hyperdex_client_returncode* status, char** text)
     int64_t hyperdex_client_sorted_search(hyperdex_client* client, char* space, hyperdex_client_attribute_check* chks, size_t chks_sz, char* sort_by, uint64_t limit, int maximize, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+    int64_t hyperdex_client_sorted_search_partial(hyperdex_client* client, char* space, hyperdex_client_attribute_check* chks, size_t chks_sz, char** attrnames, size_t attrnames_sz, char* sort_by, uint64_t limit, int maximize, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
     int64_t hyperdex_client_group_del(hyperdex_client* client, char* space, hyperdex_client_attribute_check* chks, size_t chks_sz, hyperdex_client_returncode* status)
+    int64_t hyperdex_client_group_put(hyperdex_client* client, char* space, hyperdex_client_attribute_check* chks, size_t chks_sz, hyperdex_client_attribute* attrs, size_t attrs_sz, hyperdex_client_returncode* status, uint64_t* count)
+    int64_t hyperdex_client_group_atomic_add(hyperdex_client* client, char* space, hyperdex_client_attribute_check* chks, size_t chks_sz, hyperdex_client_attribute* attrs, size_t attrs_sz, hyperdex_client_returncode* status, uint64_t* count)
+    int64_t hyperdex_client_group_atomic_sub(hyperdex_client* client, char* space, hyperdex_client_attribute_check* chks, size_t chks_sz, hyperdex_client_attribute* attrs, size_t attrs_sz, hyperdex_client_returncode* status, uint64_t* count)
     int64_t hyperdex_client_count(hyperdex_client* client, char* space, hyperdex_client_attribute_check* chks, size_t chks_sz, hyperdex_client_returncode* status, uint64_t* result)
+    int64_t hyperdex_client_aggregate(hyperdex_client* client, char* space, hyperdex_client_attribute_check* chks, size_t chks_sz, hyperdex_client_aggregate_spec* aggs, size_t aggs_sz, char* group_by, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
     int64_t hyperdex_client_loop(hyperdex_client* client, int timeout, hyperdex_client_returncode* status)
     void hyperdex_client_destroy_attrs(hyperdex_client_attribute* attrs, size_t attrs_sz)
 
+ctypedef int64_t (*hyperdex_client_group_op)(hyperdex_client*, char*, hyperdex_client_attribute_check*, size_t, hyperdex_client_attribute*, size_t, hyperdex_client_returncode*, uint64_t*)
 ctypedef int64_t (*hyperdex_client_simple_op)(hyperdex_client*, char*, char*, size_t, hyperdex_client_attribute*, size_t, hyperdex_client_returncode*)
 ctypedef int64_t (*hyperdex_client_map_op)(hyperdex_client*, char*, char*, size_t, hyperdex_client_map_attribute*, size_t, hyperdex_client_returncode*)
 ctypedef int64_t (*hyperdex_client_cond_op)(hyperdex_client*, char*, char*, size_t, hyperdex_client_attribute_check* condattrs, size_t condattrs_sz, hyperdex_client_attribute*, size_t, hyperdex_client_returncode*)
@@ -435,6 +466,19 @@ cdef _dict_to_attrs(list value, hyperdex_client_attribute** attrs):
     return backings
 
 
+cdef _attrnames_to_c(list attrnames, char*** names):
+    cdef list backings = []
+    cdef bytes backing
+    names[0] = <char**> malloc(sizeof(char*) * len(attrnames))
+    if names[0] == NULL and len(attrnames) > 0:
+        raise MemoryError()
+    for i, name in enumerate(attrnames):
+        backing = name
+        backings.append(backing)
+        names[0][i] = backing
+    return backings
+
+
 cdef _dict_to_map_attrs(list value, hyperdex_client_map_attribute** attrs, size_t* attrs_sz):
     cdef list backings = []
     cdef bytes kbacking
@@ -849,18 +893,30 @@ cdef class DeferredGet(Deferred):
     cdef size_t _attrs_sz
     cdef bytes _space
 
-    def __cinit__(self, Client client, bytes space, key):
+    def __cinit__(self, Client client, bytes space, key, list attrnames=None):
         self._attrs = <hyperdex_client_attribute*> NULL
         self._attrs_sz = 0
         self._space = space
         cdef bytes key_backing
+        cdef char** names = NULL
         datatype, key_backing = _obj_to_backing(key)
         cdef char* space_cstr = space
         cdef char* key_cstr = key_backing
-        self._reqid = hyperdex_client_get(client._client, space_cstr,
-                                      key_cstr, len(key_backing),
-                                      &self._status,
-                                      &self._attrs, &self._attrs_sz)
+        if attrnames is None:
+            self._reqid = hyperdex_client_get(client._client, space_cstr,
+                                          key_cstr, len(key_backing),
+                                          &self._status,
+                                          &self._attrs, &self._attrs_sz)
+        else:
+            try:
+                backings = _attrnames_to_c(attrnames, &names)
+                self._reqid = hyperdex_client_get_partial(client._client, space_cstr,
+                                                      key_cstr, len(key_backing),
+                                                      names, len(attrnames),
+                                                      &self._status,
+                                                      &self._attrs, &self._attrs_sz)
+            finally:
+                if names: free(names)
         _check_reqid(self._reqid, self._status)
         client._ops[self._reqid] = self
 
@@ -915,6 +971,52 @@ cdef class DeferredFromAttrs(Deferred):
             raise HyperClientException(self._status)
 
 
+cdef class DeferredBulkPut(Deferred):
+
+    def __cinit__(self, Client client, bytes space, dict objects):
+        cdef hyperdex_client_object* objs = NULL
+        cdef size_t objs_sz = len(objects)
+        cdef hyperdex_client_attribute* attrs = NULL
+        cdef bytes key_backing
+        cdef char* space_cstr = space
+        backings = []
+        try:
+            objs = <hyperdex_client_object*> \
+                   malloc(sizeof(hyperdex_client_object) * objs_sz)
+            if objs == NULL and objs_sz > 0:
+                raise MemoryError()
+            for i in range(objs_sz):
+                objs[i].attrs = NULL
+            for i, (key, value) in enumerate(objects.items()):
+                datatype, key_backing = _obj_to_backing(key)
+                backings.append(key_backing)
+                backings.append(_dict_to_attrs(value.items(), &attrs))
+                objs[i].key = key_backing
+                objs[i].key_sz = len(key_backing)
+                objs[i].attrs = attrs
+                objs[i].attrs_sz = len(value)
+                attrs = NULL
+            self._reqid = hyperdex_client_bulk_put(client._client, space_cstr,
+                                                   objs, objs_sz, &self._status)
+            _check_reqid(self._reqid, self._status)
+            client._ops[self._reqid] = self
+        finally:
+            if attrs:
+                free(attrs)
+            if objs:
+                for i in range(objs_sz):
+                    if objs[i].attrs:
+                        free(objs[i].attrs)
+                free(objs)
+
+    def wait(self):
+        Deferred.wait(self)
+        if self._status == HYPERDEX_CLIENT_SUCCESS:
+            return True
+        else:
+            raise HyperClientException(self._status)
+
+
 cdef class DeferredCondFromAttrs(Deferred):
 
     def __cinit__(self, Client client):
@@ -1145,6 +1247,38 @@ cdef class DeferredGroupDel(Deferred):
             raise HyperClientException(self._status)
 
 
+cdef class DeferredGroupAtomic(Deferred):
+
+    cdef uint64_t _count
+
+    def __cinit__(self, Client client):
+        self._count = 0
+
+    cdef call(self, hyperdex_client_group_op op, bytes space, dict predicate, dict value):
+        cdef char* space_cstr = space
+        cdef hyperdex_client_attribute_check* chks = NULL
+        cdef size_t chks_sz = 0
+        cdef hyperdex_client_attribute* attrs = NULL
+        try:
+            backings = _predicate_to_c(predicate, &chks, &chks_sz)
+            backings += _dict_to_attrs(value.items(), &attrs)
+            self._reqid = op(self._client._client, space_cstr,
+                             chks, chks_sz, attrs, len(value),
+                             &self._status, &self._count)
+            _check_reqid_search(self._reqid, self._status, chks, chks_sz)
+            self._client._ops[self._reqid] = self
+        finally:
+            if chks: free(chks)
+            if attrs: free(attrs)
+
+    def wait(self):
+        Deferred.wait(self)
+        if self._status == HYPERDEX_CLIENT_SUCCESS:
+            return self._count
+        else:
+            raise HyperClientException(self._status)
+
+
 cdef class DeferredSearchDescribe(Deferred):
 
     cdef char* _text
@@ -1253,41 +1387,144 @@ cdef class SearchBase:
 
 cdef class Search(SearchBase):
 
-    def __cinit__(self, Client client, bytes space, dict predicate):
+    def __cinit__(self, Client client, bytes space, dict predicate, list attrnames=None):
         cdef hyperdex_client_attribute_check* chks = NULL
         cdef size_t chks_sz = 0
+        cdef char** names = NULL
         try:
             backings = _predicate_to_c(predicate, &chks, &chks_sz)
-            self._reqid = hyperdex_client_search(client._client, space,
-                                             chks, chks_sz,
-                                             &self._status,
-                                             &self._attrs,
-                                             &self._attrs_sz)
+            if attrnames is None:
+                self._reqid = hyperdex_client_search(client._client, space,
+                                                 chks, chks_sz,
+                                                 &self._status,
+                                                 &self._attrs,
+                                                 &self._attrs_sz)
+            else:
+                backings += _attrnames_to_c(attrnames, &names)
+                self._reqid = hyperdex_client_search_partial(client._client, space,
+                                                         chks, chks_sz,
+                                                         names, len(attrnames),
+                                                         &self._status,
+                                                         &self._attrs,
+                                                         &self._attrs_sz)
             _check_reqid_search(self._reqid, self._status, chks, chks_sz)
             client._ops[self._reqid] = self
         finally:
             if chks: free(chks)
+            if names: free(names)
+
+
+cdef class GetMany(SearchBase):
+
+    def __cinit__(self, Client client, bytes space, list keys):
+        cdef hyperdex_client_key* ks = NULL
+        cdef size_t ks_sz = len(keys)
+        cdef bytes key_backing
+        backings = []
+        try:
+            ks = <hyperdex_client_key*> malloc(sizeof(hyperdex_client_key) * ks_sz)
+            if ks == NULL and ks_sz > 0:
+                raise MemoryError()
+            for i, key in enumerate(keys):
+                datatype, key_backing = _obj_to_backing(key)
+                backings.append(key_backing)
+                ks[i].key = key_backing
+                ks[i].key_sz = len(key_backing)
+            self._reqid = hyperdex_client_get_many(client._client, space,
+                                                   ks, ks_sz,
+                                                   &self._status,
+                                                   &self._attrs,
+                                                   &self._attrs_sz)
+            _check_reqid(self._reqid, self._status)
+            client._ops[self._reqid] = self
+        finally:
+            if ks: free(ks)
 
 
 cdef class SortedSearch(SearchBase):
 
     def __cinit__(self, Client client, bytes space, dict predicate,
-                  bytes sort_by, long limit, bytes compare):
+                  bytes sort_by, long limit, bytes compare, list attrnames=None):
         cdef uint64_t lim = limit
         cdef int maxi = 0
         cdef hyperdex_client_attribute_check* chks = NULL
         cdef size_t chks_sz = 0
+        cdef char** names = NULL
         if compare not in ('maximize', 'max', 'minimize', 'min'):
             raise ValueError("'compare' must be either 'max' or 'min'")
         if compare in ('max', 'maximize'):
             maxi = 1
         try:
             backings = _predicate_to_c(predicate, &chks, &chks_sz)
-            self._reqid = hyperdex_client_sorted_search(client._client, space,
+            if attrnames is None:
+                self._reqid = hyperdex_client_sorted_search(client._client, space,
+                                                        chks, chks_sz,
+                                                        sort_by,
+                                                        lim,
+                                                        maxi,
+                                                        &self._status,
+                                                        &self._attrs,
+                                                        &self._attrs_sz)
+            else:
+                backings += _attrnames_to_c(attrnames, &names)
+                self._reqid = hyperdex_client_sorted_search_partial(client._client, space,
+                                                                chks, chks_sz,
+                                                                names, len(attrnames),
+                                                                sort_by,
+                                                                lim,
+                                                                maxi,
+                                                                &self._status,
+                                                                &self._attrs,
+                                                                &self._attrs_sz)
+            _check_reqid_search(self._reqid, self._status, chks, chks_sz)
+            client._ops[self._reqid] = self
+        finally:
+            if chks: free(chks)
+            if names: free(names)
+
+
+_aggregate_ops = {'count': HYPERAGGREGATE_COUNT,
+                  'sum': HYPERAGGREGATE_SUM,
+                  'min': HYPERAGGREGATE_MIN,
+                  'max': HYPERAGGREGATE_MAX,
+                  'avg': HYPERAGGREGATE_AVG}
+
+
+cdef class Aggregate(SearchBase):
+
+    # Each of aggs is either 'count' or an (op, attr) pair such as
+    # ('sum', 'price').  Every group yields one dict.
+    def __cinit__(self, Client client, bytes space, dict predicate,
+                  list aggs, bytes group_by=None):
+        cdef hyperdex_client_attribute_check* chks = NULL
+        cdef size_t chks_sz = 0
+        cdef hyperdex_client_aggregate_spec* ags = NULL
+        cdef size_t ags_sz = len(aggs)
+        cdef char* group_by_cstr = NULL
+        cdef bytes attr
+        if group_by is not None:
+            group_by_cstr = group_by
+        try:
+            backings = _predicate_to_c(predicate, &chks, &chks_sz)
+            ags = <hyperdex_client_aggregate_spec*> \
+                  malloc(sizeof(hyperdex_client_aggregate_spec) * ags_sz)
+            if ags == NULL and ags_sz > 0:
+                raise MemoryError()
+            for i, agg in enumerate(aggs):
+                if isinstance(agg, tuple):
+                    op, attr = agg
+                    backings.append(attr)
+                    ags[i].attr = attr
+                else:
+                    op = agg
+                    ags[i].attr = NULL
+                if op not in _aggregate_ops:
+                    raise ValueError("aggregate must be one of 'count', 'sum', 'min', 'max', or 'avg'")
+                ags[i].op = _aggregate_ops[op]
+            self._reqid = hyperdex_client_aggregate(client._client, space,
                                                     chks, chks_sz,
-                                                    sort_by,
-                                                    lim,
-                                                    maxi,
+                                                    ags, ags_sz,
+                                                    group_by_cstr,
                                                     &self._status,
                                                     &self._attrs,
                                                     &self._attrs_sz)
@@ -1295,6 +1532,7 @@ cdef class SortedSearch(SearchBase):
             client._ops[self._reqid] = self
         finally:
             if chks: free(chks)
+            if ags: free(ags)
 
 
 cdef class Predicate:
@@ -1373,10 +1611,18 @@ cdef class Client:
         async = self.async_get(space, key)
         return async.wait()
 
+    def get_partial(self, bytes space, key, list attrnames):
+        async = self.async_get_partial(space, key, attrnames)
+        return async.wait()
+
     def put(self, bytes space, key, dict value):
         async = self.async_put(space, key, value)
         return async.wait()
 
+    def bulk_put(self, bytes space, dict objects):
+        async = self.async_bulk_put(space, objects)
+        return async.wait()
+
     def cond_put(self, bytes space, key, dict condition, dict value):
         async = self.async_cond_put(space, key, condition, value)
         return async.wait()
@@ -1625,24 +1871,55 @@ cdef class Client:
         async = self.async_group_del(space, predicate)
         return async.wait()
 
+    def group_put(self, bytes space, dict predicate, dict value):
+        async = self.async_group_put(space, predicate, value)
+        return async.wait()
+
+    def group_atomic_add(self, bytes space, dict predicate, dict value):
+        async = self.async_group_atomic_add(space, predicate, value)
+        return async.wait()
+
+    def group_atomic_sub(self, bytes space, dict predicate, dict value):
+        async = self.async_group_atomic_sub(space, predicate, value)
+        return async.wait()
+
     def count(self, bytes space, dict predicate, bool unsafe=False):
         async = self.async_count(space, predicate, unsafe)
         return async.wait()
 
+    def get_many(self, bytes space, list keys):
+        return GetMany(self, space, keys)
+
     def search(self, bytes space, dict predicate):
         return Search(self, space, predicate)
 
+    def search_partial(self, bytes space, dict predicate, list attrnames):
+        return Search(self, space, predicate, attrnames)
+
     def sorted_search(self, bytes space, dict predicate, bytes sort_by, long limit, bytes compare):
         return SortedSearch(self, space, predicate, sort_by, limit, compare)
 
+    def sorted_search_partial(self, bytes space, dict predicate, list attrnames,
+                              bytes sort_by, long limit, bytes compare):
+        return SortedSearch(self, space, predicate, sort_by, limit, compare, attrnames)
+
+    def aggregate(self, bytes space, dict predicate, list aggs, bytes group_by=None):
+        return Aggregate(self, space, predicate, aggs, group_by)
+
     def async_get(self, bytes space, key):
         return DeferredGet(self, space, key)
 
+    def async_get_partial(self, bytes space, key, list attrnames):
+        return DeferredGet(self, space, key, attrnames)
+
     def async_put(self, bytes space, key, dict value):
         d = DeferredFromAttrs(self)
         d.call(<hyperdex_client_simple_op> hyperdex_client_put, space, key, value)
         return d
 
+    def async_bulk_put(self, bytes space, dict objects):
+        return DeferredBulkPut(self, space, objects)
+
     def async_put_if_not_exist(self, bytes space, key, dict value):
         d = DeferredFromAttrs(self)
         d.call(<hyperdex_client_simple_op> hyperdex_client_put_if_not_exist, space, key, value)
@@ -1946,6 +2223,21 @@ cdef class Client:
     def async_group_del(self, bytes space, dict predicate):
         return DeferredGroupDel(self, space, predicate)
 
+    def async_group_put(self, bytes space, dict predicate, dict value):
+        d = DeferredGroupAtomic(self)
+        d.call(<hyperdex_client_group_op> hyperdex_client_group_put, space, predicate, value)
+        return d
+
+    def async_group_atomic_add(self, bytes space, dict predicate, dict value):
+        d = DeferredGroupAtomic(self)
+        d.call(<hyperdex_client_group_op> hyperdex_client_group_atomic_add, space, predicate, value)
+        return d
+
+    def async_group_atomic_sub(self, bytes space, dict predicate, dict value):
+        d = DeferredGroupAtomic(self)
+        d.call(<hyperdex_client_group_op> hyperdex_client_group_atomic_sub, space, predicate, value)
+        return d
+
     def async_count(self, bytes space, dict predicate, bool unsafe=False):
         return DeferredCount(self, space, predicate, unsafe)
 
@@ -28,6 +28,7 @@
 
 /* C */
 #include <assert.h>
+#include <string.h>
 
 /* Ruby */
 #include <ruby.h>
@@ -415,6 +416,39 @@ hyperdex_ruby_client_convert_key(struct hyperdex_ds_arena* arena,
     /* XXX if datatype is not key type */
 }
 
+static void
+hyperdex_ruby_client_convert_keys(struct hyperdex_ds_arena* arena,
+                                  VALUE x,
+                                  const struct hyperdex_client_key** _keys,
+                                  size_t* _keys_sz)
+{
+    struct hyperdex_client_key* keys = NULL;
+    size_t keys_sz = 0;
+    size_t i = 0;
+
+    if (TYPE(x) != T_ARRAY)
+    {
+        rb_exc_raise(rb_exc_new2(rb_eTypeError, "Keys must be specified as an array"));
+        abort(); // unreachable?
+    }
+
+    keys_sz = RARRAY_LEN(x);
+    keys = hyperdex_ds_allocate_key(arena, keys_sz);
+
+    if (!keys)
+    {
+        // XXX
+    }
+
+    *_keys = keys;
+    *_keys_sz = keys_sz;
+
+    for (i = 0; i < keys_sz; ++i)
+    {
+        hyperdex_ruby_client_convert_key(arena, rb_ary_entry(x, i), &keys[i].key, &keys[i].key_sz);
+    }
+}
+
 static void
 hyperdex_ruby_client_convert_limit(struct hyperdex_ds_arena* arena,
                                    VALUE x,
@@ -507,6 +541,171 @@ hyperdex_ruby_client_convert_maxmin(struct hyperdex_ds_arena* arena,
     *maxmin = x == Qtrue ? 1: 0;
 }
 
+static void
+hyperdex_ruby_client_convert_attributenames(struct hyperdex_ds_arena* arena,
+                                            VALUE x,
+                                            const char*** _attrnames,
+                                            size_t* _attrnames_sz)
+{
+    const char** attrnames = NULL;
+    size_t attrnames_sz = 0;
+    size_t i = 0;
+
+    if (TYPE(x) != T_ARRAY)
+    {
+        rb_exc_raise(rb_exc_new2(rb_eTypeError, "Attribute names must be specified as an array"));
+        abort(); // unreachable?
+    }
+
+    attrnames_sz = RARRAY_LEN(x);
+    attrnames = hyperdex_ds_allocate_attribute_names(arena, attrnames_sz);
+
+    if (!attrnames)
+    {
+        // XXX
+    }
+
+    *_attrnames = attrnames;
+    *_attrnames_sz = attrnames_sz;
+
+    for (i = 0; i < attrnames_sz; ++i)
+    {
+        attrnames[i] = hyperdex_ruby_client_convert_cstring(rb_ary_entry(x, i),
+                       "Attribute name must be a string or symbol");
+    }
+}
+
+static enum hyperaggregate
+hyperdex_ruby_client_convert_aggregate_op(VALUE x)
+{
+    const char* op = hyperdex_ruby_client_convert_cstring(x, "Aggregate must be a string or symbol");
+
+    if (strcmp(op, "count") == 0)
+    {
+        return HYPERAGGREGATE_COUNT;
+    }
+    else if (strcmp(op, "sum") == 0)
+    {
+        return HYPERAGGREGATE_SUM;
+    }
+    else if (strcmp(op, "min") == 0)
+    {
+        return HYPERAGGREGATE_MIN;
+    }
+    else if (strcmp(op, "max") == 0)
+    {
+        return HYPERAGGREGATE_MAX;
+    }
+    else if (strcmp(op, "avg") == 0)
+    {
+        return HYPERAGGREGATE_AVG;
+    }
+
+    rb_exc_raise(rb_exc_new2(rb_eValueError, "Aggregate must be one of count, sum, min, max, or avg"));
+    abort(); // unreachable?
+}
+
+/* Aggregates are an array whose entries are either :count or [op, attr] */
+static void
+hyperdex_ruby_client_convert_aggregates(struct hyperdex_ds_arena* arena,
+                                        VALUE x,
+                                        const struct hyperdex_client_aggregate_spec** _aggs,
+                                        size_t* _aggs_sz)
+{
+    VALUE entry = Qnil;
+    struct hyperdex_client_aggregate_spec* aggs = NULL;
+    size_t aggs_sz = 0;
+    size_t i = 0;
+
+    if (TYPE(x) != T_ARRAY)
+    {
+        rb_exc_raise(rb_exc_new2(rb_eTypeError, "Aggregates must be specified as an array"));
+        abort(); // unreachable?
+    }
+
+    aggs_sz = RARRAY_LEN(x);
+    aggs = hyperdex_ds_allocate_aggregate_spec(arena, aggs_sz);
+
+    if (!aggs)
+    {
+        // XXX
+    }
+
+    *_aggs = aggs;
+    *_aggs_sz = aggs_sz;
+
+    for (i = 0; i < aggs_sz; ++i)
+    {
+        entry = rb_ary_entry(x, i);
+
+        if (TYPE(entry) == T_ARRAY && RARRAY_LEN(entry) == 2)
+        {
+            aggs[i].op = hyperdex_ruby_client_convert_aggregate_op(rb_ary_entry(entry, 0));
+            aggs[i].attr = hyperdex_ruby_client_convert_cstring(rb_ary_entry(entry, 1),
+                           "Attribute name must be a string or symbol");
+        }
+        else
+        {
+            aggs[i].op = hyperdex_ruby_client_convert_aggregate_op(entry);
+            aggs[i].attr = NULL;
+        }
+    }
+}
+
+static void
+hyperdex_ruby_client_convert_groupby(struct hyperdex_ds_arena* arena,
+                                     VALUE x,
+                                     const char** groupby)
+{
+    if (NIL_P(x))
+    {
+        *groupby = NULL;
+        return;
+    }
+
+    *groupby = hyperdex_ruby_client_convert_cstring(x, "groupby must be a string, symbol, or nil");
+}
+
+static void
+hyperdex_ruby_client_convert_objects(struct hyperdex_ds_arena* arena,
+                                     VALUE x,
+                                     const struct hyperdex_client_object** _objects,
+                                     size_t* _objects_sz)
+{
+    VALUE hash_pairs = Qnil;
+    VALUE hash_pair = Qnil;
+    struct hyperdex_client_object* objects = NULL;
+    size_t objects_sz = 0;
+    size_t i = 0;
+
+    if (TYPE(x) != T_HASH)
+    {
+        rb_exc_raise(rb_exc_new2(rb_eTypeError, "Objects must be specified as a hash"));
+        abort(); // unreachable?
+    }
+
+    hash_pairs = rb_funcall(x, rb_intern("to_a"), 0);
+    objects_sz = RARRAY_LEN(hash_pairs);
+    objects = hyperdex_ds_allocate_object(arena, objects_sz);
+
+    if (!objects)
+    {
+        // XXX
+    }
+
+    *_objects = objects;
+    *_objects_sz = objects_sz;
+
+    for (i = 0; i < objects_sz; ++i)
+    {
+        hash_pair = rb_ary_entry(hash_pairs, i);
+        hyperdex_ruby_client_convert_key(arena, rb_ary_entry(hash_pair, 0),
+                                         &objects[i].key, &objects[i].key_sz);
+        hyperdex_ruby_client_convert_attributes(arena, rb_ary_entry(hash_pair, 1),
+                                                &objects[i].attrs, &objects[i].attrs_sz);
+    }
+}
+
 static size_t
 hyperdex_ruby_client_estimate_predicate_size(VALUE x)
 {
@@ -30,8 +30,13 @@
 
 rb_define_method(class_client, "async_get", hyperdex_ruby_client_get, 2);
 rb_define_method(class_client, "get", hyperdex_ruby_client_wait_get, 2);
+rb_define_method(class_client, "async_get_partial", hyperdex_ruby_client_get_partial, 3);
+rb_define_method(class_client, "get_partial", hyperdex_ruby_client_wait_get_partial, 3);
+rb_define_method(class_client, "get_many", hyperdex_ruby_client_get_many, 2);
 rb_define_method(class_client, "async_put", hyperdex_ruby_client_put, 3);
 rb_define_method(class_client, "put", hyperdex_ruby_client_wait_put, 3);
+rb_define_method(class_client, "async_bulk_put", hyperdex_ruby_client_bulk_put, 2);
+rb_define_method(class_client, "bulk_put", hyperdex_ruby_client_wait_bulk_put, 2);
 rb_define_method(class_client, "async_cond_put", hyperdex_ruby_client_cond_put, 4);
 rb_define_method(class_client, "cond_put", hyperdex_ruby_client_wait_cond_put, 4);
 rb_define_method(class_client, "async_put_if_not_exist", hyperdex_ruby_client_put_if_not_exist, 3);
@@ -153,10 +158,19 @@ rb_define_method(class_client, "map_string_append", hyperdex_ruby_client_wait_ma
 rb_define_method(class_client, "async_cond_map_string_append", hyperdex_ruby_client_cond_map_string_append, 4);
 rb_define_method(class_client, "cond_map_string_append", hyperdex_ruby_client_wait_cond_map_string_append, 4);
 rb_define_method(class_client, "search", hyperdex_ruby_client_search, 2);
+rb_define_method(class_client, "search_partial", hyperdex_ruby_client_search_partial, 3);
 rb_define_method(class_client, "async_search_describe", hyperdex_ruby_client_search_describe, 2);
 rb_define_method(class_client, "search_describe", hyperdex_ruby_client_wait_search_describe, 2);
 rb_define_method(class_client, "sorted_search", hyperdex_ruby_client_sorted_search, 5);
+rb_define_method(class_client, "sorted_search_partial", hyperdex_ruby_client_sorted_search_partial, 6);
 rb_define_method(class_client, "async_group_del", hyperdex_ruby_client_group_del, 2);
 rb_define_method(class_client, "group_del", hyperdex_ruby_client_wait_group_del, 2);
+rb_define_method(class_client, "async_group_put", hyperdex_ruby_client_group_put, 3);
+rb_define_method(class_client, "group_put", hyperdex_ruby_client_wait_group_put, 3);
+rb_define_method(class_client, "async_group_atomic_add", hyperdex_ruby_client_group_atomic_add, 3);
+rb_define_method(class_client, "group_atomic_add", hyperdex_ruby_client_wait_group_atomic_add, 3);
+rb_define_method(class_client, "async_group_atomic_sub", hyperdex_ruby_client_group_atomic_sub, 3);
+rb_define_method(class_client, "group_atomic_sub", hyperdex_ruby_client_wait_group_atomic_sub, 3);
 rb_define_method(class_client, "async_count", hyperdex_ruby_client_count, 2);
 rb_define_method(class_client, "count", hyperdex_ruby_client_wait_count, 2);
+rb_define_method(class_client, "aggregate", hyperdex_ruby_client_aggregate, 4);
@@ -194,6 +194,42 @@ hyperdex_client_get(struct hyperdex_client* _cl,
     );
 }
 
+HYPERDEX_API int64_t
+hyperdex_client_get_partial(struct hyperdex_client* _cl,
+                            const char* space,
+                            const char* key, size_t key_sz,
+                            const char** attrnames, size_t attrnames_sz,
+                            hyperdex_client_returncode* status,
+                            const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    C_WRAP_EXCEPT(
+    return cl->get_partial(space, key, key_sz, attrnames, attrnames_sz, status, attrs, attrs_sz);
+    );
+}
+
+HYPERDEX_API int64_t
+hyperdex_client_get_many(struct hyperdex_client* _cl,
+                         const char* space,
+                         const struct hyperdex_client_key* keys, size_t keys_sz,
+                         hyperdex_client_returncode* status,
+                         const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    C_WRAP_EXCEPT(
+    return cl->get_many(space, keys, keys_sz, status, attrs, attrs_sz);
+    );
+}
+
+HYPERDEX_API int64_t
+hyperdex_client_bulk_put(struct hyperdex_client* _cl,
+                         const char* space,
+                         const struct hyperdex_client_object* objects, size_t objects_sz,
+                         hyperdex_client_returncode* status)
+{
+    C_WRAP_EXCEPT(
+    return cl->bulk_put(space, objects, objects_sz, status);
+    );
+}
+
 HYPERDEX_API int64_t
 hyperdex_client_put(struct hyperdex_client* _cl,
                     const char* space,
@@ -1088,6 +1124,19 @@ hyperdex_client_search(struct hyperdex_client* _cl,
     );
 }
 
+HYPERDEX_API int64_t
+hyperdex_client_search_partial(struct hyperdex_client* _cl,
+                               const char* space,
+                               const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                               const char** attrnames, size_t attrnames_sz,
+                               hyperdex_client_returncode* status,
+                               const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    C_WRAP_EXCEPT(
+    return cl->search_partial(space, checks, checks_sz, attrnames, attrnames_sz, status, attrs, attrs_sz);
+    );
+}
+
 HYPERDEX_API int64_t
 hyperdex_client_search_describe(struct hyperdex_client* _cl,
                                 const char* space,
@@ -1113,6 +1162,20 @@ hyperdex_client_sorted_search(struct hyperdex_client* _cl,
     );
 }
 
+HYPERDEX_API int64_t
+hyperdex_client_sorted_search_partial(struct hyperdex_client* _cl,
+                                      const char* space,
+                                      const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                      const char** attrnames, size_t attrnames_sz,
+                                      const char* sort_by, uint64_t limit, int maximize,
+                                      hyperdex_client_returncode* status,
+                                      const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    C_WRAP_EXCEPT(
+    return cl->sorted_search_partial(space, checks, checks_sz, attrnames, attrnames_sz, sort_by, limit, maximize, status, attrs, attrs_sz);
+    );
+}
+
 HYPERDEX_API int64_t
 hyperdex_client_group_del(struct hyperdex_client* _cl,
                           const char* space,
@@ -1124,6 +1187,48 @@ hyperdex_client_group_del(struct hyperdex_client* _cl,
     );
 }
 
+HYPERDEX_API int64_t
+hyperdex_client_group_put(struct hyperdex_client* _cl,
+                          const char* space,
+                          const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                          const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
+                          hyperdex_client_returncode* status, uint64_t* count)
+{
+    C_WRAP_EXCEPT(
+    const hyperdex_client_keyop_info* opinfo;
+    opinfo = hyperdex_client_keyop_info_lookup(XSTR(put), strlen(XSTR(put)));
+    return cl->perform_group_funcall(opinfo, space, checks, checks_sz, attrs, attrs_sz, status, count);
+    );
+}
+
+HYPERDEX_API int64_t
+hyperdex_client_group_atomic_add(struct hyperdex_client* _cl,
+                                 const char* space,
+                                 const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                 const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
+                                 hyperdex_client_returncode* status, uint64_t* count)
+{
+    C_WRAP_EXCEPT(
+    const hyperdex_client_keyop_info* opinfo;
+    opinfo = hyperdex_client_keyop_info_lookup(XSTR(atomic_add), strlen(XSTR(atomic_add)));
+    return cl->perform_group_funcall(opinfo, space, checks, checks_sz, attrs, attrs_sz, status, count);
+    );
+}
+
+HYPERDEX_API int64_t
+hyperdex_client_group_atomic_sub(struct hyperdex_client* _cl,
+                                 const char* space,
+                                 const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                 const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
+                                 hyperdex_client_returncode* status, uint64_t* count)
+{
+    C_WRAP_EXCEPT(
+    const hyperdex_client_keyop_info* opinfo;
+    opinfo = hyperdex_client_keyop_info_lookup(XSTR(atomic_sub), strlen(XSTR(atomic_sub)));
+    return cl->perform_group_funcall(opinfo, space, checks, checks_sz, attrs, attrs_sz, status, count);
+    );
+}
+
 HYPERDEX_API int64_t
 hyperdex_client_count(struct hyperdex_client* _cl,
                       const char* space,
@@ -1135,6 +1240,20 @@ hyperdex_client_count(struct hyperdex_client* _cl,
     );
 }
 
+HYPERDEX_API int64_t
+hyperdex_client_aggregate(struct hyperdex_client* _cl,
+                          const char* space,
+                          const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                          const struct hyperdex_client_aggregate_spec* aggs, size_t aggs_sz,
+                          const char* group_by,
+                          hyperdex_client_returncode* status,
+                          const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    C_WRAP_EXCEPT(
+    return cl->aggregate(space, checks, checks_sz, aggs, aggs_sz, group_by, status, attrs, attrs_sz);
+    );
+}
+
 HYPERDEX_API int64_t
 hyperdex_client_loop(struct hyperdex_client* _cl, int timeout,
                      hyperdex_client_returncode* status)
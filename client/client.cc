@@ -45,9 +45,13 @@
 #include "common/serialization.h"
 #include "client/client.h"
 #include "client/constants.h"
+#include "client/pending_aggregate.h"
 #include "client/pending_atomic.h"
+#include "client/pending_bulk_atomic.h"
 #include "client/pending_count.h"
 #include "client/pending_get.h"
+#include "client/pending_get_many.h"
+#include "client/pending_group_atomic.h"
 #include "client/pending_group_del.h"
 #include "client/pending_search.h"
 #include "client/pending_search_describe.h"
@@ -90,9 +94,27 @@ client :: ~client() throw ()
 }
 
 int64_t
-client :: get(const char* space, const char* _key, size_t _key_sz,
+client :: get(const char* space, const char* key, size_t key_sz,
               hyperdex_client_returncode* status,
               const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    return perform_get(space, key, key_sz, false, NULL, 0, status, attrs, attrs_sz);
+}
+
+int64_t
+client :: get_partial(const char* space, const char* key, size_t key_sz,
+                      const char** attrnames, size_t attrnames_sz,
+                      hyperdex_client_returncode* status,
+                      const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    return perform_get(space, key, key_sz, true, attrnames, attrnames_sz, status, attrs, attrs_sz);
+}
+
+int64_t
+client :: perform_get(const char* space, const char* _key, size_t _key_sz,
+                      bool partial, const char** attrnames, size_t attrnames_sz,
+                      hyperdex_client_returncode* status,
+                      const hyperdex_client_attribute** attrs, size_t* attrs_sz)
 {
     if (!maintain_coord_connection(status))
     {
@@ -117,14 +139,236 @@ client :: get(const char* space, const char* _key, size_t _key_sz,
         return -1;
     }
 
+    std::vector<uint16_t> projection;
+
+    if (partial &&
+        prepare_projection(space, *sc, attrnames, attrnames_sz, status, &projection) < attrnames_sz)
+    {
+        return -1;
+    }
+
     e::intrusive_ptr<pending> op;
-    op = new pending_get(m_next_client_id++, status, attrs, attrs_sz);
-    size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ + sizeof(uint32_t) + key.size();
+    op = new pending_get(m_next_client_id++, status, attrs, attrs_sz,
+                         partial ? &projection : NULL);
+    size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ + sizeof(uint32_t) + key.size()
+              + (partial ? pack_size(projection) : 0);
     std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
-    msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ) << key;
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ) << key;
+
+    // daemons treat a trailing projection as optional
+    if (partial)
+    {
+        pa = pa << projection;
+    }
+
     return send_keyop(space, key, REQ_GET, msg, op, status);
 }
 
+int64_t
+client :: get_many(const char* space,
+                   const hyperdex_client_key* keys, size_t keys_sz,
+                   hyperdex_client_returncode* status,
+                   const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    if (!maintain_coord_connection(status))
+    {
+        return -1;
+    }
+
+    const schema* sc = m_coord.config()->get_schema(space);
+
+    if (!sc)
+    {
+        ERROR(UNKNOWNSPACE) << "space \"" << e::strescape(space) << "\" does not exist";
+        return -1;
+    }
+
+    if (keys_sz == 0)
+    {
+        ERROR(NONEPENDING) << "get_many needs at least one key";
+        return -1;
+    }
+
+    datatype_info* di = datatype_info::lookup(sc->attrs[0].type);
+    assert(di);
+
+    // group the keys by the server that leads their region so that each
+    // server sees exactly one request, no matter how many keys it holds
+    typedef std::vector<std::pair<virtual_server_id, e::slice> > key_list_t;
+    typedef std::map<server_id, key_list_t> key_batches_t;
+    key_batches_t batches;
+
+    for (size_t i = 0; i < keys_sz; ++i)
+    {
+        e::slice key(keys[i].key, keys[i].key_sz);
+
+        if (!di->validate(key))
+        {
+            ERROR(WRONGTYPE) << "key must be type " << sc->attrs[0].type;
+            return -1 - i;
+        }
+
+        virtual_server_id vsi = m_coord.config()->point_leader(space, key);
+
+        if (vsi == virtual_server_id())
+        {
+            ERROR(OFFLINE) << "all servers for key \""
+                           << e::strescape(std::string(reinterpret_cast<const char*>(key.data()), key.size()))
+                           << "\" in space \"" << e::strescape(space)
+                           << "\" are offline: bring one or more online to remedy the issue";
+            return -1 - i;
+        }
+
+        batches[m_coord.config()->get_server_id(vsi)].push_back(std::make_pair(vsi, key));
+    }
+
+    int64_t client_id = m_next_client_id++;
+    e::intrusive_ptr<pending_aggregation> op;
+    op = new pending_get_many(this, client_id, status, attrs, attrs_sz);
+
+    for (key_batches_t::iterator it = batches.begin(); it != batches.end(); ++it)
+    {
+        const key_list_t& kl(it->second);
+        size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ
+                  + sizeof(uint64_t);
+
+        for (size_t i = 0; i < kl.size(); ++i)
+        {
+            sz += sizeof(uint64_t) + pack_size(kl[i].second);
+        }
+
+        std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+        e::buffer::packer pa = msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ);
+        pa = pa << static_cast<uint64_t>(kl.size());
+
+        for (size_t i = 0; i < kl.size(); ++i)
+        {
+            pa = pa << kl[i].first << kl[i].second;
+        }
+
+        // address the batch to the first key's virtual server; the daemon
+        // routes each key by the virtual server packed alongside it
+        std::vector<virtual_server_id> servers(1, kl[0].first);
+        perform_aggregation(servers, op, REQ_GET_MANY, msg, status);
+    }
+
+    return op->client_visible_id();
+}
+
+int64_t
+client :: bulk_put(const char* space,
+                   const hyperdex_client_object* objects, size_t objects_sz,
+                   hyperdex_client_returncode* status)
+{
+    if (!maintain_coord_connection(status))
+    {
+        return -1;
+    }
+
+    const schema* sc = m_coord.config()->get_schema(space);
+
+    if (!sc)
+    {
+        ERROR(UNKNOWNSPACE) << "space \"" << e::strescape(space) << "\" does not exist";
+        return -1;
+    }
+
+    if (objects_sz == 0)
+    {
+        ERROR(NONEPENDING) << "bulk_put needs at least one object";
+        return -1;
+    }
+
+    datatype_info* di = datatype_info::lookup(sc->attrs[0].type);
+    assert(di);
+    const hyperdex_client_keyop_info* opinfo;
+    opinfo = hyperdex_client_keyop_info_lookup("put", 3);
+    assert(opinfo);
+    const uint8_t flags = (opinfo->fail_if_not_found ? 1 : 0)
+                        | (opinfo->fail_if_found ? 2 : 0)
+                        | (opinfo->erase ? 0 : 128);
+    const std::vector<attribute_check> checks;
+
+    // Validate every object before sending anything so that a bad object
+    // fails the call as a whole.  Objects are grouped by the server that
+    // leads their region, and each server gets one REQ_BULK_ATOMIC.
+    std::vector<virtual_server_id> vsis(objects_sz);
+    std::vector<std::vector<funcall> > funcs(objects_sz);
+    typedef std::map<server_id, std::vector<size_t> > object_batches_t;
+    object_batches_t batches;
+
+    for (size_t i = 0; i < objects_sz; ++i)
+    {
+        e::slice key(objects[i].key, objects[i].key_sz);
+
+        if (!di->validate(key))
+        {
+            ERROR(WRONGTYPE) << "key must be type " << sc->attrs[0].type;
+            return -1 - i;
+        }
+
+        size_t idx = prepare_funcs(space, *sc, opinfo, objects[i].attrs, objects[i].attrs_sz, status, &funcs[i]);
+
+        if (idx < objects[i].attrs_sz)
+        {
+            return -1 - i;
+        }
+
+        std::stable_sort(funcs[i].begin(), funcs[i].end());
+        vsis[i] = m_coord.config()->point_leader(space, key);
+
+        if (vsis[i] == virtual_server_id())
+        {
+            ERROR(OFFLINE) << "all servers for key \""
+                           << e::strescape(std::string(reinterpret_cast<const char*>(key.data()), key.size()))
+                           << "\" in space \"" << e::strescape(space)
+                           << "\" are offline: bring one or more online to remedy the issue";
+            return -1 - i;
+        }
+
+        batches[m_coord.config()->get_server_id(vsis[i])].push_back(i);
+    }
+
+    e::intrusive_ptr<pending> op;
+    op = new pending_bulk_atomic(m_next_client_id++, status);
+
+    for (object_batches_t::iterator it = batches.begin(); it != batches.end(); ++it)
+    {
+        const std::vector<size_t>& idxs(it->second);
+        std::vector<std::pair<uint64_t, virtual_server_id> > nonces;
+        nonces.reserve(idxs.size());
+        size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ
+                  + sizeof(uint64_t);
+
+        for (size_t i = 0; i < idxs.size(); ++i)
+        {
+            e::slice key(objects[idxs[i]].key, objects[idxs[i]].key_sz);
+            sz += sizeof(uint64_t)
+                + sizeof(uint64_t)
+                + pack_size(key)
+                + sizeof(uint8_t)
+                + pack_size(checks)
+                + pack_size(funcs[idxs[i]]);
+        }
+
+        std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+        e::buffer::packer pa = msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ);
+        pa = pa << static_cast<uint64_t>(idxs.size());
+
+        for (size_t i = 0; i < idxs.size(); ++i)
+        {
+            e::slice key(objects[idxs[i]].key, objects[idxs[i]].key_sz);
+            uint64_t nonce = m_next_server_nonce++;
+            nonces.push_back(std::make_pair(nonce, vsis[idxs[i]]));
+            pa = pa << vsis[idxs[i]] << nonce << key << flags << checks << funcs[idxs[i]];
+        }
+
+        send_bulk(REQ_BULK_ATOMIC, it->first, nonces, msg, op);
+    }
+
+    return op->client_visible_id();
+}
+
 #define SEARCH_BOILERPLATE \
     if (!maintain_coord_connection(status)) \
     { \
@@ -149,17 +393,56 @@ client :: search(const char* space,
                  const hyperdex_client_attribute_check* chks, size_t chks_sz,
                  hyperdex_client_returncode* status,
                  const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    return perform_search(space, chks, chks_sz, false, NULL, 0, status, attrs, attrs_sz);
+}
+
+int64_t
+client :: search_partial(const char* space,
+                         const hyperdex_client_attribute_check* chks, size_t chks_sz,
+                         const char** attrnames, size_t attrnames_sz,
+                         hyperdex_client_returncode* status,
+                         const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    return perform_search(space, chks, chks_sz, true, attrnames, attrnames_sz, status, attrs, attrs_sz);
+}
+
+int64_t
+client :: perform_search(const char* space,
+                         const hyperdex_client_attribute_check* chks, size_t chks_sz,
+                         bool partial, const char** attrnames, size_t attrnames_sz,
+                         hyperdex_client_returncode* status,
+                         const hyperdex_client_attribute** attrs, size_t* attrs_sz)
 {
     SEARCH_BOILERPLATE
+    std::vector<uint16_t> projection;
+
+    if (partial &&
+        prepare_projection(space, *sc, attrnames, attrnames_sz, status, &projection) < attrnames_sz)
+    {
+        return -1 - chks_sz;
+    }
+
     int64_t client_id = m_next_client_id++;
     e::intrusive_ptr<pending_aggregation> op;
-    op = new pending_search(client_id, status, attrs, attrs_sz);
+    op = new pending_search(this, client_id, status, attrs, attrs_sz,
+                            partial ? &projection : NULL);
     size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ
-              + sizeof(uint64_t)
-              + pack_size(checks);
+              + 4 * sizeof(uint64_t)
+              + pack_size(checks)
+              + (partial ? pack_size(projection) : 0);
     std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
-    msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ) << client_id << checks;
-    return perform_aggregation(servers, op, REQ_SEARCH_START, msg, status);
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ)
+        << client_id << uint64_t(SEARCH_STREAM_WINDOW)
+        << uint64_t(SEARCH_STREAM_BATCH_OBJECTS)
+        << uint64_t(SEARCH_STREAM_BATCH_BYTES) << checks;
+
+    if (partial)
+    {
+        pa = pa << projection;
+    }
+
+    return perform_stream(servers, op, REQ_SEARCH_STREAM, msg, SEARCH_STREAM_WINDOW, status);
 }
 
 int64_t
@@ -186,6 +469,34 @@ client :: sorted_search(const char* space,
                         bool maximize,
                         hyperdex_client_returncode* status,
                         const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    return perform_sorted_search(space, chks, chks_sz, false, NULL, 0,
+                                 sort_by, limit, maximize, status, attrs, attrs_sz);
+}
+
+int64_t
+client :: sorted_search_partial(const char* space,
+                                const hyperdex_client_attribute_check* chks, size_t chks_sz,
+                                const char** attrnames, size_t attrnames_sz,
+                                const char* sort_by,
+                                uint64_t limit,
+                                bool maximize,
+                                hyperdex_client_returncode* status,
+                                const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    return perform_sorted_search(space, chks, chks_sz, true, attrnames, attrnames_sz,
+                                 sort_by, limit, maximize, status, attrs, attrs_sz);
+}
+
+int64_t
+client :: perform_sorted_search(const char* space,
+                                const hyperdex_client_attribute_check* chks, size_t chks_sz,
+                                bool partial, const char** attrnames, size_t attrnames_sz,
+                                const char* sort_by,
+                                uint64_t limit,
+                                bool maximize,
+                                hyperdex_client_returncode* status,
+                                const hyperdex_client_attribute** attrs, size_t* attrs_sz)
 {
     SEARCH_BOILERPLATE
     uint16_t sort_by_num = sc->lookup_attr(sort_by);
@@ -208,17 +519,51 @@ client :: sorted_search(const char* space,
         return -1 - chks_sz;
     }
 
+    std::vector<uint16_t> projection;
+    uint16_t sort_by_idx = sort_by_num;
+
+    if (partial)
+    {
+        if (prepare_projection(space, *sc, attrnames, attrnames_sz, status, &projection) < attrnames_sz)
+        {
+            return -1 - chks_sz;
+        }
+
+        // results are merged by the sort attribute, so it must come back
+        if (sort_by_num > 0)
+        {
+            std::vector<uint16_t>::iterator it;
+            it = std::lower_bound(projection.begin(), projection.end(), sort_by_num);
+
+            if (it == projection.end() || *it != sort_by_num)
+            {
+                it = projection.insert(it, sort_by_num);
+            }
+
+            sort_by_idx = it - projection.begin() + 1;
+        }
+    }
+
     int64_t client_id = m_next_client_id++;
     e::intrusive_ptr<pending_aggregation> op;
-    op = new pending_sorted_search(this, client_id, maximize, limit, sort_by_num, di, status, attrs, attrs_sz);
+    op = new pending_sorted_search(this, client_id, maximize, limit, sort_by_idx, di, status, attrs, attrs_sz,
+                                   partial ? &projection : NULL);
     int8_t max = maximize ? 1 : 0;
     size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ
               + pack_size(checks)
               + sizeof(limit)
               + sizeof(sort_by_num)
-              + sizeof(max);
+              + sizeof(max)
+              + (partial ? pack_size(projection) : 0);
     std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
-    msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ) << checks << limit << sort_by_num << max;
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ)
+        << checks << limit << sort_by_num << max;
+
+    if (partial)
+    {
+        pa = pa << projection;
+    }
+
     return perform_aggregation(servers, op, REQ_SORTED_SEARCH, msg, status);
 }
 
@@ -255,6 +600,80 @@ client :: count(const char* space,
     return perform_aggregation(servers, op, REQ_COUNT, msg, status);
 }
 
+int64_t
+client :: aggregate(const char* space,
+                    const hyperdex_client_attribute_check* chks, size_t chks_sz,
+                    const hyperdex_client_aggregate_spec* _aggs, size_t _aggs_sz,
+                    const char* group_by,
+                    hyperdex_client_returncode* status,
+                    const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    SEARCH_BOILERPLATE
+    std::vector<hyperdex::aggregate> aggs(_aggs_sz);
+
+    for (size_t i = 0; i < _aggs_sz; ++i)
+    {
+        aggs[i].op = _aggs[i].op;
+        aggs[i].attr = 0;
+
+        if (_aggs[i].op != HYPERAGGREGATE_COUNT)
+        {
+            aggs[i].attr = _aggs[i].attr ? sc->lookup_attr(_aggs[i].attr) : sc->attrs_sz;
+
+            if (aggs[i].attr == sc->attrs_sz)
+            {
+                ERROR(UNKNOWNATTR) << "\"" << e::strescape(_aggs[i].attr ? _aggs[i].attr : "")
+                                   << "\" is not an attribute of space \""
+                                   << e::strescape(space) << "\"";
+                return -1 - chks_sz;
+            }
+        }
+
+        if (!validate_aggregate(*sc, aggs[i]))
+        {
+            ERROR(WRONGTYPE) << "cannot compute " << _aggs[i].op
+                             << " over attribute \"" << e::strescape(_aggs[i].attr)
+                             << "\": it is neither int64 nor float";
+            return -1 - chks_sz;
+        }
+    }
+
+    uint16_t group_by_num = 0;
+
+    if (group_by)
+    {
+        group_by_num = sc->lookup_attr(group_by);
+
+        if (group_by_num == sc->attrs_sz)
+        {
+            ERROR(UNKNOWNATTR) << "\"" << e::strescape(group_by)
+                               << "\" is not an attribute of space \""
+                               << e::strescape(space) << "\"";
+            return -1 - chks_sz;
+        }
+
+        // every key is its own group, and containers are not worth grouping
+        if (group_by_num == 0 || !validate_group_by(*sc, group_by_num))
+        {
+            ERROR(WRONGTYPE) << "cannot group by attribute \""
+                             << e::strescape(group_by)
+                             << "\": it must be a string, int64, or float attribute other than the key";
+            return -1 - chks_sz;
+        }
+    }
+
+    int64_t client_id = m_next_client_id++;
+    e::intrusive_ptr<pending_aggregation> op;
+    op = new pending_aggregate(this, client_id, aggs, group_by_num, status, attrs, attrs_sz);
+    size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ
+              + pack_size(checks)
+              + pack_size(aggs)
+              + sizeof(group_by_num);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ) << checks << aggs << group_by_num;
+    return perform_aggregation(servers, op, REQ_AGGREGATE, msg, status);
+}
+
 int64_t
 client :: perform_funcall(const hyperdex_client_keyop_info* opinfo,
                           const char* space, const char* _key, size_t _key_sz,
@@ -332,6 +751,39 @@ client :: perform_funcall(const hyperdex_client_keyop_info* opinfo,
     return send_keyop(space, key, REQ_ATOMIC, msg, op, status);
 }
 
+int64_t
+client :: perform_group_funcall(const hyperdex_client_keyop_info* opinfo,
+                                const char* space,
+                                const hyperdex_client_attribute_check* chks, size_t chks_sz,
+                                const hyperdex_client_attribute* attrs, size_t attrs_sz,
+                                hyperdex_client_returncode* status,
+                                uint64_t* count)
+{
+    SEARCH_BOILERPLATE
+    std::vector<funcall> funcs;
+    size_t idx = prepare_funcs(space, *sc, opinfo, attrs, attrs_sz, status, &funcs);
+
+    if (idx < attrs_sz)
+    {
+        return -1 - chks_sz - idx;
+    }
+
+    std::stable_sort(funcs.begin(), funcs.end());
+    *count = 0;
+    int64_t client_id = m_next_client_id++;
+    e::intrusive_ptr<pending_aggregation> op;
+    op = new pending_group_atomic(client_id, status, count);
+    // never recreate an object deleted after the server found it
+    uint8_t flags = 1 | (opinfo->erase ? 0 : 128);
+    size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ
+              + pack_size(checks)
+              + sizeof(uint8_t)
+              + pack_size(funcs);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ) << checks << flags << funcs;
+    return perform_aggregation(servers, op, REQ_GROUP_ATOMIC, msg, status);
+}
+
 int64_t
 client :: loop(int timeout, hyperdex_client_returncode* status)
 {
@@ -441,12 +893,15 @@ client :: loop(int timeout, hyperdex_client_returncode* status)
         if (msg_type == CONFIGMISMATCH)
         {
             m_failed.push_back(psp);
+            handle_mismatch(psp);
             continue;
         }
 
-        if (vfrom == psp.vsi &&
-            id == psp.si &&
-            m_coord.config()->get_server_id(vfrom) == id)
+        // A server answers for itself, rather than for one of its virtual
+        // servers, when a bulk request names a virtual server it doesn't own.
+        if (id == psp.si &&
+            ((vfrom == psp.vsi && m_coord.config()->get_server_id(vfrom) == id) ||
+             vfrom == virtual_server_id(UINT64_MAX)))
         {
             if (!op->handle_message(this, id, vfrom, msg_type, msg, up, status, &m_last_error))
             {
@@ -699,6 +1154,39 @@ client :: prepare_funcs(const char* space, const schema& sc,
     return mapattrs_sz;
 }
 
+size_t
+client :: prepare_projection(const char* space, const schema& sc,
+                             const char** attrnames, size_t attrnames_sz,
+                             hyperdex_client_returncode* status,
+                             std::vector<uint16_t>* projection)
+{
+    projection->clear();
+    projection->reserve(attrnames_sz);
+
+    for (size_t i = 0; i < attrnames_sz; ++i)
+    {
+        uint16_t attrnum = sc.lookup_attr(attrnames[i]);
+
+        if (attrnum == sc.attrs_sz)
+        {
+            ERROR(UNKNOWNATTR) << "\"" << e::strescape(attrnames[i])
+                               << "\" is not an attribute of space \""
+                               << e::strescape(space) << "\"";
+            return i;
+        }
+
+        // the key is never projected away
+        if (attrnum > 0)
+        {
+            projection->push_back(attrnum);
+        }
+    }
+
+    std::sort(projection->begin(), projection->end());
+    projection->erase(std::unique(projection->begin(), projection->end()), projection->end());
+    return attrnames_sz;
+}
+
 size_t
 client :: prepare_searchop(const schema& sc,
                            const char* space,
@@ -755,6 +1243,40 @@ client :: perform_aggregation(const std::vector<virtual_server_id>& servers,
     return op->client_visible_id();
 }
 
+int64_t
+client :: perform_stream(const std::vector<virtual_server_id>& servers,
+                         e::intrusive_ptr<pending_aggregation> op,
+                         network_msgtype mt,
+                         std::auto_ptr<e::buffer> msg,
+                         uint64_t window,
+                         hyperdex_client_returncode* status)
+{
+    assert(window > 0);
+
+    for (size_t i = 0; i < servers.size(); ++i)
+    {
+        uint64_t nonce = m_next_server_nonce;
+        m_next_server_nonce += window;
+        pending_server_pair psp(m_coord.config()->get_server_id(servers[i]), servers[i], op.get());
+        std::auto_ptr<e::buffer> msg_copy(msg->copy());
+
+        if (!send(mt, psp.vsi, nonce, msg_copy, op.get(), status))
+        {
+            psp.op->handle_sent_to(psp.si, psp.vsi);
+            m_failed.push_back(psp);
+            continue;
+        }
+
+        for (uint64_t w = 1; w < window; ++w)
+        {
+            psp.op->handle_sent_to(psp.si, psp.vsi);
+            m_pending_ops.insert(std::make_pair(nonce + w, psp));
+        }
+    }
+
+    return op->client_visible_id();
+}
+
 bool
 client :: maintain_coord_connection(hyperdex_client_returncode* status)
 {
@@ -851,6 +1373,46 @@ client :: send(network_msgtype mt,
     }
 }
 
+void
+client :: send_bulk(network_msgtype mt,
+                    const server_id& to,
+                    const std::vector<std::pair<uint64_t, virtual_server_id> >& nonces,
+                    std::auto_ptr<e::buffer> msg,
+                    e::intrusive_ptr<pending> op)
+{
+    assert(!nonces.empty());
+    // The message is addressed to the server as a whole; each operation
+    // inside names its own virtual server and nonce, and will be answered
+    // individually.
+    const uint8_t type = static_cast<uint8_t>(mt);
+    const uint8_t flags = 0;
+    const uint64_t version = m_coord.config()->version();
+    msg->pack_at(BUSYBEE_HEADER_SIZE)
+        << type << flags << version << uint64_t(UINT64_MAX) << nonces[0].first;
+    m_busybee.set_timeout(-1);
+    busybee_returncode rc = m_busybee.send(to.get(), msg);
+
+    if (rc == BUSYBEE_DISRUPTED)
+    {
+        handle_disruption(to);
+    }
+
+    for (size_t i = 0; i < nonces.size(); ++i)
+    {
+        pending_server_pair psp(to, nonces[i].second, op);
+        op->handle_sent_to(psp.si, psp.vsi);
+
+        if (rc == BUSYBEE_SUCCESS)
+        {
+            m_pending_ops.insert(std::make_pair(nonces[i].first, psp));
+        }
+        else
+        {
+            m_failed.push_back(psp);
+        }
+    }
+}
+
 int64_t
 client :: send_keyop(const char* space,
                      const e::slice& key,
@@ -883,6 +1445,31 @@ client :: send_keyop(const char* space,
     }
 }
 
+void
+client :: handle_mismatch(const pending_server_pair& psp)
+{
+    // A message that is answered under several nonces is bounced only once,
+    // so fail the rest of the operation's requests to the same server.
+    pending_map_t::iterator it = m_pending_ops.begin();
+
+    while (it != m_pending_ops.end())
+    {
+        if (it->second.op == psp.op &&
+            it->second.si == psp.si &&
+            it->second.vsi == psp.vsi)
+        {
+            m_failed.push_back(it->second);
+            pending_map_t::iterator tmp = it;
+            ++it;
+            m_pending_ops.erase(tmp);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
 void
 client :: handle_disruption(const server_id& si)
 {
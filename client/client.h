@@ -62,10 +62,26 @@ class client
         int64_t get(const char* space, const char* key, size_t key_sz,
                     hyperdex_client_returncode* status,
                     const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        int64_t get_partial(const char* space, const char* key, size_t key_sz,
+                            const char** attrnames, size_t attrnames_sz,
+                            hyperdex_client_returncode* status,
+                            const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        int64_t get_many(const char* space,
+                         const hyperdex_client_key* keys, size_t keys_sz,
+                         hyperdex_client_returncode* status,
+                         const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        int64_t bulk_put(const char* space,
+                         const hyperdex_client_object* objects, size_t objects_sz,
+                         hyperdex_client_returncode* status);
         int64_t search(const char* space,
                        const hyperdex_client_attribute_check* checks, size_t checks_sz,
                        hyperdex_client_returncode* status,
                        const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        int64_t search_partial(const char* space,
+                               const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                               const char** attrnames, size_t attrnames_sz,
+                               hyperdex_client_returncode* status,
+                               const hyperdex_client_attribute** attrs, size_t* attrs_sz);
         int64_t search_describe(const char* space,
                                 const hyperdex_client_attribute_check* checks, size_t checks_sz,
                                 hyperdex_client_returncode* status, const char** description);
@@ -76,12 +92,27 @@ class client
                               bool maximize,
                               hyperdex_client_returncode* status,
                               const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        // the sort attribute is always among those returned
+        int64_t sorted_search_partial(const char* space,
+                                      const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                      const char** attrnames, size_t attrnames_sz,
+                                      const char* sort_by,
+                                      uint64_t limit,
+                                      bool maximize,
+                                      hyperdex_client_returncode* status,
+                                      const hyperdex_client_attribute** attrs, size_t* attrs_sz);
         int64_t group_del(const char* space,
                           const hyperdex_client_attribute_check* checks, size_t checks_sz,
                           hyperdex_client_returncode* status);
         int64_t count(const char* space,
                       const hyperdex_client_attribute_check* checks, size_t checks_sz,
                       hyperdex_client_returncode* status, uint64_t* result);
+        int64_t aggregate(const char* space,
+                          const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                          const hyperdex_client_aggregate_spec* aggs, size_t aggs_sz,
+                          const char* group_by,
+                          hyperdex_client_returncode* status,
+                          const hyperdex_client_attribute** attrs, size_t* attrs_sz);
         // general keyop call
         int64_t perform_funcall(const hyperdex_client_keyop_info* opinfo,
                                 const char* space, const char* key, size_t key_sz,
@@ -89,6 +120,14 @@ class client
                                 const hyperdex_client_attribute* attrs, size_t attrs_sz,
                                 const hyperdex_client_map_attribute* mapattrs, size_t mapattrs_sz,
                                 hyperdex_client_returncode* status);
+        // apply a keyop to every object matching the checks; "count" is the
+        // number of objects it was applied to
+        int64_t perform_group_funcall(const hyperdex_client_keyop_info* opinfo,
+                                      const char* space,
+                                      const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                      const hyperdex_client_attribute* attrs, size_t attrs_sz,
+                                      hyperdex_client_returncode* status,
+                                      uint64_t* count);
         // looping/polling
         int64_t loop(int timeout, hyperdex_client_returncode* status);
         // error handling
@@ -115,7 +154,9 @@ class client
         };
         typedef std::map<uint64_t, pending_server_pair> pending_map_t;
         typedef std::list<pending_server_pair> pending_queue_t;
+        friend class pending_aggregate;
         friend class pending_get;
+        friend class pending_get_many;
         friend class pending_search;
         friend class pending_sorted_search;
 
@@ -134,17 +175,50 @@ class client
                              const hyperdex_client_map_attribute* mapattrs, size_t mapattrs_sz,
                              hyperdex_client_returncode* status,
                              std::vector<funcall>* funcs);
+        // returns the index of the first name not in the schema, or
+        // attrnames_sz if all are
+        size_t prepare_projection(const char* space, const schema& sc,
+                                  const char** attrnames, size_t attrnames_sz,
+                                  hyperdex_client_returncode* status,
+                                  std::vector<uint16_t>* projection);
         size_t prepare_searchop(const schema& sc,
                                 const char* space,
                                 const hyperdex_client_attribute_check* chks, size_t chks_sz,
                                 hyperdex_client_returncode* status,
                                 std::vector<attribute_check>* checks,
                                 std::vector<virtual_server_id>* servers);
+        // the public get, search and sorted_search calls, which return every
+        // attribute unless "partial" is set
+        int64_t perform_get(const char* space, const char* key, size_t key_sz,
+                            bool partial, const char** attrnames, size_t attrnames_sz,
+                            hyperdex_client_returncode* status,
+                            const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        int64_t perform_search(const char* space,
+                               const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                               bool partial, const char** attrnames, size_t attrnames_sz,
+                               hyperdex_client_returncode* status,
+                               const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        int64_t perform_sorted_search(const char* space,
+                                      const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                      bool partial, const char** attrnames, size_t attrnames_sz,
+                                      const char* sort_by,
+                                      uint64_t limit,
+                                      bool maximize,
+                                      hyperdex_client_returncode* status,
+                                      const hyperdex_client_attribute** attrs, size_t* attrs_sz);
         int64_t perform_aggregation(const std::vector<virtual_server_id>& servers,
                                     e::intrusive_ptr<pending_aggregation> op,
                                     network_msgtype mt,
                                     std::auto_ptr<e::buffer> msg,
                                     hyperdex_client_returncode* status);
+        // like perform_aggregation, but each server answers "window"
+        // consecutive nonces, starting with the one in the header
+        int64_t perform_stream(const std::vector<virtual_server_id>& servers,
+                               e::intrusive_ptr<pending_aggregation> op,
+                               network_msgtype mt,
+                               std::auto_ptr<e::buffer> msg,
+                               uint64_t window,
+                               hyperdex_client_returncode* status);
         bool maintain_coord_connection(hyperdex_client_returncode* status);
         bool send(network_msgtype mt,
                   const virtual_server_id& to,
@@ -152,12 +226,18 @@ class client
                   std::auto_ptr<e::buffer> msg,
                   e::intrusive_ptr<pending> op,
                   hyperdex_client_returncode* status);
+        void send_bulk(network_msgtype mt,
+                       const server_id& to,
+                       const std::vector<std::pair<uint64_t, virtual_server_id> >& nonces,
+                       std::auto_ptr<e::buffer> msg,
+                       e::intrusive_ptr<pending> op);
         int64_t send_keyop(const char* space,
                            const e::slice& key,
                            network_msgtype mt,
                            std::auto_ptr<e::buffer> msg,
                            e::intrusive_ptr<pending> op,
                            hyperdex_client_returncode* status);
+        void handle_mismatch(const pending_server_pair& psp);
         void handle_disruption(const server_id& si);
 
     private:
@@ -301,6 +301,34 @@ hyperdex_ds_allocate_attribute(struct hyperdex_ds_arena* arena, size_t sz)
     return reinterpret_cast<struct hyperdex_client_attribute*>(arena->allocate(bytes));
 }
 
+HYPERDEX_API const char**
+hyperdex_ds_allocate_attribute_names(struct hyperdex_ds_arena* arena, size_t sz)
+{
+    size_t bytes = sizeof(const char*) * sz;
+    return reinterpret_cast<const char**>(arena->allocate(bytes));
+}
+
+HYPERDEX_API struct hyperdex_client_key*
+hyperdex_ds_allocate_key(struct hyperdex_ds_arena* arena, size_t sz)
+{
+    size_t bytes = sizeof(struct hyperdex_client_key) * sz;
+    return reinterpret_cast<struct hyperdex_client_key*>(arena->allocate(bytes));
+}
+
+HYPERDEX_API struct hyperdex_client_object*
+hyperdex_ds_allocate_object(struct hyperdex_ds_arena* arena, size_t sz)
+{
+    size_t bytes = sizeof(struct hyperdex_client_object) * sz;
+    return reinterpret_cast<struct hyperdex_client_object*>(arena->allocate(bytes));
+}
+
+HYPERDEX_API struct hyperdex_client_aggregate_spec*
+hyperdex_ds_allocate_aggregate_spec(struct hyperdex_ds_arena* arena, size_t sz)
+{
+    size_t bytes = sizeof(struct hyperdex_client_aggregate_spec) * sz;
+    return reinterpret_cast<struct hyperdex_client_aggregate_spec*>(arena->allocate(bytes));
+}
+
 HYPERDEX_API struct hyperdex_client_attribute_check*
 hyperdex_ds_allocate_attribute_check(struct hyperdex_ds_arena* arena, size_t sz)
 {
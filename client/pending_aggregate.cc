@@ -0,0 +1,391 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// STL
+#include <algorithm>
+#include <string>
+
+// e
+#include <e/endian.h>
+
+// HyperDex
+#include "common/datatypes.h"
+#include "common/serialization.h"
+#include "client/client.h"
+#include "client/pending_aggregate.h"
+#include "client/util.h"
+
+using hyperdex::aggregate_groups;
+using hyperdex::datatype_info;
+using hyperdex::pending_aggregate;
+
+pending_aggregate :: pending_aggregate(client* cl,
+                                       uint64_t id,
+                                       const std::vector<aggregate>& aggs,
+                                       uint16_t group_by,
+                                       hyperdex_client_returncode* status,
+                                       const hyperdex_client_attribute** attrs,
+                                       size_t* attrs_sz)
+    : pending_aggregation(id, status)
+    , m_cl(cl)
+    , m_ri()
+    , m_aggs(aggs)
+    , m_group_by(group_by)
+    , m_attrs(attrs)
+    , m_attrs_sz(attrs_sz)
+    , m_groups()
+    , m_results()
+    , m_results_idx(0)
+    , m_overflow(false)
+    , m_finished(false)
+    , m_yield(false)
+    , m_error(false)
+    , m_done(false)
+{
+    *m_attrs = NULL;
+    *m_attrs_sz = 0;
+}
+
+pending_aggregate :: ~pending_aggregate() throw ()
+{
+}
+
+bool
+pending_aggregate :: can_yield()
+{
+    return m_yield;
+}
+
+bool
+pending_aggregate :: yield(hyperdex_client_returncode* status, e::error* err)
+{
+    *status = HYPERDEX_CLIENT_SUCCESS;
+    *err = e::error();
+
+    // an error was recorded by PENDING_ERROR; hand it out exactly once
+    if (m_error)
+    {
+        m_error = false;
+        m_yield = more_to_yield();
+        return true;
+    }
+
+    assert(this->aggregation_done());
+    const schema* sc = m_cl->m_coord.config()->get_schema(m_ri);
+
+    if (!m_finished)
+    {
+        finish(*sc);
+    }
+
+    if (m_results_idx >= m_results.size())
+    {
+        m_done = true;
+        m_yield = false;
+        set_status(HYPERDEX_CLIENT_SEARCHDONE);
+        set_error(e::error());
+        return true;
+    }
+
+    aggregate_groups::const_iterator it = m_results[m_results_idx];
+    ++m_results_idx;
+    m_yield = more_to_yield();
+    hyperdex_client_returncode op_status;
+    e::error op_error;
+
+    if (!group_to_attributes(*sc, it->first, it->second, &op_status, &op_error))
+    {
+        set_status(op_status);
+        set_error(op_error);
+        return true;
+    }
+
+    set_status(HYPERDEX_CLIENT_SUCCESS);
+    set_error(e::error());
+    return true;
+}
+
+void
+pending_aggregate :: handle_sent_to(const server_id& si,
+                                    const virtual_server_id& vsi)
+{
+    if (m_ri == region_id())
+    {
+        m_ri = m_cl->m_coord.config()->get_region_id(vsi);
+    }
+
+    return pending_aggregation::handle_sent_to(si, vsi);
+}
+
+void
+pending_aggregate :: handle_failure(const server_id& si,
+                                    const virtual_server_id& vsi)
+{
+    PENDING_ERROR(RECONFIGURE) << "reconfiguration affecting "
+                               << vsi << "/" << si;
+    pending_aggregation::handle_failure(si, vsi);
+    m_error = true;
+    m_yield = true;
+}
+
+bool
+pending_aggregate :: handle_message(client* cl,
+                                    const server_id& si,
+                                    const virtual_server_id& vsi,
+                                    network_msgtype mt,
+                                    std::auto_ptr<e::buffer> msg,
+                                    e::unpacker up,
+                                    hyperdex_client_returncode* status,
+                                    e::error* err)
+{
+    bool handled = pending_aggregation::handle_message(cl, si, vsi, mt, std::auto_ptr<e::buffer>(), up, status, err);
+    assert(handled);
+
+    *status = HYPERDEX_CLIENT_SUCCESS;
+    *err = e::error();
+
+    if (mt != RESP_AGGREGATE)
+    {
+        PENDING_ERROR(SERVERERROR) << "server vsi responded to AGGREGATE with " << mt;
+        m_error = true;
+        m_yield = true;
+        return true;
+    }
+
+    const schema* sc = m_cl->m_coord.config()->get_schema(m_ri);
+    bool overflowed = m_overflow;
+    uint8_t flags = 0;
+    uint64_t num_groups = 0;
+    up = up >> flags >> num_groups;
+
+    for (uint64_t i = 0; !up.error() && !m_overflow && i < num_groups; ++i)
+    {
+        e::slice group;
+        std::vector<aggregate_state> states;
+        up = up >> group >> states;
+
+        if (up.error() || states.size() != m_aggs.size())
+        {
+            break;
+        }
+
+        std::string g(reinterpret_cast<const char*>(group.data()), group.size());
+
+        if (!merge_aggregate_group(*sc, m_aggs, g, states, &m_groups))
+        {
+            m_overflow = true;
+        }
+    }
+
+    if (up.error())
+    {
+        PENDING_ERROR(SERVERERROR) << "communication error: server "
+                                   << vsi << " sent corrupt message="
+                                   << msg->as_slice().hex()
+                                   << " in response to an AGGREGATE";
+        m_error = true;
+        m_yield = true;
+        return true;
+    }
+
+    if ((flags & 0x2) && !m_error)
+    {
+        PENDING_ERROR(SERVERERROR) << "server " << si
+                                   << " reports that our aggregation was invalid;"
+                                   << " check its log for details";
+        m_error = true;
+    }
+
+    if (flags & 0x1)
+    {
+        m_overflow = true;
+    }
+
+    // report the overflow once and drop the partial groups
+    if (m_overflow && !overflowed)
+    {
+        m_groups.clear();
+        PENDING_ERROR(OVERFLOW) << "aggregation produced more than "
+                                << AGGREGATE_MAX_GROUPS << " groups";
+        m_error = true;
+    }
+
+    m_yield = m_error || more_to_yield();
+    return true;
+}
+
+bool
+pending_aggregate :: more_to_yield()
+{
+    return !m_done && this->aggregation_done();
+}
+
+namespace
+{
+
+class group_comparator
+{
+    public:
+        group_comparator(datatype_info* di) : m_di(di) {}
+
+    public:
+        bool operator () (aggregate_groups::const_iterator lhs,
+                          aggregate_groups::const_iterator rhs)
+        {
+            e::slice l(lhs->first.data(), lhs->first.size());
+            e::slice r(rhs->first.data(), rhs->first.size());
+            return m_di->compare(l, r) < 0;
+        }
+
+    private:
+        datatype_info* m_di;
+};
+
+} // namespace
+
+void
+pending_aggregate :: finish(const schema& sc)
+{
+    m_finished = true;
+
+    // without grouping there is always exactly one result, even over no
+    // objects at all; an overflow has already been reported
+    if (m_group_by == 0 && m_groups.empty() && !m_overflow)
+    {
+        m_groups[std::string()].resize(m_aggs.size());
+    }
+
+    for (aggregate_groups::const_iterator it = m_groups.begin();
+            it != m_groups.end(); ++it)
+    {
+        m_results.push_back(it);
+    }
+
+    if (m_group_by > 0 && m_group_by < sc.attrs_sz)
+    {
+        datatype_info* di = datatype_info::lookup(sc.attrs[m_group_by].type);
+
+        if (di && di->comparable())
+        {
+            std::sort(m_results.begin(), m_results.end(), group_comparator(di));
+        }
+    }
+}
+
+bool
+pending_aggregate :: group_to_attributes(const schema& sc,
+                                         const std::string& group,
+                                         const std::vector<aggregate_state>& states,
+                                         hyperdex_client_returncode* op_status,
+                                         e::error* op_error)
+{
+    // names and values must outlive the attributes copied from them
+    std::vector<std::string> names(m_aggs.size() + 1);
+    std::vector<std::string> values(m_aggs.size() + 1);
+    std::vector<hyperdex_client_attribute> attrs;
+
+    if (m_group_by > 0)
+    {
+        hyperdex_client_attribute a;
+        a.attr = sc.attrs[m_group_by].name;
+        a.value = group.data();
+        a.value_sz = group.size();
+        a.datatype = sc.attrs[m_group_by].type;
+        attrs.push_back(a);
+    }
+
+    for (size_t i = 0; i < m_aggs.size(); ++i)
+    {
+        const aggregate_state& st(states[i]);
+        hyperdatatype type = HYPERDATATYPE_INT64;
+        char buf[sizeof(int64_t)];
+
+        if (m_aggs[i].op == HYPERAGGREGATE_COUNT)
+        {
+            names[i] = "count";
+            e::pack64le(st.count, buf);
+        }
+        else
+        {
+            const char* attr = sc.attrs[m_aggs[i].attr].name;
+            bool is_int = sc.attrs[m_aggs[i].attr].type == HYPERDATATYPE_INT64;
+            type = is_int ? HYPERDATATYPE_INT64 : HYPERDATATYPE_FLOAT;
+
+            switch (m_aggs[i].op)
+            {
+                case HYPERAGGREGATE_SUM:
+                    names[i] = std::string("sum(") + attr + ")";
+
+                    if (is_int && st.overflow)
+                    {
+                        *op_status = HYPERDEX_CLIENT_OVERFLOW;
+                        op_error->set_loc(__FILE__, __LINE__);
+                        op_error->set_msg() << "sum of \"" << attr << "\" overflows int64";
+                        return false;
+                    }
+
+                    is_int ? e::pack64le(st.int_sum, buf)
+                           : e::packdoublele(st.float_sum, buf);
+                    break;
+                case HYPERAGGREGATE_MIN:
+                    names[i] = std::string("min(") + attr + ")";
+                    is_int ? e::pack64le(st.int_min, buf)
+                           : e::packdoublele(st.float_min, buf);
+                    break;
+                case HYPERAGGREGATE_MAX:
+                    names[i] = std::string("max(") + attr + ")";
+                    is_int ? e::pack64le(st.int_max, buf)
+                           : e::packdoublele(st.float_max, buf);
+                    break;
+                case HYPERAGGREGATE_AVG:
+                    names[i] = std::string("avg(") + attr + ")";
+                    type = HYPERDATATYPE_FLOAT;
+                    e::packdoublele(st.count ? st.float_sum / st.count : 0, buf);
+                    break;
+                case HYPERAGGREGATE_COUNT:
+                default:
+                    abort();
+            }
+
+            // min, max and avg of nothing are undefined; leave them out
+            if (st.count == 0 && m_aggs[i].op != HYPERAGGREGATE_SUM)
+            {
+                continue;
+            }
+        }
+
+        values[i].assign(buf, sizeof(buf));
+        hyperdex_client_attribute a;
+        a.attr = names[i].c_str();
+        a.value = values[i].data();
+        a.value_sz = values[i].size();
+        a.datatype = type;
+        attrs.push_back(a);
+    }
+
+    return copy_attributes(attrs, op_status, op_error, m_attrs, m_attrs_sz);
+}
@@ -0,0 +1,108 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_client_pending_aggregate_h_
+#define hyperdex_client_pending_aggregate_h_
+
+// STL
+#include <vector>
+
+// HyperDex
+#include "namespace.h"
+#include "common/aggregate.h"
+#include "client/pending_aggregation.h"
+
+BEGIN_HYPERDEX_NAMESPACE
+
+class pending_aggregate : public pending_aggregation
+{
+    public:
+        pending_aggregate(client* cl,
+                          uint64_t id,
+                          const std::vector<aggregate>& aggs,
+                          uint16_t group_by,
+                          hyperdex_client_returncode* status,
+                          const hyperdex_client_attribute** attrs,
+                          size_t* attrs_sz);
+        virtual ~pending_aggregate() throw ();
+
+    // return to client
+    public:
+        virtual bool can_yield();
+        virtual bool yield(hyperdex_client_returncode* status, e::error* error);
+
+    // events
+    public:
+        virtual void handle_sent_to(const server_id& si,
+                                    const virtual_server_id& vsi);
+        virtual void handle_failure(const server_id& si,
+                                    const virtual_server_id& vsi);
+        virtual bool handle_message(client*,
+                                    const server_id& si,
+                                    const virtual_server_id& vsi,
+                                    network_msgtype mt,
+                                    std::auto_ptr<e::buffer> msg,
+                                    e::unpacker up,
+                                    hyperdex_client_returncode* status,
+                                    e::error* error);
+
+    private:
+        bool more_to_yield();
+        // order the merged groups by the value of the group-by attribute
+        void finish(const schema& sc);
+        bool group_to_attributes(const schema& sc,
+                                 const std::string& group,
+                                 const std::vector<aggregate_state>& states,
+                                 hyperdex_client_returncode* op_status,
+                                 e::error* op_error);
+
+    // noncopyable
+    private:
+        pending_aggregate(const pending_aggregate& other);
+        pending_aggregate& operator = (const pending_aggregate& rhs);
+
+    private:
+        client* m_cl;
+        region_id m_ri;
+        const std::vector<aggregate> m_aggs;
+        const uint16_t m_group_by;
+        const hyperdex_client_attribute** m_attrs;
+        size_t* m_attrs_sz;
+        aggregate_groups m_groups;
+        std::vector<aggregate_groups::const_iterator> m_results;
+        size_t m_results_idx;
+        // some server, or the merge, went past AGGREGATE_MAX_GROUPS
+        bool m_overflow;
+        bool m_finished;
+        bool m_yield;
+        bool m_error;
+        bool m_done;
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_client_pending_aggregate_h_
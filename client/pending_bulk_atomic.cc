@@ -0,0 +1,184 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// HyperDex
+#include "common/network_returncode.h"
+#include "client/pending_bulk_atomic.h"
+
+using hyperdex::pending_bulk_atomic;
+
+pending_bulk_atomic :: pending_bulk_atomic(uint64_t id,
+                                           hyperdex_client_returncode* status)
+    : pending(id, status)
+    , m_outstanding(0)
+    , m_failed(0)
+    , m_yielded(false)
+{
+}
+
+pending_bulk_atomic :: ~pending_bulk_atomic() throw ()
+{
+}
+
+bool
+pending_bulk_atomic :: can_yield()
+{
+    return m_outstanding == 0 && !m_yielded;
+}
+
+bool
+pending_bulk_atomic :: yield(hyperdex_client_returncode* status, e::error* err)
+{
+    *status = HYPERDEX_CLIENT_SUCCESS;
+    *err = e::error();
+    m_yielded = true;
+
+    if (m_failed == 0)
+    {
+        set_status(HYPERDEX_CLIENT_SUCCESS);
+        set_error(e::error());
+    }
+
+    return true;
+}
+
+void
+pending_bulk_atomic :: handle_sent_to(const server_id&,
+                                      const virtual_server_id&)
+{
+    ++m_outstanding;
+}
+
+void
+pending_bulk_atomic :: handle_failure(const server_id& si,
+                                      const virtual_server_id& vsi)
+{
+    assert(m_outstanding > 0);
+    --m_outstanding;
+
+    if (first_failure())
+    {
+        PENDING_ERROR(RECONFIGURE) << "reconfiguration affecting "
+                                   << vsi << "/" << si;
+    }
+}
+
+bool
+pending_bulk_atomic :: handle_message(client*,
+                                      const server_id& si,
+                                      const virtual_server_id& vsi,
+                                      network_msgtype mt,
+                                      std::auto_ptr<e::buffer> msg,
+                                      e::unpacker up,
+                                      hyperdex_client_returncode* status,
+                                      e::error* err)
+{
+    assert(m_outstanding > 0);
+    --m_outstanding;
+    *status = HYPERDEX_CLIENT_SUCCESS;
+    *err = e::error();
+
+    if (mt != RESP_ATOMIC)
+    {
+        if (first_failure())
+        {
+            PENDING_ERROR(SERVERERROR) << "server vsi responded to BULK_ATOMIC with " << mt;
+        }
+
+        return true;
+    }
+
+    uint16_t response;
+    up = up >> response;
+
+    if (up.error())
+    {
+        if (first_failure())
+        {
+            PENDING_ERROR(SERVERERROR) << "communication error: server "
+                                       << vsi << " sent corrupt message="
+                                       << msg->as_slice().hex()
+                                       << " in response to a BULK_ATOMIC";
+        }
+
+        return true;
+    }
+
+    if (static_cast<network_returncode>(response) == NET_SUCCESS ||
+        !first_failure())
+    {
+        return true;
+    }
+
+    switch (static_cast<network_returncode>(response))
+    {
+        case NET_NOTFOUND:
+            PENDING_ERROR(NOTFOUND) << "server " << si
+                                    << " reports that an object was not found";
+            return true;
+        case NET_CMPFAIL:
+            PENDING_ERROR(CMPFAIL) << "server " << si
+                                   << " reports that a comparison failed";
+            return true;
+        case NET_BADDIMSPEC:
+            PENDING_ERROR(SERVERERROR) << "server " << si
+                                       << " reports that our request was invalid;"
+                                       << " check its log for details";
+            return true;
+        case NET_NOTUS:
+            PENDING_ERROR(RECONFIGURE) << "server " << si
+                                       << " reports that it is no longer reponsible"
+                                       << " for the requested object";
+            return true;
+        case NET_OVERFLOW:
+            PENDING_ERROR(OVERFLOW) << "server " << si
+                                    << " reports that the operation would"
+                                    << " cause a number overflow";
+            return true;
+        case NET_READONLY:
+            PENDING_ERROR(READONLY) << "cluster is in read-only mode";
+            return true;
+        case NET_SERVERERROR:
+            PENDING_ERROR(SERVERERROR) << "server " << si
+                                       << " reports a server error;"
+                                       << " check its log for details";
+            return true;
+        case NET_SUCCESS:
+        default:
+            PENDING_ERROR(SERVERERROR) << "server " << si
+                                       << " returned non-sensical returncode"
+                                       << response;
+            return true;
+    }
+}
+
+bool
+pending_bulk_atomic :: first_failure()
+{
+    ++m_failed;
+    return m_failed == 1;
+}
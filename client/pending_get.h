@@ -28,6 +28,9 @@
 #ifndef hyperdex_client_pending_get_h_
 #define hyperdex_client_pending_get_h_
 
+// STL
+#include <vector>
+
 // HyperDex
 #include "namespace.h"
 #include "client/pending.h"
@@ -39,7 +42,8 @@ class pending_get : public pending
     public:
         pending_get(uint64_t client_visible_id,
                     hyperdex_client_returncode* status,
-                    const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+                    const hyperdex_client_attribute** attrs, size_t* attrs_sz,
+                    const std::vector<uint16_t>* projection);
         virtual ~pending_get() throw ();
 
     // return to client
@@ -71,6 +75,8 @@ class pending_get : public pending
         enum { INITIALIZED, SENT, RECV, YIELDED } m_state;
         const hyperdex_client_attribute** m_attrs;
         size_t* m_attrs_sz;
+        const bool m_projected;
+        const std::vector<uint16_t> m_projection;
 };
 
 END_HYPERDEX_NAMESPACE
@@ -0,0 +1,257 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// HyperDex
+#include "common/network_returncode.h"
+#include "client/client.h"
+#include "client/pending_get_many.h"
+#include "client/util.h"
+
+using hyperdex::pending_get_many;
+
+pending_get_many :: pending_get_many(client* cl,
+                                     uint64_t id,
+                                     hyperdex_client_returncode* status,
+                                     const hyperdex_client_attribute** attrs,
+                                     size_t* attrs_sz)
+    : pending_aggregation(id, status)
+    , m_cl(cl)
+    , m_ri()
+    , m_attrs(attrs)
+    , m_attrs_sz(attrs_sz)
+    , m_results()
+    , m_results_idx(0)
+    , m_yield(false)
+    , m_error(false)
+    , m_done(false)
+{
+    *m_attrs = NULL;
+    *m_attrs_sz = 0;
+}
+
+pending_get_many :: ~pending_get_many() throw ()
+{
+}
+
+bool
+pending_get_many :: can_yield()
+{
+    return m_yield;
+}
+
+bool
+pending_get_many :: yield(hyperdex_client_returncode* status, e::error* err)
+{
+    *status = HYPERDEX_CLIENT_SUCCESS;
+    *err = e::error();
+
+    // an error was recorded by PENDING_ERROR; hand it out exactly once
+    if (m_error)
+    {
+        m_error = false;
+        m_yield = more_to_yield();
+        return true;
+    }
+
+    if (m_results_idx >= m_results.size())
+    {
+        assert(this->aggregation_done());
+        m_done = true;
+        m_yield = false;
+        set_status(HYPERDEX_CLIENT_SEARCHDONE);
+        set_error(e::error());
+        return true;
+    }
+
+    hyperdex_client_returncode op_status;
+    e::error op_error;
+    item it(m_results[m_results_idx]);
+    // release the reference to the response buffer as soon as possible
+    m_results[m_results_idx] = item();
+    ++m_results_idx;
+    m_yield = more_to_yield();
+
+    if (!value_to_attributes(*m_cl->m_coord.config(), m_ri, it.key.data(), it.key.size(),
+                             it.value, &op_status, &op_error, m_attrs, m_attrs_sz))
+    {
+        set_status(op_status);
+        set_error(op_error);
+        return true;
+    }
+
+    set_status(HYPERDEX_CLIENT_SUCCESS);
+    set_error(e::error());
+    return true;
+}
+
+void
+pending_get_many :: handle_sent_to(const server_id& si,
+                                   const virtual_server_id& vsi)
+{
+    if (m_ri == region_id())
+    {
+        m_ri = m_cl->m_coord.config()->get_region_id(vsi);
+    }
+
+    return pending_aggregation::handle_sent_to(si, vsi);
+}
+
+void
+pending_get_many :: handle_failure(const server_id& si,
+                                   const virtual_server_id& vsi)
+{
+    PENDING_ERROR(RECONFIGURE) << "reconfiguration affecting "
+                               << vsi << "/" << si;
+    pending_aggregation::handle_failure(si, vsi);
+    m_error = true;
+    m_yield = true;
+}
+
+bool
+pending_get_many :: handle_message(client* cl,
+                                   const server_id& si,
+                                   const virtual_server_id& vsi,
+                                   network_msgtype mt,
+                                   std::auto_ptr<e::buffer> msg,
+                                   e::unpacker up,
+                                   hyperdex_client_returncode* status,
+                                   e::error* err)
+{
+    bool handled = pending_aggregation::handle_message(cl, si, vsi, mt, std::auto_ptr<e::buffer>(), up, status, err);
+    assert(handled);
+
+    *status = HYPERDEX_CLIENT_SUCCESS;
+    *err = e::error();
+
+    if (mt != RESP_GET_MANY)
+    {
+        PENDING_ERROR(SERVERERROR) << "server vsi responded to GET_MANY with " << mt;
+        m_error = true;
+        m_yield = true;
+        return true;
+    }
+
+    uint16_t result;
+    uint64_t num_results = 0;
+    up = up >> result >> num_results;
+
+    if (up.error())
+    {
+        PENDING_ERROR(SERVERERROR) << "communication error: server "
+                                   << vsi << " sent corrupt message="
+                                   << msg->as_slice().hex()
+                                   << " in response to a GET_MANY";
+        m_error = true;
+        m_yield = true;
+        return true;
+    }
+
+    std::tr1::shared_ptr<e::buffer> backing(msg.release());
+
+    for (uint64_t i = 0; i < num_results; ++i)
+    {
+        e::slice key;
+        std::vector<e::slice> value;
+        up = up >> key >> value;
+
+        if (up.error())
+        {
+            PENDING_ERROR(SERVERERROR) << "communication error: server "
+                                       << vsi << " sent corrupt message="
+                                       << backing->as_slice().hex()
+                                       << " in response to a GET_MANY";
+            m_error = true;
+            m_yield = true;
+            return true;
+        }
+
+        m_results.push_back(item(key, value, backing));
+    }
+
+    if (static_cast<network_returncode>(result) == NET_NOTUS)
+    {
+        PENDING_ERROR(RECONFIGURE) << "server " << vsi
+                                   << " reports that it is no longer reponsible"
+                                   << " for some keys in the GET_MANY";
+        m_error = true;
+    }
+    else if (static_cast<network_returncode>(result) != NET_SUCCESS)
+    {
+        PENDING_ERROR(SERVERERROR) << "server " << vsi
+                                   << " could not read some keys for GET_MANY";
+        m_error = true;
+    }
+
+    m_yield = m_error || more_to_yield();
+    return true;
+}
+
+bool
+pending_get_many :: more_to_yield()
+{
+    return !m_done && (m_results_idx < m_results.size() || this->aggregation_done());
+}
+
+pending_get_many :: item :: item()
+    : key()
+    , value()
+    , backing()
+{
+}
+
+pending_get_many :: item :: item(const e::slice& _key,
+                                 const std::vector<e::slice>& _value,
+                                 std::tr1::shared_ptr<e::buffer> _backing)
+    : key(_key)
+    , value(_value)
+    , backing(_backing)
+{
+}
+
+pending_get_many :: item :: item(const item& other)
+    : key(other.key)
+    , value(other.value)
+    , backing(other.backing)
+{
+}
+
+pending_get_many :: item :: ~item() throw ()
+{
+}
+
+pending_get_many::item&
+pending_get_many :: item :: operator = (const item& other)
+{
+    if (this != &other)
+    {
+        key = other.key;
+        value = other.value;
+        backing = other.backing;
+    }
+
+    return *this;
+}
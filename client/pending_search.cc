@@ -33,13 +33,21 @@
 
 using hyperdex::pending_search;
 
-pending_search :: pending_search(uint64_t id,
+pending_search :: pending_search(client* cl,
+                                 uint64_t id,
                                  hyperdex_client_returncode* status,
-                                 const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+                                 const hyperdex_client_attribute** attrs, size_t* attrs_sz,
+                                 const std::vector<uint16_t>* projection)
     : pending_aggregation(id, status)
+    , m_cl(cl)
+    , m_ri()
     , m_attrs(attrs)
     , m_attrs_sz(attrs_sz)
+    , m_projected(projection != NULL)
+    , m_projection(projection ? *projection : std::vector<uint16_t>())
+    , m_results()
     , m_yield(false)
+    , m_error(false)
     , m_done(false)
 {
     *m_attrs = NULL;
@@ -61,29 +69,66 @@ pending_search :: yield(hyperdex_client_returncode* status, e::error* err)
 {
     *status = HYPERDEX_CLIENT_SUCCESS;
     *err = e::error();
-    m_yield = false;
 
-    if (this->aggregation_done() && !m_done)
+    // an error was recorded by PENDING_ERROR; hand it out exactly once
+    if (m_error)
     {
-        m_yield = true;
-        m_done = true;
+        m_error = false;
+        m_yield = more_to_yield();
+        return true;
     }
-    else if (m_done)
+
+    if (m_results.empty())
     {
+        assert(this->aggregation_done());
+        m_done = true;
+        m_yield = false;
         set_status(HYPERDEX_CLIENT_SEARCHDONE);
+        set_error(e::error());
+        return true;
+    }
+
+    hyperdex_client_returncode op_status;
+    e::error op_error;
+    item it(m_results.front());
+    m_results.pop_front();
+    m_yield = more_to_yield();
+
+    if (!value_to_attributes(*m_cl->m_coord.config(), m_ri, it.key.data(), it.key.size(),
+                             it.value, m_projected ? &m_projection : NULL,
+                             &op_status, &op_error, m_attrs, m_attrs_sz))
+    {
+        set_status(op_status);
+        set_error(op_error);
+        return true;
     }
 
+    set_status(HYPERDEX_CLIENT_SUCCESS);
+    set_error(e::error());
     return true;
 }
 
+void
+pending_search :: handle_sent_to(const server_id& si,
+                                 const virtual_server_id& vsi)
+{
+    if (m_ri == region_id())
+    {
+        m_ri = m_cl->m_coord.config()->get_region_id(vsi);
+    }
+
+    return pending_aggregation::handle_sent_to(si, vsi);
+}
+
 void
 pending_search :: handle_failure(const server_id& si,
                                  const virtual_server_id& vsi)
 {
-    m_yield = true;
     PENDING_ERROR(RECONFIGURE) << "reconfiguration affecting "
                                << vsi << "/" << si;
-    return pending_aggregation::handle_failure(si, vsi);
+    pending_aggregation::handle_failure(si, vsi);
+    m_error = true;
+    m_yield = true;
 }
 
 bool
@@ -102,26 +147,17 @@ pending_search :: handle_message(client* cl,
     *status = HYPERDEX_CLIENT_SUCCESS;
     *err = e::error();
 
-    if (mt == RESP_SEARCH_DONE)
-    {
-        if (this->aggregation_done())
-        {
-            m_yield = true;
-            m_done = true;
-        }
-
-        return true;
-    }
-    else if (mt != RESP_SEARCH_ITEM)
+    if (mt != RESP_SEARCH_BATCH)
     {
         PENDING_ERROR(SERVERERROR) << "server vsi responded to SEARCH with " << mt;
+        m_error = true;
         m_yield = true;
         return true;
     }
 
-    e::slice key;
-    std::vector<e::slice> value;
-    up = up >> key >> value;
+    uint8_t done;
+    uint64_t num_results = 0;
+    up = up >> done >> num_results;
 
     if (up.error())
     {
@@ -129,36 +165,94 @@ pending_search :: handle_message(client* cl,
                                    << vsi << " sent corrupt message="
                                    << msg->as_slice().hex()
                                    << " in response to a SEARCH";
+        m_error = true;
         m_yield = true;
         return true;
     }
 
-    hyperdex_client_returncode op_status;
-    e::error op_error;
+    std::tr1::shared_ptr<e::buffer> backing(msg.release());
 
-    if (!value_to_attributes(*cl->m_coord.config(),
-                             cl->m_coord.config()->get_region_id(vsi),
-                             key.data(), key.size(), value,
-                             &op_status, &op_error, m_attrs, m_attrs_sz))
+    for (uint64_t i = 0; i < num_results; ++i)
     {
-        set_status(op_status);
-        set_error(op_error);
-        m_yield = true;
-        return true;
-    }
+        e::slice key;
+        std::vector<e::slice> value;
+        up = up >> key >> value;
+
+        if (up.error())
+        {
+            PENDING_ERROR(SERVERERROR) << "communication error: server "
+                                       << vsi << " sent corrupt message="
+                                       << backing->as_slice().hex()
+                                       << " in response to a SEARCH";
+            m_error = true;
+            m_yield = true;
+            return true;
+        }
 
-    std::auto_ptr<e::buffer> smsg(e::buffer::create(HYPERDEX_CLIENT_HEADER_SIZE_REQ + sizeof(uint64_t)));
-    smsg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ) << static_cast<uint64_t>(client_visible_id());
+        m_results.push_back(item(key, value, backing));
+    }
 
-    if (!cl->send(REQ_SEARCH_NEXT, vsi, cl->m_next_server_nonce++, smsg, this, status))
+    // return the credit this batch consumed
+    if (!done)
     {
-        PENDING_ERROR(RECONFIGURE) << "could not send SEARCH_NEXT to " << vsi;
-        m_yield = true;
-        return true;
+        std::auto_ptr<e::buffer> cmsg(e::buffer::create(HYPERDEX_CLIENT_HEADER_SIZE_REQ
+                                                        + 2 * sizeof(uint64_t)));
+        cmsg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ)
+            << static_cast<uint64_t>(client_visible_id()) << uint64_t(1);
+
+        if (!cl->send(REQ_SEARCH_CREDIT, vsi, cl->m_next_server_nonce++, cmsg, this, status))
+        {
+            PENDING_ERROR(RECONFIGURE) << "could not send SEARCH_CREDIT to " << vsi;
+            m_error = true;
+        }
     }
 
-    set_status(HYPERDEX_CLIENT_SUCCESS);
-    set_error(e::error());
-    m_yield = true;
+    m_yield = m_error || more_to_yield();
     return true;
 }
+
+bool
+pending_search :: more_to_yield()
+{
+    return !m_done && (!m_results.empty() || this->aggregation_done());
+}
+
+pending_search :: item :: item()
+    : key()
+    , value()
+    , backing()
+{
+}
+
+pending_search :: item :: item(const e::slice& _key,
+                               const std::vector<e::slice>& _value,
+                               std::tr1::shared_ptr<e::buffer> _backing)
+    : key(_key)
+    , value(_value)
+    , backing(_backing)
+{
+}
+
+pending_search :: item :: item(const item& other)
+    : key(other.key)
+    , value(other.value)
+    , backing(other.backing)
+{
+}
+
+pending_search :: item :: ~item() throw ()
+{
+}
+
+pending_search::item&
+pending_search :: item :: operator = (const item& other)
+{
+    if (this != &other)
+    {
+        key = other.key;
+        value = other.value;
+        backing = other.backing;
+    }
+
+    return *this;
+}
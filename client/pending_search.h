@@ -28,18 +28,35 @@
 #ifndef hyperdex_client_pending_search_h_
 #define hyperdex_client_pending_search_h_
 
+// STL
+#include <list>
+#include <tr1/memory>
+#include <vector>
+
 // HyperDex
 #include "namespace.h"
 #include "client/pending_aggregation.h"
 
+// A search streams its results: every server is granted a window of
+// credits, each of which it redeems for a batch of results, and a credit is
+// returned as each batch arrives.  Because the client only receives when the
+// application has drained what came before, the window bounds the data in
+// flight from any one server.
+
+#define SEARCH_STREAM_WINDOW 4
+#define SEARCH_STREAM_BATCH_OBJECTS 1024
+#define SEARCH_STREAM_BATCH_BYTES (256 * 1024)
+
 BEGIN_HYPERDEX_NAMESPACE
 
 class pending_search : public pending_aggregation
 {
     public:
-        pending_search(uint64_t client_visible_id,
+        pending_search(client* cl,
+                       uint64_t client_visible_id,
                        hyperdex_client_returncode* status,
-                       const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+                       const hyperdex_client_attribute** attrs, size_t* attrs_sz,
+                       const std::vector<uint16_t>* projection);
         virtual ~pending_search() throw ();
 
     // return to client
@@ -49,6 +66,8 @@ class pending_search : public pending_aggregation
 
     // events
     public:
+        virtual void handle_sent_to(const server_id& si,
+                                    const virtual_server_id& vsi);
         virtual void handle_failure(const server_id& si,
                                     const virtual_server_id& vsi);
         virtual bool handle_message(client*,
@@ -60,18 +79,47 @@ class pending_search : public pending_aggregation
                                     hyperdex_client_returncode* status,
                                     e::error* error);
 
+    private:
+        class item;
+        bool more_to_yield();
+
     // noncopyable
     private:
         pending_search(const pending_search& other);
         pending_search& operator = (const pending_search& rhs);
 
     private:
+        client* m_cl;
+        region_id m_ri;
         const hyperdex_client_attribute** m_attrs;
         size_t* m_attrs_sz;
+        const bool m_projected;
+        const std::vector<uint16_t> m_projection;
+        std::list<item> m_results;
         bool m_yield;
+        bool m_error;
         bool m_done;
 };
 
+class pending_search :: item
+{
+    public:
+        item();
+        item(const e::slice& key,
+             const std::vector<e::slice>& value,
+             std::tr1::shared_ptr<e::buffer> backing);
+        item(const item&);
+        ~item() throw ();
+
+    public:
+        item& operator = (const item&);
+
+    public:
+        e::slice key;
+        std::vector<e::slice> value;
+        std::tr1::shared_ptr<e::buffer> backing;
+};
+
 END_HYPERDEX_NAMESPACE
 
 #endif // hyperdex_client_pending_search_h_
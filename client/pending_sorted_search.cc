@@ -44,7 +44,8 @@ pending_sorted_search :: pending_sorted_search(client* cl,
                                                datatype_info* sort_by_di,
                                                hyperdex_client_returncode* status,
                                                const hyperdex_client_attribute** attrs,
-                                               size_t* attrs_sz)
+                                               size_t* attrs_sz,
+                                               const std::vector<uint16_t>* projection)
     : pending_aggregation(id, status)
     , m_cl(cl)
     , m_yield(false)
@@ -55,8 +56,11 @@ pending_sorted_search :: pending_sorted_search(client* cl,
     , m_sort_by_di(sort_by_di)
     , m_attrs(attrs)
     , m_attrs_sz(attrs_sz)
-    , m_results()
-    , m_results_idx()
+    , m_projected(projection != NULL)
+    , m_projection(projection ? *projection : std::vector<uint16_t>())
+    , m_runs()
+    , m_heads()
+    , m_yielded(0)
 {
 }
 
@@ -76,8 +80,10 @@ pending_sorted_search :: yield(hyperdex_client_returncode* status, e::error* err
     *status = HYPERDEX_CLIENT_SUCCESS;
     *err = e::error();
     m_yield = false;
+    size_t run = 0;
 
-    if (this->aggregation_done() && m_results_idx >= m_results.size())
+    if (this->aggregation_done() &&
+        (m_yielded >= m_limit || !best_run(&run)))
     {
         set_status(HYPERDEX_CLIENT_SEARCHDONE);
         set_error(e::error());
@@ -88,12 +94,15 @@ pending_sorted_search :: yield(hyperdex_client_returncode* status, e::error* err
 
     hyperdex_client_returncode op_status;
     e::error op_error;
-    const e::slice& key(m_results[m_results_idx].key);
-    const std::vector<e::slice>& value(m_results[m_results_idx].value);
-    ++m_results_idx;
+    const item& it(m_runs[run][m_heads[run]]);
+    const e::slice& key(it.key);
+    const std::vector<e::slice>& value(it.value);
+    ++m_heads[run];
+    ++m_yielded;
 
     if (!value_to_attributes(*m_cl->m_coord.config(), m_ri, key.data(), key.size(),
-                             value, &op_status, &op_error, m_attrs, m_attrs_sz))
+                             value, m_projected ? &m_projection : NULL,
+                             &op_status, &op_error, m_attrs, m_attrs_sz))
     {
         set_status(op_status);
         set_error(op_error);
@@ -187,6 +196,29 @@ sorted_search_comparator :: operator () (const pending_sorted_search::item& lhs,
     return m_maximize ? (cmp > 0) : (cmp < 0);
 }
 
+bool
+pending_sorted_search :: best_run(size_t* run)
+{
+    sorted_search_comparator ssc(m_maximize, m_sort_by_idx, m_sort_by_di);
+    bool found = false;
+
+    for (size_t i = 0; i < m_runs.size(); ++i)
+    {
+        if (m_heads[i] >= m_runs[i].size())
+        {
+            continue;
+        }
+
+        if (!found || ssc(m_runs[i][m_heads[i]], m_runs[*run][m_heads[*run]]))
+        {
+            *run = i;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
 bool
 pending_sorted_search :: handle_message(client* cl,
                                         const server_id& si,
@@ -223,10 +255,14 @@ pending_sorted_search :: handle_message(client* cl,
         return true;
     }
 
-    sorted_search_comparator ssc(m_maximize, m_sort_by_idx, m_sort_by_di);
+    // each server returns its results best-first, so only the first m_limit
+    // of them could ever be yielded
     std::tr1::shared_ptr<e::buffer> backing(msg.release());
+    m_runs.push_back(std::vector<item>());
+    m_heads.push_back(0);
+    std::vector<item>* results = &m_runs.back();
 
-    for (uint64_t i = 0; i < num_results; ++i)
+    for (uint64_t i = 0; i < num_results && i < m_limit; ++i)
     {
         e::slice key;
         std::vector<e::slice> value;
@@ -236,31 +272,18 @@ pending_sorted_search :: handle_message(client* cl,
         {
             PENDING_ERROR(SERVERERROR) << "communication error: server "
                                        << vsi << " sent corrupt message="
-                                       << msg->as_slice().hex()
+                                       << backing->as_slice().hex()
                                        << " in response to a SORTED_SEARCH";
             m_yield = true;
             return true;
         }
 
-        m_results.push_back(item(key, value, backing));
-        std::push_heap(m_results.begin(), m_results.end(), ssc);
-
-        if (m_results.size() > m_limit)
-        {
-            std::pop_heap(m_results.begin(), m_results.end(), ssc);
-            m_results.pop_back();
-        }
+        results->push_back(item(key, value, backing));
     }
 
     m_yield = this->aggregation_done();
     set_status(HYPERDEX_CLIENT_SUCCESS);
     set_error(e::error());
-
-    if (m_yield)
-    {
-        std::sort(m_results.begin(), m_results.end(), ssc);
-    }
-
     return true;
 }
 
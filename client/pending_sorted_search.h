@@ -46,7 +46,8 @@ class pending_sorted_search : public pending_aggregation
                               datatype_info* sort_by_di,
                               hyperdex_client_returncode* status,
                               const hyperdex_client_attribute** attrs,
-                              size_t* attrs_sz);
+                              size_t* attrs_sz,
+                              const std::vector<uint16_t>* projection);
         virtual ~pending_sorted_search() throw ();
 
     // return to client
@@ -72,6 +73,11 @@ class pending_sorted_search : public pending_aggregation
     public:
         class item;
 
+    private:
+        // the run whose next unyielded result sorts first; false if all
+        // runs have been exhausted
+        bool best_run(size_t* run);
+
     // noncopyable
     private:
         pending_sorted_search(const pending_sorted_search& other);
@@ -83,12 +89,18 @@ class pending_sorted_search : public pending_aggregation
         region_id m_ri;
         bool m_maximize;
         const uint64_t m_limit;
+        // 0 for the key, or one more than the sort attribute's position in
+        // each (possibly projected) value
         const uint16_t m_sort_by_idx;
         datatype_info* m_sort_by_di;
         const hyperdex_client_attribute** m_attrs;
         size_t* m_attrs_sz;
-        std::vector<item> m_results;
-        size_t m_results_idx;
+        const bool m_projected;
+        const std::vector<uint16_t> m_projection;
+        // one best-first run of results per server, merged as we yield
+        std::vector<std::vector<item> > m_runs;
+        std::vector<size_t> m_heads;
+        uint64_t m_yielded;
 };
 
 class pending_sorted_search :: item
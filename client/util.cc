@@ -48,27 +48,61 @@ hyperdex :: value_to_attributes(const configuration& config,
                                 e::error* op_error,
                                 const hyperdex_client_attribute** attrs,
                                 size_t* attrs_sz)
+{
+    return value_to_attributes(config, rid, key, key_sz, value, NULL,
+                               op_status, op_error, attrs, attrs_sz);
+}
+
+bool
+hyperdex :: value_to_attributes(const configuration& config,
+                                const region_id& rid,
+                                const uint8_t* key,
+                                size_t key_sz,
+                                const std::vector<e::slice>& value,
+                                const std::vector<uint16_t>* projection,
+                                hyperdex_client_returncode* op_status,
+                                e::error* op_error,
+                                const hyperdex_client_attribute** attrs,
+                                size_t* attrs_sz)
 {
     const schema* sc = config.get_schema(rid);
+    size_t expected = projection ? projection->size() : sc->attrs_sz - 1u;
 
-    if (value.size() + 1 != sc->attrs_sz)
+    if (value.size() != expected)
     {
         UTIL_ERROR(SERVERERROR) << "received object with " << value.size()
                                 << " attributes instead of "
-                                << sc->attrs_sz - 1 << " attributes";
+                                << expected << " attributes";
         return false;
     }
 
-    size_t sz = sizeof(hyperdex_client_attribute) * sc->attrs_sz + key_sz
+    std::vector<uint16_t> attrnums;
+    attrnums.reserve(value.size());
+
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        uint16_t attr = projection ? (*projection)[i] : i + 1;
+
+        if (attr == 0 || attr >= sc->attrs_sz)
+        {
+            UTIL_ERROR(SERVERERROR) << "received object with attribute "
+                                    << attr << " not in the schema";
+            return false;
+        }
+
+        attrnums.push_back(attr);
+    }
+
+    size_t sz = sizeof(hyperdex_client_attribute) * (value.size() + 1) + key_sz
               + strlen(sc->attrs[0].name) + 1;
 
     for (size_t i = 0; i < value.size(); ++i)
     {
-        sz += strlen(sc->attrs[i + 1].name) + 1 + value[i].size();
+        sz += strlen(sc->attrs[attrnums[i]].name) + 1 + value[i].size();
     }
 
     std::vector<hyperdex_client_attribute> ha;
-    ha.reserve(sc->attrs_sz);
+    ha.reserve(value.size() + 1);
     char* ret = static_cast<char*>(malloc(sz));
 
     if (!ret)
@@ -97,16 +131,17 @@ hyperdex :: value_to_attributes(const configuration& config,
 
     for (size_t i = 0; i < value.size(); ++i)
     {
+        const attribute& a(sc->attrs[attrnums[i]]);
         ha.push_back(hyperdex_client_attribute());
-        size_t attr_sz = strlen(sc->attrs[i + 1].name) + 1;
+        size_t attr_sz = strlen(a.name) + 1;
         ha.back().attr = data;
-        memmove(data, sc->attrs[i + 1].name, attr_sz);
+        memmove(data, a.name, attr_sz);
         data += attr_sz;
         ha.back().value = data;
         memmove(data, value[i].data(), value[i].size());
         data += value[i].size();
         ha.back().value_sz = value[i].size();
-        ha.back().datatype = sc->attrs[i + 1].type;
+        ha.back().datatype = a.type;
     }
 
     memmove(ret, &ha.front(), sizeof(hyperdex_client_attribute) * ha.size());
@@ -117,3 +152,48 @@ hyperdex :: value_to_attributes(const configuration& config,
     g.dismiss();
     return true;
 }
+
+bool
+hyperdex :: copy_attributes(const std::vector<hyperdex_client_attribute>& in,
+                            hyperdex_client_returncode* op_status,
+                            e::error* op_error,
+                            const hyperdex_client_attribute** attrs,
+                            size_t* attrs_sz)
+{
+    size_t sz = sizeof(hyperdex_client_attribute) * in.size();
+
+    for (size_t i = 0; i < in.size(); ++i)
+    {
+        sz += strlen(in[i].attr) + 1 + in[i].value_sz;
+    }
+
+    char* ret = static_cast<char*>(malloc(sz));
+
+    if (!ret)
+    {
+        UTIL_ERROR(NOMEM) << "out of memory";
+        return false;
+    }
+
+    hyperdex_client_attribute* ha = reinterpret_cast<hyperdex_client_attribute*>(ret);
+    char* data = ret + sizeof(hyperdex_client_attribute) * in.size();
+
+    for (size_t i = 0; i < in.size(); ++i)
+    {
+        size_t attr_sz = strlen(in[i].attr) + 1;
+        ha[i].attr = data;
+        memmove(data, in[i].attr, attr_sz);
+        data += attr_sz;
+        ha[i].value = data;
+        memmove(data, in[i].value, in[i].value_sz);
+        data += in[i].value_sz;
+        ha[i].value_sz = in[i].value_sz;
+        ha[i].datatype = in[i].datatype;
+    }
+
+    *op_status = HYPERDEX_CLIENT_SUCCESS;
+    *op_error = e::error();
+    *attrs = ha;
+    *attrs_sz = in.size();
+    return true;
+}
@@ -52,6 +52,29 @@ value_to_attributes(const configuration& config,
                     const hyperdex_client_attribute** attrs,
                     size_t* attrs_sz);
 
+// As above, for a value that holds only the attributes named by projection,
+// in order.  A NULL projection means the value holds every attribute.
+bool
+value_to_attributes(const configuration& config,
+                    const region_id& rid,
+                    const uint8_t* key,
+                    size_t key_sz,
+                    const std::vector<e::slice>& value,
+                    const std::vector<uint16_t>* projection,
+                    hyperdex_client_returncode* op_status,
+                    e::error* op_error,
+                    const hyperdex_client_attribute** attrs,
+                    size_t* attrs_sz);
+
+// Copy the attributes, and the names and values they point to, into a single
+// allocation suitable for hyperdex_client_destroy_attrs.
+bool
+copy_attributes(const std::vector<hyperdex_client_attribute>& in,
+                hyperdex_client_returncode* op_status,
+                e::error* op_error,
+                const hyperdex_client_attribute** attrs,
+                size_t* attrs_sz);
+
 END_HYPERDEX_NAMESPACE
 
 #endif // hyperdex_client_util_h_
@@ -0,0 +1,269 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// C
+#include <cassert>
+
+// STL
+#include <algorithm>
+
+// e
+#include <e/endian.h>
+#include <e/safe_math.h>
+
+// HyperDex
+#include "common/aggregate.h"
+
+using hyperdex::aggregate;
+using hyperdex::aggregate_state;
+
+aggregate :: aggregate()
+    : attr()
+    , op(HYPERAGGREGATE_COUNT)
+{
+}
+
+aggregate :: ~aggregate() throw ()
+{
+}
+
+aggregate_state :: aggregate_state()
+    : count(0)
+    , overflow(false)
+    , int_sum(0)
+    , int_min(0)
+    , int_max(0)
+    , float_sum(0)
+    , float_min(0)
+    , float_max(0)
+{
+}
+
+aggregate_state :: ~aggregate_state() throw ()
+{
+}
+
+void
+aggregate_state :: add(hyperdatatype type, const e::slice& value)
+{
+    if (type == HYPERDATATYPE_INT64)
+    {
+        int64_t number = 0;
+
+        if (value.size() == sizeof(int64_t))
+        {
+            e::unpack64le(value.data(), &number);
+        }
+
+        if (!overflow && !e::safe_add(int_sum, number, &int_sum))
+        {
+            overflow = true;
+        }
+
+        int_min = count == 0 ? number : std::min(int_min, number);
+        int_max = count == 0 ? number : std::max(int_max, number);
+        float_sum += number;
+    }
+    else if (type == HYPERDATATYPE_FLOAT)
+    {
+        double number = 0;
+
+        if (value.size() == sizeof(double))
+        {
+            e::unpackdoublele(value.data(), &number);
+        }
+
+        float_min = count == 0 ? number : std::min(float_min, number);
+        float_max = count == 0 ? number : std::max(float_max, number);
+        float_sum += number;
+    }
+
+    ++count;
+}
+
+void
+aggregate_state :: merge(hyperdatatype type, const aggregate_state& other)
+{
+    if (other.count == 0)
+    {
+        return;
+    }
+
+    if (type == HYPERDATATYPE_INT64)
+    {
+        if (other.overflow ||
+            (!overflow && !e::safe_add(int_sum, other.int_sum, &int_sum)))
+        {
+            overflow = true;
+        }
+
+        int_min = count == 0 ? other.int_min : std::min(int_min, other.int_min);
+        int_max = count == 0 ? other.int_max : std::max(int_max, other.int_max);
+    }
+    else if (type == HYPERDATATYPE_FLOAT)
+    {
+        float_min = count == 0 ? other.float_min : std::min(float_min, other.float_min);
+        float_max = count == 0 ? other.float_max : std::max(float_max, other.float_max);
+    }
+
+    float_sum += other.float_sum;
+    count += other.count;
+}
+
+bool
+hyperdex :: validate_aggregate(const schema& sc, const aggregate& agg)
+{
+    switch (agg.op)
+    {
+        case HYPERAGGREGATE_COUNT:
+            return true;
+        case HYPERAGGREGATE_SUM:
+        case HYPERAGGREGATE_MIN:
+        case HYPERAGGREGATE_MAX:
+        case HYPERAGGREGATE_AVG:
+            return agg.attr > 0 && agg.attr < sc.attrs_sz &&
+                   (sc.attrs[agg.attr].type == HYPERDATATYPE_INT64 ||
+                    sc.attrs[agg.attr].type == HYPERDATATYPE_FLOAT);
+        default:
+            return false;
+    }
+}
+
+bool
+hyperdex :: validate_group_by(const schema& sc, uint16_t group_by)
+{
+    if (group_by == 0)
+    {
+        return true;
+    }
+
+    if (group_by >= sc.attrs_sz)
+    {
+        return false;
+    }
+
+    hyperdatatype t = sc.attrs[group_by].type;
+    return t == HYPERDATATYPE_STRING ||
+           t == HYPERDATATYPE_INT64 ||
+           t == HYPERDATATYPE_FLOAT;
+}
+
+namespace
+{
+
+std::vector<hyperdex::aggregate_state>*
+find_group(const std::vector<aggregate>& aggs,
+           const std::string& group,
+           hyperdex::aggregate_groups* groups)
+{
+    hyperdex::aggregate_groups::iterator it = groups->find(group);
+
+    if (it != groups->end())
+    {
+        return &it->second;
+    }
+
+    if (groups->size() >= hyperdex::AGGREGATE_MAX_GROUPS)
+    {
+        return NULL;
+    }
+
+    std::vector<aggregate_state>* states = &(*groups)[group];
+    states->resize(aggs.size());
+    return states;
+}
+
+} // namespace
+
+bool
+hyperdex :: aggregate_object(const schema& sc,
+                             const std::vector<aggregate>& aggs,
+                             uint16_t group_by,
+                             const std::vector<e::slice>& value,
+                             aggregate_groups* groups)
+{
+    std::string group;
+
+    if (group_by > 0 && group_by <= value.size())
+    {
+        const e::slice& g(value[group_by - 1]);
+        group.assign(reinterpret_cast<const char*>(g.data()), g.size());
+    }
+
+    std::vector<aggregate_state>* states = find_group(aggs, group, groups);
+
+    if (!states)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < aggs.size(); ++i)
+    {
+        if (aggs[i].op == HYPERAGGREGATE_COUNT ||
+            aggs[i].attr == 0 || aggs[i].attr > value.size())
+        {
+            ++(*states)[i].count;
+        }
+        else
+        {
+            (*states)[i].add(sc.attrs[aggs[i].attr].type, value[aggs[i].attr - 1]);
+        }
+    }
+
+    return true;
+}
+
+bool
+hyperdex :: merge_aggregate_group(const schema& sc,
+                                  const std::vector<aggregate>& aggs,
+                                  const std::string& group,
+                                  const std::vector<aggregate_state>& states,
+                                  aggregate_groups* groups)
+{
+    assert(states.size() == aggs.size());
+    std::vector<aggregate_state>* merged = find_group(aggs, group, groups);
+
+    if (!merged)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < aggs.size(); ++i)
+    {
+        hyperdatatype type = HYPERDATATYPE_GENERIC;
+
+        if (aggs[i].op != HYPERAGGREGATE_COUNT &&
+            aggs[i].attr > 0 && aggs[i].attr < sc.attrs_sz)
+        {
+            type = sc.attrs[aggs[i].attr].type;
+        }
+
+        (*merged)[i].merge(type, states[i]);
+    }
+
+    return true;
+}
@@ -0,0 +1,125 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_common_aggregate_h_
+#define hyperdex_common_aggregate_h_
+
+// C
+#include <stdint.h>
+
+// STL
+#include <map>
+#include <string>
+#include <vector>
+
+// e
+#include <e/slice.h>
+
+// HyperDex
+#include "namespace.h"
+#include "hyperdex.h"
+#include "common/schema.h"
+
+// Aggregates are evaluated where the data lives.  Each region folds its
+// matching objects into one aggregate_state per requested aggregate (per group,
+// when grouping), and the client merges the partial states from all regions.
+
+BEGIN_HYPERDEX_NAMESPACE
+
+class aggregate
+{
+    public:
+        aggregate();
+        ~aggregate() throw ();
+
+    public:
+        // ignored for HYPERAGGREGATE_COUNT
+        uint16_t attr;
+        hyperaggregate op;
+};
+
+class aggregate_state
+{
+    public:
+        aggregate_state();
+        ~aggregate_state() throw ();
+
+    public:
+        // fold in one value of an int64 or float attribute
+        void add(hyperdatatype type, const e::slice& value);
+        // fold in the state of a disjoint set of objects
+        void merge(hyperdatatype type, const aggregate_state& other);
+
+    public:
+        uint64_t count;
+        // the int64 sum left the range of int64_t
+        bool overflow;
+        int64_t int_sum;
+        int64_t int_min;
+        int64_t int_max;
+        // float aggregates, and the sum of int64 values for averaging
+        double float_sum;
+        double float_min;
+        double float_max;
+};
+
+// partial aggregates keyed by the value of the group-by attribute; without a
+// group-by attribute, everything falls into the group keyed by ""
+typedef std::map<std::string, std::vector<aggregate_state> > aggregate_groups;
+
+// the most groups a single aggregation may produce, at any one server or at
+// the client once merged
+static const size_t AGGREGATE_MAX_GROUPS = 4096;
+
+bool
+validate_aggregate(const schema& sc, const aggregate& agg);
+// group_by is 0 for no grouping, or a string, int64, or float attribute
+bool
+validate_group_by(const schema& sc, uint16_t group_by);
+
+// group_by may be 0 to put every object in one group, as grouping by the key
+// is pointless.  Returns false if the object would open a group beyond
+// AGGREGATE_MAX_GROUPS.
+bool
+aggregate_object(const schema& sc,
+                 const std::vector<aggregate>& aggs,
+                 uint16_t group_by,
+                 const std::vector<e::slice>& value,
+                 aggregate_groups* groups);
+
+// fold a group's partial states from one server into groups.  Returns false if
+// the group would be beyond AGGREGATE_MAX_GROUPS.
+bool
+merge_aggregate_group(const schema& sc,
+                      const std::vector<aggregate>& aggs,
+                      const std::string& group,
+                      const std::vector<aggregate_state>& states,
+                      aggregate_groups* groups);
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_common_aggregate_h_
@@ -30,6 +30,7 @@
 
 // STL
 #include <algorithm>
+#include <memory>
 
 // HyperDex
 #include "common/configuration.h"
@@ -46,6 +47,18 @@ using hyperdex::subspace;
 using hyperdex::subspace_id;
 using hyperdex::virtual_server_id;
 
+namespace
+{
+
+struct name_lt
+{
+    bool operator () (const std::pair<const char*, size_t>& lhs,
+                      const std::pair<const char*, size_t>& rhs) const
+    { return strcmp(lhs.first, rhs.first) < 0; }
+};
+
+} // namespace
+
 configuration :: configuration()
     : m_cluster(0)
     , m_version(0)
@@ -61,9 +74,16 @@ configuration :: configuration()
     , m_tails_by_region()
     , m_next_by_virtual()
     , m_point_leaders_by_virtual()
+    , m_spaces_by_name()
+    , m_spaces_by_region()
+    , m_regions_by_id()
+    , m_leaders_by_coord()
+    , m_captures_by_region()
+    , m_transfers_by_region()
     , m_spaces()
     , m_captures()
     , m_transfers()
+    , m_quiesced()
 {
     refill_cache();
 }
@@ -83,9 +103,16 @@ configuration :: configuration(const configuration& other)
     , m_tails_by_region(other.m_tails_by_region)
     , m_next_by_virtual(other.m_next_by_virtual)
     , m_point_leaders_by_virtual(other.m_point_leaders_by_virtual)
+    , m_spaces_by_name(other.m_spaces_by_name)
+    , m_spaces_by_region(other.m_spaces_by_region)
+    , m_regions_by_id(other.m_regions_by_id)
+    , m_leaders_by_coord(other.m_leaders_by_coord)
+    , m_captures_by_region(other.m_captures_by_region)
+    , m_transfers_by_region(other.m_transfers_by_region)
     , m_spaces(other.m_spaces)
     , m_captures(other.m_captures)
     , m_transfers(other.m_transfers)
+    , m_quiesced(other.m_quiesced)
 {
     refill_cache();
 }
@@ -166,18 +193,18 @@ configuration :: get_server_id(const virtual_server_id& id) const
     return server_id();
 }
 
+const hyperdex::space*
+configuration :: get_space(const char* sname) const
+{
+    size_t s = space_index(sname);
+    return s < m_spaces.size() ? &m_spaces[s] : NULL;
+}
+
 const schema*
 configuration :: get_schema(const char* sname) const
 {
-    for (size_t s = 0; s < m_spaces.size(); ++s)
-    {
-        if (strcmp(sname, m_spaces[s].name) == 0)
-        {
-            return &m_spaces[s].sc;
-        }
-    }
-
-    return NULL;
+    size_t s = space_index(sname);
+    return s < m_spaces.size() ? &m_spaces[s].sc : NULL;
 }
 
 const schema*
@@ -215,33 +242,23 @@ configuration :: get_subspace(const region_id& ri) const
 virtual_server_id
 configuration :: get_virtual(const region_id& ri, const server_id& si) const
 {
-    for (size_t w = 0; w < m_spaces.size(); ++w)
-    {
-        const space& s(m_spaces[w]);
+    std::vector<uint64_region_t>::const_iterator it;
+    it = std::lower_bound(m_regions_by_id.begin(),
+                          m_regions_by_id.end(),
+                          uint64_region_t(ri.get(), NULL));
 
-        for (size_t x = 0; x < s.subspaces.size(); ++x)
-        {
-            const subspace& ss(s.subspaces[x]);
-
-            for (size_t y = 0; y < ss.regions.size(); ++y)
-            {
-                const region& r(ss.regions[y]);
-
-                if (r.id != ri)
-                {
-                    continue;
-                }
+    if (it == m_regions_by_id.end() || it->first != ri.get())
+    {
+        return virtual_server_id();
+    }
 
-                for (size_t z = 0; z < r.replicas.size(); ++z)
-                {
-                    if (r.replicas[z].si == si)
-                    {
-                        return r.replicas[z].vsi;
-                    }
-                }
+    const region& r(*it->second);
 
-                return virtual_server_id();
-            }
+    for (size_t z = 0; z < r.replicas.size(); ++z)
+    {
+        if (r.replicas[z].si == si)
+        {
+            return r.replicas[z].vsi;
         }
     }
 
@@ -363,45 +380,8 @@ configuration :: point_leaders(const server_id& si, std::vector<region_id>* serv
     }
 }
 
-bool
-configuration :: is_point_leader(const virtual_server_id& e) const
-{
-    return std::binary_search(m_point_leaders_by_virtual.begin(),
-                              m_point_leaders_by_virtual.end(),
-                              e.get());
-}
-
-virtual_server_id
-configuration :: point_leader(const char* sname, const e::slice& key) const
-{
-    for (size_t s = 0; s < m_spaces.size(); ++s)
-    {
-        if (strcmp(sname, m_spaces[s].name) != 0)
-        {
-            continue;
-        }
-
-        uint64_t h;
-        hash(m_spaces[s].sc, key, &h);
-
-        for (size_t pl = 0; pl < m_spaces[s].subspaces[0].regions.size(); ++pl)
-        {
-            if (m_spaces[s].subspaces[0].regions[pl].lower_coord[0] <= h &&
-                h <= m_spaces[s].subspaces[0].regions[pl].upper_coord[0])
-            {
-                assert(!m_spaces[s].subspaces[0].regions[pl].replicas.empty());
-                return m_spaces[s].subspaces[0].regions[pl].replicas[0].vsi;
-            }
-        }
-
-        abort();
-    }
-
-    return virtual_server_id();
-}
-
-virtual_server_id
-configuration :: point_leader(const region_id& rid, const e::slice& key) const
+void
+configuration :: mapped_regions(const server_id& si, std::vector<region_id>* regions) const
 {
     for (size_t s = 0; s < m_spaces.size(); ++s)
     {
@@ -409,30 +389,39 @@ configuration :: point_leader(const region_id& rid, const e::slice& key) const
         {
             for (size_t r = 0; r < m_spaces[s].subspaces[ss].regions.size(); ++r)
             {
-                if (m_spaces[s].subspaces[ss].regions[r].id != rid)
-                {
-                    continue;
-                }
-
-                uint64_t h;
-                hash(m_spaces[s].sc, key, &h);
+                const region& reg(m_spaces[s].subspaces[ss].regions[r]);
 
-                for (size_t pl = 0; pl < m_spaces[s].subspaces[0].regions.size(); ++pl)
+                for (size_t i = 0; i < reg.replicas.size(); ++i)
                 {
-                    if (m_spaces[s].subspaces[0].regions[pl].lower_coord[0] <= h &&
-                        h <= m_spaces[s].subspaces[0].regions[pl].upper_coord[0])
+                    if (reg.replicas[i].si == si)
                     {
-                        assert(!m_spaces[s].subspaces[0].regions[pl].replicas.empty());
-                        return m_spaces[s].subspaces[0].regions[pl].replicas[0].vsi;
+                        regions->push_back(reg.id);
+                        break;
                     }
                 }
-
-                abort();
             }
         }
     }
+}
 
-    return virtual_server_id();
+bool
+configuration :: is_point_leader(const virtual_server_id& e) const
+{
+    return std::binary_search(m_point_leaders_by_virtual.begin(),
+                              m_point_leaders_by_virtual.end(),
+                              e.get());
+}
+
+virtual_server_id
+configuration :: point_leader(const char* sname, const e::slice& key) const
+{
+    return point_leader(space_index(sname), key);
+}
+
+virtual_server_id
+configuration :: point_leader(const region_id& rid, const e::slice& key) const
+{
+    return point_leader(space_index(rid), key);
 }
 
 bool
@@ -470,12 +459,14 @@ configuration :: is_captured_region(const capture_id& ci) const
 capture_id
 configuration :: capture_for(const region_id& ri) const
 {
-    for (size_t i = 0; i < m_captures.size(); ++i)
+    std::vector<pair_uint64_t>::const_iterator it;
+    it = std::lower_bound(m_captures_by_region.begin(),
+                          m_captures_by_region.end(),
+                          pair_uint64_t(ri.get(), 0));
+
+    if (it != m_captures_by_region.end() && it->first == ri.get())
     {
-        if (m_captures[i].rid == ri)
-        {
-            return m_captures[i].id;
-        }
+        return capture_id(it->second);
     }
 
     return capture_id();
@@ -484,9 +475,16 @@ configuration :: capture_for(const region_id& ri) const
 bool
 configuration :: is_server_blocked_by_live_transfer(const server_id& si, const region_id& id) const
 {
-    for (size_t i = 0; i < m_transfers.size(); ++i)
+    std::vector<pair_uint64_t>::const_iterator it;
+    it = std::lower_bound(m_transfers_by_region.begin(),
+                          m_transfers_by_region.end(),
+                          pair_uint64_t(id.get(), 0));
+
+    for (; it != m_transfers_by_region.end() && it->first == id.get(); ++it)
     {
-        if (m_transfers[i].src != si || m_transfers[i].rid != id)
+        size_t i = it->second;
+
+        if (m_transfers[i].src != si)
         {
             continue;
         }
@@ -544,6 +542,36 @@ configuration :: transfer_out_regions(const hyperdex::server_id& si, std::vector
     }
 }
 
+bool
+configuration :: is_quiesced(const region_id& ri) const
+{
+    size_t s = space_index(ri);
+    return s < m_spaces.size() &&
+           std::binary_search(m_quiesced.begin(), m_quiesced.end(), m_spaces[s].id);
+}
+
+void
+configuration :: quiesced_regions(std::vector<region_id>* regions) const
+{
+    for (size_t s = 0; s < m_spaces.size(); ++s)
+    {
+        if (!std::binary_search(m_quiesced.begin(), m_quiesced.end(), m_spaces[s].id))
+        {
+            continue;
+        }
+
+        for (size_t ss = 0; ss < m_spaces[s].subspaces.size(); ++ss)
+        {
+            for (size_t r = 0; r < m_spaces[s].subspaces[ss].regions.size(); ++r)
+            {
+                regions->push_back(m_spaces[s].subspaces[ss].regions[r].id);
+            }
+        }
+    }
+
+    std::sort(regions->begin(), regions->end());
+}
+
 void
 configuration :: lookup_region(const subspace_id& ssid,
                                const std::vector<uint64_t>& hashes,
@@ -717,6 +745,97 @@ configuration :: lookup_search(const char* space_name,
     servers->swap(smallest_server_set);
 }
 
+bool
+configuration :: differs_for(const server_id& s, const configuration& other) const
+{
+    std::string lhs;
+    std::string rhs;
+    pack_view(s, &lhs);
+    other.pack_view(s, &rhs);
+    return lhs != rhs;
+}
+
+void
+configuration :: pack_view(const server_id& si, std::string* out) const
+{
+    for (size_t s = 0; s < m_spaces.size(); ++s)
+    {
+        std::vector<region_id> rids;
+        bool involved = false;
+
+        for (size_t ss = 0; ss < m_spaces[s].subspaces.size(); ++ss)
+        {
+            for (size_t r = 0; r < m_spaces[s].subspaces[ss].regions.size(); ++r)
+            {
+                const region& reg(m_spaces[s].subspaces[ss].regions[r]);
+                rids.push_back(reg.id);
+
+                for (size_t i = 0; i < reg.replicas.size(); ++i)
+                {
+                    involved = involved || reg.replicas[i].si == si;
+                }
+            }
+        }
+
+        std::sort(rids.begin(), rids.end());
+        std::vector<transfer> transfers;
+
+        for (size_t i = 0; i < m_transfers.size(); ++i)
+        {
+            if (std::binary_search(rids.begin(), rids.end(), m_transfers[i].rid))
+            {
+                transfers.push_back(m_transfers[i]);
+                involved = involved ||
+                           m_transfers[i].src == si ||
+                           m_transfers[i].dst == si;
+            }
+        }
+
+        if (!involved)
+        {
+            continue;
+        }
+
+        std::vector<capture> captures;
+
+        for (size_t i = 0; i < m_captures.size(); ++i)
+        {
+            if (std::binary_search(rids.begin(), rids.end(), m_captures[i].rid))
+            {
+                captures.push_back(m_captures[i]);
+            }
+        }
+
+        size_t sz = pack_size(m_spaces[s]);
+
+        for (size_t i = 0; i < transfers.size(); ++i)
+        {
+            sz += pack_size(transfers[i]);
+        }
+
+        for (size_t i = 0; i < captures.size(); ++i)
+        {
+            sz += pack_size(captures[i]);
+        }
+
+        std::auto_ptr<e::buffer> buf(e::buffer::create(sz));
+        e::buffer::packer pa = buf->pack_at(0);
+        pa = pa << m_spaces[s];
+
+        for (size_t i = 0; i < transfers.size(); ++i)
+        {
+            pa = pa << transfers[i];
+        }
+
+        for (size_t i = 0; i < captures.size(); ++i)
+        {
+            pa = pa << captures[i];
+        }
+
+        out->append(reinterpret_cast<const char*>(buf->data()), buf->size());
+    }
+}
+
 void
 configuration :: dump(std::ostream& out) const
 {
@@ -811,6 +930,11 @@ configuration :: dump(std::ostream& out) const
     {
         out << m_transfers[i] << std::endl;
     }
+
+    for (size_t i = 0; i < m_quiesced.size(); ++i)
+    {
+        out << "quiesced space " << m_quiesced[i].get() << std::endl;
+    }
 }
 
 configuration&
@@ -835,13 +959,129 @@ configuration :: operator = (const configuration& rhs)
     m_tails_by_region = rhs.m_tails_by_region;
     m_next_by_virtual = rhs.m_next_by_virtual;
     m_point_leaders_by_virtual = rhs.m_point_leaders_by_virtual;
+    m_spaces_by_name = rhs.m_spaces_by_name;
+    m_spaces_by_region = rhs.m_spaces_by_region;
+    m_regions_by_id = rhs.m_regions_by_id;
+    m_leaders_by_coord = rhs.m_leaders_by_coord;
+    m_captures_by_region = rhs.m_captures_by_region;
+    m_transfers_by_region = rhs.m_transfers_by_region;
     m_spaces = rhs.m_spaces;
     m_captures = rhs.m_captures;
     m_transfers = rhs.m_transfers;
+    m_quiesced = rhs.m_quiesced;
     refill_cache();
     return *this;
 }
 
+// A delta carries the version it produces, then the complete (and small)
+// server, capture and transfer lists, then the new chain of every region
+// whose chain changed, and last the complete list of quiesced spaces.
+// Changes to the set of spaces or regions never travel as deltas.
+e::unpacker
+configuration :: apply_delta(e::unpacker up)
+{
+    uint64_t version;
+    uint64_t num_servers;
+    uint64_t num_captures;
+    uint64_t num_transfers;
+    uint64_t num_regions;
+    up = up >> version
+            >> num_servers >> num_captures
+            >> num_transfers >> num_regions;
+
+    if (up.error() || version != m_version + 1)
+    {
+        return up.as_error();
+    }
+
+    std::vector<uint64_location_t> addresses;
+    std::vector<capture> captures;
+    std::vector<transfer> transfers;
+    std::vector<region*> regions;
+    std::vector<std::vector<replica> > chains;
+
+    for (size_t i = 0; !up.error() && i < num_servers; ++i)
+    {
+        uint64_t id;
+        po6::net::location loc;
+        up = up >> id >> loc;
+        addresses.push_back(std::make_pair(id, loc));
+    }
+
+    for (size_t i = 0; !up.error() && i < num_captures; ++i)
+    {
+        capture cap;
+        up = up >> cap;
+        captures.push_back(cap);
+    }
+
+    for (size_t i = 0; !up.error() && i < num_transfers; ++i)
+    {
+        transfer xfer;
+        up = up >> xfer;
+        transfers.push_back(xfer);
+    }
+
+    for (size_t i = 0; !up.error() && i < num_regions; ++i)
+    {
+        uint64_t id;
+        uint8_t num_replicas;
+        up = up >> id >> num_replicas;
+        std::vector<replica> chain(num_replicas);
+
+        for (size_t j = 0; !up.error() && j < num_replicas; ++j)
+        {
+            up = up >> chain[j];
+        }
+
+        std::vector<uint64_region_t>::iterator it;
+        it = std::lower_bound(m_regions_by_id.begin(),
+                              m_regions_by_id.end(),
+                              uint64_region_t(id, NULL));
+
+        if (it == m_regions_by_id.end() || it->first != id)
+        {
+            return up.as_error();
+        }
+
+        // the index points into our own m_spaces
+        regions.push_back(const_cast<region*>(it->second));
+        chains.push_back(chain);
+    }
+
+    uint64_t num_quiesced = 0;
+    up = up >> num_quiesced;
+    std::vector<space_id> quiesced;
+
+    for (size_t i = 0; !up.error() && i < num_quiesced; ++i)
+    {
+        uint64_t id;
+        up = up >> id;
+        quiesced.push_back(space_id(id));
+    }
+
+    if (up.error())
+    {
+        return up;
+    }
+
+    std::sort(quiesced.begin(), quiesced.end());
+
+    m_version = version;
+    m_addresses_by_server_id.swap(addresses);
+    m_captures.swap(captures);
+    m_transfers.swap(transfers);
+    m_quiesced.swap(quiesced);
+
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+        regions[i]->replicas.swap(chains[i]);
+    }
+
+    refill_cache();
+    return up;
+}
+
 void
 configuration :: refill_cache()
 {
@@ -856,10 +1096,18 @@ configuration :: refill_cache()
     m_tails_by_region.clear();
     m_next_by_virtual.clear();
     m_point_leaders_by_virtual.clear();
+    m_spaces_by_name.clear();
+    m_spaces_by_region.clear();
+    m_regions_by_id.clear();
+    m_leaders_by_coord.clear();
+    m_leaders_by_coord.resize(m_spaces.size());
+    m_captures_by_region.clear();
+    m_transfers_by_region.clear();
 
     for (size_t w = 0; w < m_spaces.size(); ++w)
     {
         space& s(m_spaces[w]);
+        m_spaces_by_name.push_back(std::make_pair(s.name, w));
 
         for (size_t x = 0; x < s.subspaces.size(); ++x)
         {
@@ -883,6 +1131,8 @@ configuration :: refill_cache()
                 m_schemas_by_region.push_back(std::make_pair(r.id.get(), &s.sc));
                 m_subspaces_by_region.push_back(std::make_pair(r.id.get(), &ss));
                 m_subspace_ids_by_region.push_back(std::make_pair(r.id.get(), ss.id.get()));
+                m_spaces_by_region.push_back(std::make_pair(r.id.get(), w));
+                m_regions_by_id.push_back(std::make_pair(r.id.get(), &r));
 
                 if (r.replicas.empty())
                 {
@@ -892,6 +1142,7 @@ configuration :: refill_cache()
                 if (x == 0)
                 {
                     m_point_leaders_by_virtual.push_back(r.replicas[0].vsi.get());
+                    m_leaders_by_coord[w].push_back(std::make_pair(r.upper_coord[0], &r));
                 }
 
                 m_heads_by_region.push_back(std::make_pair(r.id.get(),
@@ -921,6 +1172,18 @@ configuration :: refill_cache()
         transfer& xfer(m_transfers[i]);
         m_region_ids_by_virtual.push_back(std::make_pair(xfer.vsrc.get(), xfer.rid.get()));
         m_server_ids_by_virtual.push_back(std::make_pair(xfer.vdst.get(), xfer.dst.get()));
+        m_transfers_by_region.push_back(std::make_pair(xfer.rid.get(), i));
+    }
+
+    for (size_t i = 0; i < m_captures.size(); ++i)
+    {
+        m_captures_by_region.push_back(std::make_pair(m_captures[i].rid.get(),
+                                                      m_captures[i].id.get()));
+    }
+
+    for (size_t i = 0; i < m_leaders_by_coord.size(); ++i)
+    {
+        std::sort(m_leaders_by_coord[i].begin(), m_leaders_by_coord[i].end());
     }
 
     std::sort(m_addresses_by_server_id.begin(), m_addresses_by_server_id.end());
@@ -935,6 +1198,68 @@ configuration :: refill_cache()
     std::sort(m_tails_by_region.begin(), m_tails_by_region.end());
     std::sort(m_next_by_virtual.begin(), m_next_by_virtual.end());
     std::sort(m_point_leaders_by_virtual.begin(), m_point_leaders_by_virtual.end());
+    std::sort(m_spaces_by_name.begin(), m_spaces_by_name.end(), name_lt());
+    std::sort(m_spaces_by_region.begin(), m_spaces_by_region.end());
+    std::sort(m_regions_by_id.begin(), m_regions_by_id.end());
+    std::sort(m_captures_by_region.begin(), m_captures_by_region.end());
+    std::sort(m_transfers_by_region.begin(), m_transfers_by_region.end());
+}
+
+size_t
+configuration :: space_index(const char* sname) const
+{
+    std::vector<name_index_t>::const_iterator it;
+    it = std::lower_bound(m_spaces_by_name.begin(),
+                          m_spaces_by_name.end(),
+                          name_index_t(sname, 0), name_lt());
+
+    if (it != m_spaces_by_name.end() && strcmp(it->first, sname) == 0)
+    {
+        return it->second;
+    }
+
+    return m_spaces.size();
+}
+
+size_t
+configuration :: space_index(const region_id& ri) const
+{
+    std::vector<pair_uint64_t>::const_iterator it;
+    it = std::lower_bound(m_spaces_by_region.begin(),
+                          m_spaces_by_region.end(),
+                          pair_uint64_t(ri.get(), 0));
+
+    if (it != m_spaces_by_region.end() && it->first == ri.get())
+    {
+        return it->second;
+    }
+
+    return m_spaces.size();
+}
+
+virtual_server_id
+configuration :: point_leader(size_t s, const e::slice& key) const
+{
+    if (s >= m_spaces.size())
+    {
+        return virtual_server_id();
+    }
+
+    uint64_t h;
+    hash(m_spaces[s].sc, key, &h);
+    // the first region whose range ends at or after h
+    std::vector<uint64_region_t>::const_iterator it;
+    it = std::lower_bound(m_leaders_by_coord[s].begin(),
+                          m_leaders_by_coord[s].end(),
+                          uint64_region_t(h, NULL));
+
+    if (it == m_leaders_by_coord[s].end() ||
+        it->second->lower_coord[0] > h)
+    {
+        abort();
+    }
+
+    return it->second->replicas[0].vsi;
 }
 
 e::unpacker
@@ -988,6 +1313,64 @@ hyperdex :: operator >> (e::unpacker up, configuration& c)
         c.m_transfers.push_back(xfer);
     }
 
+    c.m_quiesced.clear();
+
+    // older coordinators end the configuration with the transfers
+    if (!up.error() && up.remain() > 0)
+    {
+        uint64_t num_quiesced;
+        up = up >> num_quiesced;
+
+        for (size_t i = 0; !up.error() && i < num_quiesced; ++i)
+        {
+            uint64_t id;
+            up = up >> id;
+            c.m_quiesced.push_back(space_id(id));
+        }
+
+        std::sort(c.m_quiesced.begin(), c.m_quiesced.end());
+    }
+
     c.refill_cache();
     return up;
 }
+
+e::unpacker
+hyperdex :: unpack_config_update(e::unpacker up,
+                                 const configuration& current,
+                                 configuration* next)
+{
+    uint8_t type;
+    up = up >> type;
+
+    if (up.error())
+    {
+        return up;
+    }
+
+    if (type == CONFIG_FULL)
+    {
+        return up >> *next;
+    }
+
+    uint64_t cluster;
+    uint64_t version;
+    uint64_t num_deltas;
+    up = up >> cluster >> version >> num_deltas;
+
+    if (up.error() || type != CONFIG_DELTA ||
+        cluster != current.cluster() ||
+        version != current.version())
+    {
+        return up.as_error();
+    }
+
+    *next = current;
+
+    for (size_t i = 0; !up.error() && i < num_deltas; ++i)
+    {
+        up = next->apply_delta(up);
+    }
+
+    return up;
+}
@@ -71,6 +71,7 @@ class configuration
 
     // hyperspace metadata
     public:
+        const space* get_space(const char* space) const;
         const schema* get_schema(const char* space) const;
         const schema* get_schema(const region_id& ri) const;
         const subspace* get_subspace(const region_id& ri) const;
@@ -82,6 +83,8 @@ class configuration
         virtual_server_id tail_of_region(const region_id& ri) const;
         virtual_server_id next_in_region(const virtual_server_id& vsi) const;
         void point_leaders(const server_id& s, std::vector<region_id>* servers) const;
+        // every region with s in its chain
+        void mapped_regions(const server_id& s, std::vector<region_id>* regions) const;
         bool is_point_leader(const virtual_server_id& e) const;
         virtual_server_id point_leader(const char* space, const e::slice& key) const;
         // point leader for this key in the same space as ri
@@ -107,6 +110,14 @@ class configuration
         void transfer_in_regions(const server_id& s, std::vector<transfer>* transfers) const;
         void transfer_out_regions(const server_id& s, std::vector<transfer>* transfers) const;
 
+    // quiescence:  writes to a quiesced space are turned away while the
+    // coordinator waits for those in flight to settle before it splits or
+    // merges the space's regions
+    public:
+        bool is_quiesced(const region_id& ri) const;
+        // every region of every quiesced space, sorted
+        void quiesced_regions(std::vector<region_id>* regions) const;
+
     // hashing functions
     public:
         void lookup_region(const subspace_id& subspace,
@@ -118,12 +129,27 @@ class configuration
 
     public:
         void dump(std::ostream& out) const;
+        // true if "other" differs from this configuration in any space in
+        // which "s" holds or transfers a region
+        bool differs_for(const server_id& s, const configuration& other) const;
+
+    // incremental updates
+    public:
+        // apply one delta as packed by the coordinator; the delta must take
+        // this configuration to the very next version, or the unpacker comes
+        // back in error with the configuration unchanged
+        e::unpacker apply_delta(e::unpacker up);
 
     public:
         configuration& operator = (const configuration& rhs);
 
     private:
         void refill_cache();
+        void pack_view(const server_id& s, std::string* out) const;
+        // index into m_spaces, or m_spaces.size() if there is no such space
+        size_t space_index(const char* space) const;
+        size_t space_index(const region_id& ri) const;
+        virtual_server_id point_leader(size_t space_idx, const e::slice& key) const;
         friend size_t pack_size(const configuration&);
         friend e::buffer::packer operator << (e::buffer::packer, const configuration& s);
         friend e::unpacker operator >> (e::unpacker, configuration& s);
@@ -133,6 +159,8 @@ class configuration
         typedef std::pair<uint64_t, schema*> uint64_schema_t;
         typedef std::pair<uint64_t, subspace*> uint64_subspace_t;
         typedef std::pair<uint64_t, po6::net::location> uint64_location_t;
+        typedef std::pair<uint64_t, const region*> uint64_region_t;
+        typedef std::pair<const char*, size_t> name_index_t;
 
     private:
         uint64_t m_cluster;
@@ -149,9 +177,18 @@ class configuration
         std::vector<pair_uint64_t> m_tails_by_region;
         std::vector<pair_uint64_t> m_next_by_virtual;
         std::vector<uint64_t> m_point_leaders_by_virtual;
+        std::vector<name_index_t> m_spaces_by_name;
+        std::vector<pair_uint64_t> m_spaces_by_region;
+        std::vector<uint64_region_t> m_regions_by_id;
+        // for each space, its subspace 0 regions by upper_coord[0]
+        std::vector<std::vector<uint64_region_t> > m_leaders_by_coord;
+        std::vector<pair_uint64_t> m_captures_by_region;
+        std::vector<pair_uint64_t> m_transfers_by_region;
         std::vector<space> m_spaces;
         std::vector<capture> m_captures;
         std::vector<transfer> m_transfers;
+        // sorted
+        std::vector<space_id> m_quiesced;
 };
 
 e::buffer::packer
@@ -161,6 +198,18 @@ operator >> (e::unpacker, configuration& c);
 size_t
 pack_size(const configuration&);
 
+// The coordinator answers "get-config-delta" with a full configuration or,
+// when it still holds every delta since the caller's version, with those.
+enum config_update_t
+{
+    CONFIG_FULL  = 1,
+    CONFIG_DELTA = 2
+};
+
+// unpack such an answer into "next", building on "current"
+e::unpacker
+unpack_config_update(e::unpacker up, const configuration& current, configuration* next);
+
 END_HYPERDEX_NAMESPACE
 
 #endif // hyperdex_common_configuration_h_
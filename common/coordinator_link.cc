@@ -25,6 +25,9 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+// e
+#include <e/endian.h>
+
 // HyperDex
 #include "common/coordinator_link.h"
 
@@ -39,6 +42,7 @@ coordinator_link :: coordinator_link(const char* coordinator, uint16_t port)
     , m_output(NULL)
     , m_output_sz(0)
     , m_pending_ids()
+    , m_full_configs(false)
 {
 }
 
@@ -157,6 +161,21 @@ coordinator_link :: handle_internal_callback(replicant_returncode* status, bool*
 {
     m_id = -1;
 
+    if (m_status == REPLICANT_FUNC_NOT_FOUND &&
+        m_state == FETCHING_CONFIG && !m_full_configs)
+    {
+        // an older coordinator without "get-config-delta"
+        m_full_configs = true;
+
+        if (!begin_fetching_config(status))
+        {
+            *ensured = false;
+            return true;
+        }
+
+        return false;
+    }
+
     if (m_status != REPLICANT_SUCCESS)
     {
         if (m_output)
@@ -184,7 +203,16 @@ coordinator_link :: handle_internal_callback(replicant_returncode* status, bool*
 
     e::unpacker up(m_output, m_output_sz);
     configuration new_config;
-    up = up >> new_config;
+
+    if (m_full_configs)
+    {
+        up = up >> new_config;
+    }
+    else
+    {
+        up = unpack_config_update(up, m_config, &new_config);
+    }
+
     replicant_destroy_output(m_output, m_output_sz);
     m_output = NULL;
     m_output_sz = 0;
@@ -228,8 +256,20 @@ coordinator_link :: begin_fetching_config(replicant_returncode* status)
     assert(m_id == -1);
     assert(m_output == NULL);
     assert(m_output_sz == 0);
-    m_id = m_repl.send("hyperdex", "get-config", "", 0,
-                       &m_status, &m_output, &m_output_sz);
+    char data[sizeof(uint64_t)];
+    e::pack64be(m_config.version(), data);
+
+    if (m_full_configs)
+    {
+        m_id = m_repl.send("hyperdex", "get-config", "", 0,
+                           &m_status, &m_output, &m_output_sz);
+    }
+    else
+    {
+        m_id = m_repl.send("hyperdex", "get-config-delta", data, sizeof(uint64_t),
+                           &m_status, &m_output, &m_output_sz);
+    }
+
     m_state = FETCHING_CONFIG;
     *status = m_status;
     return m_id >= 0;
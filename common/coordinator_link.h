@@ -93,6 +93,7 @@ class coordinator_link
         const char* m_output;
         size_t m_output_sz;
         std::list<int64_t> m_pending_ids;
+        bool m_full_configs;
 };
 
 END_HYPERDEX_NAMESPACE
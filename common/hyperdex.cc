@@ -91,3 +91,21 @@ operator << (std::ostream& lhs, hyperpredicate rhs)
 
     return lhs;
 }
+
+HYPERDEX_API std::ostream&
+operator << (std::ostream& lhs, hyperaggregate rhs)
+{
+    switch (rhs)
+    {
+        STRINGIFY(HYPERAGGREGATE_COUNT);
+        STRINGIFY(HYPERAGGREGATE_SUM);
+        STRINGIFY(HYPERAGGREGATE_MIN);
+        STRINGIFY(HYPERAGGREGATE_MAX);
+        STRINGIFY(HYPERAGGREGATE_AVG);
+        default:
+            lhs << "unknown hyperaggregate";
+            break;
+    }
+
+    return lhs;
+}
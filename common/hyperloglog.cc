@@ -0,0 +1,120 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// C
+#include <cmath>
+
+// HyperDex
+#include "common/hyperloglog.h"
+
+using hyperdex::hyperloglog;
+
+const unsigned hyperloglog::PRECISION;
+const size_t hyperloglog::REGISTERS;
+
+hyperloglog :: hyperloglog()
+    : m_registers(REGISTERS, 0)
+{
+}
+
+hyperloglog :: ~hyperloglog() throw ()
+{
+}
+
+void
+hyperloglog :: add(uint64_t hash)
+{
+    size_t idx = hash >> (64 - PRECISION);
+    uint64_t rem = hash << PRECISION;
+    uint8_t rank = 1;
+
+    while (rank <= 64 - PRECISION && !(rem & 0x8000000000000000ULL))
+    {
+        rem <<= 1;
+        ++rank;
+    }
+
+    if (m_registers[idx] < rank)
+    {
+        m_registers[idx] = rank;
+    }
+}
+
+void
+hyperloglog :: merge(const hyperloglog& other)
+{
+    for (size_t i = 0; i < REGISTERS; ++i)
+    {
+        if (m_registers[i] < other.m_registers[i])
+        {
+            m_registers[i] = other.m_registers[i];
+        }
+    }
+}
+
+void
+hyperloglog :: clear()
+{
+    m_registers.assign(REGISTERS, 0);
+}
+
+uint64_t
+hyperloglog :: estimate() const
+{
+    const double m = REGISTERS;
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double sum = 0;
+    size_t zeros = 0;
+
+    for (size_t i = 0; i < REGISTERS; ++i)
+    {
+        sum += std::ldexp(1.0, -static_cast<int>(m_registers[i]));
+        zeros += m_registers[i] == 0 ? 1 : 0;
+    }
+
+    double est = alpha * m * m / sum;
+
+    // small-range correction:  fall back to linear counting
+    if (est <= 2.5 * m && zeros > 0)
+    {
+        est = m * std::log(m / zeros);
+    }
+
+    return static_cast<uint64_t>(est + 0.5);
+}
+
+bool
+hyperloglog :: set_registers(const uint8_t* registers, size_t registers_sz)
+{
+    if (registers_sz != REGISTERS)
+    {
+        return false;
+    }
+
+    m_registers.assign(registers, registers + registers_sz);
+    return true;
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_common_hyperloglog_h_
+#define hyperdex_common_hyperloglog_h_
+
+// C
+#include <stdint.h>
+
+// STL
+#include <vector>
+
+// HyperDex
+#include "namespace.h"
+
+// A HyperLogLog sketch for estimating the number of distinct values in a
+// multiset.  Values are added by their 64-bit hash; the caller is responsible
+// for picking a well-mixed hash function.  The sketch cannot forget values, so
+// estimates drift upward under deletion.
+
+BEGIN_HYPERDEX_NAMESPACE
+
+class hyperloglog
+{
+    public:
+        // 2^PRECISION registers; standard error is ~1.04/sqrt(2^PRECISION)
+        static const unsigned PRECISION = 10;
+        static const size_t REGISTERS = 1U << PRECISION;
+
+    public:
+        hyperloglog();
+        ~hyperloglog() throw ();
+
+    public:
+        void add(uint64_t hash);
+        void merge(const hyperloglog& other);
+        void clear();
+        uint64_t estimate() const;
+
+    public:
+        // raw access for serialization; "set_registers" returns false if the
+        // registers are of the wrong size
+        const std::vector<uint8_t>& registers() const { return m_registers; }
+        bool set_registers(const uint8_t* registers, size_t registers_sz);
+
+    private:
+        std::vector<uint8_t> m_registers;
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_common_hyperloglog_h_
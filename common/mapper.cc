@@ -31,7 +31,14 @@
 using hyperdex::mapper;
 
 mapper :: mapper(const hyperdex::configuration* config)
-    : m_config(config)
+    : m_fixed(config)
+    , m_config(&m_fixed)
+{
+}
+
+mapper :: mapper(const hyperdex::configuration* const* config)
+    : m_fixed(NULL)
+    , m_config(config)
 {
 }
 
@@ -42,6 +49,6 @@ mapper :: ~mapper() throw ()
 bool
 mapper :: lookup(uint64_t id, po6::net::location* addr)
 {
-    *addr = m_config->get_address(server_id(id));
+    *addr = (*m_config)->get_address(server_id(id));
     return *addr != po6::net::location();
 }
@@ -36,13 +36,19 @@ hyperdex :: operator << (std::ostream& lhs, const network_msgtype& rhs)
     {
         STRINGIFY(REQ_GET);
         STRINGIFY(RESP_GET);
+        STRINGIFY(REQ_GET_MANY);
+        STRINGIFY(RESP_GET_MANY);
         STRINGIFY(REQ_ATOMIC);
         STRINGIFY(RESP_ATOMIC);
+        STRINGIFY(REQ_BULK_ATOMIC);
         STRINGIFY(REQ_SEARCH_START);
         STRINGIFY(REQ_SEARCH_NEXT);
         STRINGIFY(REQ_SEARCH_STOP);
         STRINGIFY(RESP_SEARCH_ITEM);
         STRINGIFY(RESP_SEARCH_DONE);
+        STRINGIFY(REQ_SEARCH_STREAM);
+        STRINGIFY(REQ_SEARCH_CREDIT);
+        STRINGIFY(RESP_SEARCH_BATCH);
         STRINGIFY(REQ_SORTED_SEARCH);
         STRINGIFY(RESP_SORTED_SEARCH);
         STRINGIFY(REQ_GROUP_DEL);
@@ -51,12 +57,19 @@ hyperdex :: operator << (std::ostream& lhs, const network_msgtype& rhs)
         STRINGIFY(RESP_COUNT);
         STRINGIFY(REQ_SEARCH_DESCRIBE);
         STRINGIFY(RESP_SEARCH_DESCRIBE);
+        STRINGIFY(REQ_AGGREGATE);
+        STRINGIFY(RESP_AGGREGATE);
+        STRINGIFY(REQ_GROUP_ATOMIC);
+        STRINGIFY(RESP_GROUP_ATOMIC);
         STRINGIFY(CHAIN_OP);
         STRINGIFY(CHAIN_SUBSPACE);
         STRINGIFY(CHAIN_ACK);
         STRINGIFY(CHAIN_GC);
+        STRINGIFY(CHAIN_BATCH);
+        STRINGIFY(GROUP_KEYOP_ACK);
         STRINGIFY(XFER_OP);
         STRINGIFY(XFER_ACK);
+        STRINGIFY(XFER_BATCH);
         STRINGIFY(PERF_COUNTERS);
         STRINGIFY(CONFIGMISMATCH);
         STRINGIFY(PACKET_NOP);
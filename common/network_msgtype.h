@@ -40,15 +40,21 @@ enum network_msgtype
 {
     REQ_GET         = 8,
     RESP_GET        = 9,
+    REQ_GET_MANY    = 10,
+    RESP_GET_MANY   = 11,
 
     REQ_ATOMIC      = 16,
     RESP_ATOMIC     = 17,
+    REQ_BULK_ATOMIC = 18,
 
     REQ_SEARCH_START    = 32,
     REQ_SEARCH_NEXT     = 33,
     REQ_SEARCH_STOP     = 34,
     RESP_SEARCH_ITEM    = 35,
     RESP_SEARCH_DONE    = 36,
+    REQ_SEARCH_STREAM   = 37,
+    REQ_SEARCH_CREDIT   = 38,
+    RESP_SEARCH_BATCH   = 39,
 
     REQ_SORTED_SEARCH   = 40,
     RESP_SORTED_SEARCH  = 41,
@@ -62,13 +68,23 @@ enum network_msgtype
     REQ_SEARCH_DESCRIBE  = 52,
     RESP_SEARCH_DESCRIBE = 53,
 
+    REQ_AGGREGATE   = 54,
+    RESP_AGGREGATE  = 55,
+
+    REQ_GROUP_ATOMIC    = 56,
+    RESP_GROUP_ATOMIC   = 57,
+
     CHAIN_OP        = 64,
     CHAIN_SUBSPACE  = 65,
     CHAIN_ACK       = 66,
     CHAIN_GC        = 67,
+    CHAIN_BATCH     = 68,
+
+    GROUP_KEYOP_ACK = 72,
 
-    XFER_OP  = 80,
-    XFER_ACK = 81,
+    XFER_OP    = 80,
+    XFER_ACK   = 81,
+    XFER_BATCH = 82,
 
     PERF_COUNTERS = 127,
 
@@ -0,0 +1,70 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// C
+#include <cassert>
+
+// HyperDex
+#include "common/projection.h"
+
+bool
+hyperdex :: validate_projection(const schema& sc,
+                                const std::vector<uint16_t>& projection)
+{
+    for (size_t i = 0; i < projection.size(); ++i)
+    {
+        if (projection[i] == 0 || projection[i] >= sc.attrs_sz)
+        {
+            return false;
+        }
+
+        if (i > 0 && projection[i - 1] >= projection[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+hyperdex :: apply_projection(const std::vector<uint16_t>& projection,
+                             std::vector<e::slice>* value)
+{
+    size_t out = 0;
+
+    for (size_t i = 0; i < projection.size(); ++i)
+    {
+        size_t idx = projection[i] - 1;
+        assert(idx < value->size());
+        assert(out <= idx);
+        (*value)[out] = (*value)[idx];
+        ++out;
+    }
+
+    value->resize(out);
+}
@@ -182,6 +182,75 @@ hyperdex :: pack_size(const attribute_check& rhs)
          + pack_size(rhs.predicate);
 }
 
+e::buffer::packer
+hyperdex :: operator << (e::buffer::packer lhs, const aggregate& rhs)
+{
+    return lhs << rhs.attr << rhs.op;
+}
+
+e::unpacker
+hyperdex :: operator >> (e::unpacker lhs, aggregate& rhs)
+{
+    return lhs >> rhs.attr >> rhs.op;
+}
+
+size_t
+hyperdex :: pack_size(const aggregate& rhs)
+{
+    return sizeof(uint16_t) + pack_size(rhs.op);
+}
+
+static uint64_t
+double_bits(double d)
+{
+    uint64_t x;
+    memmove(&x, &d, sizeof(x));
+    return x;
+}
+
+static double
+bits_double(uint64_t x)
+{
+    double d;
+    memmove(&d, &x, sizeof(d));
+    return d;
+}
+
+e::buffer::packer
+hyperdex :: operator << (e::buffer::packer lhs, const aggregate_state& rhs)
+{
+    uint8_t flags = rhs.overflow ? 1 : 0;
+    return lhs << rhs.count << flags
+               << rhs.int_sum << rhs.int_min << rhs.int_max
+               << double_bits(rhs.float_sum)
+               << double_bits(rhs.float_min)
+               << double_bits(rhs.float_max);
+}
+
+e::unpacker
+hyperdex :: operator >> (e::unpacker lhs, aggregate_state& rhs)
+{
+    uint8_t flags = 0;
+    uint64_t float_sum = 0;
+    uint64_t float_min = 0;
+    uint64_t float_max = 0;
+    lhs = lhs >> rhs.count >> flags
+              >> rhs.int_sum >> rhs.int_min >> rhs.int_max
+              >> float_sum >> float_min >> float_max;
+    rhs.overflow = flags & 0x1;
+    rhs.float_sum = bits_double(float_sum);
+    rhs.float_min = bits_double(float_min);
+    rhs.float_max = bits_double(float_max);
+    return lhs;
+}
+
+size_t
+hyperdex :: pack_size(const aggregate_state&)
+{
+    return sizeof(uint64_t) + sizeof(uint8_t)
+         + 3 * sizeof(int64_t) + 3 * sizeof(uint64_t);
+}
+
 e::buffer::packer
 hyperdex :: operator << (e::buffer::packer lhs, const funcall_t& rhs)
 {
@@ -272,6 +341,28 @@ hyperdex :: pack_size(const hyperpredicate&)
     return sizeof(uint16_t);
 }
 
+e::buffer::packer
+hyperdex :: operator << (e::buffer::packer lhs, const hyperaggregate& rhs)
+{
+    uint16_t r = static_cast<uint16_t>(rhs);
+    return lhs << r;
+}
+
+e::unpacker
+hyperdex :: operator >> (e::unpacker lhs, hyperaggregate& rhs)
+{
+    uint16_t r;
+    lhs = lhs >> r;
+    rhs = static_cast<hyperaggregate>(r);
+    return lhs;
+}
+
+size_t
+hyperdex :: pack_size(const hyperaggregate&)
+{
+    return sizeof(uint16_t);
+}
+
 size_t
 hyperdex :: pack_size(const e::slice& s)
 {
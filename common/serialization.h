@@ -38,6 +38,7 @@
 // HyperDex
 #include "namespace.h"
 #include "hyperdex.h"
+#include "common/aggregate.h"
 #include "common/attribute_check.h"
 #include "common/funcall.h"
 
@@ -71,6 +72,20 @@ operator >> (e::unpacker lhs, attribute_check& rhs);
 size_t
 pack_size(const attribute_check& rhs);
 
+e::buffer::packer
+operator << (e::buffer::packer lhs, const aggregate& rhs);
+e::unpacker
+operator >> (e::unpacker lhs, aggregate& rhs);
+size_t
+pack_size(const aggregate& rhs);
+
+e::buffer::packer
+operator << (e::buffer::packer lhs, const aggregate_state& rhs);
+e::unpacker
+operator >> (e::unpacker lhs, aggregate_state& rhs);
+size_t
+pack_size(const aggregate_state& rhs);
+
 e::buffer::packer
 operator << (e::buffer::packer lhs, const funcall_t& rhs);
 e::unpacker
@@ -99,6 +114,15 @@ operator >> (e::unpacker lhs, hyperpredicate& rhs);
 size_t
 pack_size(const hyperpredicate& p);
 
+e::buffer::packer
+operator << (e::buffer::packer lhs, const hyperaggregate& rhs);
+e::unpacker
+operator >> (e::unpacker lhs, hyperaggregate& rhs);
+size_t
+pack_size(const hyperaggregate& a);
+
+inline size_t
+pack_size(uint16_t) { return sizeof(uint16_t); }
 inline size_t
 pack_size(uint64_t) { return sizeof(uint64_t); }
 
@@ -0,0 +1,139 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// C
+#include <stdint.h>
+
+// e
+#include <e/endian.h>
+
+// HyperDex
+#include "test/th.h"
+#include "common/aggregate.h"
+
+using hyperdex::aggregate;
+using hyperdex::aggregate_groups;
+using hyperdex::aggregate_state;
+using hyperdex::attribute;
+using hyperdex::schema;
+
+namespace
+{
+
+e::slice
+int64_value(int64_t x, char* buf)
+{
+    e::pack64le(x, buf);
+    return e::slice(buf, sizeof(int64_t));
+}
+
+} // namespace
+
+TEST(Aggregate, Int64)
+{
+    aggregate_state st;
+    char buf[sizeof(int64_t)];
+    st.add(HYPERDATATYPE_INT64, int64_value(5, buf));
+    st.add(HYPERDATATYPE_INT64, int64_value(-3, buf));
+    st.add(HYPERDATATYPE_INT64, e::slice());
+    ASSERT_EQ(3U, st.count);
+    ASSERT_FALSE(st.overflow);
+    ASSERT_EQ(2, st.int_sum);
+    ASSERT_EQ(-3, st.int_min);
+    ASSERT_EQ(5, st.int_max);
+}
+
+TEST(Aggregate, Int64Overflow)
+{
+    aggregate_state st;
+    char buf[sizeof(int64_t)];
+    st.add(HYPERDATATYPE_INT64, int64_value(INT64_MAX, buf));
+    ASSERT_FALSE(st.overflow);
+    st.add(HYPERDATATYPE_INT64, int64_value(1, buf));
+    ASSERT_TRUE(st.overflow);
+}
+
+TEST(Aggregate, Merge)
+{
+    aggregate_state a;
+    aggregate_state b;
+    aggregate_state empty;
+    char buf[sizeof(int64_t)];
+    a.add(HYPERDATATYPE_INT64, int64_value(10, buf));
+    b.add(HYPERDATATYPE_INT64, int64_value(-10, buf));
+    b.add(HYPERDATATYPE_INT64, int64_value(30, buf));
+    a.merge(HYPERDATATYPE_INT64, b);
+    a.merge(HYPERDATATYPE_INT64, empty);
+    ASSERT_EQ(3U, a.count);
+    ASSERT_EQ(30, a.int_sum);
+    ASSERT_EQ(-10, a.int_min);
+    ASSERT_EQ(30, a.int_max);
+    empty.merge(HYPERDATATYPE_INT64, a);
+    ASSERT_EQ(3U, empty.count);
+    ASSERT_EQ(-10, empty.int_min);
+}
+
+TEST(Aggregate, GroupBound)
+{
+    attribute attrs[2] = {attribute("k", HYPERDATATYPE_STRING),
+                          attribute("v", HYPERDATATYPE_INT64)};
+    schema sc;
+    sc.attrs_sz = 2;
+    sc.attrs = attrs;
+    std::vector<aggregate> aggs(1);
+    aggregate_groups groups;
+    char buf[sizeof(int64_t)];
+    std::vector<e::slice> value(1);
+
+    for (size_t i = 0; i < hyperdex::AGGREGATE_MAX_GROUPS; ++i)
+    {
+        value[0] = int64_value(i, buf);
+        ASSERT_TRUE(hyperdex::aggregate_object(sc, aggs, 1, value, &groups));
+    }
+
+    // an existing group still accepts objects; a new one does not
+    value[0] = int64_value(0, buf);
+    ASSERT_TRUE(hyperdex::aggregate_object(sc, aggs, 1, value, &groups));
+    value[0] = int64_value(hyperdex::AGGREGATE_MAX_GROUPS, buf);
+    ASSERT_FALSE(hyperdex::aggregate_object(sc, aggs, 1, value, &groups));
+    ASSERT_EQ(hyperdex::AGGREGATE_MAX_GROUPS, groups.size());
+}
+
+TEST(Aggregate, ValidateGroupBy)
+{
+    attribute attrs[3] = {attribute("k", HYPERDATATYPE_STRING),
+                          attribute("v", HYPERDATATYPE_INT64),
+                          attribute("l", HYPERDATATYPE_LIST_STRING)};
+    schema sc;
+    sc.attrs_sz = 3;
+    sc.attrs = attrs;
+
+    ASSERT_TRUE(hyperdex::validate_group_by(sc, 0));
+    ASSERT_TRUE(hyperdex::validate_group_by(sc, 1));
+    ASSERT_FALSE(hyperdex::validate_group_by(sc, 2));
+    ASSERT_FALSE(hyperdex::validate_group_by(sc, 3));
+}
@@ -0,0 +1,246 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#define __STDC_LIMIT_MACROS
+
+// C
+#include <stdio.h>
+#include <string.h>
+
+// HyperDex
+#include "test/th.h"
+#include "common/hash.h"
+#include "common/test/configuration_generator.h"
+
+using hyperdex::capture;
+using hyperdex::capture_id;
+using hyperdex::configuration;
+using hyperdex::region;
+using hyperdex::region_id;
+using hyperdex::replica;
+using hyperdex::server_id;
+using hyperdex::space;
+using hyperdex::space_id;
+using hyperdex::virtual_server_id;
+
+namespace
+{
+
+// the point leader, found the way configuration used to:  by scanning
+virtual_server_id
+scan_point_leader(const space& s, const e::slice& key)
+{
+    uint64_t h;
+    hyperdex::hash(s.sc, key, &h);
+
+    for (size_t i = 0; i < s.subspaces[0].regions.size(); ++i)
+    {
+        const region& r(s.subspaces[0].regions[i]);
+
+        if (r.lower_coord[0] <= h && h <= r.upper_coord[0])
+        {
+            return r.replicas[0].vsi;
+        }
+    }
+
+    return virtual_server_id();
+}
+
+// a "get-config-delta" answer holding one delta that sets the chain of "rid",
+// empties the server, capture and transfer lists, and quiesces "quiesced"
+e::buffer*
+delta_update(uint64_t from, const region_id& rid, const std::vector<replica>& chain,
+             const std::vector<space_id>& quiesced = std::vector<space_id>())
+{
+    size_t sz = sizeof(uint8_t) + 10 * sizeof(uint64_t) + sizeof(uint8_t)
+              + quiesced.size() * sizeof(uint64_t);
+
+    for (size_t i = 0; i < chain.size(); ++i)
+    {
+        sz += pack_size(chain[i]);
+    }
+
+    e::buffer* buf = e::buffer::create(sz);
+    e::buffer::packer pa = buf->pack_at(0);
+    pa = pa << uint8_t(hyperdex::CONFIG_DELTA) << uint64_t(1) << from << uint64_t(1)
+            << from + 1 << uint64_t(0) << uint64_t(0) << uint64_t(0) << uint64_t(1)
+            << rid.get() << uint8_t(chain.size());
+
+    for (size_t i = 0; i < chain.size(); ++i)
+    {
+        pa = pa << chain[i];
+    }
+
+    pa = pa << uint64_t(quiesced.size());
+
+    for (size_t i = 0; i < quiesced.size(); ++i)
+    {
+        pa = pa << quiesced[i].get();
+    }
+
+    return buf;
+}
+
+} // namespace
+
+TEST(Configuration, PointLeader)
+{
+    std::vector<space> ss;
+    std::vector<capture> caps;
+    configuration config;
+    ASSERT_TRUE(generate_configuration(8, 64, 3, &ss, &caps, &config));
+    ASSERT_EQ(virtual_server_id(), config.point_leader("nonexistent", e::slice("k", 1)));
+    ASSERT_TRUE(config.get_schema("nonexistent") == NULL);
+
+    for (size_t s = 0; s < ss.size(); ++s)
+    {
+        ASSERT_TRUE(config.get_schema(ss[s].name) != NULL);
+        ASSERT_EQ(2U, config.get_schema(ss[s].name)->attrs_sz);
+        // a region in the secondary subspace names the same space
+        region_id other = ss[s].subspaces[1].regions[s].id;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            char key[32];
+            sprintf(key, "key%lu", static_cast<unsigned long>(i));
+            e::slice k(key, strlen(key));
+            virtual_server_id vsi = scan_point_leader(ss[s], k);
+            ASSERT_EQ(vsi, config.point_leader(ss[s].name, k));
+            ASSERT_EQ(vsi, config.point_leader(other, k));
+        }
+    }
+}
+
+TEST(Configuration, GetVirtual)
+{
+    std::vector<space> ss;
+    std::vector<capture> caps;
+    configuration config;
+    ASSERT_TRUE(generate_configuration(4, 16, 2, &ss, &caps, &config));
+    // the copy must rebuild its indices rather than point into "config"
+    configuration copy(config);
+    config = configuration();
+
+    for (size_t s = 0; s < ss.size(); ++s)
+    {
+        for (size_t x = 0; x < ss[s].subspaces.size(); ++x)
+        {
+            for (size_t y = 0; y < ss[s].subspaces[x].regions.size(); ++y)
+            {
+                const region& r(ss[s].subspaces[x].regions[y]);
+
+                for (size_t z = 0; z < r.replicas.size(); ++z)
+                {
+                    ASSERT_EQ(r.replicas[z].vsi, copy.get_virtual(r.id, r.replicas[z].si));
+                }
+
+                ASSERT_EQ(virtual_server_id(), copy.get_virtual(r.id, server_id(UINT64_MAX)));
+            }
+        }
+    }
+
+    ASSERT_EQ(virtual_server_id(), copy.get_virtual(region_id(UINT64_MAX), server_id(1)));
+}
+
+TEST(Configuration, CaptureFor)
+{
+    std::vector<space> ss;
+    std::vector<capture> caps;
+    configuration config;
+    ASSERT_TRUE(generate_configuration(4, 16, 2, &ss, &caps, &config));
+    ASSERT_LT(0U, caps.size());
+
+    for (size_t i = 0; i < caps.size(); ++i)
+    {
+        ASSERT_EQ(caps[i].id, config.capture_for(caps[i].rid));
+    }
+
+    ASSERT_EQ(capture_id(), config.capture_for(ss[0].subspaces[0].regions[1].id));
+    ASSERT_EQ(capture_id(), config.capture_for(ss[0].subspaces[1].regions[0].id));
+}
+
+TEST(Configuration, ApplyDelta)
+{
+    std::vector<space> ss;
+    std::vector<capture> caps;
+    configuration config;
+    ASSERT_TRUE(generate_configuration(2, 16, 2, &ss, &caps, &config));
+    const region& r(ss[0].subspaces[0].regions[0]);
+    std::vector<replica> chain(r.replicas);
+    chain.push_back(replica(server_id(100), virtual_server_id(UINT64_MAX - 1)));
+    std::auto_ptr<e::buffer> buf(delta_update(1, r.id, chain));
+    configuration next;
+    ASSERT_FALSE(unpack_config_update(buf->unpack_from(0), config, &next).error());
+    ASSERT_EQ(2U, next.version());
+    ASSERT_EQ(virtual_server_id(UINT64_MAX - 1), next.get_virtual(r.id, server_id(100)));
+    ASSERT_EQ(virtual_server_id(UINT64_MAX - 1), next.tail_of_region(r.id));
+    ASSERT_EQ(capture_id(), next.capture_for(caps[0].rid));
+    // untouched regions keep their chains
+    const region& o(ss[1].subspaces[1].regions[3]);
+    ASSERT_EQ(o.replicas[0].vsi, next.get_virtual(o.id, o.replicas[0].si));
+
+    // a delta from any other version is refused
+    configuration again;
+    ASSERT_TRUE(unpack_config_update(buf->unpack_from(0), next, &again).error());
+    buf.reset(delta_update(2, r.id, chain));
+    ASSERT_TRUE(unpack_config_update(buf->unpack_from(0), config, &again).error());
+
+    // as is a delta naming a region the configuration does not have
+    buf.reset(delta_update(1, region_id(UINT64_MAX), chain));
+    ASSERT_TRUE(unpack_config_update(buf->unpack_from(0), config, &again).error());
+    ASSERT_EQ(1U, config.version());
+    ASSERT_EQ(virtual_server_id(), config.get_virtual(r.id, server_id(100)));
+}
+
+TEST(Configuration, Quiesce)
+{
+    std::vector<space> ss;
+    std::vector<capture> caps;
+    configuration config;
+    ASSERT_TRUE(generate_configuration(2, 16, 2, &ss, &caps, &config));
+    const region& r(ss[0].subspaces[0].regions[0]);
+    std::vector<space_id> quiesced;
+    quiesced.push_back(ss[0].id);
+    std::auto_ptr<e::buffer> buf(delta_update(1, r.id, r.replicas, quiesced));
+    configuration next;
+    ASSERT_FALSE(unpack_config_update(buf->unpack_from(0), config, &next).error());
+    ASSERT_FALSE(config.is_quiesced(r.id));
+    // the whole space is quiesced, not just the region the delta touched
+    ASSERT_TRUE(next.is_quiesced(ss[0].subspaces[1].regions[3].id));
+    ASSERT_FALSE(next.is_quiesced(ss[1].subspaces[0].regions[0].id));
+
+    std::vector<region_id> regions;
+    next.quiesced_regions(&regions);
+    ASSERT_EQ(ss[0].subspaces[0].regions.size() + ss[0].subspaces[1].regions.size(),
+              regions.size());
+
+    // the next delta lists no quiesced spaces, which releases the first
+    buf.reset(delta_update(2, r.id, r.replicas));
+    configuration after;
+    ASSERT_FALSE(unpack_config_update(buf->unpack_from(0), next, &after).error());
+    ASSERT_FALSE(after.is_quiesced(r.id));
+}
@@ -0,0 +1,175 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#define __STDC_LIMIT_MACROS
+
+// C
+#include <stdio.h>
+#include <stdlib.h>
+
+// STL
+#include <vector>
+
+// e
+#include <e/time.h>
+
+// HyperDex
+#include "common/test/configuration_generator.h"
+
+// Time the configuration lookups that sit on the per-request path of the
+// daemon against configurations of increasing size.
+
+using hyperdex::capture;
+using hyperdex::configuration;
+using hyperdex::region_id;
+using hyperdex::server_id;
+using hyperdex::space;
+using hyperdex::virtual_server_id;
+
+#define ITERATIONS 1000000
+
+namespace
+{
+
+void
+report(const char* what, size_t spaces, size_t partitions, uint64_t start, uint64_t end)
+{
+    printf("%-36s spaces=%-4lu partitions=%-5lu %8.1f ns/op\n",
+           what, static_cast<unsigned long>(spaces),
+           static_cast<unsigned long>(partitions),
+           static_cast<double>(end - start) / ITERATIONS);
+}
+
+void
+run(size_t spaces, size_t partitions)
+{
+    std::vector<space> ss;
+    std::vector<capture> caps;
+    configuration config;
+
+    if (!generate_configuration(spaces, partitions, 3, &ss, &caps, &config))
+    {
+        fprintf(stderr, "could not generate a configuration\n");
+        abort();
+    }
+
+    std::vector<std::string> keys;
+    std::vector<region_id> regions;
+    std::vector<server_id> servers;
+
+    for (size_t i = 0; i < 1024; ++i)
+    {
+        char key[32];
+        sprintf(key, "key%lu", static_cast<unsigned long>(i));
+        keys.push_back(key);
+        const space& s(ss[(i * 7919) % ss.size()]);
+        const hyperdex::region& r(s.subspaces[i % 2].regions[(i * 31) % partitions]);
+        regions.push_back(r.id);
+        servers.push_back(r.replicas[i % r.replicas.size()].si);
+    }
+
+    // keep the compiler from discarding the lookups
+    uint64_t sink = 0;
+    uint64_t start;
+
+    start = e::time();
+
+    for (size_t i = 0; i < ITERATIONS; ++i)
+    {
+        const std::string& k(keys[i % keys.size()]);
+        sink += config.point_leader(ss[i % ss.size()].name, e::slice(k)).get();
+    }
+
+    report("point_leader(space, key)", spaces, partitions, start, e::time());
+    start = e::time();
+
+    for (size_t i = 0; i < ITERATIONS; ++i)
+    {
+        const std::string& k(keys[i % keys.size()]);
+        sink += config.point_leader(regions[i % regions.size()], e::slice(k)).get();
+    }
+
+    report("point_leader(region, key)", spaces, partitions, start, e::time());
+    start = e::time();
+
+    for (size_t i = 0; i < ITERATIONS; ++i)
+    {
+        size_t idx = i % regions.size();
+        sink += config.get_virtual(regions[idx], servers[idx]).get();
+    }
+
+    report("get_virtual", spaces, partitions, start, e::time());
+    start = e::time();
+
+    for (size_t i = 0; i < ITERATIONS; ++i)
+    {
+        sink += config.capture_for(regions[i % regions.size()]).get();
+    }
+
+    report("capture_for", spaces, partitions, start, e::time());
+    start = e::time();
+
+    for (size_t i = 0; i < ITERATIONS; ++i)
+    {
+        size_t idx = i % regions.size();
+        sink += config.is_server_blocked_by_live_transfer(servers[idx], regions[idx]) ? 1 : 0;
+    }
+
+    report("is_server_blocked_by_live_transfer", spaces, partitions, start, e::time());
+    start = e::time();
+
+    for (size_t i = 0; i < ITERATIONS; ++i)
+    {
+        sink += config.get_schema(ss[i % ss.size()].name)->attrs_sz;
+    }
+
+    report("get_schema(space)", spaces, partitions, start, e::time());
+
+    if (sink == 0)
+    {
+        printf("\n");
+    }
+}
+
+} // namespace
+
+int
+main(int, const char*[])
+{
+    const size_t spaces[] = {1, 16, 256};
+    const size_t partitions[] = {64, 256, 1024};
+
+    for (size_t s = 0; s < sizeof(spaces) / sizeof(size_t); ++s)
+    {
+        for (size_t p = 0; p < sizeof(partitions) / sizeof(size_t); ++p)
+        {
+            run(spaces[s], partitions[p]);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
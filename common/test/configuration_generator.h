@@ -0,0 +1,141 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_common_test_configuration_generator_h_
+#define hyperdex_common_test_configuration_generator_h_
+
+// C
+#include <stdint.h>
+#include <stdio.h>
+
+// STL
+#include <memory>
+#include <vector>
+
+// e
+#include <e/buffer.h>
+
+// HyperDex
+#include "common/capture.h"
+#include "common/configuration.h"
+#include "common/hyperspace.h"
+
+// Build a configuration the way the coordinator would ship it:  "spaces" key
+// value spaces named "space0", "space1", ..., each with a key subspace and one
+// secondary subspace of "partitions" regions, every region replicated on
+// "replicas" servers.  Every fourth key region is captured.  The spaces and
+// captures packed into the configuration are left in "ss" and "caps".
+inline bool
+generate_configuration(size_t spaces, size_t partitions, size_t replicas,
+                       std::vector<hyperdex::space>* _ss,
+                       std::vector<hyperdex::capture>* _caps,
+                       hyperdex::configuration* config)
+{
+    using namespace hyperdex;
+    const size_t servers = 16;
+    attribute attrs[2] = {attribute("k", HYPERDATATYPE_STRING),
+                          attribute("v", HYPERDATATYPE_STRING)};
+    schema sc;
+    sc.attrs_sz = 2;
+    sc.attrs = attrs;
+    uint64_t next_id = 1;
+    std::vector<space>& ss(*_ss);
+    std::vector<capture>& caps(*_caps);
+    ss.clear();
+    caps.clear();
+
+    for (size_t s = 0; s < spaces; ++s)
+    {
+        char name[32];
+        sprintf(name, "space%lu", static_cast<unsigned long>(s));
+        ss.push_back(space(name, sc));
+        ss.back().id = space_id(next_id++);
+        ss.back().fault_tolerance = replicas - 1;
+        ss.back().subspaces.resize(2);
+
+        for (size_t x = 0; x < 2; ++x)
+        {
+            subspace& sub(ss.back().subspaces[x]);
+            sub.id = subspace_id(next_id++);
+            sub.attrs.push_back(x);
+            sub.regions.resize(partitions);
+            uint64_t step = UINT64_MAX / partitions;
+
+            for (size_t p = 0; p < partitions; ++p)
+            {
+                region& r(sub.regions[p]);
+                r.id = region_id(next_id++);
+                r.lower_coord.push_back(p * step);
+                r.upper_coord.push_back(p + 1 < partitions ? (p + 1) * step - 1 : UINT64_MAX);
+
+                for (size_t i = 0; i < replicas; ++i)
+                {
+                    server_id si(1 + (p + i) % servers);
+                    r.replicas.push_back(replica(si, virtual_server_id(next_id++)));
+                }
+
+                if (x == 0 && p % 4 == 0)
+                {
+                    caps.push_back(capture(capture_id(next_id++), r.id));
+                }
+            }
+        }
+    }
+
+    size_t sz = 6 * sizeof(uint64_t);
+
+    for (size_t i = 0; i < ss.size(); ++i)
+    {
+        sz += pack_size(ss[i]);
+    }
+
+    for (size_t i = 0; i < caps.size(); ++i)
+    {
+        sz += pack_size(caps[i]);
+    }
+
+    std::auto_ptr<e::buffer> buf(e::buffer::create(sz));
+    e::buffer::packer pa = buf->pack_at(0);
+    pa = pa << uint64_t(1) << uint64_t(1) << uint64_t(0)
+            << uint64_t(ss.size()) << uint64_t(caps.size()) << uint64_t(0);
+
+    for (size_t i = 0; i < ss.size(); ++i)
+    {
+        pa = pa << ss[i];
+    }
+
+    for (size_t i = 0; i < caps.size(); ++i)
+    {
+        pa = pa << caps[i];
+    }
+
+    e::unpacker up = buf->unpack_from(0);
+    up = up >> *config;
+    return !pa.error() && !up.error();
+}
+
+#endif // hyperdex_common_test_configuration_generator_h_
@@ -0,0 +1,117 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// HyperDex
+#include "test/th.h"
+#include "common/hyperloglog.h"
+
+using hyperdex::hyperloglog;
+
+namespace
+{
+
+// splitmix64; good enough to stand in for the daemon's CityHash
+uint64_t
+mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+} // namespace
+
+TEST(HyperLogLog, Empty)
+{
+    hyperloglog hll;
+    ASSERT_EQ(0U, hll.estimate());
+}
+
+TEST(HyperLogLog, Duplicates)
+{
+    hyperloglog hll;
+
+    for (size_t i = 0; i < 100000; ++i)
+    {
+        hll.add(mix(i % 10));
+    }
+
+    ASSERT_EQ(10U, hll.estimate());
+}
+
+TEST(HyperLogLog, Accuracy)
+{
+    const uint64_t sizes[] = {100, 1000, 10000, 100000, 1000000};
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(uint64_t); ++s)
+    {
+        hyperloglog hll;
+
+        for (uint64_t i = 0; i < sizes[s]; ++i)
+        {
+            hll.add(mix(i));
+        }
+
+        // 1.04/sqrt(1024) is ~3.25%; allow four standard errors
+        uint64_t est = hll.estimate();
+        ASSERT_LE(est, sizes[s] + sizes[s] * 13 / 100);
+        ASSERT_GE(est, sizes[s] - sizes[s] * 13 / 100);
+    }
+}
+
+TEST(HyperLogLog, Merge)
+{
+    hyperloglog a;
+    hyperloglog b;
+
+    for (uint64_t i = 0; i < 50000; ++i)
+    {
+        a.add(mix(i));
+        b.add(mix(i + 25000));
+    }
+
+    a.merge(b);
+    uint64_t est = a.estimate();
+    ASSERT_LE(est, 75000U + 75000U * 13 / 100);
+    ASSERT_GE(est, 75000U - 75000U * 13 / 100);
+}
+
+TEST(HyperLogLog, Registers)
+{
+    hyperloglog a;
+    hyperloglog b;
+
+    for (uint64_t i = 0; i < 1000; ++i)
+    {
+        a.add(mix(i));
+    }
+
+    ASSERT_FALSE(b.set_registers(&a.registers().front(), 1));
+    ASSERT_TRUE(b.set_registers(&a.registers().front(), a.registers().size()));
+    ASSERT_EQ(a.estimate(), b.estimate());
+}
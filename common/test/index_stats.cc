@@ -0,0 +1,205 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// C
+#include <stdint.h>
+
+// STL
+#include <sstream>
+#include <string>
+
+// e
+#include <e/slice.h>
+
+// HyperDex
+#include "test/th.h"
+#include "daemon/index_stats.h"
+
+using hyperdex::index_stats;
+using hyperdex::index_stats_delta;
+using hyperdex::region_id;
+
+namespace
+{
+
+// big-endian, so that memcmp order is numeric order as in the index encoding
+e::slice
+encoded(uint64_t x, char* buf)
+{
+    for (size_t i = 0; i < sizeof(uint64_t); ++i)
+    {
+        buf[i] = static_cast<char>(x >> (8 * (sizeof(uint64_t) - 1 - i)));
+    }
+
+    return e::slice(buf, sizeof(uint64_t));
+}
+
+void
+fill(index_stats* stats, const region_id& ri, uint16_t attr, uint64_t n)
+{
+    char buf[sizeof(uint64_t)];
+
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        stats->add(ri, attr, encoded(i, buf), 32);
+    }
+}
+
+} // namespace
+
+TEST(IndexStats, Empty)
+{
+    index_stats stats;
+    double fraction = 0;
+    uint64_t bytes = 0;
+    ASSERT_FALSE(stats.estimate(region_id(1), 1, NULL, NULL, &fraction, &bytes));
+    std::ostringstream ostr;
+    stats.describe(region_id(1), 1, ostr);
+    ASSERT_EQ("no statistics", ostr.str());
+}
+
+TEST(IndexStats, Range)
+{
+    index_stats stats;
+    fill(&stats, region_id(1), 1, 1000);
+    char sbuf[sizeof(uint64_t)];
+    char ebuf[sizeof(uint64_t)];
+    e::slice start(encoded(0, sbuf));
+    e::slice end(encoded(499, ebuf));
+    double fraction = 0;
+    uint64_t bytes = 0;
+
+    ASSERT_TRUE(stats.estimate(region_id(1), 1, NULL, NULL, &fraction, &bytes));
+    ASSERT_GE(fraction, 0.95);
+    ASSERT_LE(bytes, 32000U);
+
+    ASSERT_TRUE(stats.estimate(region_id(1), 1, &start, &end, &fraction, &bytes));
+    ASSERT_GE(fraction, 0.4);
+    ASSERT_LE(fraction, 0.65);
+
+    // another attribute of the same region is tracked separately
+    ASSERT_FALSE(stats.estimate(region_id(1), 2, NULL, NULL, &fraction, &bytes));
+}
+
+TEST(IndexStats, Equality)
+{
+    index_stats stats;
+    char buf[sizeof(uint64_t)];
+    fill(&stats, region_id(1), 1, 1000);
+
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        stats.add(region_id(1), 1, encoded(7, buf), 32);
+    }
+
+    e::slice rare(encoded(5, buf));
+    double rare_fraction = 0;
+    uint64_t bytes = 0;
+    ASSERT_TRUE(stats.estimate(region_id(1), 1, &rare, &rare, &rare_fraction, &bytes));
+    ASSERT_LE(rare_fraction, 0.05);
+
+    e::slice common(encoded(7, buf));
+    double common_fraction = 0;
+    ASSERT_TRUE(stats.estimate(region_id(1), 1, &common, &common, &common_fraction, &bytes));
+    ASSERT_GE(common_fraction, 0.3);
+    ASSERT_LE(common_fraction, 0.7);
+}
+
+TEST(IndexStats, Delta)
+{
+    index_stats stats;
+    index_stats_delta delta;
+    char buf[sizeof(uint64_t)];
+    double fraction = 0;
+    uint64_t bytes = 0;
+
+    for (uint64_t i = 0; i < 100; ++i)
+    {
+        delta.add(region_id(1), 1, encoded(i, buf), 32);
+    }
+
+    // nothing is visible until the delta is applied
+    ASSERT_FALSE(stats.estimate(region_id(1), 1, NULL, NULL, &fraction, &bytes));
+    stats.apply(delta);
+    ASSERT_TRUE(stats.estimate(region_id(1), 1, NULL, NULL, &fraction, &bytes));
+    ASSERT_EQ(3200U, bytes);
+
+    index_stats_delta removal;
+
+    for (uint64_t i = 0; i < 50; ++i)
+    {
+        removal.remove(region_id(1), 1, encoded(i, buf), 32);
+    }
+
+    stats.apply(removal);
+    ASSERT_TRUE(stats.estimate(region_id(1), 1, NULL, NULL, &fraction, &bytes));
+    ASSERT_EQ(1600U, bytes);
+}
+
+TEST(IndexStats, ClearAndAdopt)
+{
+    index_stats stats;
+    double fraction = 0;
+    uint64_t bytes = 0;
+    fill(&stats, region_id(1), 1, 100);
+    fill(&stats, region_id(2), 1, 100);
+    fill(&stats, region_id(3), 1, 100);
+
+    stats.clear(region_id(1));
+    ASSERT_FALSE(stats.estimate(region_id(1), 1, NULL, NULL, &fraction, &bytes));
+    ASSERT_TRUE(stats.estimate(region_id(2), 1, NULL, NULL, &fraction, &bytes));
+
+    std::vector<region_id> keep;
+    keep.push_back(region_id(3));
+    stats.adopt(keep);
+    ASSERT_FALSE(stats.estimate(region_id(2), 1, NULL, NULL, &fraction, &bytes));
+    ASSERT_TRUE(stats.estimate(region_id(3), 1, NULL, NULL, &fraction, &bytes));
+}
+
+TEST(IndexStats, Serialize)
+{
+    index_stats a;
+    index_stats b;
+    fill(&a, region_id(1), 1, 1000);
+    fill(&a, region_id(2), 3, 200);
+    std::string ser;
+    a.serialize(&ser);
+    ASSERT_TRUE(b.deserialize(e::slice(ser)));
+
+    std::ostringstream lhs;
+    std::ostringstream rhs;
+    a.describe(region_id(1), 1, lhs);
+    b.describe(region_id(1), 1, rhs);
+    ASSERT_EQ(lhs.str(), rhs.str());
+    lhs.str("");
+    rhs.str("");
+    a.describe(region_id(2), 3, lhs);
+    b.describe(region_id(2), 3, rhs);
+    ASSERT_EQ(lhs.str(), rhs.str());
+
+    ASSERT_FALSE(b.deserialize(e::slice(ser.data(), ser.size() / 2)));
+}
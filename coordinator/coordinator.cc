@@ -38,6 +38,7 @@
 #include <po6/net/location.h>
 
 // HyperDex
+#include "common/configuration.h"
 #include "common/coordinator_returncode.h"
 #include "common/serialization.h"
 #include "coordinator/coordinator.h"
@@ -114,6 +115,30 @@ generate_response(replicant_state_machine_context* ctx, coordinator_returncode x
 #define INVARIANT_BROKEN(X) \
     fprintf(log, "invariant broken at " __FILE__ ":%d:  %s\n", __LINE__, (X))
 
+// A region that grows beyond either split threshold is cut in two.  Two
+// adjacent regions are merged only when together they fall below the merge
+// thresholds, which sit well below the split thresholds so that a merged
+// region is not immediately split again.
+#define REGION_SPLIT_BYTES (4ULL * 1024ULL * 1024ULL * 1024ULL)
+#define REGION_SPLIT_OPS 20000ULL
+#define REGION_MERGE_BYTES (REGION_SPLIT_BYTES / 8)
+#define REGION_MERGE_OPS (REGION_SPLIT_OPS / 8)
+#define REGION_MAX_PER_SUBSPACE 4096
+// A quiesced space whose writes have not drained after this many reports from
+// servers that already run the quiescing config is released again, and not
+// quiesced again until this many more reports have come in
+#define QUIESCE_MAX_UNDRAINED 8
+#define QUIESCE_BACKOFF_REPORTS 64
+
+// Load is scored in thousandths of the cluster-wide mean for each of bytes
+// stored, regions held, and ops/s.  A region moves from the most to the least
+// loaded server when their scores differ by at least this much.
+#define REBALANCE_MIN_GAP 500
+
+// How many versions of configuration deltas to keep around.  Anyone further
+// behind than this fetches the full configuration.
+#define CONFIG_DELTA_HISTORY 256
+
 extern "C"
 {
 
@@ -238,6 +263,20 @@ hyperdex_coordinator_get_config(struct replicant_state_machine_context* ctx,
     c->get_config(ctx);
 }
 
+void
+hyperdex_coordinator_get_config_delta(struct replicant_state_machine_context* ctx,
+                                      void* obj, const char* data, size_t data_sz)
+{
+    PROTECT_UNINITIALIZED;
+    FILE* log = replicant_state_machine_log_stream(ctx);
+    coordinator* c = static_cast<coordinator*>(obj);
+    uint64_t version;
+    e::unpacker up(data, data_sz);
+    up = up >> version;
+    CHECK_UNPACK(get_config_delta);
+    c->get_config_delta(ctx, version);
+}
+
 void
 hyperdex_coordinator_ack_config(struct replicant_state_machine_context* ctx,
                                 void* obj, const char* data, size_t data_sz)
@@ -302,6 +341,41 @@ hyperdex_coordinator_server_suspect(struct replicant_state_machine_context* ctx,
     c->server_suspect(ctx, sid, version);
 }
 
+void
+hyperdex_coordinator_server_report(struct replicant_state_machine_context* ctx,
+                                   void* obj, const char* data, size_t data_sz)
+{
+    PROTECT_UNINITIALIZED;
+    FILE* log = replicant_state_machine_log_stream(ctx);
+    coordinator* c = static_cast<coordinator*>(obj);
+    uint64_t _sid;
+    uint64_t num_regions;
+    e::unpacker up(data, data_sz);
+    up = up >> _sid >> num_regions;
+    server_id sid(_sid);
+    std::vector<region_load> loads;
+
+    for (uint64_t i = 0; !up.error() && i < num_regions; ++i)
+    {
+        uint64_t _rid;
+        uint64_t bytes;
+        uint64_t ops;
+        up = up >> _rid >> bytes >> ops;
+        loads.push_back(region_load(region_id(_rid), sid, bytes, ops));
+    }
+
+    uint64_t drained = 0;
+
+    // older daemons don't say, so they never count as drained
+    if (!up.error() && up.remain() > 0)
+    {
+        up = up >> drained;
+    }
+
+    CHECK_UNPACK(server_report);
+    c->server_report(ctx, sid, loads, drained);
+}
+
 void
 hyperdex_coordinator_server_shutdown1(struct replicant_state_machine_context* ctx,
                                       void* obj, const char* data, size_t data_sz)
@@ -396,7 +470,14 @@ coordinator :: coordinator()
     , m_capture_server_references()
     , m_capture_transfer_references()
     , m_region_server_references()
+    , m_region_loads()
+    , m_initial_regions()
+    , m_offloads()
+    , m_quiesced()
+    , m_quiesce_backoff()
     , m_latest_config()
+    , m_published_regions()
+    , m_config_deltas()
     , m_resp()
     , m_seed()
 {
@@ -469,6 +550,8 @@ coordinator :: add_space(replicant_state_machine_context* ctx, const space& _s)
             ++m_counter;
             s->subspaces[i].regions[j].replicas.clear();
         }
+
+        m_initial_regions[s->subspaces[i].id] = s->subspaces[i].regions.size();
     }
 
     m_spaces.insert(std::make_pair(std::string(s->name), s));
@@ -493,6 +576,14 @@ coordinator :: rm_space(replicant_state_machine_context* ctx, const char* name)
     else
     {
         fprintf(log, "successfully removed space \"%s\"/space_id(%lu)\n", name, it->second->id.get());
+
+        for (size_t i = 0; i < it->second->subspaces.size(); ++i)
+        {
+            m_initial_regions.erase(it->second->subspaces[i].id);
+        }
+
+        m_quiesced.erase(it->second->id);
+        m_quiesce_backoff.erase(it->second->id);
         m_spaces.erase(it);
         issue_new_config(ctx);
         return generate_response(ctx, COORD_SUCCESS);
@@ -514,6 +605,67 @@ coordinator :: get_config(replicant_state_machine_context* ctx)
     replicant_state_machine_set_response(ctx, output, output_sz);
 }
 
+void
+coordinator :: get_config_delta(replicant_state_machine_context* ctx,
+                                uint64_t version)
+{
+    assert(m_cluster != 0 && m_version != 0);
+    // m_config_deltas covers the versions after "first" up to m_version
+    uint64_t first = m_version - m_config_deltas.size();
+    bool usable = version > 0 && version >= first && version <= m_version;
+    size_t sz = sizeof(uint8_t) + 3 * sizeof(uint64_t);
+    uint64_t num_deltas = 0;
+    std::list<std::tr1::shared_ptr<e::buffer> >::iterator it;
+    uint64_t v = first + 1;
+
+    for (it = m_config_deltas.begin(); usable && it != m_config_deltas.end(); ++it, ++v)
+    {
+        if (v <= version)
+        {
+            continue;
+        }
+
+        if (!it->get())
+        {
+            usable = false;
+            break;
+        }
+
+        sz += (*it)->size();
+        ++num_deltas;
+    }
+
+    if (!usable)
+    {
+        if (!m_latest_config.get())
+        {
+            regenerate_cached(ctx);
+        }
+
+        m_resp.reset(e::buffer::create(sizeof(uint8_t) + m_latest_config->size()));
+        e::buffer::packer pa = m_resp->pack_at(0);
+        pa = pa << uint8_t(CONFIG_FULL);
+        pa = pa.copy(m_latest_config->as_slice());
+    }
+    else
+    {
+        m_resp.reset(e::buffer::create(sz));
+        e::buffer::packer pa = m_resp->pack_at(0);
+        pa = pa << uint8_t(CONFIG_DELTA) << m_cluster << version << num_deltas;
+        v = first + 1;
+
+        for (it = m_config_deltas.begin(); it != m_config_deltas.end(); ++it, ++v)
+        {
+            if (v > version)
+            {
+                pa = pa.copy((*it)->as_slice());
+            }
+        }
+    }
+
+    replicant_state_machine_set_response(ctx, reinterpret_cast<const char*>(m_resp->data()), m_resp->size());
+}
+
 void
 coordinator :: ack_config(replicant_state_machine_context* ctx,
                           const server_id& sid,
@@ -726,6 +878,69 @@ coordinator :: server_shutdown2(replicant_state_machine_context* ctx,
     return generate_response(ctx, COORD_SUCCESS);
 }
 
+void
+coordinator :: server_report(replicant_state_machine_context* ctx,
+                             const server_id& sid,
+                             const std::vector<region_load>& loads,
+                             uint64_t drained)
+{
+    FILE* log = replicant_state_machine_log_stream(ctx);
+
+    if (!is_registered(sid))
+    {
+        fprintf(log, "ignoring load report from server_id(%lu) because "
+                     "the server does not exist\n", sid.get());
+        return generate_response(ctx, COORD_NOT_FOUND);
+    }
+
+    server_state* state = get_state(sid);
+    assert(state);
+    state->drained = drained;
+
+    for (std::map<space_id, std::pair<uint64_t, uint64_t> >::iterator it = m_quiesced.begin();
+            it != m_quiesced.end(); ++it)
+    {
+        if (state->acked >= it->second.first && drained < it->second.first)
+        {
+            ++it->second.second;
+        }
+    }
+
+    std::map<space_id, uint64_t>::iterator b = m_quiesce_backoff.begin();
+
+    while (b != m_quiesce_backoff.end())
+    {
+        if (--b->second == 0)
+        {
+            m_quiesce_backoff.erase(b++);
+        }
+        else
+        {
+            ++b;
+        }
+    }
+
+    size_t i = 0;
+
+    while (i < m_region_loads.size())
+    {
+        if (m_region_loads[i].sid == sid)
+        {
+            std::swap(m_region_loads[i], m_region_loads.back());
+            m_region_loads.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    m_region_loads.insert(m_region_loads.end(), loads.begin(), loads.end());
+    std::sort(m_region_loads.begin(), m_region_loads.end());
+    adjust_regions(ctx);
+    maintain_layout(ctx);
+}
+
 void
 coordinator :: xfer_begin(replicant_state_machine_context* ctx,
                           const region_id& rid,
@@ -1291,61 +1506,61 @@ coordinator :: remove_server(const server_id& sid, bool dry_run, bool shutdown,
     }
 }
 
-server_id
-coordinator :: select_new_server_for(const std::vector<replica>& replicas)
+namespace
 {
-    std::vector<server_id> available;
 
-    for (size_t i = 0; i < m_servers.size(); ++i)
+uint64_t
+per_mille(uint64_t x, uint64_t mean)
+{
+    return x * 1000 / std::max(mean, uint64_t(1));
+}
+
+uint64_t
+load_score(const server_load& l, const server_load& mean)
+{
+    return per_mille(l.bytes, mean.bytes)
+         + per_mille(l.regions, mean.regions)
+         + per_mille(l.ops, mean.ops);
+}
+
+server_load
+mean_load(const std::vector<server_load>& loads)
+{
+    server_load mean;
+
+    for (size_t i = 0; i < loads.size(); ++i)
     {
-        if (m_servers[i].state == server_state::AVAILABLE)
-        {
-            available.push_back(m_servers[i].id);
-        }
+        mean.bytes += loads[i].bytes;
+        mean.ops += loads[i].ops;
+        mean.regions += loads[i].regions;
     }
 
-    while (available.size() > replicas.size())
+    if (!loads.empty())
     {
-#ifdef __APPLE__
-        int y;
-        y = rand_r(&m_seed);
-#else
-        long int y;
-        lrand48_r(&m_seed, &y);
-#endif
-        bool found = false;
-        server_id tmp(m_servers[y % m_servers.size()].id);
-
-        for (size_t x = 0; x < replicas.size(); ++x)
-        {
-            if (tmp == replicas[x].si)
-            {
-                found = true;
-            }
-        }
-
-        if (!found)
-        {
-            return tmp;
-        }
+        mean.bytes /= loads.size();
+        mean.ops /= loads.size();
+        mean.regions /= loads.size();
     }
 
-    return server_id();
+    return mean;
 }
 
+} // namespace
+
 void
-coordinator :: issue_new_config(struct replicant_state_machine_context* ctx)
+coordinator :: server_loads(std::vector<server_load>* loads)
 {
-    FILE* log = replicant_state_machine_log_stream(ctx);
-    uint64_t cond_state;
+    loads->clear();
 
-    if (replicant_state_machine_condition_broadcast(ctx, "config", &cond_state) < 0)
+    for (size_t i = 0; i < m_servers.size(); ++i)
     {
-        fprintf(log, "could not broadcast on \"config\" condition\n");
+        if (m_servers[i].state == server_state::AVAILABLE)
+        {
+            loads->push_back(server_load(m_servers[i].id, m_servers[i].bind_to.address));
+        }
     }
 
-    ++m_version;
-    std::vector<server_id> sids;
+    std::vector<server_load>::iterator sl;
 
     for (std::map<std::string, std::tr1::shared_ptr<space> >::iterator it = m_spaces.begin();
             it != m_spaces.end(); ++it)
@@ -1358,59 +1573,182 @@ coordinator :: issue_new_config(struct replicant_state_machine_context* ctx)
 
             for (size_t j = 0; j < ss.regions.size(); ++j)
             {
-                region& reg(ss.regions[j]);
+                const region& reg(ss.regions[j]);
 
                 for (size_t k = 0; k < reg.replicas.size(); ++k)
                 {
-                    sids.push_back(reg.replicas[k].si);
+                    sl = std::lower_bound(loads->begin(), loads->end(), reg.replicas[k].si);
+
+                    if (sl != loads->end() && sl->sid == reg.replicas[k].si)
+                    {
+                        ++sl->regions;
+                    }
+                }
+
+                // Charge a region's load only to servers still in its chain;
+                // a server that just gave the region away keeps reporting it
+                // until its next report.
+                std::vector<region_load>::iterator rl;
+                rl = std::lower_bound(m_region_loads.begin(), m_region_loads.end(),
+                                      region_load(reg.id, server_id(), 0, 0));
+
+                for (; rl != m_region_loads.end() && rl->rid == reg.id; ++rl)
+                {
+                    bool is_replica = false;
+
+                    for (size_t k = 0; k < reg.replicas.size(); ++k)
+                    {
+                        is_replica = is_replica || reg.replicas[k].si == rl->sid;
+                    }
+
+                    sl = std::lower_bound(loads->begin(), loads->end(), rl->sid);
+
+                    if (is_replica && sl != loads->end() && sl->sid == rl->sid)
+                    {
+                        sl->bytes += rl->bytes;
+                        sl->ops += rl->ops;
+                    }
                 }
             }
         }
     }
 
-    m_missing_acks.push_back(missing_acks(m_version, sids));
-    fprintf(log, "issuing new configuration version %lu\n", m_version);
-    m_latest_config.reset();
+    // a transfer's destination will hold the region soon enough
+    for (size_t i = 0; i < m_transfers.size(); ++i)
+    {
+        sl = std::lower_bound(loads->begin(), loads->end(), m_transfers[i].dst);
+
+        if (sl != loads->end() && sl->sid == m_transfers[i].dst)
+        {
+            ++sl->regions;
+        }
+    }
 }
 
-void
-coordinator :: initial_layout(struct replicant_state_machine_context* ctx,
-                              space* s)
+server_id
+coordinator :: select_new_server_for(const std::vector<replica>& replicas,
+                                     std::vector<server_load>* loads)
 {
-    for (size_t i = 0; i < s->subspaces.size(); ++i)
+    server_load mean = mean_load(*loads);
+    server_load* best = NULL;
+    bool best_shares = false;
+    uint64_t best_score = 0;
+
+    for (size_t i = 0; i < loads->size(); ++i)
     {
-        subspace& ss(s->subspaces[i]);
+        server_load* l = &(*loads)[i];
+        bool member = false;
+        bool shares = false;
 
-        for (size_t j = 0; j < ss.regions.size(); ++j)
+        for (size_t x = 0; x < replicas.size(); ++x)
         {
-            region& reg(ss.regions[j]);
-            server_id new_server;
+            server_state* state = get_state(replicas[x].si);
+            member = member || replicas[x].si == l->sid;
+            shares = shares || (state && state->bind_to.address == l->address);
+        }
 
-            while (reg.replicas.size() < s->fault_tolerance + 1 &&
-                   (new_server = select_new_server_for(reg.replicas)) != server_id())
-            {
-                reg.replicas.push_back(replica());
-                reg.replicas.back().si = new_server;
-                reg.replicas.back().vsi = virtual_server_id(m_counter);
-                ++m_counter;
-            }
+        if (member)
+        {
+            continue;
+        }
+
+        uint64_t score = load_score(*l, mean);
+
+        // prefer a separate failure domain over a lighter load
+        if (!best || (best_shares && !shares) ||
+            (best_shares == shares && score < best_score))
+        {
+            best = l;
+            best_shares = shares;
+            best_score = score;
         }
     }
 
-    if (s->fault_tolerance + 1 < m_servers.size())
+    if (!best)
     {
-        FILE* log = replicant_state_machine_log_stream(ctx);
-        fprintf(log, "space \"%s\" desires %lu-fault tolerance, but has %lu-fault "
-                     "tolerance; add more servers\n",
-                     s->name, s->fault_tolerance, m_servers.empty() ? 0 : m_servers.size() - 1);
+        return server_id();
     }
+
+    // so successive placements in one pass spread out
+    ++best->regions;
+    return best->sid;
 }
 
-void
-coordinator :: maintain_layout(replicant_state_machine_context* ctx)
+bool
+coordinator :: finish_offload(const space& s, region* reg)
+{
+    for (size_t i = 0; i < m_offloads.size(); ++i)
+    {
+        if (m_offloads[i].first != reg->id)
+        {
+            continue;
+        }
+
+        server_id sid = m_offloads[i].second;
+        m_offloads[i] = m_offloads.back();
+        m_offloads.pop_back();
+
+        if (reg->replicas.size() <= s.fault_tolerance + 1)
+        {
+            return false;
+        }
+
+        for (size_t j = 0; j < reg->replicas.size(); ++j)
+        {
+            if (reg->replicas[j].si == sid)
+            {
+                reg->replicas.erase(reg->replicas.begin() + j);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    return false;
+}
+
+bool
+coordinator :: rebalance(struct replicant_state_machine_context* ctx,
+                         const std::vector<server_load>& loads)
 {
     FILE* log = replicant_state_machine_log_stream(ctx);
-    uint64_t changes = 0;
+
+    if (loads.size() < 2 || !m_transfers.empty())
+    {
+        return false;
+    }
+
+    // maintain_layout already finished every offload whose region survives
+    m_offloads.clear();
+    server_load mean = mean_load(loads);
+    size_t heavy = 0;
+    size_t light = 0;
+
+    for (size_t i = 1; i < loads.size(); ++i)
+    {
+        if (load_score(loads[i], mean) > load_score(loads[heavy], mean))
+        {
+            heavy = i;
+        }
+
+        if (load_score(loads[i], mean) < load_score(loads[light], mean))
+        {
+            light = i;
+        }
+    }
+
+    uint64_t gap = load_score(loads[heavy], mean) - load_score(loads[light], mean);
+
+    if (gap < REBALANCE_MIN_GAP)
+    {
+        return false;
+    }
+
+    // move the largest region that closes no more than half the gap, so the
+    // two servers do not trade places and move it right back
+    region* best = NULL;
+    uint64_t best_weight = 0;
 
     for (std::map<std::string, std::tr1::shared_ptr<space> >::iterator it = m_spaces.begin();
             it != m_spaces.end(); ++it)
@@ -1420,27 +1758,182 @@ coordinator :: maintain_layout(replicant_state_machine_context* ctx)
         for (size_t i = 0; i < s.subspaces.size(); ++i)
         {
             subspace& ss(s.subspaces[i]);
-            server_id replacement;
 
             for (size_t j = 0; j < ss.regions.size(); ++j)
             {
                 region& reg(ss.regions[j]);
+                bool on_heavy = false;
+                bool blocked = false;
 
-                if (reg.replicas.empty())
+                if (!can_restructure(s, reg))
                 {
-                    replacement = get_region_reference(reg.id);
-                    server_state* state = get_state(replacement);
+                    continue;
+                }
 
-                    if (replacement != server_id() && state &&
-                        state->state != server_state::AVAILABLE)
-                    {
-                        fprintf(log, "region_id(%lu) empty and the last server to leave it is offline\n", reg.id.get());
-                    }
-                    else if (replacement == server_id() || !state)
-                    {
-                        fprintf(log, "region_id(%lu) completely empty; cannot transfer to another node\n", reg.id.get());
-                    }
-                    else
+                for (size_t k = 0; k < reg.replicas.size(); ++k)
+                {
+                    server_state* state = get_state(reg.replicas[k].si);
+                    on_heavy = on_heavy || reg.replicas[k].si == loads[heavy].sid;
+                    blocked = blocked || reg.replicas[k].si == loads[light].sid ||
+                              (reg.replicas[k].si != loads[heavy].sid && state &&
+                               state->bind_to.address == loads[light].address);
+                }
+
+                uint64_t bytes;
+                uint64_t ops;
+
+                if (!on_heavy || blocked || !region_load_of(reg, &bytes, &ops))
+                {
+                    continue;
+                }
+
+                uint64_t weight = per_mille(bytes, mean.bytes)
+                                + per_mille(1, mean.regions)
+                                + per_mille(ops, mean.ops);
+
+                if (weight * 2 <= gap && weight > best_weight)
+                {
+                    best = &reg;
+                    best_weight = weight;
+                }
+            }
+        }
+    }
+
+    if (!best)
+    {
+        return false;
+    }
+
+    transfer* xfer = new_transfer(best, loads[light].sid);
+
+    if (!xfer)
+    {
+        return false;
+    }
+
+    m_offloads.push_back(std::make_pair(best->id, loads[heavy].sid));
+    fprintf(log, "moving region_id(%lu) from server_id(%lu) to server_id(%lu) "
+                 "using transfer_id(%lu)/virtual_server_id(%lu) to balance load\n",
+                 best->id.get(), loads[heavy].sid.get(), loads[light].sid.get(),
+                 xfer->id.get(), xfer->vdst.get());
+    return true;
+}
+
+void
+coordinator :: issue_new_config(struct replicant_state_machine_context* ctx)
+{
+    FILE* log = replicant_state_machine_log_stream(ctx);
+    uint64_t cond_state;
+
+    if (replicant_state_machine_condition_broadcast(ctx, "config", &cond_state) < 0)
+    {
+        fprintf(log, "could not broadcast on \"config\" condition\n");
+    }
+
+    ++m_version;
+    std::vector<server_id> sids;
+
+    for (std::map<std::string, std::tr1::shared_ptr<space> >::iterator it = m_spaces.begin();
+            it != m_spaces.end(); ++it)
+    {
+        space& s(*it->second);
+
+        for (size_t i = 0; i < s.subspaces.size(); ++i)
+        {
+            subspace& ss(s.subspaces[i]);
+
+            for (size_t j = 0; j < ss.regions.size(); ++j)
+            {
+                region& reg(ss.regions[j]);
+
+                for (size_t k = 0; k < reg.replicas.size(); ++k)
+                {
+                    sids.push_back(reg.replicas[k].si);
+                }
+            }
+        }
+    }
+
+    m_missing_acks.push_back(missing_acks(m_version, sids));
+    fprintf(log, "issuing new configuration version %lu\n", m_version);
+    m_latest_config.reset();
+    record_config_delta();
+}
+
+void
+coordinator :: initial_layout(struct replicant_state_machine_context* ctx,
+                              space* s)
+{
+    std::vector<server_load> loads;
+    server_loads(&loads);
+
+    for (size_t i = 0; i < s->subspaces.size(); ++i)
+    {
+        subspace& ss(s->subspaces[i]);
+
+        for (size_t j = 0; j < ss.regions.size(); ++j)
+        {
+            region& reg(ss.regions[j]);
+            server_id new_server;
+
+            while (reg.replicas.size() < s->fault_tolerance + 1 &&
+                   (new_server = select_new_server_for(reg.replicas, &loads)) != server_id())
+            {
+                reg.replicas.push_back(replica());
+                reg.replicas.back().si = new_server;
+                reg.replicas.back().vsi = virtual_server_id(m_counter);
+                ++m_counter;
+            }
+        }
+    }
+
+    if (s->fault_tolerance + 1 < m_servers.size())
+    {
+        FILE* log = replicant_state_machine_log_stream(ctx);
+        fprintf(log, "space \"%s\" desires %lu-fault tolerance, but has %lu-fault "
+                     "tolerance; add more servers\n",
+                     s->name, s->fault_tolerance, m_servers.empty() ? 0 : m_servers.size() - 1);
+    }
+}
+
+void
+coordinator :: maintain_layout(replicant_state_machine_context* ctx)
+{
+    FILE* log = replicant_state_machine_log_stream(ctx);
+    uint64_t changes = 0;
+    std::vector<server_load> loads;
+    server_loads(&loads);
+
+    for (std::map<std::string, std::tr1::shared_ptr<space> >::iterator it = m_spaces.begin();
+            it != m_spaces.end(); ++it)
+    {
+        space& s(*it->second);
+
+        for (size_t i = 0; i < s.subspaces.size(); ++i)
+        {
+            subspace& ss(s.subspaces[i]);
+            server_id replacement;
+
+            for (size_t j = 0; j < ss.regions.size(); ++j)
+            {
+                region& reg(ss.regions[j]);
+
+                if (reg.replicas.empty())
+                {
+                    replacement = get_region_reference(reg.id);
+                    server_state* state = get_state(replacement);
+
+                    if (replacement != server_id() && state &&
+                        state->state != server_state::AVAILABLE)
+                    {
+                        fprintf(log, "region_id(%lu) empty and the last server to leave it is offline\n", reg.id.get());
+                    }
+                    else if (replacement == server_id() || !state)
+                    {
+                        fprintf(log, "region_id(%lu) completely empty; cannot transfer to another node\n", reg.id.get());
+                    }
+                    else
                     {
                         reg.replicas.push_back(replica());
                         reg.replicas.back().si = replacement;
@@ -1455,7 +1948,7 @@ coordinator :: maintain_layout(replicant_state_machine_context* ctx)
                 }
                 else if (!get_transfer(reg.id) &&
                          reg.replicas.size() < s.fault_tolerance + 1 &&
-                         (replacement = select_new_server_for(reg.replicas)) != server_id())
+                         (replacement = select_new_server_for(reg.replicas, &loads)) != server_id())
                 {
                     transfer* xfer = new_transfer(&reg, replacement);
 
@@ -1468,10 +1961,20 @@ coordinator :: maintain_layout(replicant_state_machine_context* ctx)
                                      xfer->id.get(), xfer->vdst.get());
                     }
                 }
+                else if (!get_transfer(reg.id) && finish_offload(s, &reg))
+                {
+                    ++changes;
+                    fprintf(log, "region_id(%lu) finished moving to balance load\n", reg.id.get());
+                }
             }
         }
     }
 
+    if (changes == 0 && rebalance(ctx, loads))
+    {
+        ++changes;
+    }
+
     if (changes > 0)
     {
         issue_new_config(ctx);
@@ -1480,6 +1983,379 @@ coordinator :: maintain_layout(replicant_state_machine_context* ctx)
     return generate_response(ctx, COORD_SUCCESS);
 }
 
+bool
+coordinator :: region_load_of(const region& reg, uint64_t* bytes, uint64_t* ops)
+{
+    std::vector<region_load>::iterator it;
+    it = std::lower_bound(m_region_loads.begin(), m_region_loads.end(),
+                          region_load(reg.id, server_id(), 0, 0));
+    bool tail_reported = false;
+    *bytes = 0;
+    *ops = 0;
+
+    for (; it != m_region_loads.end() && it->rid == reg.id; ++it)
+    {
+        bool is_replica = false;
+
+        for (size_t i = 0; i < reg.replicas.size(); ++i)
+        {
+            is_replica = is_replica || reg.replicas[i].si == it->sid;
+        }
+
+        if (!is_replica)
+        {
+            continue;
+        }
+
+        tail_reported = tail_reported || reg.replicas.back().si == it->sid;
+        *bytes = std::max(*bytes, it->bytes);
+        *ops = std::max(*ops, it->ops);
+    }
+
+    return tail_reported;
+}
+
+void
+coordinator :: forget_region_load(const region_id& rid)
+{
+    std::vector<region_load>::iterator lower;
+    std::vector<region_load>::iterator upper;
+    lower = std::lower_bound(m_region_loads.begin(), m_region_loads.end(),
+                             region_load(rid, server_id(), 0, 0));
+    upper = lower;
+
+    while (upper != m_region_loads.end() && upper->rid == rid)
+    {
+        ++upper;
+    }
+
+    m_region_loads.erase(lower, upper);
+}
+
+bool
+coordinator :: can_restructure(const space& s, const region& reg)
+{
+    if (reg.replicas.empty() ||
+        reg.replicas.size() < s.fault_tolerance + 1 ||
+        get_transfer(reg.id) ||
+        get_capture(reg.id))
+    {
+        return false;
+    }
+
+    // every replica re-keys its own copy, so all of them must be up to it
+    for (size_t i = 0; i < reg.replicas.size(); ++i)
+    {
+        server_state* state = get_state(reg.replicas[i].si);
+
+        if (!state || state->state != server_state::AVAILABLE)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+coordinator :: quiesced(replicant_state_machine_context* ctx, const space& s)
+{
+    FILE* log = replicant_state_machine_log_stream(ctx);
+    std::map<space_id, std::pair<uint64_t, uint64_t> >::iterator it = m_quiesced.find(s.id);
+
+    // Replicas persist a write only as its ack comes back down the chain, so
+    // while writes are in flight the tail's copy is ahead of the others'.
+    // Hold off new writes until the chain catches up, so that every replica
+    // re-keys the same objects.
+    if (it == m_quiesced.end())
+    {
+        fprintf(log, "quiescing space_id(%lu) to restructure its regions\n", s.id.get());
+        m_quiesced[s.id] = std::make_pair(m_version + 1, uint64_t(0));
+        issue_new_config(ctx);
+        return false;
+    }
+
+    for (size_t i = 0; i < s.subspaces.size(); ++i)
+    {
+        for (size_t j = 0; j < s.subspaces[i].regions.size(); ++j)
+        {
+            const region& reg(s.subspaces[i].regions[j]);
+
+            for (size_t k = 0; k < reg.replicas.size(); ++k)
+            {
+                server_state* state = get_state(reg.replicas[k].si);
+
+                // a server that is down isn't taking writes, and won't report
+                if (state && state->state == server_state::AVAILABLE &&
+                    state->drained < it->second.first)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+void
+coordinator :: replace_replicas(region* reg, const std::vector<replica>& chain)
+{
+    reg->replicas.clear();
+
+    for (size_t i = 0; i < chain.size(); ++i)
+    {
+        reg->replicas.push_back(replica(chain[i].si, virtual_server_id(m_counter)));
+        ++m_counter;
+    }
+}
+
+void
+coordinator :: adjust_regions(replicant_state_machine_context* ctx)
+{
+    FILE* log = replicant_state_machine_log_stream(ctx);
+
+    for (std::map<space_id, std::pair<uint64_t, uint64_t> >::iterator it = m_quiesced.begin();
+            it != m_quiesced.end(); ++it)
+    {
+        if (it->second.second > QUIESCE_MAX_UNDRAINED)
+        {
+            fprintf(log, "releasing space_id(%lu) because its writes did not drain\n",
+                         it->first.get());
+            m_quiesce_backoff[it->first] = QUIESCE_BACKOFF_REPORTS;
+            m_quiesced.erase(it);
+            issue_new_config(ctx);
+            return;
+        }
+    }
+
+    for (std::map<std::string, std::tr1::shared_ptr<space> >::iterator it = m_spaces.begin();
+            it != m_spaces.end(); ++it)
+    {
+        space& s(*it->second);
+
+        if (m_quiesce_backoff.find(s.id) != m_quiesce_backoff.end())
+        {
+            continue;
+        }
+
+        for (size_t i = 0; i < s.subspaces.size(); ++i)
+        {
+            subspace& ss(s.subspaces[i]);
+            uint64_t bytes;
+            uint64_t ops;
+
+            for (size_t j = 0; j < ss.regions.size() &&
+                               ss.regions.size() < REGION_MAX_PER_SUBSPACE; ++j)
+            {
+                if (can_restructure(s, ss.regions[j]) &&
+                    region_load_of(ss.regions[j], &bytes, &ops) &&
+                    (bytes > REGION_SPLIT_BYTES || ops > REGION_SPLIT_OPS) &&
+                    split_region(ctx, s, &ss, j))
+                {
+                    return;
+                }
+            }
+
+            if (ss.regions.size() <= m_initial_regions[ss.id])
+            {
+                continue;
+            }
+
+            // find neighbors by where they start rather than by pairwise scan
+            std::map<std::vector<uint64_t>, size_t> by_lower;
+
+            for (size_t j = 0; j < ss.regions.size(); ++j)
+            {
+                by_lower[ss.regions[j].lower_coord] = j;
+            }
+
+            for (size_t j = 0; j < ss.regions.size(); ++j)
+            {
+                region& lhs(ss.regions[j]);
+                uint64_t lhs_bytes;
+                uint64_t lhs_ops;
+
+                if (!can_restructure(s, lhs) ||
+                    !region_load_of(lhs, &lhs_bytes, &lhs_ops))
+                {
+                    continue;
+                }
+
+                for (size_t d = 0; d < lhs.upper_coord.size(); ++d)
+                {
+                    if (lhs.upper_coord[d] == UINT64_MAX)
+                    {
+                        continue;
+                    }
+
+                    std::vector<uint64_t> next(lhs.lower_coord);
+                    next[d] = lhs.upper_coord[d] + 1;
+                    std::map<std::vector<uint64_t>, size_t>::iterator n = by_lower.find(next);
+
+                    if (n == by_lower.end())
+                    {
+                        continue;
+                    }
+
+                    region& rhs(ss.regions[n->second]);
+                    bool adjacent = true;
+
+                    for (size_t k = 0; k < lhs.upper_coord.size(); ++k)
+                    {
+                        adjacent = adjacent && (k == d || lhs.upper_coord[k] == rhs.upper_coord[k]);
+                    }
+
+                    if (adjacent &&
+                        can_restructure(s, rhs) &&
+                        region_load_of(rhs, &bytes, &ops) &&
+                        lhs_bytes + bytes < REGION_MERGE_BYTES &&
+                        lhs_ops + ops < REGION_MERGE_OPS &&
+                        merge_regions(ctx, s, &ss, j, n->second, d))
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+
+        // whatever the space was quiesced for no longer applies
+        if (m_quiesced.find(s.id) != m_quiesced.end())
+        {
+            fprintf(log, "releasing space_id(%lu) because it no longer needs "
+                         "restructuring\n", s.id.get());
+            m_quiesced.erase(s.id);
+            issue_new_config(ctx);
+            return;
+        }
+    }
+}
+
+bool
+coordinator :: split_region(replicant_state_machine_context* ctx,
+                            const space& s, subspace* ss, size_t idx)
+{
+    FILE* log = replicant_state_machine_log_stream(ctx);
+    const region& reg(ss->regions[idx]);
+    size_t dim = 0;
+
+    for (size_t i = 0; i < reg.lower_coord.size(); ++i)
+    {
+        if (reg.upper_coord[i] - reg.lower_coord[i] >
+            reg.upper_coord[dim] - reg.lower_coord[dim])
+        {
+            dim = i;
+        }
+    }
+
+    if (reg.lower_coord.empty() ||
+        reg.lower_coord[dim] == reg.upper_coord[dim])
+    {
+        return false;
+    }
+
+    if (!quiesced(ctx, s))
+    {
+        return true;
+    }
+
+    // Both halves take over the parent's chain under new virtual ids, so
+    // that every replica re-keys the parent's objects locally and the data
+    // stays as replicated as it was.
+    uint64_t mid = reg.lower_coord[dim] + (reg.upper_coord[dim] - reg.lower_coord[dim]) / 2;
+    region_id parent = reg.id;
+    region lower(reg);
+    region upper(reg);
+    lower.id = region_id(m_counter);
+    ++m_counter;
+    lower.upper_coord[dim] = mid;
+    replace_replicas(&lower, reg.replicas);
+    upper.id = region_id(m_counter);
+    ++m_counter;
+    upper.lower_coord[dim] = mid + 1;
+    replace_replicas(&upper, reg.replicas);
+    ss->regions[idx] = lower;
+    ss->regions.push_back(upper);
+    forget_region_load(parent);
+    m_quiesced.erase(s.id);
+    fprintf(log, "splitting region_id(%lu) into region_id(%lu) and "
+                 "region_id(%lu) on its %lu replicas\n",
+                 parent.get(), lower.id.get(), upper.id.get(), lower.replicas.size());
+    issue_new_config(ctx);
+    maintain_layout(ctx);
+    return true;
+}
+
+bool
+coordinator :: merge_regions(replicant_state_machine_context* ctx,
+                             const space& s, subspace* ss,
+                             size_t lhs, size_t rhs, size_t dim)
+{
+    FILE* log = replicant_state_machine_log_stream(ctx);
+    region& l(ss->regions[lhs]);
+    region& r(ss->regions[rhs]);
+
+    // The merged region takes over lhs's chain, and each of its replicas
+    // re-keys both regions locally, so rhs must first reach every one of
+    // them.  Add them one transfer at a time.
+    for (size_t i = 0; i < l.replicas.size(); ++i)
+    {
+        server_id si = l.replicas[i].si;
+        bool present = false;
+
+        for (size_t j = 0; j < r.replicas.size(); ++j)
+        {
+            present = present || r.replicas[j].si == si;
+        }
+
+        if (present)
+        {
+            continue;
+        }
+
+        transfer* xfer = new_transfer(&r, si);
+
+        if (!xfer)
+        {
+            return false;
+        }
+
+        fprintf(log, "adding server_id(%lu) to region_id(%lu) "
+                     "using transfer_id(%lu)/virtual_server_id(%lu) "
+                     "to merge it with region_id(%lu)\n",
+                     si.get(), r.id.get(), xfer->id.get(),
+                     xfer->vdst.get(), l.id.get());
+        // the transfer may take a while; don't hold writes off for it
+        m_quiesced.erase(s.id);
+        issue_new_config(ctx);
+        return true;
+    }
+
+    if (!quiesced(ctx, s))
+    {
+        return true;
+    }
+
+    region merged(l);
+    region_id lhs_id = l.id;
+    region_id rhs_id = r.id;
+    merged.id = region_id(m_counter);
+    ++m_counter;
+    merged.upper_coord[dim] = r.upper_coord[dim];
+    replace_replicas(&merged, l.replicas);
+    ss->regions[lhs] = merged;
+    ss->regions.erase(ss->regions.begin() + rhs);
+    forget_region_load(lhs_id);
+    forget_region_load(rhs_id);
+    m_quiesced.erase(s.id);
+    fprintf(log, "merging region_id(%lu) and region_id(%lu) into "
+                 "region_id(%lu) on its %lu replicas\n",
+                 lhs_id.get(), rhs_id.get(), merged.id.get(), merged.replicas.size());
+    issue_new_config(ctx);
+    maintain_layout(ctx);
+    return true;
+}
+
 void
 coordinator :: regenerate_cached(struct replicant_state_machine_context*)
 {
@@ -1511,6 +2387,7 @@ coordinator :: regenerate_cached(struct replicant_state_machine_context*)
         sz += pack_size(m_transfers[i]);
     }
 
+    sz += sizeof(uint64_t) + m_quiesced.size() * sizeof(uint64_t);
     std::auto_ptr<e::buffer> new_config(e::buffer::create(sz));
     e::buffer::packer pa = new_config->pack_at(0);
     pa = pa << m_cluster << m_version
@@ -1543,5 +2420,155 @@ coordinator :: regenerate_cached(struct replicant_state_machine_context*)
         pa = pa << m_transfers[i];
     }
 
+    pa = pa << uint64_t(m_quiesced.size());
+
+    for (std::map<space_id, std::pair<uint64_t, uint64_t> >::iterator it = m_quiesced.begin();
+            it != m_quiesced.end(); ++it)
+    {
+        pa = pa << it->first.get();
+    }
+
     m_latest_config = new_config;
 }
+
+void
+coordinator :: record_config_delta()
+{
+    std::vector<std::pair<region_id, std::vector<replica> > > regions;
+    regions.reserve(m_published_regions.size());
+
+    for (std::map<std::string, std::tr1::shared_ptr<space> >::iterator it = m_spaces.begin();
+            it != m_spaces.end(); ++it)
+    {
+        space& s(*it->second);
+
+        for (size_t i = 0; i < s.subspaces.size(); ++i)
+        {
+            subspace& ss(s.subspaces[i]);
+
+            for (size_t j = 0; j < ss.regions.size(); ++j)
+            {
+                regions.push_back(std::make_pair(ss.regions[j].id, ss.regions[j].replicas));
+            }
+        }
+    }
+
+    // a space or region that came or went changes more than chains, so only
+    // the full configuration can describe this version
+    bool structural = regions.size() != m_published_regions.size();
+    std::vector<size_t> changed;
+
+    for (size_t i = 0; !structural && i < regions.size(); ++i)
+    {
+        const std::vector<replica>& now(regions[i].second);
+        const std::vector<replica>& was(m_published_regions[i].second);
+        bool same = now.size() == was.size();
+
+        for (size_t j = 0; same && j < now.size(); ++j)
+        {
+            same = now[j].si == was[j].si && now[j].vsi == was[j].vsi;
+        }
+
+        if (regions[i].first != m_published_regions[i].first)
+        {
+            structural = true;
+        }
+        else if (!same)
+        {
+            changed.push_back(i);
+        }
+    }
+
+    m_published_regions.swap(regions);
+    std::tr1::shared_ptr<e::buffer> delta;
+
+    if (!structural)
+    {
+        size_t sz = 5 * sizeof(uint64_t);
+        uint64_t num_servers = 0;
+
+        for (size_t i = 0; i < m_servers.size(); ++i)
+        {
+            if (m_servers[i].state == server_state::AVAILABLE)
+            {
+                sz += sizeof(uint64_t) + pack_size(m_servers[i].bind_to);
+                ++num_servers;
+            }
+        }
+
+        for (size_t i = 0; i < m_captures.size(); ++i)
+        {
+            sz += pack_size(m_captures[i]);
+        }
+
+        for (size_t i = 0; i < m_transfers.size(); ++i)
+        {
+            sz += pack_size(m_transfers[i]);
+        }
+
+        for (size_t i = 0; i < changed.size(); ++i)
+        {
+            const std::vector<replica>& chain(m_published_regions[changed[i]].second);
+            sz += sizeof(uint64_t) + sizeof(uint8_t);
+
+            for (size_t j = 0; j < chain.size(); ++j)
+            {
+                sz += pack_size(chain[j]);
+            }
+        }
+
+        sz += sizeof(uint64_t) + m_quiesced.size() * sizeof(uint64_t);
+        delta.reset(e::buffer::create(sz));
+        e::buffer::packer pa = delta->pack_at(0);
+        pa = pa << m_version
+                << num_servers
+                << uint64_t(m_captures.size())
+                << uint64_t(m_transfers.size())
+                << uint64_t(changed.size());
+
+        for (size_t i = 0; i < m_servers.size(); ++i)
+        {
+            if (m_servers[i].state == server_state::AVAILABLE)
+            {
+                pa = pa << m_servers[i].id.get() << m_servers[i].bind_to;
+            }
+        }
+
+        for (size_t i = 0; i < m_captures.size(); ++i)
+        {
+            pa = pa << m_captures[i];
+        }
+
+        for (size_t i = 0; i < m_transfers.size(); ++i)
+        {
+            pa = pa << m_transfers[i];
+        }
+
+        for (size_t i = 0; i < changed.size(); ++i)
+        {
+            const std::vector<replica>& chain(m_published_regions[changed[i]].second);
+            pa = pa << m_published_regions[changed[i]].first.get()
+                    << uint8_t(chain.size());
+
+            for (size_t j = 0; j < chain.size(); ++j)
+            {
+                pa = pa << chain[j];
+            }
+        }
+
+        pa = pa << uint64_t(m_quiesced.size());
+
+        for (std::map<space_id, std::pair<uint64_t, uint64_t> >::iterator it = m_quiesced.begin();
+                it != m_quiesced.end(); ++it)
+        {
+            pa = pa << it->first.get();
+        }
+    }
+
+    m_config_deltas.push_back(delta);
+
+    while (m_config_deltas.size() > CONFIG_DELTA_HISTORY)
+    {
+        m_config_deltas.pop_front();
+    }
+}
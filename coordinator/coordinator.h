@@ -51,6 +51,8 @@
 #include "common/ids.h"
 #include "common/transfer.h"
 #include "coordinator/missing_acks.h"
+#include "coordinator/region_load.h"
+#include "coordinator/server_load.h"
 #include "coordinator/server_state.h"
 
 BEGIN_HYPERDEX_NAMESPACE
@@ -72,6 +74,8 @@ class coordinator
         void rm_space(replicant_state_machine_context* ctx, const char* name);
         // Issue configs
         void get_config(replicant_state_machine_context* ctx);
+        // deltas since "version", or the full config if they are gone
+        void get_config_delta(replicant_state_machine_context* ctx, uint64_t version);
         void ack_config(replicant_state_machine_context* ctx, const server_id&, uint64_t version);
         // Manage cluster membership
         void server_register(replicant_state_machine_context* ctx,
@@ -86,6 +90,13 @@ class coordinator
                               const server_id& sid);
         void server_shutdown2(replicant_state_machine_context* ctx,
                               const server_id& sid);
+        // Load reports; "loads" replaces everything sid reported before, and
+        // "drained" is the config with which sid found no writes in flight to
+        // any quiesced space, or 0
+        void server_report(replicant_state_machine_context* ctx,
+                           const server_id& sid,
+                           const std::vector<region_load>& loads,
+                           uint64_t drained);
         // Transfers
         void xfer_begin(replicant_state_machine_context* ctx,
                         const region_id& rid,
@@ -125,11 +136,32 @@ class coordinator
         void remove_server(const server_id& sid, bool dry_run, bool shutdown,
                            std::vector<region_id>* rids,
                            std::vector<transfer_id>* xids);
-        server_id select_new_server_for(const std::vector<replica>& replicas);
+        void server_loads(std::vector<server_load>* loads);
+        server_id select_new_server_for(const std::vector<replica>& replicas,
+                                        std::vector<server_load>* loads);
+        bool finish_offload(const space& s, region* reg);
+        bool rebalance(struct replicant_state_machine_context* ctx,
+                       const std::vector<server_load>& loads);
         void issue_new_config(struct replicant_state_machine_context* ctx);
         void initial_layout(struct replicant_state_machine_context* ctx, space* s);
         void maintain_layout(struct replicant_state_machine_context* ctx);
         void regenerate_cached(struct replicant_state_machine_context* ctx);
+        void record_config_delta();
+        // region splits and merges
+        bool region_load_of(const region& reg, uint64_t* bytes, uint64_t* ops);
+        void forget_region_load(const region_id& rid);
+        bool can_restructure(const space& s, const region& reg);
+        // true once writes to s are held off and every server in s has
+        // drained those in flight; quiesces s if it is not already
+        bool quiesced(struct replicant_state_machine_context* ctx, const space& s);
+        // give reg the servers of chain, in order, under fresh virtual ids
+        void replace_replicas(region* reg, const std::vector<replica>& chain);
+        void adjust_regions(struct replicant_state_machine_context* ctx);
+        bool split_region(struct replicant_state_machine_context* ctx,
+                          const space& s, subspace* ss, size_t idx);
+        bool merge_regions(struct replicant_state_machine_context* ctx,
+                           const space& s, subspace* ss,
+                           size_t lhs, size_t rhs, size_t dim);
 
     private:
         uint64_t m_cluster;
@@ -144,7 +176,26 @@ class coordinator
         std::vector<std::pair<capture_id, server_id> > m_capture_server_references;
         std::vector<std::pair<capture_id, transfer_id> > m_capture_transfer_references;
         std::vector<std::pair<region_id, server_id> > m_region_server_references;
+        std::vector<region_load> m_region_loads;
+        // merges never take a subspace below the regions it was created with
+        std::map<subspace_id, size_t> m_initial_regions;
+        // regions moving off a server to balance load; the server leaves the
+        // chain once the transfer onto its replacement completes
+        std::vector<std::pair<region_id, server_id> > m_offloads;
+        // spaces whose writes are held off until they drain, so that a split
+        // or merge re-keys the same data on every replica; each maps to the
+        // version that first carried the hold and the number of reports since
+        // that found writes still in flight
+        std::map<space_id, std::pair<uint64_t, uint64_t> > m_quiesced;
+        // spaces whose writes failed to drain, with the number of reports to
+        // wait before quiescing them again
+        std::map<space_id, uint64_t> m_quiesce_backoff;
         std::auto_ptr<e::buffer> m_latest_config; // cached config
+        // every region's chain as of m_version, in configuration order
+        std::vector<std::pair<region_id, std::vector<replica> > > m_published_regions;
+        // the last delta takes m_version - 1 to m_version; NULL marks a version
+        // that cannot be reached by delta
+        std::list<std::tr1::shared_ptr<e::buffer> > m_config_deltas;
         std::auto_ptr<e::buffer> m_resp; // response space
 #ifdef __APPLE__
         unsigned int m_seed;
@@ -0,0 +1,87 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_coordinator_region_load_h_
+#define hyperdex_coordinator_region_load_h_
+
+// HyperDex
+#include "namespace.h"
+#include "common/ids.h"
+
+BEGIN_HYPERDEX_NAMESPACE
+
+// What one server most recently reported about one of its regions.
+class region_load
+{
+    public:
+        region_load();
+        region_load(const region_id& rid, const server_id& sid,
+                    uint64_t bytes, uint64_t ops);
+        ~region_load() throw ();
+
+    public:
+        region_id rid;
+        server_id sid;
+        // bytes the region occupies on the server's disk
+        uint64_t bytes;
+        // gets and writes per second the server handled for the region
+        uint64_t ops;
+};
+
+inline
+region_load :: region_load()
+    : rid()
+    , sid()
+    , bytes(0)
+    , ops(0)
+{
+}
+
+inline
+region_load :: region_load(const region_id& _rid, const server_id& _sid,
+                           uint64_t _bytes, uint64_t _ops)
+    : rid(_rid)
+    , sid(_sid)
+    , bytes(_bytes)
+    , ops(_ops)
+{
+}
+
+inline
+region_load :: ~region_load() throw ()
+{
+}
+
+inline bool
+operator < (const region_load& lhs, const region_load& rhs)
+{
+    return lhs.rid < rhs.rid || (lhs.rid == rhs.rid && lhs.sid < rhs.sid);
+}
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_coordinator_region_load_h_
@@ -0,0 +1,90 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_coordinator_server_load_h_
+#define hyperdex_coordinator_server_load_h_
+
+// po6
+#include <po6/net/ipaddr.h>
+
+// HyperDex
+#include "namespace.h"
+#include "common/ids.h"
+
+BEGIN_HYPERDEX_NAMESPACE
+
+// What an available server holds, summed over the regions it replicates.
+class server_load
+{
+    public:
+        server_load();
+        server_load(const server_id& sid, const po6::net::ipaddr& address);
+        ~server_load() throw ();
+
+    public:
+        server_id sid;
+        // servers that share an address share a failure domain
+        po6::net::ipaddr address;
+        uint64_t bytes;
+        uint64_t ops;
+        uint64_t regions;
+};
+
+inline
+server_load :: server_load()
+    : sid()
+    , address()
+    , bytes(0)
+    , ops(0)
+    , regions(0)
+{
+}
+
+inline
+server_load :: server_load(const server_id& _sid, const po6::net::ipaddr& _address)
+    : sid(_sid)
+    , address(_address)
+    , bytes(0)
+    , ops(0)
+    , regions(0)
+{
+}
+
+inline
+server_load :: ~server_load() throw ()
+{
+}
+
+inline bool
+operator < (const server_load& lhs, const server_id& rhs)
+{
+    return lhs.sid < rhs;
+}
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_coordinator_server_load_h_
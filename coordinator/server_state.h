@@ -51,6 +51,9 @@ class server_state
         enum { AVAILABLE, NOT_AVAILABLE, SHUTDOWN } state;
         // the most recent config that this server has acked
         uint64_t acked;
+        // the config this server was running when it last reported nothing
+        // in flight to any quiesced space, or 0 if it had writes in flight
+        uint64_t drained;
         // the most recent config for which this server was available if
         // this->state != AVAILABLE (undefined if this->state == AVAILABLE)
         uint64_t version;
@@ -62,6 +65,7 @@ server_state :: server_state()
     , bind_to()
     , state(NOT_AVAILABLE)
     , acked(0)
+    , drained(0)
     , version(0)
 {
 }
@@ -73,6 +77,7 @@ server_state :: server_state(const server_id& _id,
     , bind_to(_bind_to)
     , state(AVAILABLE)
     , acked(0)
+    , drained(0)
     , version(0)
 {
 }
@@ -39,6 +39,7 @@ struct replicant_state_machine HYPERDEX_API rsm = {
     hyperdex_coordinator_destroy,
     hyperdex_coordinator_snapshot,
     {{"get-config", hyperdex_coordinator_get_config},
+     {"get-config-delta", hyperdex_coordinator_get_config_delta},
      {"ack-config", hyperdex_coordinator_ack_config},
      {"xfer-begin", hyperdex_coordinator_xfer_begin},
      {"xfer-go-live", hyperdex_coordinator_xfer_go_live},
@@ -47,6 +48,7 @@ struct replicant_state_machine HYPERDEX_API rsm = {
      {"server-register", hyperdex_coordinator_server_register},
      {"server-reregister", hyperdex_coordinator_server_reregister},
      {"server-suspect", hyperdex_coordinator_server_suspect},
+     {"server-report", hyperdex_coordinator_server_report},
      {"server-shutdown1", hyperdex_coordinator_server_shutdown1},
      {"server-shutdown2", hyperdex_coordinator_server_shutdown2},
 
@@ -61,6 +61,7 @@ TRANSITION(add_space);
 TRANSITION(rm_space);
 
 TRANSITION(get_config);
+TRANSITION(get_config_delta);
 TRANSITION(ack_config);
 
 TRANSITION(server_register);
@@ -68,6 +69,7 @@ TRANSITION(server_reregister);
 TRANSITION(server_shutdown1);
 TRANSITION(server_shutdown2);
 TRANSITION(server_suspect);
+TRANSITION(server_report);
 
 TRANSITION(xfer_begin);
 TRANSITION(xfer_complete);
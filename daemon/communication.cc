@@ -81,7 +81,7 @@ communication :: early_message :: ~early_message() throw ()
 
 communication :: communication(daemon* d)
     : m_daemon(d)
-    , m_busybee_mapper(&m_daemon->m_config)
+    , m_busybee_mapper(m_daemon->m_config.indirect())
     , m_busybee()
     , m_early_messages()
 {
@@ -109,13 +109,19 @@ void
 communication :: reconfigure(const configuration&,
                              const configuration& new_config,
                              const server_id&)
+{
+    deliver_early_messages(new_config.version());
+}
+
+void
+communication :: deliver_early_messages(uint64_t version)
 {
     e::lockfree_fifo<early_message> ems;
     early_message em;
 
     while (m_early_messages.pop(&em))
     {
-        if (em.config_version <= new_config.version())
+        if (em.config_version <= version)
         {
             m_busybee->deliver(em.id, em.msg);
         }
@@ -139,7 +145,7 @@ communication :: send_client(const virtual_server_id& from,
 {
     assert(msg->size() >= HYPERDEX_HEADER_SIZE_VC);
 
-    if (m_daemon->m_us != m_daemon->m_config.get_server_id(from) &&
+    if (m_daemon->m_us != m_daemon->m_config->get_server_id(from) &&
         from != virtual_server_id(UINT64_MAX))
     {
         return false;
@@ -190,7 +196,7 @@ communication :: send(const virtual_server_id& from,
 {
     assert(msg->size() >= HYPERDEX_HEADER_SIZE_VV);
 
-    if (m_daemon->m_us != m_daemon->m_config.get_server_id(from))
+    if (m_daemon->m_us != m_daemon->m_config->get_server_id(from))
     {
         return false;
     }
@@ -198,7 +204,7 @@ communication :: send(const virtual_server_id& from,
     uint8_t mt = static_cast<uint8_t>(msg_type);
     uint8_t flags = 1;
     virtual_server_id vto(UINT64_MAX);
-    msg->pack_at(BUSYBEE_HEADER_SIZE) << mt << flags << m_daemon->m_config.version() << vto.get() << from.get();
+    msg->pack_at(BUSYBEE_HEADER_SIZE) << mt << flags << m_daemon->m_config->version() << vto.get() << from.get();
 
     if (to == server_id())
     {
@@ -247,15 +253,15 @@ communication :: send(const virtual_server_id& from,
 {
     assert(msg->size() >= HYPERDEX_HEADER_SIZE_VV);
 
-    if (m_daemon->m_us != m_daemon->m_config.get_server_id(from))
+    if (m_daemon->m_us != m_daemon->m_config->get_server_id(from))
     {
         return false;
     }
 
     uint8_t mt = static_cast<uint8_t>(msg_type);
     uint8_t flags = 1;
-    msg->pack_at(BUSYBEE_HEADER_SIZE) << mt << flags << m_daemon->m_config.version() << vto.get() << from.get();
-    server_id to = m_daemon->m_config.get_server_id(vto);
+    msg->pack_at(BUSYBEE_HEADER_SIZE) << mt << flags << m_daemon->m_config->version() << vto.get() << from.get();
+    server_id to = m_daemon->m_config->get_server_id(vto);
 
     if (to == server_id())
     {
@@ -305,8 +311,8 @@ communication :: send(const virtual_server_id& vto,
 
     uint8_t mt = static_cast<uint8_t>(msg_type);
     uint8_t flags = 0;
-    msg->pack_at(BUSYBEE_HEADER_SIZE) << mt << flags << m_daemon->m_config.version() << vto.get();
-    server_id to = m_daemon->m_config.get_server_id(vto);
+    msg->pack_at(BUSYBEE_HEADER_SIZE) << mt << flags << m_daemon->m_config->version() << vto.get();
+    server_id to = m_daemon->m_config->get_server_id(vto);
 
     if (to == server_id())
     {
@@ -355,15 +361,15 @@ communication :: send_exact(const virtual_server_id& from,
 {
     assert(msg->size() >= HYPERDEX_HEADER_SIZE_VV);
 
-    if (m_daemon->m_us != m_daemon->m_config.get_server_id(from))
+    if (m_daemon->m_us != m_daemon->m_config->get_server_id(from))
     {
         return false;
     }
 
     uint8_t mt = static_cast<uint8_t>(msg_type);
     uint8_t flags = 1 | 2;
-    msg->pack_at(BUSYBEE_HEADER_SIZE) << mt << flags << m_daemon->m_config.version() << vto.get() << from.get();
-    server_id to = m_daemon->m_config.get_server_id(vto);
+    msg->pack_at(BUSYBEE_HEADER_SIZE) << mt << flags << m_daemon->m_config->version() << vto.get() << from.get();
+    server_id to = m_daemon->m_config->get_server_id(vto);
 
     if (to == server_id())
     {
@@ -421,7 +427,11 @@ communication :: recv(server_id* from,
     while (true)
     {
         uint64_t id;
+        // hold nothing from the configuration while blocked; the handler
+        // for this message may use it until we come back around
+        m_daemon->m_config.offline();
         busybee_returncode rc = m_busybee->recv(&id, msg);
+        m_daemon->m_config.online();
 
         switch (rc)
         {
@@ -471,24 +481,32 @@ communication :: recv(server_id* from,
         }
 
         bool from_valid = true;
-        bool to_valid = m_daemon->m_us == m_daemon->m_config.get_server_id(*vto) ||
+        bool to_valid = m_daemon->m_us == m_daemon->m_config->get_server_id(*vto) ||
                         *vto == virtual_server_id(UINT64_MAX);
 
         // If this is a virtual-virtual message
         if ((flags & 0x1))
         {
-            from_valid = *from == m_daemon->m_config.get_server_id(virtual_server_id(vidf));
+            from_valid = *from == m_daemon->m_config->get_server_id(virtual_server_id(vidf));
         }
 
         // No matter what, wait for the config the sender saw
-        if (version > m_daemon->m_config.version())
+        if (version > m_daemon->m_config->version())
         {
             early_message em(version, id, *msg);
             m_early_messages.push(em);
+
+            // the configuration may have been published since we checked,
+            // in which case its reconfigure may have missed this message
+            if (version <= m_daemon->m_config->version())
+            {
+                deliver_early_messages(m_daemon->m_config->version());
+            }
+
             continue;
         }
 
-        if ((flags & 0x2) && version < m_daemon->m_config.version())
+        if ((flags & 0x2) && version < m_daemon->m_config->version())
         {
             continue;
         }
@@ -501,6 +519,13 @@ communication :: recv(server_id* from,
             return true;
         }
 
+        // A group_keyop's REQ_BULK_ATOMIC that was shoved back at us; hand it
+        // to the search manager rather than bouncing it again.
+        if (*msg_type == CONFIGMISMATCH)
+        {
+            return true;
+        }
+
         // Shove the message back at the client so it fails with a reconfigure.
         if (!(flags & 0x1))
         {
@@ -514,7 +539,7 @@ communication :: recv(server_id* from,
 void
 communication :: handle_disruption(uint64_t id)
 {
-    if (m_daemon->m_config.get_address(server_id(id)) != po6::net::location())
+    if (m_daemon->m_config->get_address(server_id(id)) != po6::net::location())
     {
         m_daemon->m_coord.report_tcp_disconnect(server_id(id));
         // XXX If the above line changes, then we need to sometimes tell
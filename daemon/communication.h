@@ -117,6 +117,8 @@ class communication
 
     private:
         void handle_disruption(uint64_t id);
+        // deliver every early message for a configuration <= version
+        void deliver_early_messages(uint64_t version);
 
     private:
         communication(const communication&);
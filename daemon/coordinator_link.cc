@@ -33,6 +33,7 @@
 
 // e
 #include <e/endian.h>
+#include <e/time.h>
 
 // HyperDex
 #include "common/coordinator_returncode.h"
@@ -60,6 +61,7 @@ coordinator_link :: coordinator_link(daemon* d)
     , m_get_config_status(REPLICANT_GARBAGE)
     , m_get_config_output(NULL)
     , m_get_config_output_sz(0)
+    , m_get_config_full(false)
     , m_shutdown1_id(-1)
     , m_shutdown1_status(REPLICANT_GARBAGE)
     , m_shutdown1_output(NULL)
@@ -77,6 +79,9 @@ coordinator_link :: coordinator_link(daemon* d)
     , m_queue_transfers_go_live()
     , m_queue_transfers_complete()
     , m_queue_tcp_disconnects()
+    , m_report_time(0)
+    , m_report_ops()
+    , m_reports()
 {
 }
 
@@ -430,6 +435,8 @@ coordinator_link :: wait_for_config(configuration* config)
         {
             alarm(30);
             s_alarm = false;
+            // report before the retransmitter takes its queue for this trip
+            initiate_report_load();
             m_daemon->m_repl.trip_periodic();
             need_to_backoff = false;
         }
@@ -591,6 +598,7 @@ coordinator_link :: wait_for_config(configuration* config)
         std::map<int64_t, std::pair<uint64_t, std::tr1::shared_ptr<replicant_returncode> > >::iterator ack_iter;
         std::map<int64_t, std::pair<transfer_id, std::tr1::shared_ptr<replicant_returncode> > >::iterator xfer_iter;
         std::map<int64_t, std::pair<server_id, std::tr1::shared_ptr<replicant_returncode> > >::iterator tcp_iter;
+        std::map<int64_t, std::tr1::shared_ptr<replicant_returncode> >::iterator report_iter;
 
         if (lid == m_wait_config_id)
         {
@@ -613,6 +621,20 @@ coordinator_link :: wait_for_config(configuration* config)
                 case REPLICANT_SUCCESS:
                     break;
                 case REPLICANT_FUNC_NOT_FOUND:
+                    if (!m_get_config_full)
+                    {
+                        LOG(WARNING) << "coordinator missing \"get-config-delta\" function; "
+                                     << "falling back to \"get-config\"";
+                        m_get_config_full = true;
+
+                        if (initiate_get_config())
+                        {
+                            need_to_backoff = false;
+                        }
+
+                        continue;
+                    }
+
                     LOG(ERROR) << "coordinator missing \"get-config\" function: "
                                << m_repl->last_error().msg()
                                << "(" << m_get_config_status << ";"
@@ -656,7 +678,16 @@ coordinator_link :: wait_for_config(configuration* config)
             need_to_backoff = false;
             m_get_config_status = REPLICANT_GARBAGE;
             e::unpacker up(m_get_config_output, m_get_config_output_sz);
-            up = up >> *config;
+
+            if (m_get_config_full)
+            {
+                up = up >> *config;
+            }
+            else
+            {
+                up = unpack_config_update(up, *m_daemon->m_config, config);
+            }
+
             replicant_destroy_output(m_get_config_output, m_get_config_output_sz);
             m_get_config_output = NULL;
 
@@ -669,11 +700,11 @@ coordinator_link :: wait_for_config(configuration* config)
                 continue;
             }
 
-            if (m_daemon->m_config.cluster() != 0 &&
-                m_daemon->m_config.cluster() != config->cluster())
+            if (m_daemon->m_config->cluster() != 0 &&
+                m_daemon->m_config->cluster() != config->cluster())
             {
                 LOG(ERROR) << "coordinator has changed the cluster identity from "
-                           << m_daemon->m_config.cluster() << " to "
+                           << m_daemon->m_config->cluster() << " to "
                            << config->cluster() << "; treating it as failed";
                 retry = 10000000000;
                 need_to_backoff = true;
@@ -787,6 +818,15 @@ coordinator_link :: wait_for_config(configuration* config)
 
             m_tcp_disconnects.erase(tcp_iter);
         }
+        else if ((report_iter = m_reports.find(lid)) != m_reports.end())
+        {
+            if (*report_iter->second != REPLICANT_SUCCESS)
+            {
+                LOG(ERROR) << "could not report region load because " << *report_iter->second;
+            }
+
+            m_reports.erase(report_iter);
+        }
         else
         {
             LOG(ERROR) << "received event from replicant, but don't know where it came from";
@@ -954,7 +994,7 @@ bool
 coordinator_link :: initiate_wait_for_config()
 {
     m_wait_config_id = m_repl->wait("hyperdex", "config",
-                                    m_daemon->m_config.version(),
+                                    m_daemon->m_config->version(),
                                     &m_wait_config_status);
 
     if (m_wait_config_id < 0)
@@ -978,9 +1018,21 @@ coordinator_link :: initiate_get_config()
         m_get_config_output = NULL;
     }
 
-    m_get_config_id = m_repl->send("hyperdex", "get-config", "", 0,
-                                   &m_get_config_status,
-                                   &m_get_config_output, &m_get_config_output_sz);
+    char data[sizeof(uint64_t)];
+    e::pack64be(m_daemon->m_config->version(), data);
+
+    if (m_get_config_full)
+    {
+        m_get_config_id = m_repl->send("hyperdex", "get-config", "", 0,
+                                       &m_get_config_status,
+                                       &m_get_config_output, &m_get_config_output_sz);
+    }
+    else
+    {
+        m_get_config_id = m_repl->send("hyperdex", "get-config-delta", data, sizeof(uint64_t),
+                                       &m_get_config_status,
+                                       &m_get_config_output, &m_get_config_output_sz);
+    }
 
     if (m_get_config_id < 0)
     {
@@ -1055,7 +1107,7 @@ coordinator_link :: initiate_report_tcp_disconnect(const server_id& id)
 
     char buf[2 * sizeof(uint64_t)];
     e::pack64be(id.get(), buf);
-    e::pack64be(m_daemon->m_config.version(), buf + sizeof(uint64_t));
+    e::pack64be(m_daemon->m_config->version(), buf + sizeof(uint64_t));
     std::tr1::shared_ptr<replicant_returncode> ret(new replicant_returncode(REPLICANT_GARBAGE));
     int64_t req_id = m_repl->send("hyperdex", "server-suspect", buf, 2 * sizeof(uint64_t),
                                   ret.get(), NULL, NULL);
@@ -1069,3 +1121,74 @@ coordinator_link :: initiate_report_tcp_disconnect(const server_id& id)
         m_tcp_disconnects.insert(std::make_pair(req_id, std::make_pair(id, ret)));
     }
 }
+
+void
+coordinator_link :: initiate_report_load()
+{
+    // don't pile reports up behind a coordinator that isn't answering
+    if (!m_reports.empty())
+    {
+        return;
+    }
+
+    std::vector<region_id> regions;
+    m_daemon->m_config->mapped_regions(m_daemon->m_us, &regions);
+    std::map<region_id, uint64_t> ops;
+    m_daemon->m_data.region_ops(&ops);
+    uint64_t now = e::time();
+    uint64_t elapsed = now - m_report_time;
+    // Writes to a quiesced space are turned away, but those accepted before
+    // every thread saw the quiesce, or still working down the chain, must
+    // finish before the coordinator may restructure the space.
+    std::vector<region_id> quiesced;
+    m_daemon->m_config->quiesced_regions(&quiesced);
+    uint64_t drained = 0;
+
+    if (m_daemon->m_config.settled() && m_daemon->m_repl.drained(quiesced))
+    {
+        drained = m_daemon->m_config->version();
+    }
+
+    size_t sz = 3 * sizeof(uint64_t) + regions.size() * 3 * sizeof(uint64_t);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    e::buffer::packer pa = msg->pack_at(0);
+    pa = pa << m_daemon->m_us.get() << static_cast<uint64_t>(regions.size());
+
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+        std::map<region_id, uint64_t>::iterator cur = ops.find(regions[i]);
+        std::map<region_id, uint64_t>::iterator prev = m_report_ops.find(regions[i]);
+        uint64_t rate = 0;
+
+        // a rate needs two samples of the same region
+        if (cur != ops.end() && prev != m_report_ops.end() &&
+            m_report_time > 0 && elapsed > 0 && cur->second >= prev->second)
+        {
+            rate = (cur->second - prev->second) * 1000000000ULL / elapsed;
+        }
+
+        pa = pa << regions[i].get()
+                << m_daemon->m_data.approximate_size(regions[i])
+                << rate;
+    }
+
+    pa = pa << drained;
+    m_report_ops.swap(ops);
+    m_report_time = now;
+    std::tr1::shared_ptr<replicant_returncode> ret(new replicant_returncode(REPLICANT_GARBAGE));
+    int64_t req_id = m_repl->send("hyperdex", "server-report",
+                                  reinterpret_cast<const char*>(msg->data()), msg->size(),
+                                  ret.get(), NULL, NULL);
+
+    if (req_id < 0)
+    {
+        LOG(ERROR) << "could not report region load to the coordinator: "
+                   << m_repl->last_error().msg()
+                   << "(" << *ret << ";"
+                   << m_repl->last_error().loc() << ")";
+    }
+    else
+    {
+        m_reports.insert(std::make_pair(req_id, ret));
+    }
+}
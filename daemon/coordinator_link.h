@@ -79,6 +79,8 @@ class coordinator_link
         void initiate_transfer_go_live(const transfer_id& id);
         void initiate_transfer_complete(const transfer_id& id);
         void initiate_report_tcp_disconnect(const server_id& id);
+        // tell the coordinator how large and how busy our regions are
+        void initiate_report_load();
 
     private:
         daemon* m_daemon;
@@ -91,6 +93,7 @@ class coordinator_link
         replicant_returncode m_get_config_status;
         const char* m_get_config_output;
         size_t m_get_config_output_sz;
+        bool m_get_config_full;
         int64_t m_shutdown1_id;
         replicant_returncode m_shutdown1_status;
         const char* m_shutdown1_output;
@@ -108,6 +111,9 @@ class coordinator_link
         std::queue<transfer_id> m_queue_transfers_go_live;
         std::queue<transfer_id> m_queue_transfers_complete;
         std::queue<server_id> m_queue_tcp_disconnects;
+        uint64_t m_report_time;
+        std::map<region_id, uint64_t> m_report_ops;
+        std::map<int64_t, std::tr1::shared_ptr<replicant_returncode> > m_reports;
 
     private:
         coordinator_link(const coordinator_link&);
@@ -30,6 +30,7 @@
 #include <signal.h>
 
 // STL
+#include <list>
 #include <sstream>
 
 // Google Log
@@ -42,8 +43,10 @@
 
 // HyperDex
 #include "common/coordinator_returncode.h"
+#include "common/projection.h"
 #include "common/serialization.h"
 #include "daemon/daemon.h"
+#include "daemon/replication_manager_chain_batch.h"
 
 using hyperdex::daemon;
 
@@ -86,21 +89,31 @@ daemon :: daemon()
     , m_stm(this)
     , m_sm(this)
     , m_config()
+    , m_io()
     , m_perf_req_get()
+    , m_perf_req_get_many()
     , m_perf_req_atomic()
+    , m_perf_req_bulk_atomic()
     , m_perf_req_search_start()
     , m_perf_req_search_next()
     , m_perf_req_search_stop()
+    , m_perf_req_search_stream()
+    , m_perf_req_search_credit()
     , m_perf_req_sorted_search()
     , m_perf_req_group_del()
     , m_perf_req_count()
     , m_perf_req_search_describe()
+    , m_perf_req_aggregate()
+    , m_perf_req_group_atomic()
     , m_perf_chain_op()
     , m_perf_chain_subspace()
     , m_perf_chain_ack()
     , m_perf_chain_gc()
+    , m_perf_chain_batch()
+    , m_perf_group_keyop_ack()
     , m_perf_xfer_op()
     , m_perf_xfer_ack()
+    , m_perf_xfer_batch()
     , m_perf_perf_counters()
     , m_block_stat_path()
     , m_stat_collector(std::tr1::bind(&daemon::collect_stats, this))
@@ -149,7 +162,8 @@ daemon :: run(bool daemonize,
               po6::net::location bind_to,
               bool set_coordinator,
               po6::net::hostname coordinator,
-              unsigned threads)
+              unsigned threads,
+              const storage_options& storage)
 {
     if (!install_signal_handler(SIGHUP, exit_on_signal))
     {
@@ -228,7 +242,7 @@ daemon :: run(bool daemonize,
     po6::net::hostname saved_coordinator;
     LOG(INFO) << "initializing persistent storage";
 
-    if (!m_data.setup(data, &saved, &saved_us, &saved_bind_to, &saved_coordinator))
+    if (!m_data.setup(data, storage, &saved, &saved_us, &saved_bind_to, &saved_coordinator))
     {
         return EXIT_FAILURE;
     }
@@ -309,7 +323,7 @@ daemon :: run(bool daemonize,
 
     while (!m_coord.exit_wait_loop())
     {
-        configuration old_config = m_config;
+        configuration old_config = *m_config;
         configuration new_config;
 
         if (!m_coord.wait_for_config(&new_config))
@@ -325,6 +339,22 @@ daemon :: run(bool daemonize,
             continue;
         }
 
+        // When nothing changed in the spaces we serve, the managers have
+        // nothing to do; readers simply pick up the new snapshot with their
+        // next request.
+        if (!old_config.differs_for(m_us, new_config))
+        {
+            LOG(INFO) << "received new configuration version=" << new_config.version()
+                      << "; nothing we serve changed, so switching without pausing";
+            m_config.publish(new_config);
+            m_comm.reconfigure(old_config, new_config, m_us);
+            m_sm.reconfigure(old_config, new_config, m_us);
+            m_coord.ack_config(new_config.version());
+            continue;
+        }
+
+        // copy regions being split or merged while we still serve them
+        m_data.prepare_reconfigure(old_config, new_config, m_us);
         LOG(INFO) << "received new configuration version=" << new_config.version()
                   << "; pausing all activity while we reconfigure";
         m_stm.pause();
@@ -336,7 +366,7 @@ daemon :: run(bool daemonize,
         m_repl.reconfigure(old_config, new_config, m_us);
         m_stm.reconfigure(old_config, new_config, m_us);
         m_sm.reconfigure(old_config, new_config, m_us);
-        m_config = new_config;
+        m_config.publish(new_config);
         m_comm.unpause();
         m_data.unpause();
         m_repl.unpause();
@@ -423,82 +453,125 @@ daemon :: loop(size_t thread)
     {
         assert(from != server_id());
         assert(vto != virtual_server_id());
+        uint64_t start = e::time();
 
         switch (type)
         {
             case REQ_GET:
                 process_req_get(from, vfrom, vto, msg, up);
-                m_perf_req_get.tap();
+                m_perf_req_get.record(e::time() - start);
+                break;
+            case REQ_GET_MANY:
+                process_req_get_many(from, vfrom, vto, msg, up);
+                m_perf_req_get_many.record(e::time() - start);
                 break;
             case REQ_ATOMIC:
                 process_req_atomic(from, vfrom, vto, msg, up);
-                m_perf_req_atomic.tap();
+                m_perf_req_atomic.record(e::time() - start);
+                break;
+            case REQ_BULK_ATOMIC:
+                process_req_bulk_atomic(from, vfrom, vto, msg, up);
+                m_perf_req_bulk_atomic.record(e::time() - start);
                 break;
             case REQ_SEARCH_START:
                 process_req_search_start(from, vfrom, vto, msg, up);
-                m_perf_req_search_start.tap();
+                m_perf_req_search_start.record(e::time() - start);
                 break;
             case REQ_SEARCH_NEXT:
                 process_req_search_next(from, vfrom, vto, msg, up);
-                m_perf_req_search_next.tap();
+                m_perf_req_search_next.record(e::time() - start);
                 break;
             case REQ_SEARCH_STOP:
                 process_req_search_stop(from, vfrom, vto, msg, up);
-                m_perf_req_search_stop.tap();
+                m_perf_req_search_stop.record(e::time() - start);
+                break;
+            case REQ_SEARCH_STREAM:
+                process_req_search_stream(from, vfrom, vto, msg, up);
+                m_perf_req_search_stream.record(e::time() - start);
+                break;
+            case REQ_SEARCH_CREDIT:
+                process_req_search_credit(from, vfrom, vto, msg, up);
+                m_perf_req_search_credit.record(e::time() - start);
                 break;
             case REQ_SORTED_SEARCH:
                 process_req_sorted_search(from, vfrom, vto, msg, up);
-                m_perf_req_sorted_search.tap();
+                m_perf_req_sorted_search.record(e::time() - start);
                 break;
             case REQ_GROUP_DEL:
                 process_req_group_del(from, vfrom, vto, msg, up);
-                m_perf_req_group_del.tap();
+                m_perf_req_group_del.record(e::time() - start);
                 break;
             case REQ_COUNT:
                 process_req_count(from, vfrom, vto, msg, up);
-                m_perf_req_count.tap();
+                m_perf_req_count.record(e::time() - start);
                 break;
             case REQ_SEARCH_DESCRIBE:
                 process_req_search_describe(from, vfrom, vto, msg, up);
-                m_perf_req_search_describe.tap();
+                m_perf_req_search_describe.record(e::time() - start);
+                break;
+            case REQ_AGGREGATE:
+                process_req_aggregate(from, vfrom, vto, msg, up);
+                m_perf_req_aggregate.record(e::time() - start);
+                break;
+            case REQ_GROUP_ATOMIC:
+                process_req_group_atomic(from, vfrom, vto, msg, up);
+                m_perf_req_group_atomic.record(e::time() - start);
                 break;
             case CHAIN_OP:
-                process_chain_op(from, vfrom, vto, msg, up);
-                m_perf_chain_op.tap();
+                process_chain_op(from, vfrom, vto, msg, up, NULL);
+                m_perf_chain_op.record(e::time() - start);
                 break;
             case CHAIN_SUBSPACE:
-                process_chain_subspace(from, vfrom, vto, msg, up);
-                m_perf_chain_subspace.tap();
+                process_chain_subspace(from, vfrom, vto, msg, up, NULL);
+                m_perf_chain_subspace.record(e::time() - start);
                 break;
             case CHAIN_ACK:
-                process_chain_ack(from, vfrom, vto, msg, up);
-                m_perf_chain_ack.tap();
+                process_chain_ack(from, vfrom, vto, msg, up, NULL);
+                m_perf_chain_ack.record(e::time() - start);
                 break;
             case CHAIN_GC:
                 process_chain_gc(from, vfrom, vto, msg, up);
-                m_perf_chain_gc.tap();
+                m_perf_chain_gc.record(e::time() - start);
+                break;
+            case CHAIN_BATCH:
+                // records its own latency, less that of the ops it carries
+                process_chain_batch(from, vfrom, vto, msg, up);
+                break;
+            case GROUP_KEYOP_ACK:
+                process_group_keyop_ack(from, vfrom, vto, msg, up);
+                m_perf_group_keyop_ack.record(e::time() - start);
                 break;
             case XFER_OP:
                 process_xfer_op(from, vfrom, vto, msg, up);
-                m_perf_xfer_op.tap();
+                m_perf_xfer_op.record(e::time() - start);
                 break;
             case XFER_ACK:
                 process_xfer_ack(from, vfrom, vto, msg, up);
-                m_perf_xfer_ack.tap();
+                m_perf_xfer_ack.record(e::time() - start);
+                break;
+            case XFER_BATCH:
+                process_xfer_batch(from, vfrom, vto, msg, up);
+                m_perf_xfer_batch.record(e::time() - start);
                 break;
             case PERF_COUNTERS:
                 process_perf_counters(from, vfrom, vto, msg, up);
-                m_perf_perf_counters.tap();
+                m_perf_perf_counters.record(e::time() - start);
                 break;
             case RESP_GET:
+            case RESP_GET_MANY:
             case RESP_ATOMIC:
             case RESP_SEARCH_ITEM:
             case RESP_SEARCH_DONE:
+            case RESP_SEARCH_BATCH:
             case RESP_SORTED_SEARCH:
             case RESP_GROUP_DEL:
             case RESP_COUNT:
             case RESP_SEARCH_DESCRIBE:
+            case RESP_AGGREGATE:
             case CONFIGMISMATCH:
+                process_config_mismatch(from, vfrom, vto, msg, up);
+                break;
+            case RESP_GROUP_ATOMIC:
             case PACKET_NOP:
             default:
                 LOG(INFO) << "received " << type << " message which servers do not process";
@@ -506,6 +579,7 @@ daemon :: loop(size_t thread)
         }
     }
 
+    m_config.offline();
     LOG(INFO) << "network thread shutting down";
 }
 
@@ -518,6 +592,8 @@ daemon :: process_req_get(server_id from,
 {
     uint64_t nonce;
     e::slice key;
+    std::vector<uint16_t> projection;
+    bool projected = false;
 
     if ((up >> nonce >> key).error())
     {
@@ -525,15 +601,36 @@ daemon :: process_req_get(server_id from,
         return;
     }
 
+    // a trailing projection limits the attributes returned
+    if (up.remain() > 0)
+    {
+        const schema* sc = m_config->get_schema(m_config->get_region_id(vto));
+
+        if ((up >> projection).error() || !sc ||
+            !validate_projection(*sc, projection))
+        {
+            LOG(WARNING) << "unpack of REQ_GET failed; here's some hex:  " << msg->hex();
+            return;
+        }
+
+        projected = true;
+    }
+
     std::vector<e::slice> value;
     uint64_t version;
     datalayer::reference ref;
     network_returncode result;
 
-    switch (m_data.get(m_config.get_region_id(vto), key, &value, &version, &ref))
+    switch (m_data.get(m_config->get_region_id(vto), key, &value, &version, &ref))
     {
         case datalayer::SUCCESS:
             result = NET_SUCCESS;
+
+            if (projected)
+            {
+                apply_projection(projection, &value);
+            }
+
             break;
         case datalayer::NOT_FOUND:
             result = NET_NOTFOUND;
@@ -558,6 +655,92 @@ daemon :: process_req_get(server_id from,
     m_comm.send_client(vto, from, RESP_GET, msg);
 }
 
+void
+daemon :: process_req_get_many(server_id from,
+                               virtual_server_id,
+                               virtual_server_id vto,
+                               std::auto_ptr<e::buffer> msg,
+                               e::unpacker up)
+{
+    uint64_t nonce;
+    uint64_t count;
+
+    if ((up >> nonce >> count).error())
+    {
+        LOG(WARNING) << "unpack of REQ_GET_MANY failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    // every key is read from the same snapshot so that the batch observes a
+    // single point in time, and so that LevelDB pins one version for us
+    datalayer::snapshot snap = m_data.make_snapshot();
+    std::vector<e::slice> keys;
+    std::vector<std::vector<e::slice> > values;
+    std::list<datalayer::reference> refs;
+    network_returncode result = NET_SUCCESS;
+    size_t sz = HYPERDEX_HEADER_SIZE_VC
+              + sizeof(uint64_t)
+              + sizeof(uint16_t)
+              + sizeof(uint64_t);
+
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        virtual_server_id vsi;
+        e::slice key;
+
+        if ((up >> vsi >> key).error())
+        {
+            LOG(WARNING) << "unpack of REQ_GET_MANY failed; here's some hex:  " << msg->hex();
+            return;
+        }
+
+        // the client routed this key with a configuration that no longer
+        // places it here; say so, as REQ_GET would, so the client re-routes
+        // rather than report the object missing
+        if (m_config->get_server_id(vsi) != m_us)
+        {
+            result = result == NET_SUCCESS ? NET_NOTUS : result;
+            continue;
+        }
+
+        std::vector<e::slice> value;
+        uint64_t version;
+        refs.push_back(datalayer::reference());
+
+        switch (m_data.get(snap, m_config->get_region_id(vsi), key, &value, &version, &refs.back()))
+        {
+            case datalayer::SUCCESS:
+                keys.push_back(key);
+                values.push_back(value);
+                sz += pack_size(key) + pack_size(value);
+                break;
+            case datalayer::NOT_FOUND:
+                refs.pop_back();
+                break;
+            case datalayer::BAD_ENCODING:
+            case datalayer::CORRUPTION:
+            case datalayer::IO_ERROR:
+            case datalayer::LEVELDB_ERROR:
+            default:
+                LOG(ERROR) << "GET_MANY returned unacceptable error code.";
+                result = NET_SERVERERROR;
+                refs.pop_back();
+                break;
+        }
+    }
+
+    msg.reset(e::buffer::create(sz));
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_HEADER_SIZE_VC);
+    pa = pa << nonce << static_cast<uint16_t>(result) << static_cast<uint64_t>(keys.size());
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        pa = pa << keys[i] << values[i];
+    }
+
+    m_comm.send_client(vto, from, RESP_GET_MANY, msg);
+}
+
 void
 daemon :: process_req_atomic(server_id from,
                              virtual_server_id,
@@ -581,7 +764,54 @@ daemon :: process_req_atomic(server_id from,
     bool erase = !(flags & 128);
     bool fail_if_not_found = flags & 1;
     bool fail_if_found = flags & 2;
-    m_repl.client_atomic(from, vto, nonce, erase, fail_if_not_found, fail_if_found, key, checks, funcs);
+    m_repl.client_atomic(from, vto, vto, nonce, erase, fail_if_not_found, fail_if_found, key, checks, funcs, NULL);
+}
+
+void
+daemon :: process_req_bulk_atomic(server_id from,
+                                  virtual_server_id,
+                                  virtual_server_id vto,
+                                  std::auto_ptr<e::buffer> msg,
+                                  e::unpacker up)
+{
+    uint64_t nonce;
+    uint64_t count;
+
+    // the nonce in the header is that of the first operation; each operation
+    // carries its own below
+    if ((up >> nonce >> count).error())
+    {
+        LOG(WARNING) << "unpack of REQ_BULK_ATOMIC failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    // Each operation is an independent REQ_ATOMIC that carries its own
+    // virtual server and nonce; the client gets a RESP_ATOMIC for each one.
+    // The resulting CHAIN_* messages are collected so that all operations
+    // headed down the same chain travel together.
+    replication_manager::chain_batch batch(&m_comm);
+
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        virtual_server_id vsi;
+        uint64_t nonce;
+        e::slice key;
+        uint8_t flags;
+        std::vector<attribute_check> checks;
+        std::vector<funcall> funcs;
+        up = up >> vsi >> nonce >> key >> flags >> checks >> funcs;
+
+        if (up.error())
+        {
+            LOG(WARNING) << "unpack of REQ_BULK_ATOMIC failed; here's some hex:  " << msg->hex();
+            return;
+        }
+
+        bool erase = !(flags & 128);
+        bool fail_if_not_found = flags & 1;
+        bool fail_if_found = flags & 2;
+        m_repl.client_atomic(from, vto, vsi, nonce, erase, fail_if_not_found, fail_if_found, key, checks, funcs, &batch);
+    }
 }
 
 void
@@ -623,6 +853,63 @@ daemon :: process_req_search_next(server_id from,
     m_sm.next(from, vto, nonce, search_id);
 }
 
+void
+daemon :: process_req_search_stream(server_id from,
+                                    virtual_server_id,
+                                    virtual_server_id vto,
+                                    std::auto_ptr<e::buffer> msg,
+                                    e::unpacker up)
+{
+    uint64_t nonce;
+    uint64_t search_id;
+    uint64_t credits;
+    uint64_t batch_objects;
+    uint64_t batch_bytes;
+    std::vector<attribute_check> checks;
+    std::vector<uint16_t> projection;
+    bool projected = false;
+
+    if ((up >> nonce >> search_id >> credits >> batch_objects >> batch_bytes >> checks).error())
+    {
+        LOG(WARNING) << "unpack of REQ_SEARCH_STREAM failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    if (up.remain() > 0)
+    {
+        if ((up >> projection).error())
+        {
+            LOG(WARNING) << "unpack of REQ_SEARCH_STREAM failed; here's some hex:  " << msg->hex();
+            return;
+        }
+
+        projected = true;
+    }
+
+    m_sm.stream(from, vto, msg, nonce, credits, search_id, batch_objects, batch_bytes,
+                &checks, projected ? &projection : NULL);
+}
+
+void
+daemon :: process_req_search_credit(server_id from,
+                                    virtual_server_id,
+                                    virtual_server_id vto,
+                                    std::auto_ptr<e::buffer> msg,
+                                    e::unpacker up)
+{
+    uint64_t nonce;
+    uint64_t search_id;
+    uint64_t credits;
+
+    if ((up >> nonce >> search_id >> credits).error())
+    {
+        LOG(WARNING) << "unpack of REQ_SEARCH_CREDIT failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    m_sm.credit(from, vto, nonce, credits, search_id);
+}
+
 void
 daemon :: process_req_search_stop(server_id from,
                                   virtual_server_id,
@@ -654,6 +941,8 @@ daemon :: process_req_sorted_search(server_id from,
     uint64_t limit;
     uint16_t sort_by;
     uint8_t flags;
+    std::vector<uint16_t> projection;
+    bool projected = false;
 
     if ((up >> nonce >> checks >> limit >> sort_by >> flags).error())
     {
@@ -661,7 +950,19 @@ daemon :: process_req_sorted_search(server_id from,
         return;
     }
 
-    m_sm.sorted_search(from, vto, nonce, &checks, limit, sort_by, flags & 0x1);
+    if (up.remain() > 0)
+    {
+        if ((up >> projection).error())
+        {
+            LOG(WARNING) << "unpack of REQ_SORTED_SEARCH failed; here's some hex:  " << msg->hex();
+            return;
+        }
+
+        projected = true;
+    }
+
+    m_sm.sorted_search(from, vto, nonce, &checks, limit, sort_by, flags & 0x1,
+                       projected ? &projection : NULL);
 }
 
 void
@@ -680,8 +981,30 @@ daemon :: process_req_group_del(server_id from,
         return;
     }
 
-    e::slice sl("\x01\x00\x00\x00\x00\x00\x00\x00\x00", 9);
-    m_sm.group_keyop(from, vto, nonce, &checks, REQ_ATOMIC, sl, RESP_GROUP_DEL);
+    // erase (no 128 bit), failing for objects deleted out from under us
+    std::vector<funcall> funcs;
+    m_sm.group_keyop(from, vto, nonce, &checks, 1, funcs, RESP_GROUP_DEL);
+}
+
+void
+daemon :: process_req_group_atomic(server_id from,
+                                   virtual_server_id,
+                                   virtual_server_id vto,
+                                   std::auto_ptr<e::buffer> msg,
+                                   e::unpacker up)
+{
+    uint64_t nonce;
+    std::vector<attribute_check> checks;
+    uint8_t flags;
+    std::vector<funcall> funcs;
+
+    if ((up >> nonce >> checks >> flags >> funcs).error())
+    {
+        LOG(WARNING) << "unpack of REQ_GROUP_ATOMIC failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    m_sm.group_keyop(from, vto, nonce, &checks, flags, funcs, RESP_GROUP_ATOMIC);
 }
 
 void
@@ -703,6 +1026,27 @@ daemon :: process_req_count(server_id from,
     m_sm.count(from, vto, nonce, &checks);
 }
 
+void
+daemon :: process_req_aggregate(server_id from,
+                                virtual_server_id,
+                                virtual_server_id vto,
+                                std::auto_ptr<e::buffer> msg,
+                                e::unpacker up)
+{
+    uint64_t nonce;
+    std::vector<attribute_check> checks;
+    std::vector<aggregate> aggs;
+    uint16_t group_by;
+
+    if ((up >> nonce >> checks >> aggs >> group_by).error())
+    {
+        LOG(WARNING) << "unpack of REQ_AGGREGATE failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    m_sm.aggregate(from, vto, nonce, &checks, aggs, group_by);
+}
+
 void
 daemon :: process_req_search_describe(server_id from,
                                       virtual_server_id,
@@ -727,7 +1071,8 @@ daemon :: process_chain_op(server_id,
                            virtual_server_id vfrom,
                            virtual_server_id vto,
                            std::auto_ptr<e::buffer> msg,
-                           e::unpacker up)
+                           e::unpacker up,
+                           replication_manager::chain_batch* batch)
 {
     uint8_t flags;
     uint64_t reg_id;
@@ -745,7 +1090,7 @@ daemon :: process_chain_op(server_id,
     bool fresh = flags & 1;
     bool has_value = flags & 2;
     bool retransmission = flags & 128;
-    m_repl.chain_op(vfrom, vto, retransmission, region_id(reg_id), seq_id, version, fresh, has_value, msg, key, value);
+    m_repl.chain_op(vfrom, vto, retransmission, region_id(reg_id), seq_id, version, fresh, has_value, msg, key, value, batch);
 }
 
 void
@@ -753,7 +1098,8 @@ daemon :: process_chain_subspace(server_id,
                                  virtual_server_id vfrom,
                                  virtual_server_id vto,
                                  std::auto_ptr<e::buffer> msg,
-                                 e::unpacker up)
+                                 e::unpacker up,
+                                 replication_manager::chain_batch* batch)
 {
     uint8_t flags;
     uint64_t reg_id;
@@ -770,7 +1116,7 @@ daemon :: process_chain_subspace(server_id,
     }
 
     bool retransmission = flags & 128;
-    m_repl.chain_subspace(vfrom, vto, retransmission, region_id(reg_id), seq_id, version, msg, key, value, hashes);
+    m_repl.chain_subspace(vfrom, vto, retransmission, region_id(reg_id), seq_id, version, msg, key, value, hashes, batch);
 }
 
 void
@@ -788,7 +1134,7 @@ daemon :: process_chain_gc(server_id,
         return;
     }
 
-    region_id ri = m_config.get_region_id(vfrom);
+    region_id ri = m_config->get_region_id(vfrom);
     m_repl.chain_gc(ri, seq_id);
 }
 
@@ -797,7 +1143,8 @@ daemon :: process_chain_ack(server_id,
                             virtual_server_id vfrom,
                             virtual_server_id vto,
                             std::auto_ptr<e::buffer> msg,
-                            e::unpacker up)
+                            e::unpacker up,
+                            replication_manager::chain_batch* batch)
 {
     uint8_t flags;
     uint64_t reg_id;
@@ -812,7 +1159,114 @@ daemon :: process_chain_ack(server_id,
     }
 
     bool retransmission = flags & 128;
-    m_repl.chain_ack(vfrom, vto, retransmission, region_id(reg_id), seq_id, version, key);
+    m_repl.chain_ack(vfrom, vto, retransmission, region_id(reg_id), seq_id, version, key, batch);
+}
+
+void
+daemon :: process_chain_batch(server_id from,
+                              virtual_server_id vfrom,
+                              virtual_server_id vto,
+                              std::auto_ptr<e::buffer> msg,
+                              e::unpacker up)
+{
+    uint64_t batch_start = e::time();
+    uint64_t in_ops = 0;
+    uint32_t count;
+
+    if ((up >> count).error())
+    {
+        LOG(WARNING) << "unpack of CHAIN_BATCH failed; here's some hex:  " << msg->hex();
+        m_perf_chain_batch.record(e::time() - batch_start);
+        return;
+    }
+
+    // forward whatever the batch generates as a batch of its own, so that the
+    // operations stay together all the way down the chain
+    replication_manager::chain_batch batch(&m_comm);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint8_t type;
+        e::slice body;
+
+        if ((up >> type >> body).error())
+        {
+            LOG(WARNING) << "unpack of CHAIN_BATCH failed; here's some hex:  " << msg->hex();
+            m_perf_chain_batch.record(e::time() - batch_start - in_ops);
+            return;
+        }
+
+        // every operation owns its backing, so give each its own buffer laid
+        // out exactly like a standalone message
+        std::auto_ptr<e::buffer> sub(e::buffer::create(HYPERDEX_HEADER_SIZE_VV + body.size()));
+        sub->pack_at(HYPERDEX_HEADER_SIZE_VV).copy(body);
+        e::unpacker sup = sub->unpack_from(HYPERDEX_HEADER_SIZE_VV);
+        uint64_t start = e::time();
+
+        switch (static_cast<network_msgtype>(type))
+        {
+            case CHAIN_OP:
+                process_chain_op(from, vfrom, vto, sub, sup, &batch);
+                m_perf_chain_op.record(e::time() - start);
+                break;
+            case CHAIN_SUBSPACE:
+                process_chain_subspace(from, vfrom, vto, sub, sup, &batch);
+                m_perf_chain_subspace.record(e::time() - start);
+                break;
+            case CHAIN_ACK:
+                process_chain_ack(from, vfrom, vto, sub, sup, &batch);
+                m_perf_chain_ack.record(e::time() - start);
+                break;
+            default:
+                LOG(WARNING) << "CHAIN_BATCH carried a " << static_cast<network_msgtype>(type)
+                             << " message, which cannot be batched";
+                break;
+        }
+
+        in_ops += e::time() - start;
+    }
+
+    m_perf_chain_batch.record(e::time() - batch_start - in_ops);
+}
+
+void
+daemon :: process_group_keyop_ack(server_id,
+                                  virtual_server_id,
+                                  virtual_server_id,
+                                  std::auto_ptr<e::buffer> msg,
+                                  e::unpacker up)
+{
+    uint64_t nonce;
+    uint16_t result;
+
+    if ((up >> nonce >> result).error())
+    {
+        LOG(WARNING) << "unpack of GROUP_KEYOP_ACK failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    m_sm.group_keyop_ack(nonce, static_cast<network_returncode>(result));
+}
+
+void
+daemon :: process_config_mismatch(server_id,
+                                  virtual_server_id,
+                                  virtual_server_id,
+                                  std::auto_ptr<e::buffer> msg,
+                                  e::unpacker up)
+{
+    uint64_t group_id;
+    uint64_t count;
+
+    // the only client-style message a daemon sends is a group_keyop's
+    // REQ_BULK_ATOMIC, whose header nonce is the group's id
+    if ((up >> group_id >> count).error())
+    {
+        LOG(WARNING) << "unpack of CONFIGMISMATCH failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    m_sm.group_keyop_bounced(group_id, count);
 }
 
 void
@@ -856,7 +1310,27 @@ daemon :: process_xfer_ack(server_id from,
         return;
     }
 
-    m_stm.xfer_ack(from, vto, transfer_id(xid), seq_no);
+    bool cumulative = flags & 1;
+    m_stm.xfer_ack(from, vto, transfer_id(xid), seq_no, cumulative);
+}
+
+void
+daemon :: process_xfer_batch(server_id,
+                             virtual_server_id vfrom,
+                             virtual_server_id,
+                             std::auto_ptr<e::buffer> msg,
+                             e::unpacker up)
+{
+    uint8_t flags;
+    uint64_t xid;
+
+    if ((up >> flags >> xid).error())
+    {
+        LOG(WARNING) << "unpack of XFER_BATCH failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    m_stm.xfer_batch(vfrom, transfer_id(xid), msg, up);
 }
 
 void
@@ -939,10 +1413,24 @@ daemon :: collect_stats()
             continue;
         }
 
+        // background work turned away by the scheduler waits for this
+        if (m_io.tick())
+        {
+            m_stm.kick();
+            // stalled group scans resume here, on this thread
+            m_config.online();
+            m_sm.kick();
+            m_config.offline();
+        }
+
+        // snapshots still in use when they were replaced
+        m_config.reclaim();
+
         // collect the stats
         std::ostringstream ret;
         ret << target;
         collect_stats_msgs(&ret);
+        m_repl.collect_stats(&ret);
         collect_stats_leveldb(&ret);
         collect_stats_io(&ret);
         ret << "\n";
@@ -964,22 +1452,56 @@ daemon :: collect_stats()
 void
 daemon :: collect_stats_msgs(std::ostringstream* ret)
 {
-    *ret << " msgs.req_get=" << m_perf_req_get.read();
-    *ret << " msgs.req_atomic=" << m_perf_req_atomic.read();
-    *ret << " msgs.req_search_start=" << m_perf_req_search_start.read();
-    *ret << " msgs.req_search_next=" << m_perf_req_search_next.read();
-    *ret << " msgs.req_search_stop=" << m_perf_req_search_stop.read();
-    *ret << " msgs.req_sorted_search=" << m_perf_req_sorted_search.read();
-    *ret << " msgs.req_group_del=" << m_perf_req_group_del.read();
-    *ret << " msgs.req_count=" << m_perf_req_count.read();
-    *ret << " msgs.req_search_describe=" << m_perf_req_search_describe.read();
-    *ret << " msgs.chain_op=" << m_perf_chain_op.read();
-    *ret << " msgs.chain_subspace=" << m_perf_chain_subspace.read();
-    *ret << " msgs.chain_ack=" << m_perf_chain_ack.read();
-    *ret << " msgs.chain_gc=" << m_perf_chain_gc.read();
-    *ret << " msgs.xfer_op=" << m_perf_xfer_op.read();
-    *ret << " msgs.xfer_ack=" << m_perf_xfer_ack.read();
-    *ret << " msgs.perf_counters=" << m_perf_perf_counters.read();
+    *ret << " msgs.req_get=" << m_perf_req_get.count();
+    *ret << " msgs.req_get_many=" << m_perf_req_get_many.count();
+    *ret << " msgs.req_atomic=" << m_perf_req_atomic.count();
+    *ret << " msgs.req_bulk_atomic=" << m_perf_req_bulk_atomic.count();
+    *ret << " msgs.req_search_start=" << m_perf_req_search_start.count();
+    *ret << " msgs.req_search_next=" << m_perf_req_search_next.count();
+    *ret << " msgs.req_search_stop=" << m_perf_req_search_stop.count();
+    *ret << " msgs.req_search_stream=" << m_perf_req_search_stream.count();
+    *ret << " msgs.req_search_credit=" << m_perf_req_search_credit.count();
+    *ret << " msgs.req_sorted_search=" << m_perf_req_sorted_search.count();
+    *ret << " msgs.req_group_del=" << m_perf_req_group_del.count();
+    *ret << " msgs.req_count=" << m_perf_req_count.count();
+    *ret << " msgs.req_search_describe=" << m_perf_req_search_describe.count();
+    *ret << " msgs.req_aggregate=" << m_perf_req_aggregate.count();
+    *ret << " msgs.req_group_atomic=" << m_perf_req_group_atomic.count();
+    *ret << " msgs.chain_op=" << m_perf_chain_op.count();
+    *ret << " msgs.chain_subspace=" << m_perf_chain_subspace.count();
+    *ret << " msgs.chain_ack=" << m_perf_chain_ack.count();
+    *ret << " msgs.chain_gc=" << m_perf_chain_gc.count();
+    *ret << " msgs.chain_batch=" << m_perf_chain_batch.count();
+    *ret << " msgs.group_keyop_ack=" << m_perf_group_keyop_ack.count();
+    *ret << " msgs.xfer_op=" << m_perf_xfer_op.count();
+    *ret << " msgs.xfer_ack=" << m_perf_xfer_ack.count();
+    *ret << " msgs.xfer_batch=" << m_perf_xfer_batch.count();
+    *ret << " msgs.perf_counters=" << m_perf_perf_counters.count();
+    m_perf_req_get.summarize("lat.req_get", ret);
+    m_perf_req_get_many.summarize("lat.req_get_many", ret);
+    m_perf_req_atomic.summarize("lat.req_atomic", ret);
+    m_perf_req_bulk_atomic.summarize("lat.req_bulk_atomic", ret);
+    m_perf_req_search_start.summarize("lat.req_search_start", ret);
+    m_perf_req_search_next.summarize("lat.req_search_next", ret);
+    m_perf_req_search_stop.summarize("lat.req_search_stop", ret);
+    m_perf_req_search_stream.summarize("lat.req_search_stream", ret);
+    m_perf_req_search_credit.summarize("lat.req_search_credit", ret);
+    m_perf_req_sorted_search.summarize("lat.req_sorted_search", ret);
+    m_perf_req_group_del.summarize("lat.req_group_del", ret);
+    m_perf_req_count.summarize("lat.req_count", ret);
+    m_perf_req_search_describe.summarize("lat.req_search_describe", ret);
+    m_perf_req_aggregate.summarize("lat.req_aggregate", ret);
+    m_perf_req_group_atomic.summarize("lat.req_group_atomic", ret);
+    m_perf_chain_op.summarize("lat.chain_op", ret);
+    m_perf_chain_subspace.summarize("lat.chain_subspace", ret);
+    m_perf_chain_ack.summarize("lat.chain_ack", ret);
+    m_perf_chain_gc.summarize("lat.chain_gc", ret);
+    m_perf_chain_batch.summarize("lat.chain_batch", ret);
+    m_perf_group_keyop_ack.summarize("lat.group_keyop_ack", ret);
+    m_perf_xfer_op.summarize("lat.xfer_op", ret);
+    m_perf_xfer_ack.summarize("lat.xfer_ack", ret);
+    m_perf_xfer_batch.summarize("lat.xfer_batch", ret);
+    m_perf_perf_counters.summarize("lat.perf_counters", ret);
 }
 
 namespace
@@ -1001,6 +1523,7 @@ void
 daemon :: collect_stats_leveldb(std::ostringstream* ret)
 {
     *ret << " leveldb.size=" << m_data.approximate_size();
+    m_data.collect_stats(ret);
     std::string tmp;
 
     if (m_data.get_property(e::slice("leveldb.stats"), &tmp))
@@ -1181,6 +1704,8 @@ daemon :: determine_block_stat_path(const po6::pathname& data)
 void
 daemon :: collect_stats_io(std::ostringstream* ret)
 {
+    m_io.collect_stats(ret);
+
     if (m_block_stat_path.empty())
     {
         return;
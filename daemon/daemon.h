@@ -47,10 +47,13 @@
 #include "daemon/communication.h"
 #include "daemon/coordinator_link.h"
 #include "daemon/datalayer.h"
-#include "daemon/performance_counter.h"
+#include "daemon/io_scheduler.h"
+#include "daemon/latency_histogram.h"
+#include "daemon/published_config.h"
 #include "daemon/replication_manager.h"
 #include "daemon/search_manager.h"
 #include "daemon/state_transfer_manager.h"
+#include "daemon/storage_options.h"
 
 BEGIN_HYPERDEX_NAMESPACE
 
@@ -67,26 +70,37 @@ class daemon
                 po6::net::location bind_to,
                 bool set_coordinator,
                 po6::net::hostname coordinator,
-                unsigned threads);
+                unsigned threads,
+                const storage_options& storage);
 
     private:
         void loop(size_t thread);
         void process_req_get(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_req_get_many(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_atomic(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_req_bulk_atomic(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_search_start(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_search_next(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_req_search_stream(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_req_search_credit(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_search_stop(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_sorted_search(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_group_del(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_count(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_search_describe(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
-        void process_chain_op(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
-        void process_chain_subspace(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
-        void process_chain_ack(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_req_aggregate(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_req_group_atomic(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_chain_op(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up, replication_manager::chain_batch* batch);
+        void process_chain_subspace(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up, replication_manager::chain_batch* batch);
+        void process_chain_ack(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up, replication_manager::chain_batch* batch);
+        void process_chain_batch(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_chain_gc(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_group_keyop_ack(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_xfer_op(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_xfer_ack(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_xfer_batch(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_perf_counters(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_config_mismatch(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
 
     private:
         void collect_stats();
@@ -112,24 +126,34 @@ class daemon
         replication_manager m_repl;
         state_transfer_manager m_stm;
         search_manager m_sm;
-        configuration m_config;
-        // counters
-        performance_counter m_perf_req_get;
-        performance_counter m_perf_req_atomic;
-        performance_counter m_perf_req_search_start;
-        performance_counter m_perf_req_search_next;
-        performance_counter m_perf_req_search_stop;
-        performance_counter m_perf_req_sorted_search;
-        performance_counter m_perf_req_group_del;
-        performance_counter m_perf_req_count;
-        performance_counter m_perf_req_search_describe;
-        performance_counter m_perf_chain_op;
-        performance_counter m_perf_chain_subspace;
-        performance_counter m_perf_chain_ack;
-        performance_counter m_perf_chain_gc;
-        performance_counter m_perf_xfer_op;
-        performance_counter m_perf_xfer_ack;
-        performance_counter m_perf_perf_counters;
+        published_config m_config;
+        io_scheduler m_io;
+        // message counts and the time taken to handle each message
+        latency_histogram m_perf_req_get;
+        latency_histogram m_perf_req_get_many;
+        latency_histogram m_perf_req_atomic;
+        latency_histogram m_perf_req_bulk_atomic;
+        latency_histogram m_perf_req_search_start;
+        latency_histogram m_perf_req_search_next;
+        latency_histogram m_perf_req_search_stop;
+        latency_histogram m_perf_req_search_stream;
+        latency_histogram m_perf_req_search_credit;
+        latency_histogram m_perf_req_sorted_search;
+        latency_histogram m_perf_req_group_del;
+        latency_histogram m_perf_req_count;
+        latency_histogram m_perf_req_search_describe;
+        latency_histogram m_perf_req_aggregate;
+        latency_histogram m_perf_req_group_atomic;
+        latency_histogram m_perf_chain_op;
+        latency_histogram m_perf_chain_subspace;
+        latency_histogram m_perf_chain_ack;
+        latency_histogram m_perf_chain_gc;
+        latency_histogram m_perf_chain_batch;
+        latency_histogram m_perf_group_keyop_ack;
+        latency_histogram m_perf_xfer_op;
+        latency_histogram m_perf_xfer_ack;
+        latency_histogram m_perf_xfer_batch;
+        latency_histogram m_perf_perf_counters;
         // iostat-like stats
         std::string m_block_stat_path;
         // historical data
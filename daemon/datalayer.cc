@@ -36,6 +36,8 @@
 
 // STL
 #include <algorithm>
+#include <iterator>
+#include <memory>
 #include <sstream>
 #include <string>
 
@@ -43,14 +45,18 @@
 #include <glog/logging.h>
 
 // LevelDB
+#include <hyperleveldb/cache.h>
 #include <hyperleveldb/write_batch.h>
 #include <hyperleveldb/filter_policy.h>
 
 // e
+#include <e/atomic.h>
 #include <e/endian.h>
+#include <e/time.h>
 
 // HyperDex
 #include "common/datatypes.h"
+#include "common/hash.h"
 #include "common/macros.h"
 #include "common/range_searches.h"
 #include "common/serialization.h"
@@ -66,8 +72,12 @@ using hyperdex::reconfigure_returncode;
 
 datalayer :: datalayer(daemon* d)
     : m_daemon(d)
+    , m_cache(NULL)
     , m_db()
     , m_counters()
+    , m_region_ops()
+    , m_stats()
+    , m_objects()
     , m_cleaner(std::tr1::bind(&datalayer::cleaner, this))
     , m_block_cleaner()
     , m_wakeup_cleaner(&m_block_cleaner)
@@ -77,6 +87,19 @@ datalayer :: datalayer(daemon* d)
     , m_need_pause(false)
     , m_paused(false)
     , m_state_transfer_captures()
+    , m_dropped_regions()
+    , m_rekey_mtx()
+    , m_rekey_watching(0)
+    , m_rekey_touched()
+    , m_rekey_cleared()
+    , m_rekey_copied()
+    , m_commit_mtx()
+    , m_commit_queue()
+    , m_perf_commits()
+    , m_perf_commit_writes()
+    , m_perf_commit_wait()
+    , m_perf_leveldb_get()
+    , m_perf_leveldb_write()
 {
 }
 
@@ -85,17 +108,105 @@ datalayer :: ~datalayer() throw ()
     shutdown();
 }
 
+class datalayer::counting_cache : public leveldb::Cache
+{
+    public:
+        counting_cache(size_t capacity)
+            : lookups(), hits(), m_capacity(capacity), m_cache(leveldb::NewLRUCache(capacity)) {}
+        virtual ~counting_cache() throw () {}
+
+    public:
+        virtual Handle* Insert(const leveldb::Slice& key, void* value, size_t charge,
+                               void (*deleter)(const leveldb::Slice& key, void* value))
+        { return m_cache->Insert(key, value, charge, deleter); }
+        virtual Handle* Lookup(const leveldb::Slice& key)
+        {
+            Handle* h = m_cache->Lookup(key);
+            lookups.tap();
+            if (h) hits.tap();
+            return h;
+        }
+        virtual void Release(Handle* handle) { m_cache->Release(handle); }
+        virtual void* Value(Handle* handle) { return m_cache->Value(handle); }
+        virtual void Erase(const leveldb::Slice& key) { m_cache->Erase(key); }
+        virtual uint64_t NewId() { return m_cache->NewId(); }
+
+    public:
+        size_t capacity() const { return m_capacity; }
+
+    public:
+        performance_counter lookups;
+        performance_counter hits;
+
+    private:
+        counting_cache(const counting_cache&);
+        counting_cache& operator = (const counting_cache&);
+
+    private:
+        size_t m_capacity;
+        const std::auto_ptr<leveldb::Cache> m_cache;
+};
+
+namespace
+{
+
+// The cache and filter policy must outlive the DB, which outlives the
+// datalayer while snapshots remain.  Tie them together.
+class db_deleter
+{
+    public:
+        db_deleter(leveldb::Cache* cache, const leveldb::FilterPolicy* policy)
+            : m_cache(cache), m_policy(policy) {}
+
+    public:
+        void operator () (leveldb::DB* db)
+        {
+            delete db;
+            delete m_cache;
+            delete m_policy;
+        }
+
+    private:
+        leveldb::Cache* m_cache;
+        const leveldb::FilterPolicy* m_policy;
+};
+
+} // namespace
+
 bool
 datalayer :: setup(const po6::pathname& path,
+                   const storage_options& overrides,
                    bool* saved,
                    server_id* saved_us,
                    po6::net::location* saved_bind_to,
                    po6::net::hostname* saved_coordinator)
 {
+    storage_options so;
+
+    if (!so.load(path))
+    {
+        LOG(ERROR) << "could not parse the storage options saved in " << path.get();
+        return false;
+    }
+
+    so.override_with(overrides);
+    std::auto_ptr<counting_cache> cache(new counting_cache(so.block_cache_size));
+    std::auto_ptr<const leveldb::FilterPolicy> policy;
+
+    if (so.bloom_bits > 0)
+    {
+        policy.reset(leveldb::NewBloomFilterPolicy(so.bloom_bits));
+    }
+
     leveldb::Options opts;
-    opts.write_buffer_size = 64ULL * 1024ULL * 1024ULL;
+    opts.write_buffer_size = so.write_buffer_size;
+    opts.max_open_files = so.max_open_files;
+    opts.block_cache = cache.get();
+    opts.block_size = so.block_size;
+    opts.compression = so.compression ? leveldb::kSnappyCompression
+                                      : leveldb::kNoCompression;
     opts.create_if_missing = true;
-    opts.filter_policy = leveldb::NewBloomFilterPolicy(10);
+    opts.filter_policy = policy.get();
     std::string name(path.get());
     leveldb::DB* tmp_db;
     leveldb::Status st = leveldb::DB::Open(opts, name, &tmp_db);
@@ -106,7 +217,18 @@ datalayer :: setup(const po6::pathname& path,
         return false;
     }
 
-    m_db.reset(tmp_db);
+    LOG(INFO) << "opened LevelDB with storage options:\n" << so;
+    m_objects.set_capacity(so.object_cache_size);
+    m_cache = cache.get();
+    m_db.reset(tmp_db, db_deleter(cache.release(), policy.release()));
+
+    // LevelDB has created the directory by now, even on first start
+    if (overrides.any_set() && !so.save(path))
+    {
+        LOG(ERROR) << "could not save the storage options to " << path.get();
+        return false;
+    }
+
     leveldb::ReadOptions ropts;
     ropts.fill_cache = true;
     ropts.verify_checksums = true;
@@ -223,12 +345,30 @@ datalayer :: setup(const po6::pathname& path,
         return false;
     }
 
+    // the index statistics are advisory; start afresh if they're unusable
+    std::string tbacking;
+    st = m_db->Get(ropts, leveldb::Slice("stats", 5), &tbacking);
+
+    if (st.ok() && !m_stats.deserialize(e::slice(tbacking)))
+    {
+        LOG(WARNING) << "discarding invalid index statistics";
+    }
+    else if (!st.ok() && !st.IsNotFound())
+    {
+        LOG(WARNING) << "could not restore index statistics: " << st.ToString();
+    }
+
     return true;
 }
 
 void
 datalayer :: teardown()
 {
+    if (m_db)
+    {
+        save_stats();
+    }
+
     shutdown();
 }
 
@@ -323,6 +463,7 @@ datalayer :: save_state(const server_id& us,
 
     if (st.ok())
     {
+        save_stats();
         return true;
     }
     else if (st.IsNotFound())
@@ -405,8 +546,182 @@ datalayer :: unpause()
     m_need_cleaning = true;
 }
 
+namespace
+{
+
+// regions whose data belongs on "us":  those we replicate and those we are
+// transferring in or out
+void
+held_regions(const hyperdex::configuration& config,
+             const hyperdex::server_id& us,
+             std::vector<hyperdex::region_id>* regions)
+{
+    config.mapped_regions(us, regions);
+    std::vector<hyperdex::transfer> transfers;
+    config.transfer_in_regions(us, &transfers);
+    config.transfer_out_regions(us, &transfers);
+
+    for (size_t i = 0; i < transfers.size(); ++i)
+    {
+        regions->push_back(transfers[i].rid);
+    }
+
+    std::sort(regions->begin(), regions->end());
+    regions->erase(std::unique(regions->begin(), regions->end()), regions->end());
+}
+
+const hyperdex::region*
+find_region(const hyperdex::subspace& sub, const hyperdex::region_id& ri)
+{
+    for (size_t i = 0; i < sub.regions.size(); ++i)
+    {
+        if (sub.regions[i].id == ri)
+        {
+            return &sub.regions[i];
+        }
+    }
+
+    return NULL;
+}
+
+bool
+overlaps(const hyperdex::region& lhs, const hyperdex::region& rhs)
+{
+    for (size_t i = 0; i < lhs.lower_coord.size() && i < rhs.lower_coord.size(); ++i)
+    {
+        if (lhs.upper_coord[i] < rhs.lower_coord[i] ||
+            rhs.upper_coord[i] < lhs.lower_coord[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+covers(const hyperdex::subspace& sub,
+       const hyperdex::region& r,
+       const std::vector<uint64_t>& hashes)
+{
+    for (size_t i = 0; i < sub.attrs.size(); ++i)
+    {
+        uint64_t h = hashes[sub.attrs[i]];
+
+        if (h < r.lower_coord[i] || r.upper_coord[i] < h)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+void
+datalayer :: plan_rekeys(const configuration& old_config,
+                         const configuration& new_config,
+                         const server_id& us,
+                         std::vector<rekey_plan_t>* plan)
+{
+    std::vector<region_id> old_held;
+    std::vector<region_id> new_held;
+    held_regions(old_config, us, &old_held);
+    held_regions(new_config, us, &new_held);
+    std::vector<region_id> dropped;
+    std::set_difference(old_held.begin(), old_held.end(),
+                        new_held.begin(), new_held.end(),
+                        std::back_inserter(dropped));
+
+    // A region that appears here without a transfer into it was split or
+    // merged out of regions we held (the coordinator gives it to every
+    // replica of the regions it replaces).
+    std::vector<region_id> adopted;
+    std::set_difference(new_held.begin(), new_held.end(),
+                        old_held.begin(), old_held.end(),
+                        std::back_inserter(adopted));
+    std::vector<transfer> transfers_in;
+    new_config.transfer_in_regions(us, &transfers_in);
+
+    for (size_t i = 0; i < transfers_in.size(); ++i)
+    {
+        adopted.erase(std::remove(adopted.begin(), adopted.end(), transfers_in[i].rid),
+                      adopted.end());
+    }
+
+    for (size_t i = 0; !adopted.empty() && i < dropped.size(); ++i)
+    {
+        const subspace* old_sub = old_config.get_subspace(dropped[i]);
+
+        // regions we merely left still exist in the new configuration
+        if (new_config.get_subspace(dropped[i]) || !old_sub)
+        {
+            continue;
+        }
+
+        const region* from = find_region(*old_sub, dropped[i]);
+        std::vector<region_id> to;
+
+        for (size_t j = 0; from && j < adopted.size(); ++j)
+        {
+            const subspace* new_sub = new_config.get_subspace(adopted[j]);
+            const region* candidate = new_sub ? find_region(*new_sub, adopted[j]) : NULL;
+
+            if (candidate && !old_config.get_subspace(adopted[j]) &&
+                new_config.subspace_of(adopted[j]) == old_config.subspace_of(dropped[i]) &&
+                overlaps(*from, *candidate))
+            {
+                to.push_back(adopted[j]);
+            }
+        }
+
+        if (!to.empty())
+        {
+            plan->push_back(std::make_pair(dropped[i], to));
+        }
+    }
+}
+
+void
+datalayer :: prepare_reconfigure(const configuration& old_config,
+                                 const configuration& new_config,
+                                 const server_id& us)
+{
+    std::vector<rekey_plan_t> plan;
+    plan_rekeys(old_config, new_config, us, &plan);
+
+    if (plan.empty())
+    {
+        return;
+    }
+
+    // Note every write to the regions about to be re-keyed from before the
+    // copies take their snapshots; reconfigure replays them.
+    {
+        po6::threads::mutex::hold hold(&m_rekey_mtx);
+
+        for (size_t i = 0; i < plan.size(); ++i)
+        {
+            m_rekey_touched[plan[i].first];
+        }
+
+        e::atomic::store_32_release(&m_rekey_watching, 1);
+    }
+
+    // The bulk of the copy happens here, while we still serve the old
+    // configuration; nobody else writes to the new regions until it is
+    // published.
+    for (size_t i = 0; i < plan.size(); ++i)
+    {
+        returncode rc = rekey_region(new_config, plan[i].first, plan[i].second);
+        po6::threads::mutex::hold hold(&m_rekey_mtx);
+        m_rekey_copied[plan[i].first] = rc;
+    }
+}
+
 void
-datalayer :: reconfigure(const configuration&,
+datalayer :: reconfigure(const configuration& old_config,
                          const configuration& new_config,
                          const server_id& us)
 {
@@ -435,6 +750,59 @@ datalayer :: reconfigure(const configuration&,
 
     std::sort(regions.begin(), regions.end());
     m_counters.adopt(regions);
+    m_stats.adopt(regions);
+    save_stats();
+
+    if (m_objects.enabled())
+    {
+        m_objects.clear();
+    }
+
+    // hand regions we no longer hold to the cleaner
+    std::vector<region_id> old_held;
+    std::vector<region_id> new_held;
+    held_regions(old_config, us, &old_held);
+    held_regions(new_config, us, &new_held);
+    std::vector<region_id> dropped;
+    std::set_difference(old_held.begin(), old_held.end(),
+                        new_held.begin(), new_held.end(),
+                        std::back_inserter(dropped));
+    m_region_ops.adopt(new_held);
+
+    // Regions split or merged out of regions we held were copied into by
+    // prepare_reconfigure while we still served the old configuration;
+    // bring them up to date with what changed since.  A region whose
+    // objects could not be moved stays put rather than go to the cleaner.
+    std::vector<rekey_plan_t> plan;
+    plan_rekeys(old_config, new_config, us, &plan);
+
+    for (size_t i = 0; i < plan.size(); ++i)
+    {
+        returncode rc = finish_rekey(new_config, plan[i].first, plan[i].second);
+
+        if (rc != SUCCESS)
+        {
+            LOG(ERROR) << "could not move the objects of " << plan[i].first
+                       << " into the regions that replaced it: " << rc
+                       << "; keeping its data";
+            dropped.erase(std::remove(dropped.begin(), dropped.end(), plan[i].first),
+                          dropped.end());
+        }
+    }
+
+    {
+        po6::threads::mutex::hold hold(&m_rekey_mtx);
+        e::atomic::store_32_release(&m_rekey_watching, 0);
+        m_rekey_touched.clear();
+        m_rekey_cleared.clear();
+        m_rekey_copied.clear();
+    }
+
+    if (!dropped.empty())
+    {
+        po6::threads::mutex::hold hold(&m_block_cleaner);
+        m_dropped_regions.insert(dropped.begin(), dropped.end());
+    }
 }
 
 bool
@@ -456,6 +824,63 @@ datalayer :: approximate_size()
     return ret;
 }
 
+uint64_t
+datalayer :: approximate_size(const region_id& ri)
+{
+    const char prefixes[] = {'o', 'i'};
+    char sbacking[sizeof(prefixes)][sizeof(uint8_t) + sizeof(uint64_t)];
+    char lbacking[sizeof(prefixes)][sizeof(uint8_t) + sizeof(uint64_t)];
+    leveldb::Range r[sizeof(prefixes)];
+    uint64_t sizes[sizeof(prefixes)];
+    uint64_t ret = 0;
+
+    for (size_t i = 0; i < sizeof(prefixes); ++i)
+    {
+        e::pack64be(ri.get(), e::pack8be(prefixes[i], sbacking[i]));
+        e::pack64be(ri.get() + 1, e::pack8be(prefixes[i], lbacking[i]));
+        r[i] = leveldb::Range(leveldb::Slice(sbacking[i], sizeof(sbacking[i])),
+                              leveldb::Slice(lbacking[i], sizeof(lbacking[i])));
+    }
+
+    m_db->GetApproximateSizes(r, sizeof(prefixes), sizes);
+
+    for (size_t i = 0; i < sizeof(prefixes); ++i)
+    {
+        ret += sizes[i];
+    }
+
+    return ret;
+}
+
+void
+datalayer :: region_ops(std::map<region_id, uint64_t>* ops)
+{
+    m_region_ops.peek(ops);
+}
+
+void
+datalayer :: collect_stats(std::ostringstream* ret)
+{
+    *ret << " datalayer.commits=" << m_perf_commits.read();
+    *ret << " datalayer.commit_writes=" << m_perf_commit_writes.read();
+    *ret << " datalayer.commit_wait=" << m_perf_commit_wait.read();
+    m_perf_leveldb_get.summarize("lat.leveldb_get", ret);
+    m_perf_leveldb_write.summarize("lat.leveldb_write", ret);
+
+    if (m_cache)
+    {
+        *ret << " leveldb.cache_capacity=" << m_cache->capacity();
+        *ret << " leveldb.cache_lookups=" << m_cache->lookups.read();
+        *ret << " leveldb.cache_hits=" << m_cache->hits.read();
+    }
+
+    if (m_objects.enabled())
+    {
+        *ret << " datalayer.object_cache_hits=" << m_objects.hits.read();
+        *ret << " datalayer.object_cache_misses=" << m_objects.misses.read();
+    }
+}
+
 datalayer::returncode
 datalayer :: get(const region_id& ri,
                  const e::slice& key,
@@ -463,7 +888,67 @@ datalayer :: get(const region_id& ri,
                  uint64_t* version,
                  reference* ref)
 {
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    count_op(ri);
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
+    std::vector<char> scratch;
+
+    // create the encoded key
+    leveldb::Slice lkey;
+    encode_key(ri, sc.attrs[0].type, key, &scratch, &lkey);
+    e::slice ckey(lkey.data(), lkey.size());
+    uint64_t ticket = 0;
+
+    if (m_objects.enabled())
+    {
+        if (m_objects.lookup(ckey, &ref->m_cached, value, version))
+        {
+            return SUCCESS;
+        }
+
+        ticket = m_objects.ticket(ckey);
+    }
+
+    // perform the read
+    leveldb::ReadOptions opts;
+    opts.fill_cache = true;
+    opts.verify_checksums = true;
+    uint64_t start = e::time();
+    leveldb::Status st = m_db->Get(opts, lkey, &ref->m_backing);
+    uint64_t elapsed = e::time() - start;
+    m_perf_leveldb_get.record(elapsed);
+    m_daemon->m_io.foreground(elapsed);
+
+    if (st.ok())
+    {
+        e::slice v(ref->m_backing.data(), ref->m_backing.size());
+        returncode rc = decode_value(v, value, version);
+
+        if (rc == SUCCESS && m_objects.enabled())
+        {
+            m_objects.insert(ticket, ckey, ref->m_backing, *value, *version);
+        }
+
+        return rc;
+    }
+    else if (st.IsNotFound())
+    {
+        return NOT_FOUND;
+    }
+    else
+    {
+        return handle_error(st);
+    }
+}
+
+datalayer::returncode
+datalayer :: get(snapshot snap,
+                 const region_id& ri,
+                 const e::slice& key,
+                 std::vector<e::slice>* value,
+                 uint64_t* version,
+                 reference* ref)
+{
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
     std::vector<char> scratch;
 
     // create the encoded key
@@ -474,7 +959,12 @@ datalayer :: get(const region_id& ri,
     leveldb::ReadOptions opts;
     opts.fill_cache = true;
     opts.verify_checksums = true;
+    opts.snapshot = snap.get();
+    uint64_t start = e::time();
     leveldb::Status st = m_db->Get(opts, lkey, &ref->m_backing);
+    uint64_t elapsed = e::time() - start;
+    m_perf_leveldb_get.record(elapsed);
+    m_daemon->m_io.foreground(elapsed);
 
     if (st.ok())
     {
@@ -498,8 +988,10 @@ datalayer :: del(const region_id& ri,
                  const e::slice& key,
                  const std::vector<e::slice>& old_value)
 {
+    count_op(ri);
     leveldb::WriteBatch updates;
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    index_stats_delta delta;
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
     std::vector<char> scratch;
 
     // create the encoded key
@@ -510,8 +1002,8 @@ datalayer :: del(const region_id& ri,
     updates.Delete(lkey);
 
     // delete the index entries
-    const subspace& sub(*m_daemon->m_config.get_subspace(ri));
-    create_index_changes(sc, sub, ri, key, &old_value, NULL, &updates);
+    const subspace& sub(*m_daemon->m_config->get_subspace(ri));
+    create_index_changes(sc, sub, ri, key, &old_value, NULL, &updates, &delta);
 
     // Mark acked as part of this batch write
     if (seq_id != 0)
@@ -530,7 +1022,7 @@ datalayer :: del(const region_id& ri,
     if (m_counters.lookup(ri, &count))
     {
         char tbacking[TRANSFER_BUF_SIZE];
-        capture_id cid = m_daemon->m_config.capture_for(ri);
+        capture_id cid = m_daemon->m_config->capture_for(ri);
         assert(cid != capture_id());
         leveldb::Slice tkey(tbacking, TRANSFER_BUF_SIZE);
         leveldb::Slice tval;
@@ -540,12 +1032,19 @@ datalayer :: del(const region_id& ri,
     }
 
     // Perform the write
-    leveldb::WriteOptions opts;
-    opts.sync = false;
-    leveldb::Status st = m_db->Write(opts, &updates);
+    leveldb::Status st = commit(&updates);
+    note_write(ri, key);
+
+    // the scratch space behind lkey was reused for the transfer log
+    if (m_objects.enabled())
+    {
+        encode_key(ri, sc.attrs[0].type, key, &scratch, &lkey);
+        m_objects.invalidate(e::slice(lkey.data(), lkey.size()));
+    }
 
     if (st.ok())
     {
+        m_stats.apply(delta);
         return SUCCESS;
     }
     else if (st.IsNotFound())
@@ -566,8 +1065,10 @@ datalayer :: put(const region_id& ri,
                  const std::vector<e::slice>& new_value,
                  uint64_t version)
 {
+    count_op(ri);
     leveldb::WriteBatch updates;
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    index_stats_delta delta;
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
     std::vector<char> scratch1;
     std::vector<char> scratch2;
 
@@ -583,8 +1084,8 @@ datalayer :: put(const region_id& ri,
     updates.Put(lkey, lval);
 
     // put the index entries
-    const subspace& sub(*m_daemon->m_config.get_subspace(ri));
-    create_index_changes(sc, sub, ri, key, NULL, &new_value, &updates);
+    const subspace& sub(*m_daemon->m_config->get_subspace(ri));
+    create_index_changes(sc, sub, ri, key, NULL, &new_value, &updates, &delta);
 
     // Mark acked as part of this batch write
     if (seq_id != 0)
@@ -603,7 +1104,7 @@ datalayer :: put(const region_id& ri,
     if (m_counters.lookup(ri, &count))
     {
         char tbacking[TRANSFER_BUF_SIZE];
-        capture_id cid = m_daemon->m_config.capture_for(ri);
+        capture_id cid = m_daemon->m_config->capture_for(ri);
         assert(cid != capture_id());
         leveldb::Slice tkey(tbacking, TRANSFER_BUF_SIZE);
         leveldb::Slice tval;
@@ -613,12 +1114,19 @@ datalayer :: put(const region_id& ri,
     }
 
     // Perform the write
-    leveldb::WriteOptions opts;
-    opts.sync = false;
-    leveldb::Status st = m_db->Write(opts, &updates);
+    leveldb::Status st = commit(&updates);
+    note_write(ri, key);
+
+    // the scratch space behind lkey was reused for the transfer log
+    if (m_objects.enabled())
+    {
+        encode_key(ri, sc.attrs[0].type, key, &scratch1, &lkey);
+        m_objects.invalidate(e::slice(lkey.data(), lkey.size()));
+    }
 
     if (st.ok())
     {
+        m_stats.apply(delta);
         return SUCCESS;
     }
     else
@@ -636,8 +1144,10 @@ datalayer :: overput(const region_id& ri,
                      const std::vector<e::slice>& new_value,
                      uint64_t version)
 {
+    count_op(ri);
     leveldb::WriteBatch updates;
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    index_stats_delta delta;
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
     std::vector<char> scratch1;
     std::vector<char> scratch2;
 
@@ -653,8 +1163,8 @@ datalayer :: overput(const region_id& ri,
     updates.Put(lkey, lval);
 
     // put the index entries
-    const subspace& sub(*m_daemon->m_config.get_subspace(ri));
-    create_index_changes(sc, sub, ri, key, &old_value, &new_value, &updates);
+    const subspace& sub(*m_daemon->m_config->get_subspace(ri));
+    create_index_changes(sc, sub, ri, key, &old_value, &new_value, &updates, &delta);
 
     // Mark acked as part of this batch write
     if (seq_id != 0)
@@ -673,7 +1183,7 @@ datalayer :: overput(const region_id& ri,
     if (m_counters.lookup(ri, &count))
     {
         char tbacking[TRANSFER_BUF_SIZE];
-        capture_id cid = m_daemon->m_config.capture_for(ri);
+        capture_id cid = m_daemon->m_config->capture_for(ri);
         assert(cid != capture_id());
         leveldb::Slice tkey(tbacking, TRANSFER_BUF_SIZE);
         leveldb::Slice tval;
@@ -683,12 +1193,19 @@ datalayer :: overput(const region_id& ri,
     }
 
     // Perform the write
-    leveldb::WriteOptions opts;
-    opts.sync = false;
-    leveldb::Status st = m_db->Write(opts, &updates);
+    leveldb::Status st = commit(&updates);
+    note_write(ri, key);
+
+    // the scratch space behind lkey was reused for the transfer log
+    if (m_objects.enabled())
+    {
+        encode_key(ri, sc.attrs[0].type, key, &scratch1, &lkey);
+        m_objects.invalidate(e::slice(lkey.data(), lkey.size()));
+    }
 
     if (st.ok())
     {
+        m_stats.apply(delta);
         return SUCCESS;
     }
     else
@@ -697,37 +1214,185 @@ datalayer :: overput(const region_id& ri,
     }
 }
 
-datalayer::returncode
-datalayer :: uncertain_del(const region_id& ri,
-                           const e::slice& key)
+namespace
 {
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
-    std::vector<char> scratch;
 
-    // create the encoded key
-    leveldb::Slice lkey;
-    encode_key(ri, sc.attrs[0].type, key, &scratch, &lkey);
+// Bound the size of a group commit so that the writers queued at the end of
+// the group don't wait on an arbitrarily large write.
+const size_t GROUP_COMMIT_MAX_WRITES = 128;
+const size_t GROUP_COMMIT_MAX_BYTES = 1ULL << 20;
+// Bulk deletes are written in batches of this many keys.
+const size_t CLEANUP_BATCH_KEYS = 4096;
+// Objects moved between split or merged regions are read and written in
+// runs of roughly this many bytes.
+const uint64_t REKEY_RUN_BYTES = 4ULL * 1024ULL * 1024ULL;
+
+class batch_appender : public leveldb::WriteBatch::Handler
+{
+    public:
+        batch_appender(leveldb::WriteBatch* batch) : bytes(0), m_batch(batch) {}
+        virtual ~batch_appender() throw () {}
 
-    // perform the read
-    std::string ref;
-    leveldb::ReadOptions opts;
-    opts.fill_cache = true;
-    opts.verify_checksums = true;
-    leveldb::Status st = m_db->Get(opts, lkey, &ref);
+    public:
+        virtual void Put(const leveldb::Slice& key, const leveldb::Slice& value)
+        { bytes += key.size() + value.size(); m_batch->Put(key, value); }
+        virtual void Delete(const leveldb::Slice& key)
+        { bytes += key.size(); m_batch->Delete(key); }
 
-    if (st.ok())
-    {
-        std::vector<e::slice> old_value;
-        uint64_t old_version;
-        returncode rc = decode_value(e::slice(ref.data(), ref.size()),
-                                     &old_value, &old_version);
+    public:
+        size_t bytes;
 
-        if (rc != SUCCESS)
-        {
-            return rc;
-        }
+    private:
+        batch_appender(const batch_appender&);
+        batch_appender& operator = (const batch_appender&);
 
-        if (old_value.size() + 1 != sc.attrs_sz)
+    private:
+        leveldb::WriteBatch* m_batch;
+};
+
+} // namespace
+
+class datalayer::pending_write
+{
+    public:
+        pending_write(po6::threads::mutex* mtx, leveldb::WriteBatch* b)
+            : batch(b), done(false), status(), wakeup(mtx), enqueued(e::time()) {}
+        ~pending_write() throw () {}
+
+    public:
+        leveldb::WriteBatch* batch;
+        bool done;
+        leveldb::Status status;
+        po6::threads::cond wakeup;
+        uint64_t enqueued;
+
+    private:
+        pending_write(const pending_write&);
+        pending_write& operator = (const pending_write&);
+};
+
+// Writers queue up behind one another.  The writer at the head of the queue
+// becomes the leader:  it folds the writes queued behind it into a single
+// batch, writes it to LevelDB without holding the lock, and then wakes the
+// writers it committed on behalf of and the next leader.
+leveldb::Status
+datalayer :: commit(leveldb::WriteBatch* updates)
+{
+    pending_write w(&m_commit_mtx, updates);
+    m_commit_mtx.lock();
+    m_commit_queue.push_back(&w);
+
+    while (!w.done && m_commit_queue.front() != &w)
+    {
+        w.wakeup.wait();
+    }
+
+    if (w.done)
+    {
+        m_commit_mtx.unlock();
+        return w.status;
+    }
+
+    std::vector<pending_write*> group;
+    group.reserve(std::min(m_commit_queue.size(), GROUP_COMMIT_MAX_WRITES));
+
+    for (std::list<pending_write*>::iterator it = m_commit_queue.begin();
+            it != m_commit_queue.end() && group.size() < GROUP_COMMIT_MAX_WRITES; ++it)
+    {
+        group.push_back(*it);
+    }
+
+    m_commit_mtx.unlock();
+    leveldb::WriteBatch combined;
+    leveldb::WriteBatch* batch = updates;
+    uint64_t now = e::time();
+    uint64_t waited = 0;
+    size_t group_sz = 1;
+
+    if (group.size() > 1)
+    {
+        batch_appender app(&combined);
+        batch = &combined;
+        group_sz = 0;
+
+        while (group_sz < group.size() && app.bytes < GROUP_COMMIT_MAX_BYTES)
+        {
+            group[group_sz]->batch->Iterate(&app);
+            ++group_sz;
+        }
+    }
+
+    for (size_t i = 0; i < group_sz; ++i)
+    {
+        waited += now - group[i]->enqueued;
+    }
+
+    leveldb::WriteOptions opts;
+    opts.sync = false;
+    uint64_t start = e::time();
+    leveldb::Status st = m_db->Write(opts, batch);
+    uint64_t elapsed = e::time() - start;
+    m_perf_leveldb_write.record(elapsed);
+    m_daemon->m_io.foreground(elapsed);
+    m_perf_commits.tap();
+    m_perf_commit_writes.add(group_sz);
+    m_perf_commit_wait.add(waited);
+
+    m_commit_mtx.lock();
+
+    for (size_t i = 0; i < group_sz; ++i)
+    {
+        assert(m_commit_queue.front() == group[i]);
+        m_commit_queue.pop_front();
+        group[i]->status = st;
+        group[i]->done = true;
+
+        if (group[i] != &w)
+        {
+            group[i]->wakeup.signal();
+        }
+    }
+
+    if (!m_commit_queue.empty())
+    {
+        m_commit_queue.front()->wakeup.signal();
+    }
+
+    m_commit_mtx.unlock();
+    return st;
+}
+
+datalayer::returncode
+datalayer :: uncertain_del(const region_id& ri,
+                           const e::slice& key)
+{
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
+    std::vector<char> scratch;
+
+    // create the encoded key
+    leveldb::Slice lkey;
+    encode_key(ri, sc.attrs[0].type, key, &scratch, &lkey);
+
+    // perform the read
+    std::string ref;
+    leveldb::ReadOptions opts;
+    opts.fill_cache = true;
+    opts.verify_checksums = true;
+    leveldb::Status st = m_db->Get(opts, lkey, &ref);
+
+    if (st.ok())
+    {
+        std::vector<e::slice> old_value;
+        uint64_t old_version;
+        returncode rc = decode_value(e::slice(ref.data(), ref.size()),
+                                     &old_value, &old_version);
+
+        if (rc != SUCCESS)
+        {
+            return rc;
+        }
+
+        if (old_value.size() + 1 != sc.attrs_sz)
         {
             return BAD_ENCODING;
         }
@@ -750,42 +1415,557 @@ datalayer :: uncertain_put(const region_id& ri,
                            const std::vector<e::slice>& new_value,
                            uint64_t version)
 {
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
+    std::vector<char> scratch;
+
+    // create the encoded key
+    leveldb::Slice lkey;
+    encode_key(ri, sc.attrs[0].type, key, &scratch, &lkey);
+
+    // perform the read
+    std::string ref;
+    leveldb::ReadOptions opts;
+    opts.fill_cache = true;
+    opts.verify_checksums = true;
+    leveldb::Status st = m_db->Get(opts, lkey, &ref);
+
+    if (st.ok())
+    {
+        std::vector<e::slice> old_value;
+        uint64_t old_version;
+        returncode rc = decode_value(e::slice(ref.data(), ref.size()),
+                                     &old_value, &old_version);
+
+        if (rc != SUCCESS)
+        {
+            return rc;
+        }
+
+        if (old_value.size() + 1 != sc.attrs_sz)
+        {
+            return BAD_ENCODING;
+        }
+
+        return overput(ri, region_id(), 0, key, old_value, new_value, version);
+    }
+    else if (st.IsNotFound())
+    {
+        return put(ri, region_id(), 0, key, new_value, version);
+    }
+    else
+    {
+        return handle_error(st);
+    }
+}
+
+datalayer::returncode
+datalayer :: clear_region(const region_id& ri)
+{
+    returncode rc = clear_region(ri, false);
+
+    // a region about to be re-keyed must then be copied from scratch
+    if (e::atomic::load_32_acquire(&m_rekey_watching) != 0)
+    {
+        po6::threads::mutex::hold hold(&m_rekey_mtx);
+
+        if (m_rekey_touched.find(ri) != m_rekey_touched.end())
+        {
+            m_rekey_cleared.insert(ri);
+        }
+    }
+
+    return rc;
+}
+
+datalayer::returncode
+datalayer :: clear_region(const region_id& ri, bool cleaner)
+{
+    const char prefixes[] = {'o', 'i'};
+    region_id dropped(ri);
+
+    for (size_t i = 0; i < sizeof(prefixes); ++i)
+    {
+        char sbacking[sizeof(uint8_t) + sizeof(uint64_t)];
+        char lbacking[sizeof(uint8_t) + sizeof(uint64_t)];
+        e::pack64be(ri.get(), e::pack8be(prefixes[i], sbacking));
+        e::pack64be(ri.get() + 1, e::pack8be(prefixes[i], lbacking));
+        returncode rc = delete_range(leveldb::Slice(sbacking, sizeof(sbacking)),
+                                     leveldb::Slice(lbacking, sizeof(lbacking)),
+                                     cleaner ? &dropped : NULL);
+
+        if (rc != SUCCESS)
+        {
+            return rc;
+        }
+
+        // we hold the region again; state transfer clears what's left
+        if (dropped == region_id())
+        {
+            LOG(INFO) << "stopped removing data for " << ri << " which we hold again";
+            return SUCCESS;
+        }
+    }
+
+    m_stats.clear(ri);
+
+    if (m_objects.enabled())
+    {
+        m_objects.clear();
+    }
+
+    return SUCCESS;
+}
+
+datalayer::returncode
+datalayer :: rekey_region(const configuration& new_config,
+                          const region_id& from,
+                          const std::vector<region_id>& to)
+{
+    assert(!to.empty());
+    const schema& sc(*new_config.get_schema(to[0]));
+    const subspace& sub(*new_config.get_subspace(to[0]));
+    std::vector<const region*> targets;
+
+    for (size_t i = 0; i < to.size(); ++i)
+    {
+        targets.push_back(find_region(sub, to[i]));
+        assert(targets.back());
+    }
+
+    snapshot snap = make_snapshot();
+    std::string cursor;
+    std::vector<e::slice> records;
+    std::vector<uint64_t> hashes(sc.attrs_sz);
+    std::vector<char> scratch;
+    std::vector<char> kbacking;
+    uint64_t moved = 0;
+
+    while (true)
+    {
+        reference ref;
+        returncode rc = get_raw_run(snap, from, &cursor, REKEY_RUN_BYTES, &records, &ref);
+
+        if (rc != SUCCESS)
+        {
+            return rc;
+        }
+
+        if (records.empty())
+        {
+            break;
+        }
+
+        leveldb::WriteBatch updates;
+        index_stats_delta delta;
+
+        for (size_t i = 0; i + 1 < records.size(); i += 2)
+        {
+            leveldb::Slice lkey(reinterpret_cast<const char*>(records[i].data()), records[i].size());
+            region_id kri;
+            e::slice key;
+            std::vector<e::slice> value;
+            uint64_t version;
+
+            if (!decode_key(lkey, sc.attrs[0].type, &kri, &kbacking, &key))
+            {
+                return BAD_ENCODING;
+            }
+
+            rc = decode_value(records[i + 1], &value, &version);
+
+            if (rc != SUCCESS)
+            {
+                return rc;
+            }
+
+            if (value.size() + 1 != sc.attrs_sz)
+            {
+                return BAD_ENCODING;
+            }
+
+            hash(sc, key, value, &hashes.front());
+            const region* target = NULL;
+
+            for (size_t t = 0; !target && t < targets.size(); ++t)
+            {
+                if (covers(sub, *targets[t], hashes))
+                {
+                    target = targets[t];
+                }
+            }
+
+            // the parent must not go to the cleaner with this object in it
+            if (!target)
+            {
+                LOG(ERROR) << "an object of " << from << " falls outside the regions that replaced it";
+                return CORRUPTION;
+            }
+
+            // the value encoding doesn't name the region, so it moves as is
+            leveldb::Slice nkey;
+            encode_key(target->id, sc.attrs[0].type, key, &scratch, &nkey);
+            updates.Put(nkey, leveldb::Slice(reinterpret_cast<const char*>(records[i + 1].data()),
+                                             records[i + 1].size()));
+            create_index_changes(sc, sub, target->id, key, NULL, &value, &updates, &delta);
+            ++moved;
+        }
+
+        leveldb::Status st = commit(&updates);
+
+        if (!st.ok())
+        {
+            return handle_error(st);
+        }
+
+        m_stats.apply(delta);
+    }
+
+    LOG(INFO) << "moved " << moved << " objects from " << from
+              << " into the regions that replaced it";
+    return SUCCESS;
+}
+
+datalayer::returncode
+datalayer :: finish_rekey(const configuration& new_config,
+                          const region_id& from,
+                          const std::vector<region_id>& to)
+{
+    std::set<std::string> touched;
+    bool copied = false;
+
+    {
+        po6::threads::mutex::hold hold(&m_rekey_mtx);
+        std::map<region_id, returncode>::iterator c = m_rekey_copied.find(from);
+        copied = c != m_rekey_copied.end() && c->second == SUCCESS &&
+                 m_rekey_cleared.find(from) == m_rekey_cleared.end();
+        std::map<region_id, std::set<std::string> >::iterator t = m_rekey_touched.find(from);
+
+        if (t != m_rekey_touched.end())
+        {
+            touched.swap(t->second);
+        }
+    }
+
+    // start over, now that nothing can change underneath the copy
+    if (!copied)
+    {
+        for (size_t i = 0; i < to.size(); ++i)
+        {
+            returncode rc = clear_region(to[i], false);
+
+            if (rc != SUCCESS)
+            {
+                return rc;
+            }
+        }
+
+        return rekey_region(new_config, from, to);
+    }
+
+    const schema& sc(*new_config.get_schema(to[0]));
+    const subspace& sub(*new_config.get_subspace(to[0]));
+    std::vector<const region*> targets;
+
+    for (size_t i = 0; i < to.size(); ++i)
+    {
+        targets.push_back(find_region(sub, to[i]));
+        assert(targets.back());
+    }
+
+    for (std::set<std::string>::iterator k = touched.begin(); k != touched.end(); ++k)
+    {
+        returncode rc = rekey_object(sc, sub, from, targets, e::slice(*k));
+
+        if (rc != SUCCESS)
+        {
+            return rc;
+        }
+    }
+
+    LOG(INFO) << "caught up " << touched.size() << " objects of " << from
+              << " written while it was being moved";
+    return SUCCESS;
+}
+
+datalayer::returncode
+datalayer :: rekey_object(const schema& sc,
+                          const subspace& sub,
+                          const region_id& from,
+                          const std::vector<const region*>& targets,
+                          const e::slice& key)
+{
+    leveldb::ReadOptions opts;
+    opts.fill_cache = false;
+    opts.verify_checksums = true;
+    std::vector<char> scratch;
+    leveldb::Slice lkey;
+    encode_key(from, sc.attrs[0].type, key, &scratch, &lkey);
+    std::string backing;
+    leveldb::Status st = m_db->Get(opts, lkey, &backing);
+    std::vector<e::slice> value;
+    uint64_t version;
+    const region* target = NULL;
+
+    if (st.ok())
+    {
+        returncode rc = decode_value(e::slice(backing.data(), backing.size()), &value, &version);
+
+        if (rc != SUCCESS)
+        {
+            return rc;
+        }
+
+        if (value.size() + 1 != sc.attrs_sz)
+        {
+            return BAD_ENCODING;
+        }
+
+        std::vector<uint64_t> hashes(sc.attrs_sz);
+        hash(sc, key, value, &hashes.front());
+
+        for (size_t t = 0; !target && t < targets.size(); ++t)
+        {
+            if (covers(sub, *targets[t], hashes))
+            {
+                target = targets[t];
+            }
+        }
+
+        if (!target)
+        {
+            LOG(ERROR) << "an object of " << from << " falls outside the regions that replaced it";
+            return CORRUPTION;
+        }
+    }
+    else if (!st.IsNotFound())
+    {
+        return handle_error(st);
+    }
+
+    // the object lives in at most the one region that covers it now
+    leveldb::WriteBatch updates;
+    index_stats_delta delta;
+
+    for (size_t t = 0; t < targets.size(); ++t)
+    {
+        leveldb::Slice tkey;
+        encode_key(targets[t]->id, sc.attrs[0].type, key, &scratch, &tkey);
+        std::string obacking;
+        st = m_db->Get(opts, tkey, &obacking);
+        std::vector<e::slice> old_value;
+        uint64_t old_version;
+        bool found = false;
+
+        if (st.ok())
+        {
+            returncode rc = decode_value(e::slice(obacking.data(), obacking.size()),
+                                         &old_value, &old_version);
+
+            if (rc != SUCCESS)
+            {
+                return rc;
+            }
+
+            found = true;
+        }
+        else if (!st.IsNotFound())
+        {
+            return handle_error(st);
+        }
+
+        if (targets[t] == target)
+        {
+            updates.Put(tkey, leveldb::Slice(backing.data(), backing.size()));
+            create_index_changes(sc, sub, target->id, key, found ? &old_value : NULL,
+                                 &value, &updates, &delta);
+        }
+        else if (found)
+        {
+            updates.Delete(tkey);
+            create_index_changes(sc, sub, targets[t]->id, key, &old_value, NULL,
+                                 &updates, &delta);
+        }
+    }
+
+    st = commit(&updates);
+
+    if (!st.ok())
+    {
+        return handle_error(st);
+    }
+
+    m_stats.apply(delta);
+    return SUCCESS;
+}
+
+void
+datalayer :: note_write(const region_id& ri, const e::slice& key)
+{
+    if (e::atomic::load_32_acquire(&m_rekey_watching) == 0)
+    {
+        return;
+    }
+
+    po6::threads::mutex::hold hold(&m_rekey_mtx);
+    std::map<region_id, std::set<std::string> >::iterator it = m_rekey_touched.find(ri);
+
+    if (it != m_rekey_touched.end())
+    {
+        it->second.insert(key.str());
+    }
+}
+
+datalayer::returncode
+datalayer :: put_absent(const region_id& ri,
+                        const std::vector<e::slice>& keys,
+                        const std::vector<const std::vector<e::slice>*>& values,
+                        const std::vector<uint64_t>& versions)
+{
+    assert(keys.size() == values.size());
+    assert(keys.size() == versions.size());
+    leveldb::WriteBatch updates;
+    index_stats_delta delta;
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
+    const subspace& sub(*m_daemon->m_config->get_subspace(ri));
+    capture_id cid = m_daemon->m_config->capture_for(ri);
+    std::vector<char> scratch1;
+    std::vector<char> scratch2;
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        // put the actual object; WriteBatch copies, so scratch may be reused
+        leveldb::Slice lkey;
+        encode_key(ri, sc.attrs[0].type, keys[i], &scratch1, &lkey);
+        leveldb::Slice lval;
+        encode_value(*values[i], versions[i], &scratch2, &lval);
+        updates.Put(lkey, lval);
+
+        // put the index entries
+        create_index_changes(sc, sub, ri, keys[i], NULL, values[i], &updates, &delta);
+
+        uint64_t count;
+
+        // If this is a captured region, then we must log this transfer
+        if (m_counters.lookup(ri, &count))
+        {
+            char tbacking[TRANSFER_BUF_SIZE];
+            assert(cid != capture_id());
+            leveldb::Slice tkey(tbacking, TRANSFER_BUF_SIZE);
+            leveldb::Slice tval;
+            encode_transfer(cid, count, tbacking);
+            encode_key_value(keys[i], values[i], versions[i], &scratch1, &tval);
+            updates.Put(tkey, tval);
+        }
+    }
+
+    // Perform the write
+    leveldb::Status st = commit(&updates);
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        note_write(ri, keys[i]);
+    }
+
+    for (size_t i = 0; m_objects.enabled() && i < keys.size(); ++i)
+    {
+        leveldb::Slice lkey;
+        encode_key(ri, sc.attrs[0].type, keys[i], &scratch1, &lkey);
+        m_objects.invalidate(e::slice(lkey.data(), lkey.size()));
+    }
+
+    if (st.ok())
+    {
+        m_stats.apply(delta);
+        return SUCCESS;
+    }
+    else
+    {
+        return handle_error(st);
+    }
+}
+
+datalayer::returncode
+datalayer :: put_raw_run(const region_id& ri,
+                         const std::vector<e::slice>& records)
+{
+    if (records.size() % 2 != 0)
+    {
+        return BAD_ENCODING;
+    }
+
+    leveldb::WriteBatch updates;
+    index_stats_delta delta;
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
+    const subspace& sub(*m_daemon->m_config->get_subspace(ri));
+    capture_id cid = m_daemon->m_config->capture_for(ri);
     std::vector<char> scratch;
+    // backing for each record's key, which the later loops still use
+    std::vector<std::vector<char> > decoded(records.size() / 2);
+    std::vector<e::slice> keys;
 
-    // create the encoded key
-    leveldb::Slice lkey;
-    encode_key(ri, sc.attrs[0].type, key, &scratch, &lkey);
+    for (size_t i = 0; i < records.size(); i += 2)
+    {
+        leveldb::Slice lkey(reinterpret_cast<const char*>(records[i].data()), records[i].size());
+        leveldb::Slice lval(reinterpret_cast<const char*>(records[i + 1].data()), records[i + 1].size());
+        region_id kri;
+        e::slice key;
+        std::vector<e::slice> value;
+        uint64_t version;
 
-    // perform the read
-    std::string ref;
-    leveldb::ReadOptions opts;
-    opts.fill_cache = true;
-    opts.verify_checksums = true;
-    leveldb::Status st = m_db->Get(opts, lkey, &ref);
+        if (!decode_key(lkey, sc.attrs[0].type, &kri, &decoded[i / 2], &key) || kri != ri)
+        {
+            return BAD_ENCODING;
+        }
 
-    if (st.ok())
-    {
-        std::vector<e::slice> old_value;
-        uint64_t old_version;
-        returncode rc = decode_value(e::slice(ref.data(), ref.size()),
-                                     &old_value, &old_version);
+        returncode rc = decode_value(records[i + 1], &value, &version);
 
         if (rc != SUCCESS)
         {
             return rc;
         }
 
-        if (old_value.size() + 1 != sc.attrs_sz)
+        if (value.size() + 1 != sc.attrs_sz)
         {
             return BAD_ENCODING;
         }
 
-        return overput(ri, region_id(), 0, key, old_value, new_value, version);
+        // the object goes in exactly as the sender stored it
+        updates.Put(lkey, lval);
+        keys.push_back(key);
+        create_index_changes(sc, sub, ri, key, NULL, &value, &updates, &delta);
+
+        uint64_t count;
+
+        // If this is a captured region, then we must log this transfer
+        if (m_counters.lookup(ri, &count))
+        {
+            char tbacking[TRANSFER_BUF_SIZE];
+            assert(cid != capture_id());
+            leveldb::Slice tkey(tbacking, TRANSFER_BUF_SIZE);
+            leveldb::Slice tval;
+            encode_transfer(cid, count, tbacking);
+            encode_key_value(key, &value, version, &scratch, &tval);
+            updates.Put(tkey, tval);
+        }
     }
-    else if (st.IsNotFound())
+
+    // Perform the write
+    leveldb::Status st = commit(&updates);
+
+    for (size_t i = 0; i < keys.size(); ++i)
     {
-        return put(ri, region_id(), 0, key, new_value, version);
+        note_write(ri, keys[i]);
+    }
+
+    for (size_t i = 0; m_objects.enabled() && i < records.size(); i += 2)
+    {
+        m_objects.invalidate(records[i]);
+    }
+
+    if (st.ok())
+    {
+        m_stats.apply(delta);
+        return SUCCESS;
     }
     else
     {
@@ -806,7 +1986,7 @@ datalayer :: get_transfer(const region_id& ri,
     opts.fill_cache = true;
     opts.verify_checksums = true;
     char tbacking[TRANSFER_BUF_SIZE];
-    capture_id cid = m_daemon->m_config.capture_for(ri);
+    capture_id cid = m_daemon->m_config->capture_for(ri);
     assert(cid != capture_id());
     leveldb::Slice lkey(tbacking, TRANSFER_BUF_SIZE);
     encode_transfer(cid, seq_no, tbacking);
@@ -1035,24 +2215,117 @@ datalayer :: make_region_iterator(snapshot snap,
     opts.snapshot = snap.get();
     leveldb_iterator_ptr iter;
     iter.reset(snap, m_db->NewIterator(opts));
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
     return new region_iterator(iter, ri, index_info::lookup(sc.attrs[0].type));
 }
 
+namespace
+{
+
+// Retrieving an object through a secondary index is a random read, while a
+// full scan reads the region sequentially.  Weight the former accordingly.
+const uint64_t RANDOM_READ_PENALTY = 4;
+// Unsorted iterators are intersected by materializing their keys in memory;
+// don't do so for iterators that cover more than this many bytes of index.
+const uint64_t HASH_INTERSECT_MAX_BYTES = 64ULL * 1024ULL * 1024ULL;
+
+struct plan_step
+{
+    plan_step()
+        : iter(), attr(), cost(), selectivity(1.0)
+        , has_bounds(false), has_start(false), has_end(false), start(), end() {}
+    bool operator < (const plan_step& rhs) const
+    { return selectivity < rhs.selectivity ||
+             (selectivity == rhs.selectivity && cost < rhs.cost); }
+    e::intrusive_ptr<datalayer::index_iterator> iter;
+    uint16_t attr;
+    uint64_t cost;
+    double selectivity;
+    // index-encoded bounds of the values the iterator covers, for consulting
+    // the index statistics
+    bool has_bounds;
+    bool has_start;
+    bool has_end;
+    std::string start;
+    std::string end;
+};
+
+void
+encode_index_value(hyperdex::index_info* ii, const e::slice& value, std::string* out)
+{
+    out->resize(ii->encoded_size(value));
+
+    if (!out->empty())
+    {
+        ii->encode(value, &(*out)[0]);
+    }
+}
+
+} // namespace
+
+uint64_t
+datalayer :: index_size(const region_id& ri, uint16_t attr)
+{
+    const size_t sz = sizeof(uint8_t) + sizeof(uint64_t) + sizeof(uint16_t);
+    char buf[2 * sz];
+    char* ptr = buf;
+    ptr = e::pack8be('i', ptr);
+    ptr = e::pack64be(ri.get(), ptr);
+    ptr = e::pack16be(attr, ptr);
+    memmove(ptr, buf, sz);
+    encode_bump(buf + sz, buf + 2 * sz);
+    leveldb::Range r(leveldb::Slice(buf, sz), leveldb::Slice(buf + sz, sz));
+    uint64_t ret = 0;
+    m_db->GetApproximateSizes(&r, 1, &ret);
+    return ret;
+}
+
+void
+datalayer :: save_stats()
+{
+    std::string stats;
+    m_stats.serialize(&stats);
+    leveldb::WriteOptions wopts;
+    wopts.sync = false;
+    leveldb::Status st = m_db->Put(wopts, leveldb::Slice("stats", 5),
+                                   leveldb::Slice(stats.data(), stats.size()));
+
+    if (!st.ok())
+    {
+        LOG(WARNING) << "could not save index statistics: " << st.ToString();
+    }
+}
+
 datalayer::iterator*
 datalayer :: make_search_iterator(snapshot snap,
                                   const region_id& ri,
                                   const std::vector<attribute_check>& checks,
                                   std::ostringstream* ostr)
 {
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
-    std::vector<e::intrusive_ptr<index_iterator> > iterators;
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
+    std::vector<plan_step> steps;
 
     // pull a set of range queries from checks
     std::vector<range> ranges;
     range_searches(checks, &ranges);
     index_info* ki = index_info::lookup(sc.attrs[0].type);
-    const subspace& sub(*m_daemon->m_config.get_subspace(ri));
+    const subspace& sub(*m_daemon->m_config->get_subspace(ri));
+
+    // The plan covers the search when every check is answered exactly by an
+    // index range that makes it into the plan.  Covered searches needn't
+    // retrieve objects to re-check them.  Bounds on the key are not exact.
+    bool covered = true;
+
+    for (size_t i = 0; i < checks.size(); ++i)
+    {
+        if (checks[i].attr == 0 ||
+            (checks[i].predicate != HYPERPREDICATE_EQUALS &&
+             checks[i].predicate != HYPERPREDICATE_LESS_EQUAL &&
+             checks[i].predicate != HYPERPREDICATE_GREATER_EQUAL))
+        {
+            covered = false;
+        }
+    }
 
     // for each range query, construct an iterator
     for (size_t i = 0; i < ranges.size(); ++i)
@@ -1073,10 +2346,12 @@ datalayer :: make_search_iterator(snapshot snap,
 
         if (!sub.indexed(ranges[i].attr))
         {
+            covered = false;
             continue;
         }
 
         index_info* ii = index_info::lookup(ranges[i].type);
+        bool planned = false;
 
         if (ii)
         {
@@ -1084,9 +2359,30 @@ datalayer :: make_search_iterator(snapshot snap,
 
             if (it)
             {
-                iterators.push_back(it);
+                steps.push_back(plan_step());
+                steps.back().iter = it;
+                steps.back().attr = ranges[i].attr;
+                steps.back().has_bounds = ranges[i].attr != 0;
+                steps.back().has_start = ranges[i].has_start;
+                steps.back().has_end = ranges[i].has_end;
+                planned = true;
+
+                if (ranges[i].has_start)
+                {
+                    encode_index_value(ii, ranges[i].start, &steps.back().start);
+                }
+
+                if (ranges[i].has_end)
+                {
+                    encode_index_value(ii, ranges[i].end, &steps.back().end);
+                }
             }
         }
+
+        if (!planned)
+        {
+            covered = false;
+        }
     }
 
     // for everything that is not a range query, construct an iterator
@@ -1112,7 +2408,20 @@ datalayer :: make_search_iterator(snapshot snap,
 
             if (it)
             {
-                iterators.push_back(it);
+                steps.push_back(plan_step());
+                steps.back().iter = it;
+                steps.back().attr = checks[i].attr;
+                index_info* ei = index_info::lookup(checks[i].datatype);
+
+                // container membership is an equality on the element index
+                if (checks[i].predicate == HYPERPREDICATE_CONTAINS && ei)
+                {
+                    steps.back().has_bounds = true;
+                    steps.back().has_start = true;
+                    steps.back().has_end = true;
+                    encode_index_value(ei, checks[i].value, &steps.back().start);
+                    steps.back().end = steps.back().start;
+                }
             }
         }
     }
@@ -1126,53 +2435,258 @@ datalayer :: make_search_iterator(snapshot snap,
     scan.has_end = false;
     scan.invalid = false;
     full_scan = ki->iterator_from_range(snap, ri, scan, ki);
-    if (ostr) *ostr << "accessing all objects has cost " << full_scan->cost(m_db.get()) << "\n";
+    const uint64_t full_scan_cost = full_scan->cost(m_db.get());
+    if (ostr) *ostr << "accessing all objects has cost " << full_scan_cost << "\n";
 
-    // figure out the cost of each iterator
+    // figure out the cost and selectivity of each iterator
     // we do this here and not below so that iterators can cache the size and we
-    // don't ping-pong between HyperDex and LevelDB.
-    for (size_t i = 0; i < iterators.size(); ++i)
+    // don't ping-pong between HyperDex and LevelDB.  Where the index statistics
+    // can answer, we don't ask LevelDB at all.
+    for (size_t i = 0; i < steps.size(); ++i)
     {
-        uint64_t iterator_cost = iterators[i]->cost(m_db.get());
-        if (ostr) *ostr << "iterator " << *iterators[i] << " has cost " << iterator_cost << "\n";
+        if (steps[i].has_bounds)
+        {
+            e::slice start(steps[i].start);
+            e::slice end(steps[i].end);
+            double fraction = 1.0;
+            uint64_t bytes = 0;
+
+            if (ostr)
+            {
+                *ostr << "statistics for attr " << steps[i].attr << ": ";
+                m_stats.describe(ri, steps[i].attr, *ostr);
+                *ostr << "\n";
+            }
+
+            if (m_stats.estimate(ri, steps[i].attr,
+                                 steps[i].has_start ? &start : NULL,
+                                 steps[i].has_end ? &end : NULL,
+                                 &fraction, &bytes))
+            {
+                steps[i].cost = bytes;
+                steps[i].selectivity = fraction;
+                if (ostr) *ostr << "iterator " << *steps[i].iter << " has estimated cost " << steps[i].cost
+                                << " and selectivity " << steps[i].selectivity << " from statistics\n";
+                continue;
+            }
+        }
+
+        steps[i].cost = steps[i].iter->cost(m_db.get());
+        uint64_t total = steps[i].attr == 0 ? full_scan_cost
+                                            : index_size(ri, steps[i].attr);
+
+        if (total > 0)
+        {
+            steps[i].selectivity = std::min(1.0, double(steps[i].cost) / double(total));
+        }
+
+        if (ostr) *ostr << "iterator " << *steps[i].iter << " has cost " << steps[i].cost
+                        << " and selectivity " << steps[i].selectivity << "\n";
     }
 
+    // Greedily build a plan from the most selective iterators.  Each iterator
+    // we add must be scanned in full (for unsorted iterators) or in part (for
+    // sorted iterators), but reduces the number of objects we must retrieve.
+    // Selectivities are assumed to be independent.
+    std::sort(steps.begin(), steps.end());
     std::vector<e::intrusive_ptr<index_iterator> > sorted;
     std::vector<e::intrusive_ptr<index_iterator> > unsorted;
+    double plan_cost = 0;
+    double plan_scan = 0;
+    double plan_selectivity = 1.0;
 
-    for (size_t i = 0; i < iterators.size(); ++i)
+    for (size_t i = 0; i < steps.size(); ++i)
     {
-        if (iterators[i]->sorted())
+        bool is_sorted = steps[i].iter->sorted();
+        bool is_first = sorted.empty() && unsorted.empty();
+
+        // an unsorted iterator that is not driving the plan must be
+        // materialized in memory
+        if (!is_sorted && !is_first && steps[i].cost > HASH_INTERSECT_MAX_BYTES)
+        {
+            continue;
+        }
+
+        double scan = plan_scan + steps[i].cost;
+        double selectivity = plan_selectivity * steps[i].selectivity;
+        double cost = scan + selectivity * full_scan_cost * RANDOM_READ_PENALTY;
+
+        if (!is_first && cost >= plan_cost)
+        {
+            continue;
+        }
+
+        if (is_sorted)
         {
-            sorted.push_back(iterators[i]);
+            sorted.push_back(steps[i].iter);
         }
         else
         {
-            unsorted.push_back(iterators[i]);
+            unsorted.push_back(steps[i].iter);
         }
+
+        plan_scan = scan;
+        plan_selectivity = selectivity;
+        plan_cost = cost;
     }
 
-    e::intrusive_ptr<index_iterator> best;
+    // a step left out of the plan leaves its check to the search iterator
+    if (sorted.size() + unsorted.size() < steps.size())
+    {
+        covered = false;
+    }
 
-    if (!sorted.empty())
+    if (ostr && (!sorted.empty() || !unsorted.empty()))
     {
-        best = new intersect_iterator(snap, sorted);
+        *ostr << "best index plan has estimated cost " << uint64_t(plan_cost)
+              << " using " << sorted.size() << " sorted and "
+              << unsorted.size() << " unsorted iterators\n";
     }
 
-    if (!best || best->cost(m_db.get()) * 4 > full_scan->cost(m_db.get()))
+    e::intrusive_ptr<index_iterator> best;
+
+    if ((sorted.empty() && unsorted.empty()) ||
+        plan_cost > full_scan_cost)
     {
         best = full_scan;
+        covered = covered && checks.empty();
     }
-
-    // just pick one; do something smart later
-    if (!unsorted.empty() && !best)
+    else
     {
-        best = unsorted[0];
+        // prefer a sorted driver, as the unsorted iterators will be hashed
+        if (sorted.size() > 1)
+        {
+            best = new intersect_iterator(snap, sorted);
+        }
+        else if (sorted.size() == 1)
+        {
+            best = sorted[0];
+        }
+        else
+        {
+            best = unsorted[0];
+            unsorted.erase(unsorted.begin());
+        }
+
+        // the search iterator re-checks every predicate, so filters that are
+        // too large to hash may simply be dropped
+        for (size_t i = 0; i < unsorted.size(); )
+        {
+            if (unsorted[i]->cost(m_db.get()) > HASH_INTERSECT_MAX_BYTES)
+            {
+                unsorted.erase(unsorted.begin() + i);
+                covered = false;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        if (!unsorted.empty())
+        {
+            best = new hash_intersect_iterator(snap, best, unsorted);
+        }
     }
 
     assert(best);
     if (ostr) *ostr << "choosing to use " << *best << "\n";
-    return new search_iterator(this, ri, best, ostr, &checks);
+    if (ostr && covered) *ostr << "index plan covers every check; objects will not be retrieved\n";
+    return new search_iterator(this, ri, best, ostr, &checks, covered);
+}
+
+datalayer::iterator*
+datalayer :: make_ordered_iterator(snapshot snap,
+                                   const region_id& ri,
+                                   uint16_t attr,
+                                   bool reverse)
+{
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
+    const subspace& sub(*m_daemon->m_config->get_subspace(ri));
+
+    if (attr == 0 || attr >= sc.attrs_sz || !sub.indexed(attr))
+    {
+        return NULL;
+    }
+
+    index_info* ki = index_info::lookup(sc.attrs[0].type);
+    index_info* ii = index_info::lookup(sc.attrs[attr].type);
+
+    if (!ki || !ii)
+    {
+        return NULL;
+    }
+
+    return ii->iterator_in_order(snap, ri, attr, reverse, ki);
+}
+
+datalayer::returncode
+datalayer :: get_raw_run(snapshot snap,
+                         const region_id& ri,
+                         std::string* cursor,
+                         uint64_t max_bytes,
+                         std::vector<e::slice>* records,
+                         reference* ref)
+{
+    const size_t prefix_sz = sizeof(uint8_t) + sizeof(uint64_t);
+    char prefix[prefix_sz];
+    char* ptr = prefix;
+    ptr = e::pack8be('o', ptr);
+    ptr = e::pack64be(ri.get(), ptr);
+
+    // a bulk scan would only evict the working set
+    leveldb::ReadOptions opts;
+    opts.fill_cache = false;
+    opts.verify_checksums = true;
+    opts.snapshot = snap.get();
+    std::auto_ptr<leveldb::Iterator> it(m_db->NewIterator(opts));
+
+    if (cursor->empty())
+    {
+        it->Seek(leveldb::Slice(prefix, prefix_sz));
+    }
+    else
+    {
+        it->Seek(*cursor);
+
+        if (it->Valid() && it->key() == leveldb::Slice(*cursor))
+        {
+            it->Next();
+        }
+    }
+
+    std::vector<size_t> offsets;
+    ref->m_backing.clear();
+    ref->m_cached = object_cache::backing_ptr();
+
+    while (it->Valid() &&
+           it->key().starts_with(leveldb::Slice(prefix, prefix_sz)) &&
+           ref->m_backing.size() < max_bytes)
+    {
+        offsets.push_back(ref->m_backing.size());
+        ref->m_backing.append(it->key().data(), it->key().size());
+        offsets.push_back(ref->m_backing.size());
+        ref->m_backing.append(it->value().data(), it->value().size());
+        cursor->assign(it->key().data(), it->key().size());
+        it->Next();
+    }
+
+    if (!it->status().ok())
+    {
+        return handle_error(it->status());
+    }
+
+    offsets.push_back(ref->m_backing.size());
+    records->clear();
+    records->reserve(offsets.size() - 1);
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(ref->m_backing.data());
+
+    for (size_t i = 0; i + 1 < offsets.size(); ++i)
+    {
+        records->push_back(e::slice(base + offsets[i], offsets[i + 1] - offsets[i]));
+    }
+
+    return SUCCESS;
 }
 
 datalayer::returncode
@@ -1183,7 +2697,7 @@ datalayer :: get_from_iterator(const region_id& ri,
                                uint64_t* version,
                                reference* ref)
 {
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
     std::vector<char> scratch;
 
     // create the encoded key
@@ -1195,7 +2709,9 @@ datalayer :: get_from_iterator(const region_id& ri,
     opts.fill_cache = true;
     opts.verify_checksums = true;
     opts.snapshot = iter->snap().get();
+    uint64_t start = e::time();
     leveldb::Status st = m_db->Get(opts, lkey, &ref->m_backing);
+    m_perf_leveldb_get.record(e::time() - start);
 
     if (st.ok())
     {
@@ -1235,15 +2751,19 @@ datalayer :: cleaner()
         return;
     }
 
+    m_daemon->m_config.online();
+
     while (true)
     {
         std::set<capture_id> state_transfer_captures;
+        std::set<region_id> dropped_regions;
 
         {
             po6::threads::mutex::hold hold(&m_block_cleaner);
 
             while ((!m_need_cleaning &&
                     m_state_transfer_captures.empty() &&
+                    m_dropped_regions.empty() &&
                     !m_shutdown) || m_need_pause)
             {
                 m_paused = true;
@@ -1253,7 +2773,9 @@ datalayer :: cleaner()
                     m_wakeup_reconfigurer.signal();
                 }
 
+                m_daemon->m_config.offline();
                 m_wakeup_cleaner.wait();
+                m_daemon->m_config.online();
                 m_paused = false;
             }
 
@@ -1263,78 +2785,78 @@ datalayer :: cleaner()
             }
 
             m_state_transfer_captures.swap(state_transfer_captures);
+            m_dropped_regions.swap(dropped_regions);
             m_need_cleaning = false;
         }
 
         leveldb::ReadOptions opts;
-        opts.fill_cache = true;
+        opts.fill_cache = false;
         opts.verify_checksums = true;
         std::auto_ptr<leveldb::Iterator> it;
         it.reset(m_db->NewIterator(opts));
         it->Seek(leveldb::Slice("t", 1));
-        capture_id cached_cid;
 
+        // the transfer log is keyed by capture, so each log that is no
+        // longer needed goes as a single range
         while (it->Valid())
         {
             uint8_t prefix;
             uint64_t cid;
-            uint64_t seq_no;
             e::unpacker up(it->key().data(), it->key().size());
-            up = up >> prefix >> cid >> seq_no;
+            up = up >> prefix >> cid;
 
             if (up.error() || prefix != 't')
             {
                 break;
             }
 
-            if (cid == cached_cid.get())
+            char sbacking[TRANSFER_BUF_SIZE];
+            char lbacking[TRANSFER_BUF_SIZE];
+            encode_transfer(capture_id(cid), 0, sbacking);
+            encode_transfer(capture_id(cid + 1), 0, lbacking);
+            leveldb::Slice start(sbacking, TRANSFER_BUF_SIZE);
+            leveldb::Slice limit(lbacking, TRANSFER_BUF_SIZE);
+            bool wipe = !m_daemon->m_config->is_captured_region(capture_id(cid)) ||
+                        state_transfer_captures.erase(capture_id(cid)) > 0;
+
+            if (wipe)
             {
-                leveldb::WriteOptions wopts;
-                wopts.sync = false;
-                leveldb::Status st = m_db->Delete(wopts, it->key());
+                region_id none;
+                returncode rc = delete_range(start, limit, &none);
 
-                if (st.ok() || st.IsNotFound())
+                if (rc != SUCCESS)
                 {
-                    // pass
-                }
-                else if (st.IsCorruption())
-                {
-                    LOG(ERROR) << "corruption at the disk layer: could not cleanup old transfers:"
-                               << " desc=" << st.ToString();
-                }
-                else if (st.IsIOError())
-                {
-                    LOG(ERROR) << "IO error at the disk layer: could not cleanup old transfers:"
-                               << " desc=" << st.ToString();
-                }
-                else
-                {
-                    LOG(ERROR) << "LevelDB returned an unknown error that we don't know how to handle";
+                    LOG(ERROR) << "could not cleanup old transfers: " << rc;
                 }
 
-                it->Next();
-                continue;
+                m_daemon->m_stm.report_wiped(capture_id(cid));
             }
 
-            m_daemon->m_stm.report_wiped(cached_cid);
+            it->Seek(limit);
+        }
+
+        it.reset();
+
+        for (std::set<region_id>::iterator r = dropped_regions.begin();
+                r != dropped_regions.end(); ++r)
+        {
+            // we may have been handed the region back in the meantime, which
+            // includes while clearing an earlier region
+            std::vector<region_id> held;
+            held_regions(*m_daemon->m_config, m_daemon->m_us, &held);
 
-            if (!m_daemon->m_config.is_captured_region(capture_id(cid)))
+            if (std::binary_search(held.begin(), held.end(), *r))
             {
-                cached_cid = capture_id(cid);
                 continue;
             }
 
-            if (state_transfer_captures.find(capture_id(cid)) != state_transfer_captures.end())
+            LOG(INFO) << "removing data for " << *r << " which we no longer hold";
+            returncode rc = clear_region(*r, true);
+
+            if (rc != SUCCESS)
             {
-                cached_cid = capture_id(cid);
-                state_transfer_captures.erase(cached_cid);
-                continue;
+                LOG(ERROR) << "could not remove data for " << *r << ": " << rc;
             }
-
-            char tbacking[TRANSFER_BUF_SIZE];
-            leveldb::Slice slice(tbacking, TRANSFER_BUF_SIZE);
-            encode_transfer(capture_id(cid + 1), 0, tbacking);
-            it->Seek(slice);
         }
 
         while (!state_transfer_captures.empty())
@@ -1344,9 +2866,115 @@ datalayer :: cleaner()
         }
     }
 
+    m_daemon->m_config.offline();
     LOG(INFO) << "cleanup thread shutting down";
 }
 
+bool
+datalayer :: cleaner_park()
+{
+    po6::threads::mutex::hold hold(&m_block_cleaner);
+    bool parked = false;
+
+    while (m_need_pause && !m_shutdown)
+    {
+        parked = true;
+        m_paused = true;
+        m_wakeup_reconfigurer.signal();
+        m_daemon->m_config.offline();
+        m_wakeup_cleaner.wait();
+        m_daemon->m_config.online();
+        m_paused = false;
+    }
+
+    return parked;
+}
+
+datalayer::returncode
+datalayer :: delete_range(const leveldb::Slice& start,
+                          const leveldb::Slice& limit,
+                          region_id* dropped)
+{
+    leveldb::ReadOptions opts;
+    opts.fill_cache = false;
+    opts.verify_checksums = true;
+    std::auto_ptr<leveldb::Iterator> it(m_db->NewIterator(opts));
+    it->Seek(start);
+    leveldb::WriteOptions wopts;
+    wopts.sync = false;
+
+    while (it->Valid() && it->key().compare(limit) < 0)
+    {
+        leveldb::WriteBatch updates;
+        uint64_t bytes = 0;
+
+        for (size_t n = 0; n < CLEANUP_BATCH_KEYS &&
+                it->Valid() && it->key().compare(limit) < 0; ++n)
+        {
+            updates.Delete(it->key());
+            bytes += it->key().size() + it->value().size();
+            it->Next();
+        }
+
+        // The compaction at the end rewrites roughly what we delete, so
+        // its cost is paid as we go rather than in one lump at the end.
+        // Only the cleaner may wait on the bucket, and a pending
+        // reconfiguration cuts its wait short; everyone else, such as a
+        // network thread or the reconfiguration itself, leaves the debt for
+        // the background work that comes after it.
+        m_daemon->m_io.charge(io_scheduler::COMPACTION, bytes);
+
+        if (dropped)
+        {
+            m_daemon->m_io.throttle(io_scheduler::CLEANUP, bytes, &m_need_pause);
+        }
+        else
+        {
+            m_daemon->m_io.charge(io_scheduler::CLEANUP, bytes);
+        }
+
+        leveldb::Status st = m_db->Write(wopts, &updates);
+
+        if (!st.ok())
+        {
+            return handle_error(st);
+        }
+
+        // let a reconfiguration through instead of holding it up until the
+        // whole range is gone
+        if (dropped && cleaner_park() && *dropped != region_id())
+        {
+            std::vector<region_id> held;
+            held_regions(*m_daemon->m_config, m_daemon->m_us, &held);
+
+            if (std::binary_search(held.begin(), held.end(), *dropped))
+            {
+                *dropped = region_id();
+                return SUCCESS;
+            }
+        }
+    }
+
+    if (!it->status().ok())
+    {
+        return handle_error(it->status());
+    }
+
+    it.reset();
+
+    // Compacting just this range drops the tombstones together with the
+    // data they cover, instead of leaving both for background compaction to
+    // carry through every level.  It can take as long as the region is
+    // big, so only the cleaner does it; a state transfer clearing its
+    // region on a network thread leaves the tombstones to LevelDB.
+    if (dropped)
+    {
+        m_db->CompactRange(&start, &limit);
+    }
+
+    return SUCCESS;
+}
+
 void
 datalayer :: shutdown()
 {
@@ -1387,6 +3015,7 @@ datalayer :: handle_error(leveldb::Status st)
 
 datalayer :: reference :: reference()
     : m_backing()
+    , m_cached()
 {
 }
 
@@ -1398,6 +3027,7 @@ void
 datalayer :: reference :: swap(reference* ref)
 {
     m_backing.swap(ref->m_backing);
+    m_cached.swap(ref->m_cached);
 }
 
 std::ostream&
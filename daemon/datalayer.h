@@ -30,6 +30,7 @@
 
 // STL
 #include <list>
+#include <map>
 #include <set>
 #include <sstream>
 #include <string>
@@ -55,7 +56,12 @@
 #include "common/datatypes.h"
 #include "common/ids.h"
 #include "common/schema.h"
+#include "daemon/index_stats.h"
+#include "daemon/latency_histogram.h"
 #include "daemon/leveldb.h"
+#include "daemon/object_cache.h"
+#include "daemon/performance_counter.h"
+#include "daemon/storage_options.h"
 #include "daemon/reconfigure_returncode.h"
 
 BEGIN_HYPERDEX_NAMESPACE
@@ -82,6 +88,7 @@ class datalayer
         class sorted_iterator;
         class unsorted_iterator;
         class intersect_iterator;
+        class hash_intersect_iterator;
         typedef leveldb_snapshot_ptr snapshot;
 
     public:
@@ -89,7 +96,9 @@ class datalayer
         ~datalayer() throw ();
 
     public:
+        // options set in "opts" override those saved in "path"
         bool setup(const po6::pathname& path,
+                   const storage_options& opts,
                    bool* saved,
                    server_id* saved_us,
                    po6::net::location* saved_bind_to,
@@ -106,6 +115,14 @@ class datalayer
         bool clear_dirty();
         void pause();
         void unpause();
+        // Called, before pausing, with the configuration about to be
+        // installed.  Copies the objects of regions that it splits or merges
+        // into their replacements while the old configuration is still
+        // served, so that reconfigure only has to catch up on the writes
+        // made in the meantime.
+        void prepare_reconfigure(const configuration& old_config,
+                                 const configuration& new_config,
+                                 const server_id& us);
         void reconfigure(const configuration& old_config,
                          const configuration& new_config,
                          const server_id& us);
@@ -113,6 +130,11 @@ class datalayer
         bool get_property(const e::slice& property,
                           std::string* value);
         uint64_t approximate_size();
+        // bytes on disk for the objects and index entries of ri
+        uint64_t approximate_size(const region_id& ri);
+        // gets and writes served per region since we first held it
+        void region_ops(std::map<region_id, uint64_t>* ops);
+        void collect_stats(std::ostringstream* ret);
 
     public:
         // retrieve the current value of a key
@@ -121,6 +143,13 @@ class datalayer
                        std::vector<e::slice>* value,
                        uint64_t* version,
                        reference* ref);
+        // retrieve the value of a key as of snap; bypasses the object cache
+        returncode get(snapshot snap,
+                       const region_id& ri,
+                       const e::slice& key,
+                       std::vector<e::slice>* value,
+                       uint64_t* version,
+                       reference* ref);
         // put, overput, or delete a key where the existing value is known
         returncode del(const region_id& ri,
                        const region_id& reg_id,
@@ -147,6 +176,14 @@ class datalayer
                                  const e::slice& key,
                                  const std::vector<e::slice>& new_value,
                                  uint64_t version);
+        // remove every object and index entry of ri in bulk
+        returncode clear_region(const region_id& ri);
+        // put many objects, in a single write, that are known to be absent
+        // from the region (e.g., when state transfer fills an empty region)
+        returncode put_absent(const region_id& ri,
+                              const std::vector<e::slice>& keys,
+                              const std::vector<const std::vector<e::slice>*>& values,
+                              const std::vector<uint64_t>& versions);
         // get a logged transfer
         returncode get_transfer(const region_id& ri,
                                 uint64_t seq_no,
@@ -182,6 +219,12 @@ class datalayer
                                        const region_id& ri,
                                        const std::vector<attribute_check>& checks,
                                        std::ostringstream* ostr);
+        // walk the index on attr in value order; NULL if the subspace holding
+        // ri doesn't index attr or the index cannot be walked in order
+        iterator* make_ordered_iterator(snapshot snap,
+                                        const region_id& ri,
+                                        uint16_t attr,
+                                        bool reverse);
         // get the object pointed to by the iterator
         returncode get_from_iterator(const region_id& ri,
                                      iterator* iter,
@@ -189,20 +232,88 @@ class datalayer
                                      std::vector<e::slice>* value,
                                      uint64_t* version,
                                      reference* ref);
+        // Read the encoded objects of ri that sort after "cursor" (from the
+        // start of the region when empty) until max_bytes have been read.
+        // "records" alternates encoded keys and values and points into ref.
+        // The cursor is advanced; an empty "records" marks the end.
+        returncode get_raw_run(snapshot snap,
+                               const region_id& ri,
+                               std::string* cursor,
+                               uint64_t max_bytes,
+                               std::vector<e::slice>* records,
+                               reference* ref);
+        // write a run from get_raw_run into a region known not to hold any
+        // of its keys, regenerating index entries without re-encoding
+        returncode put_raw_run(const region_id& ri,
+                               const std::vector<e::slice>& records);
+
+    private:
+        class counting_cache;
+        class pending_write;
 
     private:
         datalayer(const datalayer&);
         datalayer& operator = (const datalayer&);
 
     private:
+        // write "updates" as part of a group commit with other threads
+        leveldb::Status commit(leveldb::WriteBatch* updates);
+        // approximate number of bytes of index for attr in region ri
+        uint64_t index_size(const region_id& ri, uint16_t attr);
+        // persist the index statistics; failure is logged, not fatal
+        void save_stats();
+        // delete every key in [start, limit) with batched writes, then
+        // compact the range so the tombstones don't linger; a non-NULL
+        // "dropped" means the cleaner is calling, which parks between batches
+        // for a pending reconfiguration, and stops early (setting *dropped
+        // to region_id()) if that reconfiguration handed the region back
+        returncode delete_range(const leveldb::Slice& start,
+                                const leveldb::Slice& limit,
+                                region_id* dropped);
+        returncode clear_region(const region_id& ri, bool cleaner);
+        // park the cleaner while a reconfiguration is pending; returns true
+        // if it parked, in which case the configuration may have changed
+        bool cleaner_park();
         void cleaner();
         void shutdown();
         returncode handle_error(leveldb::Status st);
+        void count_op(const region_id& ri)
+        { uint64_t ignored; m_region_ops.lookup(ri, &ignored); }
+        // each region we hold that the new configuration split or merged
+        // away, with the regions that replace it
+        typedef std::pair<region_id, std::vector<region_id> > rekey_plan_t;
+        static void plan_rekeys(const configuration& old_config,
+                                const configuration& new_config,
+                                const server_id& us,
+                                std::vector<rekey_plan_t>* plan);
+        // move the objects of "from", which the new configuration split or
+        // merged away, into the regions of "to" that now cover them
+        returncode rekey_region(const configuration& new_config,
+                                const region_id& from,
+                                const std::vector<region_id>& to);
+        // redo the objects written to "from" since prepare_reconfigure
+        // copied it, or the whole copy if that failed
+        returncode finish_rekey(const configuration& new_config,
+                                const region_id& from,
+                                const std::vector<region_id>& to);
+        // make the regions of "targets" agree with "from" on "key"
+        returncode rekey_object(const schema& sc,
+                                const subspace& sub,
+                                const region_id& from,
+                                const std::vector<const region*>& targets,
+                                const e::slice& key);
+        // every write to a region calls this once it is committed
+        void note_write(const region_id& ri, const e::slice& key);
 
     private:
         daemon* m_daemon;
+        // owned by m_db
+        counting_cache* m_cache;
         leveldb_db_ptr m_db;
         counter_map m_counters;
+        counter_map m_region_ops;
+        index_stats m_stats;
+        object_cache m_objects;
         po6::threads::thread m_cleaner;
         po6::threads::mutex m_block_cleaner;
         po6::threads::cond m_wakeup_cleaner;
@@ -212,6 +323,21 @@ class datalayer
         bool m_need_pause;
         bool m_paused;
         std::set<capture_id> m_state_transfer_captures;
+        std::set<region_id> m_dropped_regions;
+        // regions being copied by prepare_reconfigure, and the keys written
+        // to each since; m_rekey_watching is read without m_rekey_mtx
+        po6::threads::mutex m_rekey_mtx;
+        uint32_t m_rekey_watching;
+        std::map<region_id, std::set<std::string> > m_rekey_touched;
+        std::set<region_id> m_rekey_cleared;
+        std::map<region_id, returncode> m_rekey_copied;
+        po6::threads::mutex m_commit_mtx;
+        std::list<pending_write*> m_commit_queue;
+        performance_counter m_perf_commits;
+        performance_counter m_perf_commit_writes;
+        performance_counter m_perf_commit_wait;
+        latency_histogram m_perf_leveldb_get;
+        latency_histogram m_perf_leveldb_write;
 };
 
 class datalayer::reference
@@ -228,6 +354,7 @@ class datalayer::reference
 
     private:
         std::string m_backing;
+        object_cache::backing_ptr m_cached;
 };
 
 std::ostream&
@@ -97,6 +97,33 @@ hyperdex :: decode_key(const leveldb::Slice& in,
     return true;
 }
 
+bool
+hyperdex :: decode_key(const leveldb::Slice& in,
+                       hyperdatatype key_type,
+                       region_id* ri,
+                       std::vector<char>* scratch,
+                       e::slice* key)
+{
+    e::slice internal_key;
+
+    if (!decode_key(in, ri, &internal_key))
+    {
+        return false;
+    }
+
+    index_info* ii(index_info::lookup(key_type));
+    size_t sz = ii->decoded_size(internal_key);
+
+    if (scratch->size() < sz + 1)
+    {
+        scratch->resize(sz + 1);
+    }
+
+    ii->decode(internal_key, &scratch->front());
+    *key = e::slice(&scratch->front(), sz);
+    return true;
+}
+
 void
 hyperdex :: encode_value(const std::vector<e::slice>& attrs,
                          uint64_t version,
@@ -354,7 +381,8 @@ hyperdex :: create_index_changes(const schema& sc,
                                  const e::slice& key,
                                  const std::vector<e::slice>* old_value,
                                  const std::vector<e::slice>* new_value,
-                                 leveldb::WriteBatch* updates)
+                                 leveldb::WriteBatch* updates,
+                                 index_stats_delta* stats)
 {
     assert(!old_value || !new_value || old_value->size() == new_value->size());
     assert(!old_value || old_value->size() + 1 == sc.attrs_sz);
@@ -400,7 +428,7 @@ hyperdex :: create_index_changes(const schema& sc,
         ai->index_changes(ri, attr, ki, key,
                           old_value ? &(*old_value)[attr - 1] : NULL,
                           new_value ? &(*new_value)[attr - 1] : NULL,
-                          updates);
+                          updates, stats);
     }
 }
 
@@ -54,6 +54,14 @@ bool
 decode_key(const leveldb::Slice& in,
            region_id* ri,
            e::slice* internal_key);
+// like the above, but undo the key's index encoding as well; "key" points
+// into "scratch"
+bool
+decode_key(const leveldb::Slice& in,
+           hyperdatatype key_type,
+           region_id* ri,
+           std::vector<char>* scratch,
+           e::slice* key);
 
 void
 encode_value(const std::vector<e::slice>& attrs,
@@ -105,7 +113,8 @@ create_index_changes(const schema& sc,
                      const e::slice& key,
                      const std::vector<e::slice>* old_value,
                      const std::vector<e::slice>* new_value,
-                     leveldb::WriteBatch* updates);
+                     leveldb::WriteBatch* updates,
+                     index_stats_delta* stats);
 
 void
 encode_bump(char* start, char* end);
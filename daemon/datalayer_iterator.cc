@@ -27,6 +27,9 @@
 
 #define __STDC_LIMIT_MACROS
 
+// STL
+#include <algorithm>
+
 // e
 #include <e/endian.h>
 
@@ -366,13 +369,155 @@ datalayer :: intersect_iterator :: seek(const e::slice& k)
     return m_iters[0]->seek(k);
 }
 
+///////////////////////// class hash_intersect_iterator ////////////////////////
+
+datalayer :: hash_intersect_iterator :: hash_intersect_iterator(leveldb_snapshot_ptr s,
+                                                                e::intrusive_ptr<index_iterator> driver,
+                                                                const std::vector<e::intrusive_ptr<index_iterator> >& filters)
+    : index_iterator(s)
+    , m_driver(driver)
+    , m_filters()
+    , m_keys()
+    , m_cost(0)
+    , m_materialized(false)
+{
+    assert(m_driver);
+    assert(!filters.empty());
+    std::vector<std::pair<uint64_t, e::intrusive_ptr<index_iterator> > > iters;
+
+    for (size_t i = 0; i < filters.size(); ++i)
+    {
+        iters.push_back(std::make_pair(filters[i]->cost(s.db()), filters[i]));
+    }
+
+    // materialize the smallest filter first so the hash set only shrinks
+    std::sort(iters.begin(), iters.end());
+    m_filters.resize(iters.size());
+    m_cost = m_driver->cost(s.db());
+
+    for (size_t i = 0; i < iters.size(); ++i)
+    {
+        m_cost += iters[i].first;
+        m_filters[i] = iters[i].second;
+    }
+}
+
+datalayer :: hash_intersect_iterator :: ~hash_intersect_iterator() throw ()
+{
+}
+
+bool
+datalayer :: hash_intersect_iterator :: valid()
+{
+    if (!m_materialized)
+    {
+        materialize();
+    }
+
+    while (m_driver->valid())
+    {
+        e::slice ik = m_driver->internal_key();
+        std::string k(reinterpret_cast<const char*>(ik.data()), ik.size());
+
+        if (m_keys.find(k) != m_keys.end())
+        {
+            return true;
+        }
+
+        m_driver->next();
+    }
+
+    return false;
+}
+
+void
+datalayer :: hash_intersect_iterator :: next()
+{
+    m_driver->next();
+}
+
+uint64_t
+datalayer :: hash_intersect_iterator :: cost(leveldb::DB*)
+{
+    return m_cost;
+}
+
+e::slice
+datalayer :: hash_intersect_iterator :: key()
+{
+    return m_driver->key();
+}
+
+std::ostream&
+datalayer :: hash_intersect_iterator :: describe(std::ostream& out) const
+{
+    out << "hash_intersect_iterator(" << *m_driver;
+
+    for (size_t i = 0; i < m_filters.size(); ++i)
+    {
+        out << ", " << *m_filters[i];
+    }
+
+    return out << ")";
+}
+
+e::slice
+datalayer :: hash_intersect_iterator :: internal_key()
+{
+    return m_driver->internal_key();
+}
+
+bool
+datalayer :: hash_intersect_iterator :: sorted()
+{
+    return m_driver->sorted();
+}
+
+void
+datalayer :: hash_intersect_iterator :: seek(const e::slice& k)
+{
+    m_driver->seek(k);
+}
+
+void
+datalayer :: hash_intersect_iterator :: materialize()
+{
+    m_materialized = true;
+
+    for (size_t i = 0; i < m_filters.size(); ++i)
+    {
+        std::tr1::unordered_set<std::string> keys;
+
+        while (m_filters[i]->valid())
+        {
+            e::slice ik = m_filters[i]->internal_key();
+            std::string k(reinterpret_cast<const char*>(ik.data()), ik.size());
+
+            if (i == 0 || m_keys.find(k) != m_keys.end())
+            {
+                keys.insert(k);
+            }
+
+            m_filters[i]->next();
+        }
+
+        m_keys.swap(keys);
+
+        if (m_keys.empty())
+        {
+            break;
+        }
+    }
+}
+
 ///////////////////////////// class search_iterator ////////////////////////////
 
 datalayer :: search_iterator :: search_iterator(datalayer* dl,
                                                 const region_id& ri,
                                                 e::intrusive_ptr<index_iterator> iter,
                                                 std::ostringstream* ostr,
-                                                const std::vector<attribute_check>* checks)
+                                                const std::vector<attribute_check>* checks,
+                                                bool covered)
     : iterator(iter->snap())
     , m_dl(dl)
     , m_ri(ri)
@@ -381,6 +526,7 @@ datalayer :: search_iterator :: search_iterator(datalayer* dl,
     , m_ostr(ostr)
     , m_num_gets(0)
     , m_checks(checks)
+    , m_covered(covered)
 {
 }
 
@@ -402,9 +548,14 @@ datalayer :: search_iterator :: valid()
         return false;
     }
 
+    if (m_covered)
+    {
+        return m_iter->valid();
+    }
+
     // Don't try to optimize by replacing m_ri with a const schema* because it
     // won't persist across reconfigurations
-    const schema& sc(*m_dl->m_daemon->m_config.get_schema(m_ri));
+    const schema& sc(*m_dl->m_daemon->m_config->get_schema(m_ri));
 
     uint64_t version;
     std::vector<e::slice> value;
@@ -28,6 +28,10 @@
 #ifndef hyperdex_daemon_datalayer_iterator_h_
 #define hyperdex_daemon_datalayer_iterator_h_
 
+// STL
+#include <string>
+#include <tr1/unordered_set>
+
 // e
 #include <e/intrusive_ptr.h>
 
@@ -148,6 +152,39 @@ class datalayer::intersect_iterator : public index_iterator
         bool m_invalid;
 };
 
+// Intersect a (possibly unsorted) driver with unsorted iterators by
+// materializing the keys of the latter into a hash set.  The keys are
+// materialized lazily on first use, and the iterator inherits the ordering
+// properties of the driver.
+class datalayer::hash_intersect_iterator : public index_iterator
+{
+    public:
+        hash_intersect_iterator(leveldb_snapshot_ptr snap,
+                                e::intrusive_ptr<index_iterator> driver,
+                                const std::vector<e::intrusive_ptr<index_iterator> >& filters);
+        virtual ~hash_intersect_iterator() throw ();
+
+    public:
+        virtual bool valid();
+        virtual void next();
+        virtual uint64_t cost(leveldb::DB*);
+        virtual e::slice key();
+        virtual std::ostream& describe(std::ostream&) const;
+        virtual e::slice internal_key();
+        virtual bool sorted();
+        virtual void seek(const e::slice& internal_key);
+
+    private:
+        void materialize();
+
+    private:
+        e::intrusive_ptr<index_iterator> m_driver;
+        std::vector<e::intrusive_ptr<index_iterator> > m_filters;
+        std::tr1::unordered_set<std::string> m_keys;
+        uint64_t m_cost;
+        bool m_materialized;
+};
+
 class datalayer::search_iterator : public iterator
 {
     public:
@@ -155,7 +192,8 @@ class datalayer::search_iterator : public iterator
                         const region_id& ri,
                         e::intrusive_ptr<index_iterator> iter,
                         std::ostringstream* ostr,
-                        const std::vector<attribute_check>* checks);
+                        const std::vector<attribute_check>* checks,
+                        bool covered);
         virtual ~search_iterator() throw ();
 
     public:
@@ -177,6 +215,8 @@ class datalayer::search_iterator : public iterator
         std::ostringstream* m_ostr;
         uint64_t m_num_gets;
         const std::vector<attribute_check>* m_checks;
+        // every check is answered exactly by m_iter
+        bool m_covered;
 };
 
 inline std::ostream&
@@ -83,7 +83,8 @@ index_container :: index_changes(const region_id& ri,
                                  const e::slice& key,
                                  const e::slice* old_value,
                                  const e::slice* new_value,
-                                 leveldb::WriteBatch* updates)
+                                 leveldb::WriteBatch* updates,
+                                 index_stats_delta* stats)
 {
     std::vector<e::slice> old_elems;
     std::vector<e::slice> new_elems;
@@ -118,20 +119,20 @@ index_container :: index_changes(const region_id& ri,
         {
             ii->index_changes(ri, attr, key_ii, key,
                               &old_elems[old_idx], &new_elems[new_idx],
-                              updates);
+                              updates, stats);
             ++old_idx;
             ++new_idx;
         }
         else if (old_elems[old_idx] < new_elems[new_idx])
         {
             ii->index_changes(ri, attr, key_ii, key,
-                              &old_elems[old_idx], NULL, updates);
+                              &old_elems[old_idx], NULL, updates, stats);
             ++old_idx;
         }
         else if (old_elems[old_idx] > new_elems[new_idx])
         {
             ii->index_changes(ri, attr, key_ii, key,
-                              NULL, &new_elems[new_idx], updates);
+                              NULL, &new_elems[new_idx], updates, stats);
             ++new_idx;
         }
     }
@@ -139,14 +140,14 @@ index_container :: index_changes(const region_id& ri,
     while (old_idx < old_elems.size())
     {
         ii->index_changes(ri, attr, key_ii, key,
-                          &old_elems[old_idx], NULL, updates);
+                          &old_elems[old_idx], NULL, updates, stats);
         ++old_idx;
     }
 
     while (new_idx < new_elems.size())
     {
         ii->index_changes(ri, attr, key_ii, key,
-                          NULL, &new_elems[new_idx], updates);
+                          NULL, &new_elems[new_idx], updates, stats);
         ++new_idx;
     }
 }
@@ -136,3 +136,13 @@ index_info :: iterator_from_check(leveldb_snapshot_ptr,
 {
     return NULL;
 }
+
+datalayer::index_iterator*
+index_info :: iterator_in_order(leveldb_snapshot_ptr,
+                                const region_id&,
+                                uint16_t,
+                                bool,
+                                index_info*)
+{
+    return NULL;
+}
@@ -43,6 +43,7 @@
 #include "daemon/datalayer.h"
 
 BEGIN_HYPERDEX_NAMESPACE
+class index_stats_delta;
 
 class index_info
 {
@@ -74,14 +75,16 @@ class index_info
     // override these if the type can be in a localized index
     public:
         // apply to updates all the writes necessary to transform the index from
-        // old_value to new_value
+        // old_value to new_value; if stats is non-NULL, record the entries
+        // added and removed in it
         virtual void index_changes(const region_id& ri,
                                    uint16_t attr,
                                    index_info* key_ii,
                                    const e::slice& key,
                                    const e::slice* old_value,
                                    const e::slice* new_value,
-                                   leveldb::WriteBatch* updates) = 0;
+                                   leveldb::WriteBatch* updates,
+                                   index_stats_delta* stats) = 0;
         // return an iterator that retrieves at least the keys matching r
         // if not indexable (full scan), return NULL
         virtual datalayer::index_iterator* iterator_from_range(leveldb_snapshot_ptr snap,
@@ -94,6 +97,14 @@ class index_info
                                                                const region_id& ri,
                                                                const attribute_check& c,
                                                                index_info* key_ii);
+        // return an iterator that visits every key indexed under attr in the
+        // order of the attribute's value (descending if reverse is set)
+        // if the index cannot be walked in value order, return NULL
+        virtual datalayer::index_iterator* iterator_in_order(leveldb_snapshot_ptr snap,
+                                                             const region_id& ri,
+                                                             uint16_t attr,
+                                                             bool reverse,
+                                                             index_info* key_ii);
 };
 
 END_HYPERDEX_NAMESPACE
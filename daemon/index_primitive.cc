@@ -25,6 +25,9 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+// C
+#include <cstdlib>
+
 // e
 #include <e/endian.h>
 
@@ -32,6 +35,7 @@
 #include "daemon/datalayer_encodings.h"
 #include "daemon/datalayer_iterator.h"
 #include "daemon/index_primitive.h"
+#include "daemon/index_stats.h"
 
 using hyperdex::datalayer;
 using hyperdex::index_primitive;
@@ -51,8 +55,11 @@ index_primitive :: index_changes(const region_id& ri,
                                  const e::slice& key,
                                  const e::slice* old_value,
                                  const e::slice* new_value,
-                                 leveldb::WriteBatch* updates)
+                                 leveldb::WriteBatch* updates,
+                                 index_stats_delta* stats)
 {
+    // offset of the encoded value within an index entry
+    const size_t value_off = sizeof(uint8_t) + sizeof(uint64_t) + sizeof(uint16_t);
     std::vector<char> scratch;
     leveldb::Slice slice;
 
@@ -65,12 +72,24 @@ index_primitive :: index_changes(const region_id& ri,
     {
         index_entry(ri, attr, key_ii, key, *old_value, &scratch, &slice);
         updates->Delete(slice);
+
+        if (stats)
+        {
+            e::slice encoded(slice.data() + value_off, this->encoded_size(*old_value));
+            stats->remove(ri, attr, encoded, slice.size());
+        }
     }
 
     if (new_value)
     {
         index_entry(ri, attr, key_ii, key, *new_value, &scratch, &slice);
         updates->Put(slice, leveldb::Slice());
+
+        if (stats)
+        {
+            e::slice encoded(slice.data() + value_off, this->encoded_size(*new_value));
+            stats->add(ri, attr, encoded, slice.size());
+        }
     }
 }
 
@@ -281,9 +300,23 @@ class range_iterator : public datalayer::index_iterator
         index_primitive* m_val_ii;
         index_info* m_key_ii;
         std::vector<char> m_scratch;
+        // the range owns its bounds; the encoded forms are what we compare
+        // against the values stored in the index
+        std::string m_start;
+        std::string m_end;
+        std::string m_start_encoded;
+        std::string m_end_encoded;
         bool m_invalid;
 };
 
+void
+encode_bound(index_info* ii, const e::slice& value, std::string* out)
+{
+    std::vector<char> scratch(ii->encoded_size(value) + 1);
+    char* end = ii->encode(value, &scratch.front());
+    out->assign(&scratch.front(), end);
+}
+
 range_iterator :: range_iterator(leveldb_snapshot_ptr s,
                                  const region_id& ri, 
                                  const range& r,
@@ -296,8 +329,26 @@ range_iterator :: range_iterator(leveldb_snapshot_ptr s,
     , m_val_ii(val_ii)
     , m_key_ii(key_ii)
     , m_scratch()
+    , m_start()
+    , m_end()
+    , m_start_encoded()
+    , m_end_encoded()
     , m_invalid(false)
 {
+    if (m_range.has_start)
+    {
+        m_start.assign(reinterpret_cast<const char*>(r.start.data()), r.start.size());
+        m_range.start = e::slice(m_start.data(), m_start.size());
+        encode_bound(m_val_ii, m_range.start, &m_start_encoded);
+    }
+
+    if (m_range.has_end)
+    {
+        m_end.assign(reinterpret_cast<const char*>(r.end.data()), r.end.size());
+        m_range.end = e::slice(m_end.data(), m_end.size());
+        encode_bound(m_val_ii, m_range.end, &m_end_encoded);
+    }
+
     leveldb::ReadOptions opts;
     opts.fill_cache = true;
     opts.verify_checksums = true;
@@ -349,11 +400,11 @@ range_iterator :: valid()
         // the iterator
         if (m_range.has_start)
         {
-            size_t sz = std::min(m_range.start.size(), v.size());
-            int cmp = memcmp(m_range.start.data(), v.data(), sz);
+            size_t sz = std::min(m_start_encoded.size(), v.size());
+            int cmp = memcmp(m_start_encoded.data(), v.data(), sz);
 
             if (cmp > 0 ||
-                (cmp == 0 && m_range.start.size() > v.size()))
+                (cmp == 0 && m_start_encoded.size() > v.size()))
             {
                 m_iter->Next();
                 continue;
@@ -365,8 +416,8 @@ range_iterator :: valid()
         // advance to the end
         if (m_range.has_end)
         {
-            size_t sz = std::min(m_range.end.size(), v.size());
-            int cmp = memcmp(m_range.end.data(), v.data(), sz);
+            size_t sz = std::min(m_end_encoded.size(), v.size());
+            int cmp = memcmp(m_end_encoded.data(), v.data(), sz);
 
             if (cmp < 0)
             {
@@ -374,7 +425,7 @@ range_iterator :: valid()
                 return false;
             }
 
-            if (cmp == 0 && m_range.end.size() < v.size())
+            if (cmp == 0 && m_end_encoded.size() < v.size())
             {
                 m_iter->Next();
                 continue;
@@ -397,7 +448,11 @@ range_iterator :: next()
 uint64_t
 range_iterator :: cost(leveldb::DB* db)
 {
-    assert(this->sorted());
+    if (!m_iter->Valid())
+    {
+        return 0;
+    }
+
     leveldb::Slice upper;
 
     if (m_range.has_end)
@@ -409,7 +464,7 @@ range_iterator :: cost(leveldb::DB* db)
         m_val_ii->index_entry(m_ri, m_range.attr, &m_scratch, &upper);
     }
 
-    hyperdex::encode_bump(&m_scratch.front(), &m_scratch.front() + m_scratch.size());
+    hyperdex::encode_bump(&m_scratch.front(), &m_scratch.front() + upper.size());
     // create the range
     leveldb::Range r;
     r.start = m_iter->key();
@@ -438,7 +493,7 @@ range_iterator :: key()
 std::ostream&
 range_iterator :: describe(std::ostream& out) const
 {
-    return out << "primitive range_iterator()";
+    return out << "primitive range_iterator(attr=" << m_range.attr << ")";
 }
 
 e::slice
@@ -584,6 +639,12 @@ uint64_t
 key_iterator :: cost(leveldb::DB* db)
 {
     assert(this->sorted());
+
+    if (!m_iter->Valid())
+    {
+        return 0;
+    }
+
     leveldb::Slice upper;
 
     if (m_range.has_end)
@@ -595,7 +656,7 @@ key_iterator :: cost(leveldb::DB* db)
         encode_object_region(m_ri, &m_scratch, &upper);
     }
 
-    hyperdex::encode_bump(&m_scratch.front(), &m_scratch.front() + m_scratch.size());
+    hyperdex::encode_bump(&m_scratch.front(), &m_scratch.front() + upper.size());
     // create the range
     leveldb::Range r;
     r.start = m_iter->key();
@@ -651,6 +712,198 @@ key_iterator :: seek(const e::slice& ik)
     m_iter->Seek(slice);
 }
 
+// Walk every entry of one attribute's index in the order of the encoded
+// values.  This is only meaningful for fixed-size encodings:  with variable
+// sized values the key appended to each entry interleaves with the value and
+// memcmp no longer reflects the ordering of the values alone.
+class ordered_iterator : public datalayer::index_iterator
+{
+    public:
+        ordered_iterator(leveldb_snapshot_ptr snap,
+                         const region_id& ri,
+                         uint16_t attr,
+                         bool reverse,
+                         index_primitive* val_ii,
+                         index_info* key_ii);
+        virtual ~ordered_iterator() throw ();
+
+    public:
+        virtual bool valid();
+        virtual void next();
+        virtual uint64_t cost(leveldb::DB*);
+        virtual e::slice key();
+        virtual std::ostream& describe(std::ostream&) const;
+        virtual e::slice internal_key();
+        virtual bool sorted();
+        virtual void seek(const e::slice& internal_key);
+
+    private:
+        ordered_iterator(const ordered_iterator&);
+        ordered_iterator& operator = (const ordered_iterator&);
+
+    private:
+        leveldb_iterator_ptr m_iter;
+        region_id m_ri;
+        uint16_t m_attr;
+        bool m_reverse;
+        index_primitive* m_val_ii;
+        index_info* m_key_ii;
+        std::vector<char> m_scratch;
+        bool m_invalid;
+};
+
+ordered_iterator :: ordered_iterator(leveldb_snapshot_ptr s,
+                                     const region_id& ri,
+                                     uint16_t attr,
+                                     bool reverse,
+                                     index_primitive* val_ii,
+                                     index_info* key_ii)
+    : index_iterator(s)
+    , m_iter()
+    , m_ri(ri)
+    , m_attr(attr)
+    , m_reverse(reverse)
+    , m_val_ii(val_ii)
+    , m_key_ii(key_ii)
+    , m_scratch()
+    , m_invalid(false)
+{
+    assert(m_val_ii->encoding_fixed());
+    leveldb::ReadOptions opts;
+    opts.fill_cache = true;
+    opts.verify_checksums = true;
+    opts.snapshot = s.get();
+    m_iter.reset(s, s.db()->NewIterator(opts));
+
+    leveldb::Slice slice;
+    m_val_ii->index_entry(m_ri, m_attr, &m_scratch, &slice);
+
+    if (!m_reverse)
+    {
+        m_iter->Seek(slice);
+        return;
+    }
+
+    // position on the first entry past this attribute's index, and step back
+    hyperdex::encode_bump(&m_scratch.front(), &m_scratch.front() + slice.size());
+    m_iter->Seek(slice);
+
+    if (m_iter->Valid())
+    {
+        m_iter->Prev();
+    }
+    else
+    {
+        m_iter->SeekToLast();
+    }
+}
+
+ordered_iterator :: ~ordered_iterator() throw ()
+{
+}
+
+bool
+ordered_iterator :: valid()
+{
+    if (m_invalid || !m_iter->Valid())
+    {
+        return false;
+    }
+
+    leveldb::Slice _k = m_iter->key();
+    region_id ri;
+    uint16_t attr;
+    e::slice v;
+    e::slice k;
+
+    if (!decode_entry(_k, m_val_ii, m_key_ii, &ri, &attr, &v, &k) ||
+        ri != m_ri || attr != m_attr)
+    {
+        m_invalid = true;
+        return false;
+    }
+
+    return true;
+}
+
+void
+ordered_iterator :: next()
+{
+    if (m_reverse)
+    {
+        m_iter->Prev();
+    }
+    else
+    {
+        m_iter->Next();
+    }
+}
+
+uint64_t
+ordered_iterator :: cost(leveldb::DB* db)
+{
+    std::vector<char> lower_scratch;
+    std::vector<char> upper_scratch;
+    leveldb::Slice lower;
+    leveldb::Slice upper;
+    m_val_ii->index_entry(m_ri, m_attr, &lower_scratch, &lower);
+    m_val_ii->index_entry(m_ri, m_attr, &upper_scratch, &upper);
+    hyperdex::encode_bump(&upper_scratch.front(), &upper_scratch.front() + upper.size());
+    leveldb::Range r;
+    r.start = lower;
+    r.limit = upper;
+    uint64_t ret;
+    db->GetApproximateSizes(&r, 1, &ret);
+    return ret;
+}
+
+e::slice
+ordered_iterator :: key()
+{
+    e::slice ik = this->internal_key();
+    size_t decoded_sz = m_key_ii->decoded_size(ik);
+
+    if (m_scratch.size() < decoded_sz)
+    {
+        m_scratch.resize(decoded_sz);
+    }
+
+    m_key_ii->decode(ik, &m_scratch.front());
+    return e::slice(&m_scratch.front(), decoded_sz);
+}
+
+std::ostream&
+ordered_iterator :: describe(std::ostream& out) const
+{
+    return out << "primitive ordered_iterator(attr=" << m_attr
+               << (m_reverse ? ", descending)" : ", ascending)");
+}
+
+e::slice
+ordered_iterator :: internal_key()
+{
+    leveldb::Slice _k = m_iter->key();
+    region_id ri;
+    uint16_t attr;
+    e::slice v;
+    e::slice k;
+    decode_entry(_k, m_val_ii, m_key_ii, &ri, &attr, &v, &k);
+    return k;
+}
+
+bool
+ordered_iterator :: sorted()
+{
+    // ordered by value, not by key
+    return false;
+}
+
+void
+ordered_iterator :: seek(const e::slice&)
+{
+    abort();
+}
+
 } // namespace
 
 datalayer::index_iterator*
@@ -673,3 +926,18 @@ index_primitive :: iterator_from_range(leveldb_snapshot_ptr snap,
         return new key_iterator(snap, ri, r, key_ii);
     }
 }
+
+datalayer::index_iterator*
+index_primitive :: iterator_in_order(leveldb_snapshot_ptr snap,
+                                     const region_id& ri,
+                                     uint16_t attr,
+                                     bool reverse,
+                                     index_info* key_ii)
+{
+    if (attr == 0 || !this->encoding_fixed())
+    {
+        return NULL;
+    }
+
+    return new ordered_iterator(snap, ri, attr, reverse, this, key_ii);
+}
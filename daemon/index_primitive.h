@@ -47,11 +47,17 @@ class index_primitive : public index_info
                                    const e::slice& key,
                                    const e::slice* old_value,
                                    const e::slice* new_value,
-                                   leveldb::WriteBatch* updates);
+                                   leveldb::WriteBatch* updates,
+                                   index_stats_delta* stats);
         virtual datalayer::index_iterator* iterator_from_range(leveldb_snapshot_ptr snap,
                                                                const region_id& ri,
                                                                const range& r,
                                                                index_info* key_ii);
+        virtual datalayer::index_iterator* iterator_in_order(leveldb_snapshot_ptr snap,
+                                                             const region_id& ri,
+                                                             uint16_t attr,
+                                                             bool reverse,
+                                                             index_info* key_ii);
 
     public:
         void index_entry(const region_id& ri,
@@ -0,0 +1,563 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// C
+#include <string.h>
+
+// STL
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+
+// CityHash
+#include <city.h>
+
+// e
+#include <e/buffer.h>
+
+// HyperDex
+#include "common/serialization.h"
+#include "daemon/index_stats.h"
+
+using hyperdex::index_stats;
+using hyperdex::index_stats_delta;
+
+// Number of values kept in the reservoir sample for each index
+#define SAMPLE_SIZE 512
+// Number of buckets in the equi-depth histogram
+#define HISTOGRAM_BUCKETS 16
+// Do not offer estimates based on fewer samples than this
+#define MIN_SAMPLES 32
+// Number of independently locked shards of statistics
+#define SHARDS 64
+
+namespace
+{
+
+uint64_t
+mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+int
+compare(const std::string& lhs, const e::slice& rhs)
+{
+    size_t sz = std::min(lhs.size(), rhs.size());
+    int cmp = memcmp(lhs.data(), rhs.data(), sz);
+
+    if (cmp != 0)
+    {
+        return cmp;
+    }
+
+    if (lhs.size() < rhs.size())
+    {
+        return -1;
+    }
+
+    if (lhs.size() > rhs.size())
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+struct before_slice
+{
+    bool operator () (const std::string& lhs, const e::slice& rhs) const
+    { return compare(lhs, rhs) < 0; }
+    bool operator () (const e::slice& lhs, const std::string& rhs) const
+    { return compare(rhs, lhs) > 0; }
+};
+
+} // namespace
+
+index_stats :: index_stats()
+    : m_shards(new shard[SHARDS])
+{
+}
+
+index_stats :: ~index_stats() throw ()
+{
+}
+
+void
+index_stats :: add(const region_id& ri, uint16_t attr,
+                   const e::slice& value, size_t entry_sz)
+{
+    shard* s = shard_for(ri, attr);
+    po6::threads::mutex::hold hold(&s->mtx);
+    s->stats[std::make_pair(ri, attr)].add(value, entry_sz);
+}
+
+void
+index_stats :: remove(const region_id& ri, uint16_t attr,
+                      const e::slice& value, size_t entry_sz)
+{
+    shard* s = shard_for(ri, attr);
+    po6::threads::mutex::hold hold(&s->mtx);
+    s->stats[std::make_pair(ri, attr)].remove(value, entry_sz);
+}
+
+void
+index_stats :: apply(const index_stats_delta& d)
+{
+    for (size_t i = 0; i < d.m_changes.size(); ++i)
+    {
+        const index_stats_delta::change& c(d.m_changes[i]);
+
+        if (c.add)
+        {
+            add(c.ri, c.attr, e::slice(c.value), c.entry_sz);
+        }
+        else
+        {
+            remove(c.ri, c.attr, e::slice(c.value), c.entry_sz);
+        }
+    }
+}
+
+void
+index_stats :: adopt(const std::vector<region_id>& ris)
+{
+    for (size_t i = 0; i < SHARDS; ++i)
+    {
+        po6::threads::mutex::hold hold(&m_shards[i].mtx);
+        stats_map_t& stats(m_shards[i].stats);
+        stats_map_t::iterator it = stats.begin();
+
+        while (it != stats.end())
+        {
+            if (std::binary_search(ris.begin(), ris.end(), it->first.first))
+            {
+                ++it;
+            }
+            else
+            {
+                stats.erase(it++);
+            }
+        }
+    }
+}
+
+void
+index_stats :: clear(const region_id& ri)
+{
+    for (size_t i = 0; i < SHARDS; ++i)
+    {
+        po6::threads::mutex::hold hold(&m_shards[i].mtx);
+        stats_map_t& stats(m_shards[i].stats);
+        stats_map_t::iterator it = stats.lower_bound(std::make_pair(ri, uint16_t(0)));
+
+        while (it != stats.end() && it->first.first == ri)
+        {
+            stats.erase(it++);
+        }
+    }
+}
+
+bool
+index_stats :: estimate(const region_id& ri, uint16_t attr,
+                        const e::slice* start, const e::slice* end,
+                        double* fraction, uint64_t* bytes)
+{
+    shard* s = shard_for(ri, attr);
+    po6::threads::mutex::hold hold(&s->mtx);
+    stats_map_t::iterator it = s->stats.find(std::make_pair(ri, attr));
+
+    if (it == s->stats.end())
+    {
+        return false;
+    }
+
+    return it->second.estimate(start, end, fraction, bytes);
+}
+
+void
+index_stats :: describe(const region_id& ri, uint16_t attr, std::ostream& out)
+{
+    shard* s = shard_for(ri, attr);
+    po6::threads::mutex::hold hold(&s->mtx);
+    stats_map_t::iterator it = s->stats.find(std::make_pair(ri, attr));
+
+    if (it == s->stats.end())
+    {
+        out << "no statistics";
+        return;
+    }
+
+    it->second.describe(out);
+}
+
+void
+index_stats :: serialize(std::string* out)
+{
+    // copy each shard out under its own lock; the result need not be a
+    // consistent cut across shards
+    stats_map_t all;
+
+    for (size_t i = 0; i < SHARDS; ++i)
+    {
+        po6::threads::mutex::hold hold(&m_shards[i].mtx);
+        all.insert(m_shards[i].stats.begin(), m_shards[i].stats.end());
+    }
+
+    size_t sz = sizeof(uint64_t);
+    std::vector<std::vector<e::slice> > samples;
+    samples.reserve(all.size());
+
+    for (stats_map_t::iterator it = all.begin();
+            it != all.end(); ++it)
+    {
+        const attribute& a(it->second);
+        samples.push_back(std::vector<e::slice>());
+
+        for (size_t i = 0; i < a.m_sample.size(); ++i)
+        {
+            samples.back().push_back(e::slice(a.m_sample[i]));
+        }
+
+        sz += sizeof(uint64_t) + sizeof(uint16_t)
+            + 3 * sizeof(uint64_t)
+            + pack_size(e::slice(&a.m_distinct.registers()[0],
+                                 a.m_distinct.registers().size()))
+            + pack_size(samples.back());
+    }
+
+    std::auto_ptr<e::buffer> buf(e::buffer::create(sz));
+    e::buffer::packer pa = buf->pack_at(0);
+    pa = pa << uint64_t(all.size());
+    size_t idx = 0;
+
+    for (stats_map_t::iterator it = all.begin();
+            it != all.end(); ++it, ++idx)
+    {
+        const attribute& a(it->second);
+        e::slice regs(&a.m_distinct.registers()[0],
+                      a.m_distinct.registers().size());
+        pa = pa << it->first.first << it->first.second
+                << a.m_entries << a.m_bytes << a.m_seen
+                << regs << samples[idx];
+    }
+
+    out->assign(reinterpret_cast<const char*>(buf->data()), buf->size());
+}
+
+bool
+index_stats :: deserialize(const e::slice& in)
+{
+    std::vector<stats_map_t> stats(SHARDS);
+    e::unpacker up(in.data(), in.size());
+    uint64_t count = 0;
+    up = up >> count;
+
+    for (uint64_t i = 0; !up.error() && i < count; ++i)
+    {
+        region_id ri;
+        uint16_t attr = 0;
+        attribute a;
+        e::slice regs;
+        std::vector<e::slice> sample;
+        up = up >> ri >> attr >> a.m_entries >> a.m_bytes >> a.m_seen
+                >> regs >> sample;
+
+        if (up.error() ||
+            !a.m_distinct.set_registers(regs.data(), regs.size()) ||
+            sample.size() > SAMPLE_SIZE)
+        {
+            return false;
+        }
+
+        for (size_t j = 0; j < sample.size(); ++j)
+        {
+            a.m_sample.push_back(sample[j].str());
+        }
+
+        stats[shard_for(ri, attr) - m_shards.get()][std::make_pair(ri, attr)] = a;
+    }
+
+    if (up.error())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < SHARDS; ++i)
+    {
+        po6::threads::mutex::hold hold(&m_shards[i].mtx);
+        m_shards[i].stats.swap(stats[i]);
+    }
+
+    return true;
+}
+
+index_stats::shard*
+index_stats :: shard_for(const region_id& ri, uint16_t attr)
+{
+    return &m_shards[mix(ri.get() ^ (uint64_t(attr) << 48)) % SHARDS];
+}
+
+index_stats :: shard :: shard()
+    : mtx()
+    , stats()
+{
+}
+
+index_stats :: shard :: ~shard() throw ()
+{
+}
+
+index_stats :: attribute :: attribute()
+    : m_entries(0)
+    , m_bytes(0)
+    , m_seen(0)
+    , m_distinct()
+    , m_sample()
+    , m_histogram_stale(true)
+    , m_sorted()
+    , m_bounds()
+{
+}
+
+index_stats :: attribute :: ~attribute() throw ()
+{
+}
+
+void
+index_stats :: attribute :: add(const e::slice& value, size_t entry_sz)
+{
+    uint64_t h = CityHash64(reinterpret_cast<const char*>(value.data()), value.size());
+    ++m_entries;
+    m_bytes += entry_sz;
+    ++m_seen;
+    m_distinct.add(h);
+
+    if (m_sample.size() < SAMPLE_SIZE)
+    {
+        m_sample.push_back(value.str());
+        m_histogram_stale = true;
+        return;
+    }
+
+    // reservoir sampling:  keep this value with probability SAMPLE_SIZE/seen.
+    // The value's hash is mixed with the count so that repeated values are
+    // not all-or-nothing.
+    uint64_t slot = mix(h ^ m_seen) % m_seen;
+
+    if (slot < SAMPLE_SIZE)
+    {
+        m_sample[slot] = value.str();
+        m_histogram_stale = true;
+    }
+}
+
+void
+index_stats :: attribute :: remove(const e::slice& value, size_t entry_sz)
+{
+    m_entries = m_entries > 0 ? m_entries - 1 : 0;
+    m_bytes = m_bytes > entry_sz ? m_bytes - entry_sz : 0;
+
+    // Once the reservoir is full it holds any one entry with probability
+    // SAMPLE_SIZE/entries, so only look for the value that often rather than
+    // scanning the sample on every removal.
+    if (m_sample.size() >= SAMPLE_SIZE)
+    {
+        uint64_t h = CityHash64(reinterpret_cast<const char*>(value.data()), value.size());
+
+        if (mix(h ^ m_entries) % std::max(m_entries, uint64_t(1)) >= m_sample.size())
+        {
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < m_sample.size(); ++i)
+    {
+        if (compare(m_sample[i], value) == 0)
+        {
+            std::swap(m_sample[i], m_sample.back());
+            m_sample.pop_back();
+            m_histogram_stale = true;
+            break;
+        }
+    }
+}
+
+bool
+index_stats :: attribute :: estimate(const e::slice* start, const e::slice* end,
+                                     double* fraction, uint64_t* bytes)
+{
+    if (m_sample.size() < MIN_SAMPLES || m_entries == 0)
+    {
+        return false;
+    }
+
+    build_histogram();
+    const double n = m_sorted.size();
+    const double per_bucket = 1.0 / HISTOGRAM_BUCKETS;
+    double frac = 0;
+
+    if (start && end && start->size() == end->size() &&
+        memcmp(start->data(), end->data(), start->size()) == 0)
+    {
+        // equality:  heavy hitters span several buckets, so go straight to
+        // the sample.  Values missing from the sample are assumed to be
+        // no more common than the average distinct value.
+        std::pair<std::vector<std::string>::iterator,
+                  std::vector<std::string>::iterator> eq;
+        eq = std::equal_range(m_sorted.begin(), m_sorted.end(), *start, before_slice());
+        frac = (eq.second - eq.first) / n;
+
+        if (frac == 0)
+        {
+            uint64_t distinct = std::max(m_distinct.estimate(), uint64_t(1));
+            frac = 1.0 / std::max(double(distinct), n);
+        }
+    }
+    else
+    {
+        // bucket i spans [m_bounds[i], m_bounds[i + 1]] and holds
+        // 1/HISTOGRAM_BUCKETS of the entries.  Buckets wholly inside the
+        // range count fully; partial overlaps count for half.
+        for (size_t i = 0; i + 1 < m_bounds.size(); ++i)
+        {
+            const std::string& lower(m_bounds[i]);
+            const std::string& upper(m_bounds[i + 1]);
+
+            if ((start && compare(upper, *start) < 0) ||
+                (end && compare(lower, *end) > 0))
+            {
+                continue;
+            }
+
+            if ((!start || compare(lower, *start) >= 0) &&
+                (!end || compare(upper, *end) <= 0))
+            {
+                frac += per_bucket;
+            }
+            else
+            {
+                frac += per_bucket / 2;
+            }
+        }
+
+        frac = std::min(frac, 1.0);
+    }
+
+    *fraction = frac;
+    *bytes = frac * m_bytes;
+    return true;
+}
+
+void
+index_stats :: attribute :: describe(std::ostream& out)
+{
+    build_histogram();
+    out << "entries=" << m_entries
+        << " bytes=" << m_bytes
+        << " distinct~" << m_distinct.estimate()
+        << " samples=" << m_sample.size()
+        << " histogram=[";
+
+    for (size_t i = 0; i < m_bounds.size(); ++i)
+    {
+        out << (i > 0 ? " " : "");
+
+        for (size_t j = 0; j < m_bounds[i].size(); ++j)
+        {
+            out << std::hex << std::setfill('0') << std::setw(2)
+                << (static_cast<unsigned>(m_bounds[i][j]) & 0xff);
+        }
+
+        out << std::dec;
+    }
+
+    out << "]";
+}
+
+void
+index_stats :: attribute :: build_histogram()
+{
+    if (!m_histogram_stale)
+    {
+        return;
+    }
+
+    m_sorted = m_sample;
+    std::sort(m_sorted.begin(), m_sorted.end());
+    m_bounds.clear();
+
+    if (!m_sorted.empty())
+    {
+        for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i)
+        {
+            m_bounds.push_back(m_sorted[i * m_sorted.size() / HISTOGRAM_BUCKETS]);
+        }
+
+        m_bounds.push_back(m_sorted.back());
+    }
+
+    m_histogram_stale = false;
+}
+
+index_stats_delta :: index_stats_delta()
+    : m_changes()
+{
+}
+
+index_stats_delta :: ~index_stats_delta() throw ()
+{
+}
+
+void
+index_stats_delta :: add(const region_id& ri, uint16_t attr,
+                         const e::slice& value, size_t entry_sz)
+{
+    m_changes.push_back(change(ri, attr, true, value, entry_sz));
+}
+
+void
+index_stats_delta :: remove(const region_id& ri, uint16_t attr,
+                            const e::slice& value, size_t entry_sz)
+{
+    m_changes.push_back(change(ri, attr, false, value, entry_sz));
+}
+
+index_stats_delta :: change :: change(const region_id& _ri, uint16_t _attr, bool _add,
+                                      const e::slice& _value, size_t _entry_sz)
+    : ri(_ri)
+    , attr(_attr)
+    , add(_add)
+    , value(_value.str())
+    , entry_sz(_entry_sz)
+{
+}
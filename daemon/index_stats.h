@@ -0,0 +1,198 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_daemon_index_stats_h_
+#define hyperdex_daemon_index_stats_h_
+
+// STL
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// po6
+#include <po6/threads/mutex.h>
+
+// e
+#include <e/array_ptr.h>
+#include <e/slice.h>
+
+// HyperDex
+#include "namespace.h"
+#include "common/hyperloglog.h"
+#include "common/ids.h"
+
+// Statistics about the secondary indices, maintained incrementally as index
+// entries are written.  For each (region, attribute) pair we track the number
+// and size of live index entries, a HyperLogLog sketch of the distinct values,
+// and a reservoir sample of values from which an equi-depth histogram is
+// derived.  All values are in their index encoding, so memcmp order is the
+// datatype's order.
+//
+// All calls are thread-safe.  The statistics are split across shards by
+// (region, attribute), each with its own lock, so that writers to different
+// indices do not contend.
+//
+// Writers record their index changes in an index_stats_delta while building a
+// batch, and apply it only once the batch commits, so that failed writes
+// leave the statistics untouched.
+
+BEGIN_HYPERDEX_NAMESPACE
+
+class index_stats_delta;
+
+class index_stats
+{
+    public:
+        index_stats();
+        ~index_stats() throw ();
+
+    public:
+        // record that an index entry of entry_sz bytes was added or removed
+        void add(const region_id& ri, uint16_t attr,
+                 const e::slice& value, size_t entry_sz);
+        void remove(const region_id& ri, uint16_t attr,
+                    const e::slice& value, size_t entry_sz);
+        // replay the changes recorded in d, in order
+        void apply(const index_stats_delta& d);
+        // drop statistics for every region not in the sorted "ris"
+        void adopt(const std::vector<region_id>& ris);
+        // drop statistics for ri, whose index entries were removed wholesale
+        void clear(const region_id& ri);
+        // estimate the fraction of index entries whose value falls in the
+        // inclusive range [start, end] (NULL for unbounded) and the number of
+        // bytes of index those entries occupy.  Returns false when there are
+        // too few samples to say anything useful.
+        bool estimate(const region_id& ri, uint16_t attr,
+                      const e::slice* start, const e::slice* end,
+                      double* fraction, uint64_t* bytes);
+        void describe(const region_id& ri, uint16_t attr, std::ostream& out);
+
+    public:
+        void serialize(std::string* out);
+        bool deserialize(const e::slice& in);
+
+    private:
+        class attribute;
+        class shard;
+        typedef std::pair<region_id, uint16_t> key_t;
+        typedef std::map<key_t, attribute> stats_map_t;
+
+    private:
+        shard* shard_for(const region_id& ri, uint16_t attr);
+
+    private:
+        index_stats(const index_stats&);
+        index_stats& operator = (const index_stats&);
+
+    private:
+        e::array_ptr<shard> m_shards;
+};
+
+class index_stats::attribute
+{
+    public:
+        attribute();
+        ~attribute() throw ();
+
+    public:
+        void add(const e::slice& value, size_t entry_sz);
+        void remove(const e::slice& value, size_t entry_sz);
+        bool estimate(const e::slice* start, const e::slice* end,
+                      double* fraction, uint64_t* bytes);
+        void describe(std::ostream& out);
+
+    private:
+        friend class index_stats;
+        void build_histogram();
+
+    private:
+        uint64_t m_entries;
+        uint64_t m_bytes;
+        uint64_t m_seen;
+        hyperloglog m_distinct;
+        std::vector<std::string> m_sample;
+        // derived from m_sample on demand
+        bool m_histogram_stale;
+        std::vector<std::string> m_sorted;
+        std::vector<std::string> m_bounds;
+};
+
+class index_stats::shard
+{
+    public:
+        shard();
+        ~shard() throw ();
+
+    public:
+        po6::threads::mutex mtx;
+        stats_map_t stats;
+
+    private:
+        shard(const shard&);
+        shard& operator = (const shard&);
+};
+
+// The index entries a single write adds and removes, held until the write
+// commits.  Not thread-safe; each writer keeps its own.
+class index_stats_delta
+{
+    public:
+        index_stats_delta();
+        ~index_stats_delta() throw ();
+
+    public:
+        void add(const region_id& ri, uint16_t attr,
+                 const e::slice& value, size_t entry_sz);
+        void remove(const region_id& ri, uint16_t attr,
+                    const e::slice& value, size_t entry_sz);
+
+    private:
+        friend class index_stats;
+        struct change
+        {
+            change(const region_id& ri, uint16_t attr, bool add,
+                   const e::slice& value, size_t entry_sz);
+            region_id ri;
+            uint16_t attr;
+            bool add;
+            std::string value;
+            size_t entry_sz;
+        };
+
+    private:
+        index_stats_delta(const index_stats_delta&);
+        index_stats_delta& operator = (const index_stats_delta&);
+
+    private:
+        std::vector<change> m_changes;
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_daemon_index_stats_h_
@@ -25,6 +25,9 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+// STL
+#include <string>
+
 // e
 #include <e/endian.h>
 
@@ -74,3 +77,99 @@ index_string :: decode(const e::slice& encoded, char* decoded)
     memmove(decoded, encoded.data(), encoded.size());
     return decoded + encoded.size();
 }
+
+namespace
+{
+
+// Compute the literal prefix every string matching an anchored regex must
+// begin with.  Stops at the first metacharacter, or at a literal that is
+// followed by a '*' (because the literal may then be absent).
+void
+regex_prefix(const e::slice& regex, std::string* prefix)
+{
+    const char* ptr = reinterpret_cast<const char*>(regex.data());
+    const char* end = ptr + regex.size();
+    prefix->clear();
+
+    if (ptr == end || *ptr != '^')
+    {
+        return;
+    }
+
+    ++ptr;
+
+    while (ptr < end)
+    {
+        char c = *ptr;
+        size_t width = 1;
+
+        if (c == '\\' && ptr + 1 < end)
+        {
+            c = ptr[1];
+            width = 2;
+        }
+        else if (c == '.' || c == '$' || c == '*' || c == '\\')
+        {
+            return;
+        }
+
+        if (ptr + width < end && ptr[width] == '*')
+        {
+            return;
+        }
+
+        prefix->push_back(c);
+        ptr += width;
+    }
+}
+
+} // namespace
+
+datalayer::index_iterator*
+index_string :: iterator_from_check(leveldb_snapshot_ptr snap,
+                                    const region_id& ri,
+                                    const attribute_check& c,
+                                    index_info* key_ii)
+{
+    if (c.predicate != HYPERPREDICATE_REGEX ||
+        c.datatype != HYPERDATATYPE_STRING)
+    {
+        return NULL;
+    }
+
+    std::string prefix;
+    regex_prefix(c.value, &prefix);
+
+    if (prefix.empty())
+    {
+        return NULL;
+    }
+
+    // every match lies in [prefix, successor(prefix)]; the range is inclusive,
+    // so the successor itself may come back too, but the search iterator
+    // re-checks each object against the regex and drops it
+    std::string upper(prefix);
+
+    while (!upper.empty() &&
+           static_cast<unsigned char>(upper[upper.size() - 1]) == 255)
+    {
+        upper.resize(upper.size() - 1);
+    }
+
+    range r;
+    r.attr = c.attr;
+    r.type = HYPERDATATYPE_STRING;
+    r.start = e::slice(prefix.data(), prefix.size());
+    r.has_start = true;
+    r.has_end = !upper.empty();
+    r.invalid = false;
+
+    if (r.has_end)
+    {
+        ++upper[upper.size() - 1];
+        r.end = e::slice(upper.data(), upper.size());
+    }
+
+    // the range iterator copies its bounds, so the locals may go away
+    return this->iterator_from_range(snap, ri, r, key_ii);
+}
@@ -46,6 +46,12 @@ class index_string : public index_primitive
         virtual char* encode(const e::slice& decoded, char* encoded);
         virtual size_t decoded_size(const e::slice& encoded);
         virtual char* decode(const e::slice& encoded, char* decoded);
+
+    public:
+        virtual datalayer::index_iterator* iterator_from_check(leveldb_snapshot_ptr snap,
+                                                               const region_id& ri,
+                                                               const attribute_check& c,
+                                                               index_info* key_ii);
 };
 
 END_HYPERDEX_NAMESPACE
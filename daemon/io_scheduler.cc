@@ -0,0 +1,230 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// C
+#include <time.h>
+
+// STL
+#include <algorithm>
+
+// e
+#include <e/time.h>
+
+// HyperDex
+#include "daemon/io_scheduler.h"
+
+using hyperdex::io_scheduler;
+
+// bytes per second granted to background work
+#define IO_RATE_MIN (4ULL << 20)
+#define IO_RATE_MAX (1ULL << 30)
+#define IO_RATE_INITIAL (64ULL << 20)
+// the bucket holds at most this much time's worth of tokens
+#define IO_BURST_NANOS 100000000ULL
+// back off when foreground latency is this far above its floor
+#define IO_BACKOFF_RATIO 2.0
+// let the floor creep up so it follows a change in workload
+#define IO_FLOOR_DRIFT 1.01
+
+io_scheduler :: io_scheduler()
+    : m_mtx()
+    , m_last_refill(e::time())
+    , m_rate(IO_RATE_INITIAL)
+    , m_tokens(0)
+    , m_floor(0)
+    , m_latest(0)
+    , m_turned_away(false)
+    , m_fg_nanos(0)
+    , m_fg_count(0)
+{
+    for (size_t i = 0; i < ACTIVITIES; ++i)
+    {
+        m_bytes[i] = 0;
+        m_throttled[i] = 0;
+    }
+}
+
+io_scheduler :: ~io_scheduler() throw ()
+{
+}
+
+void
+io_scheduler :: foreground(uint64_t nanos)
+{
+    __sync_add_and_fetch(&m_fg_nanos, nanos);
+    __sync_add_and_fetch(&m_fg_count, 1);
+}
+
+bool
+io_scheduler :: admit(activity a)
+{
+    po6::threads::mutex::hold hold(&m_mtx);
+    refill();
+
+    if (m_tokens > 0)
+    {
+        return true;
+    }
+
+    ++m_throttled[a];
+    m_turned_away = true;
+    return false;
+}
+
+void
+io_scheduler :: charge(activity a, uint64_t bytes)
+{
+    po6::threads::mutex::hold hold(&m_mtx);
+    m_tokens -= static_cast<int64_t>(bytes);
+    m_bytes[a] += bytes;
+}
+
+bool
+io_scheduler :: throttle(activity a, uint64_t bytes, const bool* give_up)
+{
+    charge(a, bytes);
+    bool counted = false;
+
+    while (true)
+    {
+        uint64_t wait;
+
+        {
+            po6::threads::mutex::hold hold(&m_mtx);
+            refill();
+
+            if (m_tokens > 0)
+            {
+                return true;
+            }
+
+            // set by another thread without m_mtx
+            if (give_up && *static_cast<const volatile bool*>(give_up))
+            {
+                return false;
+            }
+
+            if (!counted)
+            {
+                ++m_throttled[a];
+                counted = true;
+            }
+
+            uint64_t debt = 1 - m_tokens;
+            wait = std::min<uint64_t>(debt * 1000000000ULL / m_rate, IO_BURST_NANOS);
+            wait = std::max<uint64_t>(wait, 1000000ULL);
+        }
+
+        struct timespec ts;
+        ts.tv_sec = 0;
+        ts.tv_nsec = wait;
+        nanosleep(&ts, NULL);
+    }
+}
+
+bool
+io_scheduler :: tick()
+{
+    uint64_t nanos = __sync_lock_test_and_set(&m_fg_nanos, 0);
+    uint64_t count = __sync_lock_test_and_set(&m_fg_count, 0);
+    po6::threads::mutex::hold hold(&m_mtx);
+    refill();
+
+    if (count > 0)
+    {
+        m_latest = double(nanos) / count;
+
+        if (m_floor == 0 || m_latest < m_floor)
+        {
+            m_floor = m_latest;
+        }
+        else
+        {
+            m_floor *= IO_FLOOR_DRIFT;
+        }
+    }
+
+    if (count > 0 && m_latest > IO_BACKOFF_RATIO * m_floor)
+    {
+        m_rate = std::max<uint64_t>(m_rate / 2, IO_RATE_MIN);
+    }
+    else
+    {
+        m_rate = std::min<uint64_t>(m_rate + m_rate / 8, IO_RATE_MAX);
+    }
+
+    bool turned_away = m_turned_away;
+    m_turned_away = false;
+    return turned_away;
+}
+
+void
+io_scheduler :: collect_stats(std::ostringstream* ret)
+{
+    po6::threads::mutex::hold hold(&m_mtx);
+    *ret << " io.sched.rate=" << m_rate;
+    *ret << " io.sched.tokens=" << m_tokens;
+    *ret << " io.sched.fg_latency=" << uint64_t(m_latest);
+    *ret << " io.sched.fg_floor=" << uint64_t(m_floor);
+
+    for (size_t i = 0; i < ACTIVITIES; ++i)
+    {
+        const char* n = name(static_cast<activity>(i));
+        *ret << " io.sched." << n << "_bytes=" << m_bytes[i];
+        *ret << " io.sched." << n << "_throttled=" << m_throttled[i];
+    }
+}
+
+void
+io_scheduler :: refill()
+{
+    uint64_t now = e::time();
+    uint64_t elapsed = now > m_last_refill ? now - m_last_refill : 0;
+    m_last_refill = now;
+    int64_t burst = m_rate * IO_BURST_NANOS / 1000000000ULL;
+    int64_t added = double(m_rate) * elapsed / 1000000000.0;
+    m_tokens = std::min(m_tokens + added, burst);
+}
+
+const char*
+io_scheduler :: name(activity a)
+{
+    switch (a)
+    {
+        case TRANSFER:
+            return "transfer";
+        case CLEANUP:
+            return "cleanup";
+        case GROUP:
+            return "group";
+        case COMPACTION:
+            return "compaction";
+        case ACTIVITIES:
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,114 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_daemon_io_scheduler_h_
+#define hyperdex_daemon_io_scheduler_h_
+
+// C
+#include <stdint.h>
+
+// STL
+#include <sstream>
+
+// po6
+#include <po6/threads/mutex.h>
+
+// HyperDex
+#include "namespace.h"
+
+// Background disk activity (state transfer, cleanup, group operations and the
+// compactions they trigger) draws from a single token bucket.  The bucket's
+// rate adapts to the latency of foreground reads and writes:  it halves
+// whenever foreground latency exceeds IO_BACKOFF_RATIO times its recent floor
+// and otherwise grows by an eighth per tick.  Callers may overdraw the bucket;
+// the debt is repaid before anyone else is admitted.
+//
+// All calls are thread-safe.
+
+BEGIN_HYPERDEX_NAMESPACE
+
+class io_scheduler
+{
+    public:
+        enum activity
+        {
+            TRANSFER,
+            CLEANUP,
+            GROUP,
+            COMPACTION,
+            ACTIVITIES
+        };
+
+    public:
+        io_scheduler();
+        ~io_scheduler() throw ();
+
+    public:
+        // foreground reads and writes report their latency here
+        void foreground(uint64_t nanos);
+        // never blocks; false means "a" should wait for the next tick
+        bool admit(activity a);
+        // account for "bytes" of background I/O done on behalf of "a"
+        void charge(activity a, uint64_t bytes);
+        // charge, then sleep until the bucket is out of debt; for threads
+        // that may be held up without holding up anybody else.  Returns
+        // false, leaving the debt in place, if "*give_up" (when non-NULL)
+        // becomes true first.
+        bool throttle(activity a, uint64_t bytes, const bool* give_up);
+        // Refill the bucket and adapt the rate.  Must be called
+        // periodically by a single thread.  Returns true if any activity was
+        // turned away by "admit" since the last tick.
+        bool tick();
+        void collect_stats(std::ostringstream* ret);
+
+    private:
+        // caller must hold m_mtx
+        void refill();
+        static const char* name(activity a);
+
+    private:
+        io_scheduler(const io_scheduler&);
+        io_scheduler& operator = (const io_scheduler&);
+
+    private:
+        po6::threads::mutex m_mtx;
+        uint64_t m_last_refill;
+        uint64_t m_rate;
+        int64_t m_tokens;
+        double m_floor;
+        double m_latest;
+        bool m_turned_away;
+        // updated without m_mtx
+        uint64_t m_fg_nanos;
+        uint64_t m_fg_count;
+        uint64_t m_bytes[ACTIVITIES];
+        uint64_t m_throttled[ACTIVITIES];
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_daemon_io_scheduler_h_
@@ -0,0 +1,219 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#define __STDC_LIMIT_MACROS
+
+// C
+#include <stdint.h>
+#include <string.h>
+
+// e
+#include <e/atomic.h>
+
+// HyperDex
+#include "daemon/latency_histogram.h"
+
+using hyperdex::latency_histogram;
+
+namespace
+{
+
+uint64_t s_next_thread = 0;
+__thread uint64_t s_thread = UINT64_MAX;
+
+// a small number unique to the calling thread, shared by every histogram
+uint64_t
+this_thread()
+{
+    if (s_thread == UINT64_MAX)
+    {
+        uint64_t n;
+
+        do
+        {
+            n = e::atomic::load_64_nobarrier(&s_next_thread);
+        }
+        while (e::atomic::compare_and_swap_64_nobarrier(&s_next_thread, n, n + 1) != n);
+
+        s_thread = n;
+    }
+
+    return s_thread;
+}
+
+} // namespace
+
+latency_histogram :: latency_histogram()
+    : m_summarized(LATENCY_BUCKETS, 0)
+{
+    memset(m_shards, 0, sizeof(m_shards));
+    memset(m_overflow, 0, sizeof(m_overflow));
+}
+
+latency_histogram :: ~latency_histogram() throw ()
+{
+    for (size_t t = 0; t < LATENCY_MAX_THREADS; ++t)
+    {
+        delete[] m_shards[t];
+    }
+}
+
+void
+latency_histogram :: record(uint64_t nanos)
+{
+    uint64_t t = this_thread();
+
+    if (t >= LATENCY_MAX_THREADS)
+    {
+        e::atomic::increment_64_nobarrier(&m_overflow[bucket(nanos)], 1);
+        return;
+    }
+
+    // only this thread writes its shard, so no read-modify-write is needed
+    uint64_t* b = &shard(t)[bucket(nanos)];
+    e::atomic::store_64_nobarrier(b, e::atomic::load_64_nobarrier(b) + 1);
+}
+
+uint64_t
+latency_histogram :: count()
+{
+    std::vector<uint64_t> buckets;
+    merge(&buckets);
+    uint64_t total = 0;
+
+    for (size_t b = 0; b < LATENCY_BUCKETS; ++b)
+    {
+        total += buckets[b];
+    }
+
+    return total;
+}
+
+void
+latency_histogram :: summarize(const char* name, std::ostream* out)
+{
+    std::vector<uint64_t> buckets;
+    merge(&buckets);
+    uint64_t total = 0;
+
+    for (size_t b = 0; b < LATENCY_BUCKETS; ++b)
+    {
+        uint64_t now = buckets[b];
+        buckets[b] -= m_summarized[b];
+        m_summarized[b] = now;
+        total += buckets[b];
+    }
+
+    static const struct { const char* suffix; uint64_t num; uint64_t den; } quantiles[] = {
+        {"p50", 50, 100},
+        {"p99", 99, 100},
+        {"p999", 999, 1000},
+        {"max", 1, 1}
+    };
+
+    *out << " " << name << ".count=" << total;
+    size_t b = 0;
+    uint64_t seen = 0;
+
+    for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); ++q)
+    {
+        // the smallest bucket at or below which the quantile's share lies
+        uint64_t target = (total * quantiles[q].num + quantiles[q].den - 1) / quantiles[q].den;
+
+        while (b < LATENCY_BUCKETS && seen + buckets[b] < target)
+        {
+            seen += buckets[b];
+            ++b;
+        }
+
+        uint64_t value = total > 0 && b < LATENCY_BUCKETS ? upper_bound(b) : 0;
+        *out << " " << name << "." << quantiles[q].suffix << "=" << value;
+    }
+}
+
+unsigned
+latency_histogram :: bucket(uint64_t nanos)
+{
+    if (nanos < LATENCY_SUB_BUCKETS)
+    {
+        return nanos;
+    }
+
+    unsigned exp = 63 - __builtin_clzll(nanos);
+    unsigned shift = exp - LATENCY_SUB_BUCKET_BITS;
+    unsigned sub = (nanos >> shift) & (LATENCY_SUB_BUCKETS - 1);
+    return (shift + 1) * LATENCY_SUB_BUCKETS + sub;
+}
+
+uint64_t
+latency_histogram :: upper_bound(unsigned b)
+{
+    if (b < LATENCY_SUB_BUCKETS)
+    {
+        return b;
+    }
+
+    unsigned shift = b / LATENCY_SUB_BUCKETS - 1;
+    uint64_t sub = LATENCY_SUB_BUCKETS + b % LATENCY_SUB_BUCKETS;
+    return ((sub + 1) << shift) - 1;
+}
+
+uint64_t*
+latency_histogram :: shard(unsigned t)
+{
+    uint64_t* s = e::atomic::load_ptr_acquire(&m_shards[t]);
+
+    if (!s)
+    {
+        s = new uint64_t[LATENCY_BUCKETS];
+        memset(s, 0, sizeof(uint64_t) * LATENCY_BUCKETS);
+        e::atomic::store_ptr_release(&m_shards[t], s);
+    }
+
+    return s;
+}
+
+void
+latency_histogram :: merge(std::vector<uint64_t>* buckets)
+{
+    buckets->assign(LATENCY_BUCKETS, 0);
+
+    for (size_t b = 0; b < LATENCY_BUCKETS; ++b)
+    {
+        (*buckets)[b] += e::atomic::load_64_nobarrier(&m_overflow[b]);
+    }
+
+    for (size_t t = 0; t < LATENCY_MAX_THREADS; ++t)
+    {
+        uint64_t* s = e::atomic::load_ptr_acquire(&m_shards[t]);
+
+        for (size_t b = 0; s && b < LATENCY_BUCKETS; ++b)
+        {
+            (*buckets)[b] += e::atomic::load_64_nobarrier(&s[b]);
+        }
+    }
+}
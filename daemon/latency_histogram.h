@@ -0,0 +1,90 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_daemon_latency_histogram_h_
+#define hyperdex_daemon_latency_histogram_h_
+
+// C
+#include <stdint.h>
+
+// STL
+#include <iostream>
+#include <vector>
+
+// HyperDex
+#include "namespace.h"
+
+// A threadsafe histogram of latencies in nanoseconds.  Values are bucketed
+// HDR-style: each power of two is split into LATENCY_SUB_BUCKETS linear
+// buckets, so any reported quantile is within 1/LATENCY_SUB_BUCKETS of the
+// true value.  Each recording thread owns a shard of the buckets, allocated
+// the first time it records, so writers never share a cache line; readers
+// merge the shards.  Threads beyond LATENCY_MAX_THREADS share one overflow
+// shard.
+
+#define LATENCY_SUB_BUCKET_BITS 3
+#define LATENCY_SUB_BUCKETS (1U << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_BUCKETS ((64 - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKETS)
+#define LATENCY_MAX_THREADS 128
+
+BEGIN_HYPERDEX_NAMESPACE
+
+class latency_histogram
+{
+    public:
+        latency_histogram();
+        ~latency_histogram() throw ();
+
+    public:
+        // any number of threads can record simultaneously
+        void record(uint64_t nanos);
+        // the number of values ever recorded
+        uint64_t count();
+        // write "name.count", "name.p50", "name.p99", "name.p999" and
+        // "name.max" for the values recorded since the last call; only one
+        // thread may summarize a histogram
+        void summarize(const char* name, std::ostream* out);
+
+    private:
+        static unsigned bucket(uint64_t nanos);
+        static uint64_t upper_bound(unsigned bucket);
+        uint64_t* shard(unsigned thread);
+        void merge(std::vector<uint64_t>* buckets);
+
+    private:
+        latency_histogram(const latency_histogram&);
+        latency_histogram& operator = (const latency_histogram&);
+
+    private:
+        uint64_t* m_shards[LATENCY_MAX_THREADS];
+        uint64_t m_overflow[LATENCY_BUCKETS];
+        std::vector<uint64_t> m_summarized;
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_daemon_latency_histogram_h_
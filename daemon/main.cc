@@ -54,6 +54,13 @@ static const char* _coordinator_host = "127.0.0.1";
 static unsigned long _coordinator_port = 1982;
 static bool _coordinator = false;
 static long _threads = 0;
+static const char* _block_cache_size = NULL;
+static const char* _write_buffer_size = NULL;
+static const char* _block_size = NULL;
+static const char* _bloom_bits = NULL;
+static const char* _max_open_files = NULL;
+static const char* _compression = NULL;
+static const char* _object_cache_size = NULL;
 
 extern "C"
 {
@@ -82,6 +89,27 @@ static struct poptOption popts[] = {
     {"threads", 't', POPT_ARG_LONG, &_threads, 't',
      "the number of threads which will handle network traffic",
      "N"},
+    {"block-cache-size", 0, POPT_ARG_STRING, &_block_cache_size, 'b',
+     "size of the LevelDB block cache (default: 8M)",
+     "bytes"},
+    {"write-buffer-size", 0, POPT_ARG_STRING, &_write_buffer_size, 'w',
+     "size of the LevelDB write buffer (default: 64M)",
+     "bytes"},
+    {"block-size", 0, POPT_ARG_STRING, &_block_size, 'k',
+     "size of LevelDB table blocks (default: 4K)",
+     "bytes"},
+    {"bloom-bits", 0, POPT_ARG_STRING, &_bloom_bits, 'B',
+     "bits per key in LevelDB bloom filters; 0 disables them (default: 10)",
+     "N"},
+    {"max-open-files", 0, POPT_ARG_STRING, &_max_open_files, 'o',
+     "number of files LevelDB may keep open (default: 1000)",
+     "N"},
+    {"compression", 0, POPT_ARG_STRING, &_compression, 'z',
+     "compress LevelDB tables with \"snappy\" or \"none\" (default: snappy)",
+     "type"},
+    {"object-cache-size", 0, POPT_ARG_STRING, &_object_cache_size, 'O',
+     "size of the cache of hot objects; 0 disables it (default: 0)",
+     "bytes"},
     POPT_TABLEEND
 };
 
@@ -95,6 +123,7 @@ main(int argc, const char* argv[])
     e::guard g = e::makeguard(poptFreeContext, poptcon); g.use_variable();
     int rc;
     po6::net::location listen;
+    hyperdex::storage_options storage;
 
     while ((rc = poptGetNextOpt(poptcon)) != -1)
     {
@@ -160,6 +189,62 @@ main(int argc, const char* argv[])
                 _coordinator = true;
                 break;
             case 't':
+                break;
+            case 'b':
+                if (!storage.set("block-cache-size", _block_cache_size))
+                {
+                    std::cerr << "invalid block cache size" << std::endl;
+                    return EXIT_FAILURE;
+                }
+
+                break;
+            case 'w':
+                if (!storage.set("write-buffer-size", _write_buffer_size))
+                {
+                    std::cerr << "invalid write buffer size" << std::endl;
+                    return EXIT_FAILURE;
+                }
+
+                break;
+            case 'k':
+                if (!storage.set("block-size", _block_size))
+                {
+                    std::cerr << "invalid block size" << std::endl;
+                    return EXIT_FAILURE;
+                }
+
+                break;
+            case 'B':
+                if (!storage.set("bloom-bits", _bloom_bits))
+                {
+                    std::cerr << "invalid number of bloom filter bits" << std::endl;
+                    return EXIT_FAILURE;
+                }
+
+                break;
+            case 'o':
+                if (!storage.set("max-open-files", _max_open_files))
+                {
+                    std::cerr << "invalid open file limit (must be at least 64)" << std::endl;
+                    return EXIT_FAILURE;
+                }
+
+                break;
+            case 'z':
+                if (!storage.set("compression", _compression))
+                {
+                    std::cerr << "compression must be \"snappy\" or \"none\"" << std::endl;
+                    return EXIT_FAILURE;
+                }
+
+                break;
+            case 'O':
+                if (!storage.set("object-cache-size", _object_cache_size))
+                {
+                    std::cerr << "invalid object cache size" << std::endl;
+                    return EXIT_FAILURE;
+                }
+
                 break;
             case POPT_ERROR_NOARG:
             case POPT_ERROR_BADOPT:
@@ -212,7 +297,7 @@ main(int argc, const char* argv[])
             return EXIT_FAILURE;
         }
 
-        return d.run(_daemonize, data, _listen, bind_to, _coordinator, coord, _threads);
+        return d.run(_daemonize, data, _listen, bind_to, _coordinator, coord, _threads, storage);
     }
     catch (po6::error& e)
     {
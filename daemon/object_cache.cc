@@ -0,0 +1,243 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// C
+#include <assert.h>
+
+// CityHash
+#include <city.h>
+
+// HyperDex
+#include "daemon/object_cache.h"
+
+using hyperdex::object_cache;
+
+#define SHARDS 64
+// rough per-entry cost of the containers, in bytes
+#define ENTRY_OVERHEAD 128
+
+object_cache :: object_cache()
+    : hits()
+    , misses()
+    , m_capacity(0)
+    , m_shards()
+{
+}
+
+object_cache :: ~object_cache() throw ()
+{
+    for (size_t i = 0; i < m_shards.size(); ++i)
+    {
+        delete m_shards[i];
+    }
+}
+
+void
+object_cache :: set_capacity(uint64_t bytes)
+{
+    assert(m_shards.empty());
+    m_capacity = bytes;
+
+    if (m_capacity == 0)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < SHARDS; ++i)
+    {
+        m_shards.push_back(new shard(m_capacity / SHARDS));
+    }
+}
+
+bool
+object_cache :: lookup(const e::slice& key,
+                       backing_ptr* backing,
+                       std::vector<e::slice>* value,
+                       uint64_t* version)
+{
+    shard* s = get_shard(key);
+    po6::threads::mutex::hold hold(&s->mtx);
+    shard::map_t::iterator it = s->map.find(key.str());
+
+    if (it == s->map.end())
+    {
+        misses.tap();
+        return false;
+    }
+
+    // move to the most-recently-used end
+    s->lru.splice(s->lru.end(), s->lru, it->second);
+    const entry& e(*it->second);
+    *backing = e.backing;
+    *version = e.version;
+    value->resize(e.offsets.size());
+
+    for (size_t i = 0; i < e.offsets.size(); ++i)
+    {
+        (*value)[i] = e::slice(e.backing->data() + e.offsets[i].first,
+                               e.offsets[i].second);
+    }
+
+    hits.tap();
+    return true;
+}
+
+uint64_t
+object_cache :: ticket(const e::slice& key)
+{
+    shard* s = get_shard(key);
+    po6::threads::mutex::hold hold(&s->mtx);
+    return s->generation;
+}
+
+void
+object_cache :: insert(uint64_t ticket,
+                       const e::slice& key,
+                       const std::string& backing,
+                       const std::vector<e::slice>& value,
+                       uint64_t version)
+{
+    entry e;
+    e.key = key.str();
+    e.backing.reset(new std::string(backing));
+    e.version = version;
+    e.offsets.reserve(value.size());
+    const char* base = backing.data();
+
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        const char* ptr = reinterpret_cast<const char*>(value[i].data());
+        assert(ptr >= base && ptr + value[i].size() <= base + backing.size());
+        e.offsets.push_back(std::make_pair(uint32_t(ptr - base), uint32_t(value[i].size())));
+    }
+
+    e.charge = e.key.size() + backing.size()
+             + e.offsets.size() * sizeof(e.offsets[0])
+             + ENTRY_OVERHEAD;
+    shard* s = get_shard(key);
+    po6::threads::mutex::hold hold(&s->mtx);
+
+    if (ticket != s->generation || e.charge > s->capacity)
+    {
+        return;
+    }
+
+    s->erase(e.key);
+    s->usage += e.charge;
+    s->lru.push_back(entry());
+    s->lru.back().key.swap(e.key);
+    s->lru.back().backing.swap(e.backing);
+    s->lru.back().offsets.swap(e.offsets);
+    s->lru.back().version = e.version;
+    s->lru.back().charge = e.charge;
+    s->map[s->lru.back().key] = --s->lru.end();
+    s->evict();
+}
+
+void
+object_cache :: invalidate(const e::slice& key)
+{
+    shard* s = get_shard(key);
+    po6::threads::mutex::hold hold(&s->mtx);
+    ++s->generation;
+    s->erase(key.str());
+}
+
+void
+object_cache :: clear()
+{
+    for (size_t i = 0; i < m_shards.size(); ++i)
+    {
+        shard* s = m_shards[i];
+        po6::threads::mutex::hold hold(&s->mtx);
+        ++s->generation;
+        s->map.clear();
+        s->lru.clear();
+        s->usage = 0;
+    }
+}
+
+object_cache::shard*
+object_cache :: get_shard(const e::slice& key)
+{
+    assert(!m_shards.empty());
+    uint64_t h = CityHash64(reinterpret_cast<const char*>(key.data()), key.size());
+    return m_shards[h % m_shards.size()];
+}
+
+object_cache :: entry :: entry()
+    : key()
+    , backing()
+    , offsets()
+    , version(0)
+    , charge(0)
+{
+}
+
+object_cache :: entry :: ~entry() throw ()
+{
+}
+
+object_cache :: shard :: shard(uint64_t c)
+    : mtx()
+    , capacity(c)
+    , usage(0)
+    , generation(0)
+    , lru()
+    , map()
+{
+}
+
+object_cache :: shard :: ~shard() throw ()
+{
+}
+
+void
+object_cache :: shard :: erase(const std::string& key)
+{
+    map_t::iterator it = map.find(key);
+
+    if (it == map.end())
+    {
+        return;
+    }
+
+    usage -= it->second->charge;
+    lru.erase(it->second);
+    map.erase(it);
+}
+
+void
+object_cache :: shard :: evict()
+{
+    while (usage > capacity && !lru.empty())
+    {
+        usage -= lru.front().charge;
+        map.erase(lru.front().key);
+        lru.pop_front();
+    }
+}
@@ -0,0 +1,149 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_daemon_object_cache_h_
+#define hyperdex_daemon_object_cache_h_
+
+// STL
+#include <list>
+#include <string>
+#include <tr1/memory>
+#include <tr1/unordered_map>
+#include <utility>
+#include <vector>
+
+// po6
+#include <po6/threads/mutex.h>
+
+// e
+#include <e/slice.h>
+
+// HyperDex
+#include "namespace.h"
+#include "daemon/performance_counter.h"
+
+// A cache of recently read objects, keyed by their encoded LevelDB key.  Each
+// entry holds the value as read from LevelDB along with its decoded form, so
+// that a hit costs neither a LevelDB lookup nor a decode.  The cache is split
+// into independently locked shards, each evicting in LRU order within its
+// share of the byte budget.
+//
+// To keep stale values out of the cache, a reader must take a ticket before
+// reading from LevelDB and present it on insert.  Every invalidation of a
+// shard voids the tickets outstanding for it.
+
+BEGIN_HYPERDEX_NAMESPACE
+
+class object_cache
+{
+    public:
+        typedef std::tr1::shared_ptr<const std::string> backing_ptr;
+
+    public:
+        object_cache();
+        ~object_cache() throw ();
+
+    public:
+        // a capacity of 0 disables the cache; call before any other method
+        void set_capacity(uint64_t bytes);
+        bool enabled() const { return m_capacity > 0; }
+        bool lookup(const e::slice& key,
+                    backing_ptr* backing,
+                    std::vector<e::slice>* value,
+                    uint64_t* version);
+        uint64_t ticket(const e::slice& key);
+        // "value" must point into "backing"
+        void insert(uint64_t ticket,
+                    const e::slice& key,
+                    const std::string& backing,
+                    const std::vector<e::slice>& value,
+                    uint64_t version);
+        void invalidate(const e::slice& key);
+        void clear();
+
+    public:
+        performance_counter hits;
+        performance_counter misses;
+
+    private:
+        class entry;
+        class shard;
+
+    private:
+        object_cache(const object_cache&);
+        object_cache& operator = (const object_cache&);
+
+    private:
+        shard* get_shard(const e::slice& key);
+
+    private:
+        uint64_t m_capacity;
+        std::vector<shard*> m_shards;
+};
+
+class object_cache::entry
+{
+    public:
+        entry();
+        ~entry() throw ();
+
+    public:
+        std::string key;
+        backing_ptr backing;
+        std::vector<std::pair<uint32_t, uint32_t> > offsets;
+        uint64_t version;
+        uint64_t charge;
+};
+
+class object_cache::shard
+{
+    public:
+        shard(uint64_t capacity);
+        ~shard() throw ();
+
+    public:
+        void erase(const std::string& key);
+        void evict();
+
+    public:
+        typedef std::list<entry> lru_t;
+        typedef std::tr1::unordered_map<std::string, lru_t::iterator> map_t;
+        po6::threads::mutex mtx;
+        uint64_t capacity;
+        uint64_t usage;
+        uint64_t generation;
+        lru_t lru;
+        map_t map;
+
+    private:
+        shard(const shard&);
+        shard& operator = (const shard&);
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_daemon_object_cache_h_
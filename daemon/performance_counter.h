@@ -44,6 +44,8 @@ class performance_counter
         // increment the counter
         // any number of threads can tap simultaneously
         void tap() { e::atomic::increment_64_nobarrier(&m_count, 1); }
+        // add "n" to the counter
+        void add(uint64_t n) { e::atomic::increment_64_nobarrier(&m_count, n); }
         // any number of threads can call "read" simultaneously
         uint64_t read() { return e::atomic::load_64_nobarrier(&m_count); }
 
@@ -0,0 +1,150 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#define __STDC_LIMIT_MACROS
+
+// C
+#include <assert.h>
+
+// STL
+#include <algorithm>
+
+// HyperDex
+#include "daemon/published_config.h"
+
+using hyperdex::configuration;
+using hyperdex::published_config;
+
+// There is one published_config per daemon, so a thread's slot can live in a
+// plain thread-local.
+static __thread size_t s_slot = SIZE_MAX;
+
+published_config :: published_config()
+    : m_current(new configuration())
+    , m_epoch(1)
+    , m_slots_used(0)
+    , m_retired_mtx()
+    , m_retired()
+{
+    for (size_t i = 0; i < PUBLISHED_CONFIG_MAX_THREADS; ++i)
+    {
+        m_slots[i] = UINT64_MAX;
+    }
+}
+
+published_config :: ~published_config() throw ()
+{
+    for (size_t i = 0; i < m_retired.size(); ++i)
+    {
+        delete m_retired[i].second;
+    }
+
+    delete m_current;
+}
+
+void
+published_config :: online()
+{
+    size_t s = slot();
+    m_slots[s] = __sync_add_and_fetch(&m_epoch, 0);
+    // pairs with the barrier in publish:  either it sees our slot, or we see
+    // the snapshot it published
+    __sync_synchronize();
+}
+
+void
+published_config :: offline()
+{
+    __sync_synchronize();
+    m_slots[slot()] = UINT64_MAX;
+}
+
+void
+published_config :: publish(const configuration& config)
+{
+    const configuration* old = m_current;
+    m_current = new configuration(config);
+    __sync_synchronize();
+    uint64_t epoch = __sync_add_and_fetch(&m_epoch, 1);
+
+    {
+        po6::threads::mutex::hold hold(&m_retired_mtx);
+        m_retired.push_back(std::make_pair(epoch, old));
+    }
+
+    reclaim();
+}
+
+void
+published_config :: reclaim()
+{
+    __sync_synchronize();
+    uint64_t oldest = UINT64_MAX;
+    uint64_t used = __sync_add_and_fetch(&m_slots_used, 0);
+
+    for (size_t i = 0; i < used; ++i)
+    {
+        oldest = std::min(oldest, m_slots[i]);
+    }
+
+    po6::threads::mutex::hold hold(&m_retired_mtx);
+    size_t i = 0;
+
+    while (i < m_retired.size())
+    {
+        if (m_retired[i].first <= oldest)
+        {
+            delete m_retired[i].second;
+            m_retired[i] = m_retired.back();
+            m_retired.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+bool
+published_config :: settled()
+{
+    reclaim();
+    po6::threads::mutex::hold hold(&m_retired_mtx);
+    return m_retired.empty();
+}
+
+size_t
+published_config :: slot()
+{
+    if (s_slot == SIZE_MAX)
+    {
+        s_slot = __sync_fetch_and_add(&m_slots_used, 1);
+        assert(s_slot < PUBLISHED_CONFIG_MAX_THREADS);
+    }
+
+    return s_slot;
+}
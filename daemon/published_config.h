@@ -0,0 +1,106 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_daemon_published_config_h_
+#define hyperdex_daemon_published_config_h_
+
+// C
+#include <stdint.h>
+
+// STL
+#include <vector>
+
+// po6
+#include <po6/threads/mutex.h>
+
+// HyperDex
+#include "namespace.h"
+#include "common/configuration.h"
+
+// The daemon's current configuration, published as an immutable snapshot that
+// readers use without locking and the coordinator thread replaces without
+// stopping them.  Old snapshots are reclaimed by quiescent-state-based
+// reclamation:  a thread that reads the configuration goes "online" before it
+// does so and "offline" before it blocks, at which point it holds no
+// references into any snapshot.  A snapshot retired at epoch E is freed once
+// every thread is offline or came online at epoch E or later.
+//
+// Threads that never go online must not read the configuration; the one
+// thread that publishes may read it at any time.
+
+#define PUBLISHED_CONFIG_MAX_THREADS 1024
+
+BEGIN_HYPERDEX_NAMESPACE
+
+class published_config
+{
+    public:
+        published_config();
+        ~published_config() throw ();
+
+    public:
+        const configuration& operator * () const { return *m_current; }
+        const configuration* operator -> () const { return m_current; }
+        // for readers, such as the busybee mapper, that must follow the
+        // current configuration as it changes
+        const configuration* const* indirect() const { return &m_current; }
+
+    // reader threads
+    public:
+        void online();
+        void offline();
+
+    // the publishing thread
+    public:
+        void publish(const configuration& config);
+        // free every retired snapshot that no thread can still see
+        void reclaim();
+        // true once every thread has let go of every snapshot but the
+        // current one, and so acts on nothing an older one told it
+        bool settled();
+
+    private:
+        typedef std::pair<uint64_t, const configuration*> retired_t;
+        size_t slot();
+
+    private:
+        published_config(const published_config&);
+        published_config& operator = (const published_config&);
+
+    private:
+        const configuration* m_current;
+        uint64_t m_epoch;
+        // the epoch at which each thread came online, or UINT64_MAX
+        uint64_t m_slots[PUBLISHED_CONFIG_MAX_THREADS];
+        uint64_t m_slots_used;
+        po6::threads::mutex m_retired_mtx;
+        std::vector<retired_t> m_retired;
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_daemon_published_config_h_
@@ -46,6 +46,7 @@
 #include "common/serialization.h"
 #include "daemon/daemon.h"
 #include "daemon/replication_manager.h"
+#include "daemon/replication_manager_chain_batch.h"
 #include "daemon/replication_manager_key_region.h"
 #include "daemon/replication_manager_key_state.h"
 #include "daemon/replication_manager_key_state_reference.h"
@@ -67,10 +68,14 @@ replication_manager :: replication_manager(daemon* d)
     , m_wakeup_garbage_collector(&m_block_both)
     , m_wakeup_reconfigurer(&m_block_both)
     , m_need_retransmit(false)
+    , m_protect_retransmit()
+    , m_retransmit_queue()
+    , m_retransmitting(false)
     , m_lower_bounds()
     , m_need_pause(false)
     , m_paused_retransmitter(false)
     , m_paused_garbage_collector(false)
+    , m_perf_client_atomic()
 {
 }
 
@@ -142,18 +147,68 @@ replication_manager :: reconfigure(const configuration&,
 
     std::sort(transfer_in_regions.begin(), transfer_in_regions.end());
 
-    for (key_state_map_t::iterator it = m_key_states.begin();
-            it != m_key_states.end(); it.next())
+    // Every key_state with operations outstanding sits on the retransmit
+    // queue (an empty one is collected when its reference is released), and
+    // with the retransmitter paused none is off the queue for a pass.  So the
+    // queue holds all the sequence numbers in flight, and we needn't sweep
+    // m_key_states.
+    retransmit_queue_t queue;
+
+    {
+        po6::threads::mutex::hold hold(&m_protect_retransmit);
+        queue.swap(m_retransmit_queue);
+    }
+
+    for (retransmit_queue_t::iterator it = queue.begin();
+            it != queue.end(); ++it)
     {
-        e::intrusive_ptr<key_state> ks = it.value();
-        key_state_reference ksr(this, ks);
-        ks->clear_deferred();
-        uint64_t max_seq_id = ks->max_seq_id();
-        seq_ids[it.key().region.get()] = std::max(seq_ids[it.key().region.get()], max_seq_id);
+        const region_id ri(it->first);
+        std::vector<e::intrusive_ptr<key_state> >& kss(it->second);
+        bool transfer_in = std::binary_search(transfer_in_regions.begin(),
+                                              transfer_in_regions.end(), ri);
+        uint64_t max_seq_id = 0;
 
-        if (std::binary_search(transfer_in_regions.begin(), transfer_in_regions.end(), it.key().region))
+        for (size_t i = 0; i < kss.size(); ++i)
         {
-            m_key_states.remove(it.key());
+            {
+                key_state_reference ksr;
+                e::intrusive_ptr<key_state> ks = get_key_state(ri, kss[i]->key(), &ksr);
+
+                // a stale entry; the current key_state is queued too
+                if (ks.get() != kss[i].get())
+                {
+                    continue;
+                }
+
+                ks->clear_deferred();
+                max_seq_id = std::max(max_seq_id, ks->max_seq_id());
+            }
+
+            if (transfer_in)
+            {
+                e::striped_lock<po6::threads::mutex>::hold hold(&m_key_states_locks,
+                        get_lock_num(ri, kss[i]->key()));
+                e::intrusive_ptr<key_state> ks;
+
+                if (m_key_states.lookup(kss[i]->kr(), &ks) && ks.get() == kss[i].get())
+                {
+                    m_key_states.remove(kss[i]->kr());
+                }
+            }
+        }
+
+        // stale entries leave this at zero; let the disk speak for ri then
+        if (max_seq_id > 0)
+        {
+            seq_ids[ri.get()] = max_seq_id;
+        }
+
+        // the transferred data replaces whatever was in flight for ri
+        if (!transfer_in)
+        {
+            po6::threads::mutex::hold hold(&m_protect_retransmit);
+            std::vector<e::intrusive_ptr<key_state> >& q(m_retransmit_queue[ri]);
+            q.insert(q.end(), kss.begin(), kss.end());
         }
     }
 
@@ -184,6 +239,7 @@ replication_manager :: reconfigure(const configuration&,
 
 void
 replication_manager :: client_atomic(const server_id& from,
+                                     const virtual_server_id& addressed,
                                      const virtual_server_id& to,
                                      uint64_t nonce,
                                      bool erase,
@@ -191,10 +247,22 @@ replication_manager :: client_atomic(const server_id& from,
                                      bool fail_if_found,
                                      const e::slice& key,
                                      const std::vector<attribute_check>& checks,
-                                     const std::vector<funcall>& funcs)
+                                     const std::vector<funcall>& funcs,
+                                     chain_batch* batch)
 {
-    const region_id ri(m_daemon->m_config.get_region_id(to));
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    // Bulk requests name a virtual server per key, and the network layer only
+    // checked the one the message was addressed to.  We cannot speak for a
+    // virtual server we don't own, so the miss goes out from that one.
+    if (m_daemon->m_config->get_server_id(to) != m_daemon->m_us)
+    {
+        LOG(ERROR) << "dropping nonce=" << nonce << " from client=" << from
+                   << " because " << to << " is not on this server";
+        respond_to_client(addressed, from, nonce, NET_NOTUS);
+        return;
+    }
+
+    const region_id ri(m_daemon->m_config->get_region_id(to));
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
 
     if (!datatype_info::lookup(sc.attrs[0].type)->validate(key) ||
         validate_attribute_checks(sc, checks) != checks.size() ||
@@ -207,7 +275,7 @@ replication_manager :: client_atomic(const server_id& from,
         return;
     }
 
-    if (m_daemon->m_config.point_leader(ri, key) != to)
+    if (m_daemon->m_config->point_leader(ri, key) != to)
     {
         LOG(ERROR) << "dropping nonce=" << nonce << " from client=" << from
                    << " because it doesn't map to " << ri;
@@ -215,6 +283,14 @@ replication_manager :: client_atomic(const server_id& from,
         return;
     }
 
+    // the coordinator is about to split or merge this space's regions and is
+    // waiting for the writes already in flight to drain
+    if (m_daemon->m_config->is_quiesced(ri))
+    {
+        respond_to_client(to, from, nonce, NET_NOTUS);
+        return;
+    }
+
     key_state_reference ksr;
     e::intrusive_ptr<key_state> ks = get_or_create_key_state(ri, key, &ksr);
     network_returncode nrc;
@@ -242,7 +318,7 @@ replication_manager :: client_atomic(const server_id& from,
         }
     }
 
-    ks->move_operations_between_queues(this, to, ri, sc);
+    ks->move_operations_between_queues(this, to, ri, sc, batch);
 }
 
 void
@@ -256,14 +332,15 @@ replication_manager :: chain_op(const virtual_server_id& from,
                                 bool has_value,
                                 std::auto_ptr<e::buffer> backing,
                                 const e::slice& key,
-                                const std::vector<e::slice>& value)
+                                const std::vector<e::slice>& value,
+                                chain_batch* batch)
 {
-    const region_id ri(m_daemon->m_config.get_region_id(to));
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    const region_id ri(m_daemon->m_config->get_region_id(to));
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
 
     if (retransmission && m_daemon->m_data.check_acked(ri, reg_id, seq_id))
     {
-        send_ack(to, from, true, reg_id, seq_id, version, key);
+        send_ack(to, from, true, reg_id, seq_id, version, key, batch);
         return;
     }
 
@@ -292,12 +369,12 @@ replication_manager :: chain_op(const virtual_server_id& from,
 
     if (op)
     {
-        op->recv_config_version = m_daemon->m_config.version();
+        op->recv_config_version = m_daemon->m_config->version();
         op->recv = from;
 
         if (op->acked)
         {
-            send_ack(to, from, false, reg_id, seq_id, version, key);
+            send_ack(to, from, false, reg_id, seq_id, version, key, batch);
         }
 
         return;
@@ -307,9 +384,9 @@ replication_manager :: chain_op(const virtual_server_id& from,
                      reg_id, seq_id, fresh,
                      has_value, value,
                      server_id(), 0,
-                     m_daemon->m_config.version(), from);
+                     m_daemon->m_config->version(), from);
     ks->insert_deferred(version, op);
-    ks->move_operations_between_queues(this, to, ri, sc);
+    ks->move_operations_between_queues(this, to, ri, sc, batch);
 }
 
 void
@@ -322,14 +399,15 @@ replication_manager :: chain_subspace(const virtual_server_id& from,
                                       std::auto_ptr<e::buffer> backing,
                                       const e::slice& key,
                                       const std::vector<e::slice>& value,
-                                      const std::vector<uint64_t>& hashes)
+                                      const std::vector<uint64_t>& hashes,
+                                      chain_batch* batch)
 {
-    const region_id ri(m_daemon->m_config.get_region_id(to));
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    const region_id ri(m_daemon->m_config->get_region_id(to));
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
 
     if (retransmission && m_daemon->m_data.check_acked(ri, reg_id, seq_id))
     {
-        send_ack(to, from, true, reg_id, seq_id, version, key);
+        send_ack(to, from, true, reg_id, seq_id, version, key, batch);
         return;
     }
 
@@ -357,43 +435,43 @@ replication_manager :: chain_subspace(const virtual_server_id& from,
                      reg_id, seq_id, false,
                      true, value,
                      server_id(), 0,
-                     m_daemon->m_config.version(), from);
+                     m_daemon->m_config->version(), from);
     op->old_hashes.resize(sc.attrs_sz);
     op->new_hashes.resize(sc.attrs_sz);
     op->this_old_region = region_id();
     op->this_new_region = region_id();
     op->prev_region = region_id();
     op->next_region = region_id();
-    subspace_id subspace_this = m_daemon->m_config.subspace_of(ri);
-    subspace_id subspace_prev = m_daemon->m_config.subspace_prev(subspace_this);
-    subspace_id subspace_next = m_daemon->m_config.subspace_next(subspace_this);
+    subspace_id subspace_this = m_daemon->m_config->subspace_of(ri);
+    subspace_id subspace_prev = m_daemon->m_config->subspace_prev(subspace_this);
+    subspace_id subspace_next = m_daemon->m_config->subspace_next(subspace_this);
     op->old_hashes = hashes;
     hyperdex::hash(sc, key, value, &op->new_hashes.front());
 
     if (subspace_prev != subspace_id())
     {
-        m_daemon->m_config.lookup_region(subspace_prev, op->new_hashes, &op->prev_region);
+        m_daemon->m_config->lookup_region(subspace_prev, op->new_hashes, &op->prev_region);
     }
 
-    m_daemon->m_config.lookup_region(subspace_this, op->old_hashes, &op->this_old_region);
-    m_daemon->m_config.lookup_region(subspace_this, op->new_hashes, &op->this_new_region);
+    m_daemon->m_config->lookup_region(subspace_this, op->old_hashes, &op->this_old_region);
+    m_daemon->m_config->lookup_region(subspace_this, op->new_hashes, &op->this_new_region);
 
     if (subspace_next != subspace_id())
     {
-        m_daemon->m_config.lookup_region(subspace_next, op->old_hashes, &op->next_region);
+        m_daemon->m_config->lookup_region(subspace_next, op->old_hashes, &op->next_region);
     }
 
-    if (!(op->this_old_region == m_daemon->m_config.get_region_id(from) &&
-          m_daemon->m_config.tail_of_region(op->this_old_region) == from) &&
-        !(op->this_new_region == m_daemon->m_config.get_region_id(from) &&
-          m_daemon->m_config.next_in_region(from) == to))
+    if (!(op->this_old_region == m_daemon->m_config->get_region_id(from) &&
+          m_daemon->m_config->tail_of_region(op->this_old_region) == from) &&
+        !(op->this_new_region == m_daemon->m_config->get_region_id(from) &&
+          m_daemon->m_config->next_in_region(from) == to))
     {
         LOG(ERROR) << "dropping CHAIN_SUBSPACE which didn't obey chaining rules";
         return;
     }
 
     ks->insert_deferred(version, op);
-    ks->move_operations_between_queues(this, to, ri, sc);
+    ks->move_operations_between_queues(this, to, ri, sc, batch);
 }
 
 void
@@ -403,10 +481,11 @@ replication_manager :: chain_ack(const virtual_server_id& from,
                                  const region_id& reg_id,
                                  uint64_t seq_id,
                                  uint64_t version,
-                                 const e::slice& key)
+                                 const e::slice& key,
+                                 chain_batch* batch)
 {
-    const region_id ri(m_daemon->m_config.get_region_id(to));
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    const region_id ri(m_daemon->m_config->get_region_id(to));
+    const schema& sc(*m_daemon->m_config->get_schema(ri));
 
     if (retransmission && m_daemon->m_data.check_acked(ri, reg_id, seq_id))
     {
@@ -432,10 +511,10 @@ replication_manager :: chain_ack(const virtual_server_id& from,
 
     if (op->sent == virtual_server_id() ||
         from != op->sent ||
-        m_daemon->m_config.version() != op->sent_config_version)
+        m_daemon->m_config->version() != op->sent_config_version)
     {
         LOG(ERROR) << "dropping CHAIN_ACK that came from " << from
-                   << " in version " << m_daemon->m_config.version()
+                   << " in version " << m_daemon->m_config->version()
                    << " but should have come from " << op->sent
                    << " in version " << op->sent_config_version;
         return;
@@ -448,11 +527,11 @@ replication_manager :: chain_ack(const virtual_server_id& from,
     }
 
     op->acked = true;
-    bool is_head = m_daemon->m_config.head_of_region(ri) == to;
+    bool is_head = m_daemon->m_config->head_of_region(ri) == to;
 
-    if (!is_head && m_daemon->m_config.version() == op->recv_config_version)
+    if (!is_head && m_daemon->m_config->version() == op->recv_config_version)
     {
-        send_ack(to, op->recv, false, reg_id, seq_id, version, key);
+        send_ack(to, op->recv, false, reg_id, seq_id, version, key, batch);
     }
 
     if (!ks->persist_to_datalayer(this, ri, reg_id, seq_id, version))
@@ -462,16 +541,17 @@ replication_manager :: chain_ack(const virtual_server_id& from,
     }
 
     ks->clear_acked_prefix();
-    ks->move_operations_between_queues(this, to, ri, sc);
+    ks->move_operations_between_queues(this, to, ri, sc, batch);
 
     if (op->client != server_id())
     {
         respond_to_client(to, op->client, op->nonce, NET_SUCCESS);
+        m_perf_client_atomic.record(e::time() - op->created);
     }
 
-    if (is_head && m_daemon->m_config.version() == op->recv_config_version)
+    if (is_head && m_daemon->m_config->version() == op->recv_config_version)
     {
-        send_ack(to, op->recv, false, reg_id, seq_id, version, key);
+        send_ack(to, op->recv, false, reg_id, seq_id, version, key, batch);
     }
 }
 
@@ -491,6 +571,50 @@ replication_manager :: trip_periodic()
     m_need_retransmit = true;
 }
 
+bool
+replication_manager :: drained(const std::vector<region_id>& regions)
+{
+    std::vector<e::intrusive_ptr<key_state> > kss;
+
+    {
+        po6::threads::mutex::hold hold(&m_protect_retransmit);
+
+        if (m_retransmitting)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < regions.size(); ++i)
+        {
+            retransmit_queue_t::iterator it = m_retransmit_queue.find(regions[i]);
+
+            if (it != m_retransmit_queue.end())
+            {
+                kss.insert(kss.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
+
+    for (size_t i = 0; i < kss.size(); ++i)
+    {
+        key_state_reference ksr;
+        e::intrusive_ptr<key_state> ks = get_key_state(kss[i]->kr().region, kss[i]->key(), &ksr);
+
+        if (ks.get() == kss[i].get() && !ks->empty())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+replication_manager :: collect_stats(std::ostringstream* ret)
+{
+    m_perf_client_atomic.summarize("lat.client_atomic", ret);
+}
+
 uint64_t
 replication_manager :: hash(const key_region& kr)
 {
@@ -597,16 +721,17 @@ replication_manager :: send_message(const virtual_server_id& us,
                                     bool retransmission,
                                     uint64_t version,
                                     const e::slice& key,
-                                    e::intrusive_ptr<pending> op)
+                                    e::intrusive_ptr<pending> op,
+                                    chain_batch* batch)
 {
     // If we've sent it somewhere, we shouldn't resend.  If the sender intends a
     // resend, they should clear "sent" first.
     assert(op->sent == virtual_server_id());
-    region_id ri(m_daemon->m_config.get_region_id(us));
+    region_id ri(m_daemon->m_config->get_region_id(us));
 
     // facts we use to decide what to do
     assert(ri == op->this_old_region || ri == op->this_new_region);
-    bool last_in_chain = m_daemon->m_config.tail_of_region(ri) == us;
+    bool last_in_chain = m_daemon->m_config->tail_of_region(ri) == us;
     bool has_next_subspace = op->next_region != region_id();
 
     // variables we fill in to determine the message type/destination
@@ -619,7 +744,7 @@ replication_manager :: send_message(const virtual_server_id& us,
         {
             if (has_next_subspace)
             {
-                dest = m_daemon->m_config.head_of_region(op->next_region);
+                dest = m_daemon->m_config->head_of_region(op->next_region);
                 type = type; // it stays the same
             }
             else
@@ -630,7 +755,7 @@ replication_manager :: send_message(const virtual_server_id& us,
         }
         else
         {
-            dest = m_daemon->m_config.next_in_region(us);
+            dest = m_daemon->m_config->next_in_region(us);
             type = type; // it stays the same
         }
     }
@@ -639,12 +764,12 @@ replication_manager :: send_message(const virtual_server_id& us,
         if (last_in_chain)
         {
             assert(op->has_value);
-            dest = m_daemon->m_config.head_of_region(op->this_new_region);
+            dest = m_daemon->m_config->head_of_region(op->this_new_region);
             type = CHAIN_SUBSPACE;
         }
         else
         {
-            dest = m_daemon->m_config.next_in_region(us);
+            dest = m_daemon->m_config->next_in_region(us);
             type = type; // it stays the same
         }
     }
@@ -654,7 +779,7 @@ replication_manager :: send_message(const virtual_server_id& us,
         {
             if (has_next_subspace)
             {
-                dest = m_daemon->m_config.head_of_region(op->next_region);
+                dest = m_daemon->m_config->head_of_region(op->next_region);
                 type = type; // it stays the same
             }
             else
@@ -666,7 +791,7 @@ replication_manager :: send_message(const virtual_server_id& us,
         else
         {
             assert(op->has_value);
-            dest = m_daemon->m_config.next_in_region(us);
+            dest = m_daemon->m_config->next_in_region(us);
             type = CHAIN_SUBSPACE;
         }
     }
@@ -726,9 +851,9 @@ replication_manager :: send_message(const virtual_server_id& us,
         abort();
     }
 
-    op->sent_config_version = m_daemon->m_config.version();
+    op->sent_config_version = m_daemon->m_config->version();
     op->sent = dest;
-    m_daemon->m_comm.send_exact(us, dest, type, msg);
+    send_chain(us, dest, type, msg, batch);
 }
 
 bool
@@ -738,7 +863,8 @@ replication_manager :: send_ack(const virtual_server_id& us,
                                 const region_id& reg_id,
                                 uint64_t seq_id,
                                 uint64_t version,
-                                const e::slice& key)
+                                const e::slice& key,
+                                chain_batch* batch)
 {
     uint8_t flags = (retransmission ? 128 : 0);
     size_t sz = HYPERDEX_HEADER_SIZE_VV
@@ -750,7 +876,23 @@ replication_manager :: send_ack(const virtual_server_id& us,
               + key.size();
     std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
     msg->pack_at(HYPERDEX_HEADER_SIZE_VV) << flags << reg_id.get() << seq_id << version << key;
-    return m_daemon->m_comm.send_exact(us, to, CHAIN_ACK, msg);
+    return send_chain(us, to, CHAIN_ACK, msg, batch);
+}
+
+bool
+replication_manager :: send_chain(const virtual_server_id& us,
+                                  const virtual_server_id& to,
+                                  network_msgtype type,
+                                  std::auto_ptr<e::buffer> msg,
+                                  chain_batch* batch)
+{
+    if (batch)
+    {
+        batch->append(us, to, type, msg);
+        return true;
+    }
+
+    return m_daemon->m_comm.send_exact(us, to, type, msg);
 }
 
 void
@@ -759,15 +901,36 @@ replication_manager :: respond_to_client(const virtual_server_id& us,
                                          uint64_t nonce,
                                          network_returncode ret)
 {
+    uint16_t result = static_cast<uint16_t>(ret);
+
+    // Operations issued by another daemon's group_keyop are acked to that
+    // daemon; clients never appear in the configuration.
+    if (m_daemon->m_config->get_address(client) != po6::net::location())
+    {
+        size_t sz = HYPERDEX_HEADER_SIZE_VV
+                  + sizeof(uint64_t)
+                  + sizeof(uint16_t);
+        std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+        msg->pack_at(HYPERDEX_HEADER_SIZE_VV) << nonce << result;
+        m_daemon->m_comm.send(us, client, GROUP_KEYOP_ACK, msg);
+        return;
+    }
+
     size_t sz = HYPERDEX_HEADER_SIZE_VC
               + sizeof(uint64_t)
               + sizeof(uint16_t);
     std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
-    uint16_t result = static_cast<uint16_t>(ret);
     msg->pack_at(HYPERDEX_HEADER_SIZE_VC) << nonce << result;
     m_daemon->m_comm.send_client(us, client, RESP_ATOMIC, msg);
 }
 
+void
+replication_manager :: queue_retransmit(e::intrusive_ptr<key_state> ks)
+{
+    po6::threads::mutex::hold hold(&m_protect_retransmit);
+    m_retransmit_queue[ks->kr().region].push_back(ks);
+}
+
 void
 replication_manager :: retransmitter()
 {
@@ -788,6 +951,8 @@ replication_manager :: retransmitter()
 
     uint64_t then = e::time();
 
+    m_daemon->m_config.online();
+
     while (true)
     {
         {
@@ -802,7 +967,9 @@ replication_manager :: retransmitter()
                     m_wakeup_reconfigurer.signal();
                 }
 
+                m_daemon->m_config.offline();
                 m_wakeup_retransmitter.wait();
+                m_daemon->m_config.online();
                 m_paused_retransmitter = false;
             }
 
@@ -814,68 +981,105 @@ replication_manager :: retransmitter()
             m_need_retransmit = false;
         }
 
-        std::set<region_id> region_cache;
         std::map<region_id, uint64_t> seq_id_lower_bounds;
 
         {
             m_counters.peek(&seq_id_lower_bounds);
         }
 
-        for (key_state_map_t::iterator it = m_key_states.begin();
-                it != m_key_states.end(); it.next())
-        {
-            region_id ri(it.key().region);
+        // Only key_states with outstanding operations are queued, so the cost
+        // of a pass scales with the work in flight rather than the number of
+        // keys we have ever touched.  Whatever is still outstanding after a
+        // pass queues itself again when its reference is released.
+        retransmit_queue_t queue;
 
-            if (region_cache.find(ri) != region_cache.end() ||
-                m_daemon->m_config.is_server_blocked_by_live_transfer(m_daemon->m_us, ri))
-            {
-                region_cache.insert(ri);
-                continue;
-            }
+        {
+            po6::threads::mutex::hold hold(&m_protect_retransmit);
+            queue.swap(m_retransmit_queue);
+            m_retransmitting = true;
+        }
 
-            e::slice key(it.key().key.data(), it.key().key.size());
-            key_state_reference ksr;
-            e::intrusive_ptr<key_state> ks = get_key_state(ri, key, &ksr);
+        for (retransmit_queue_t::iterator it = queue.begin();
+                it != queue.end(); ++it)
+        {
+            const region_id ri(it->first);
+            std::vector<e::intrusive_ptr<key_state> >& kss(it->second);
 
-            if (!ks)
+            // leave a blocked region's keys queued, untouched, for next time
+            if (m_daemon->m_config->is_server_blocked_by_live_transfer(m_daemon->m_us, ri))
             {
+                po6::threads::mutex::hold hold(&m_protect_retransmit);
+                std::vector<e::intrusive_ptr<key_state> >& q(m_retransmit_queue[ri]);
+                q.insert(q.end(), kss.begin(), kss.end());
                 continue;
             }
 
-            virtual_server_id us = m_daemon->m_config.get_virtual(ri, m_daemon->m_us);
+            virtual_server_id us = m_daemon->m_config->get_virtual(ri, m_daemon->m_us);
 
+            // We left the region.  Drop its state; the key_states stay marked
+            // as queued so that they never queue themselves again.
             if (us == virtual_server_id())
             {
-                m_key_states.remove(it.key());
+                for (size_t i = 0; i < kss.size(); ++i)
+                {
+                    e::striped_lock<po6::threads::mutex>::hold hold(&m_key_states_locks,
+                            get_lock_num(ri, kss[i]->key()));
+                    e::intrusive_ptr<key_state> ks;
+
+                    if (m_key_states.lookup(kss[i]->kr(), &ks) && ks.get() == kss[i].get())
+                    {
+                        m_key_states.remove(kss[i]->kr());
+                    }
+                }
+
                 continue;
             }
 
-            const schema& sc(*m_daemon->m_config.get_schema(ri));
+            const schema& sc(*m_daemon->m_config->get_schema(ri));
 
-            if (ks->empty())
+            for (size_t i = 0; i < kss.size(); ++i)
             {
-                continue;
-            }
+                key_state_reference ksr;
+                e::intrusive_ptr<key_state> ks = get_key_state(ri, kss[i]->key(), &ksr);
 
-            ks->resend_committable(this, us);
-            ks->move_operations_between_queues(this, us, ri, sc);
+                // a stale entry; the current key_state queues itself
+                if (ks.get() != kss[i].get())
+                {
+                    continue;
+                }
 
-            if (m_daemon->m_config.is_point_leader(us))
-            {
-                uint64_t min_id = ks->min_seq_id();
-                std::map<region_id, uint64_t>::iterator lb = seq_id_lower_bounds.find(ri);
+                ks->clear_queued();
 
-                if (lb == seq_id_lower_bounds.end())
+                if (ks->empty())
                 {
-                    seq_id_lower_bounds.insert(std::make_pair(ri, min_id));
+                    continue;
                 }
-                else
+
+                ks->resend_committable(this, us);
+                ks->move_operations_between_queues(this, us, ri, sc, NULL);
+
+                if (m_daemon->m_config->is_point_leader(us))
                 {
-                    lb->second = std::min(lb->second, min_id);
+                    uint64_t min_id = ks->min_seq_id();
+                    std::map<region_id, uint64_t>::iterator lb = seq_id_lower_bounds.find(ri);
+
+                    if (lb == seq_id_lower_bounds.end())
+                    {
+                        seq_id_lower_bounds.insert(std::make_pair(ri, min_id));
+                    }
+                    else
+                    {
+                        lb->second = std::min(lb->second, min_id);
+                    }
                 }
             }
         }
 
+        {
+            po6::threads::mutex::hold hold(&m_protect_retransmit);
+            m_retransmitting = false;
+        }
+
         m_daemon->m_comm.wake_one();
         uint64_t now = e::time();
 
@@ -887,15 +1091,15 @@ replication_manager :: retransmitter()
 
         then = now;
         std::vector<std::pair<server_id, po6::net::location> > cluster_members;
-        m_daemon->m_config.get_all_addresses(&cluster_members);
+        m_daemon->m_config->get_all_addresses(&cluster_members);
 
         for (std::map<region_id, uint64_t>::iterator it = seq_id_lower_bounds.begin();
                 it != seq_id_lower_bounds.end(); ++it)
         {
             // lookup and check again since we lost/acquired the lock
-            virtual_server_id us = m_daemon->m_config.get_virtual(it->first, m_daemon->m_us);
+            virtual_server_id us = m_daemon->m_config->get_virtual(it->first, m_daemon->m_us);
 
-            if (us == virtual_server_id() || !m_daemon->m_config.is_point_leader(us))
+            if (us == virtual_server_id() || !m_daemon->m_config->is_point_leader(us))
             {
                 continue;
             }
@@ -912,6 +1116,7 @@ replication_manager :: retransmitter()
         }
     }
 
+    m_daemon->m_config.offline();
     LOG(INFO) << "retransmitter thread shutting down";
 }
 
@@ -933,6 +1138,8 @@ replication_manager :: garbage_collector()
         return;
     }
 
+    m_daemon->m_config.online();
+
     while (true)
     {
         std::list<std::pair<region_id, uint64_t> > lower_bounds;
@@ -949,7 +1156,9 @@ replication_manager :: garbage_collector()
                     m_wakeup_reconfigurer.signal();
                 }
 
+                m_daemon->m_config.offline();
                 m_wakeup_garbage_collector.wait();
+                m_daemon->m_config.online();
                 m_paused_garbage_collector = false;
             }
 
@@ -981,6 +1190,7 @@ replication_manager :: garbage_collector()
         }
     }
 
+    m_daemon->m_config.offline();
     LOG(INFO) << "garbage collector thread shutting down";
 }
 
@@ -30,6 +30,8 @@
 
 // STL
 #include <list>
+#include <map>
+#include <sstream>
 #include <tr1/memory>
 #include <tr1/unordered_map>
 
@@ -51,7 +53,9 @@
 #include "common/counter_map.h"
 #include "common/funcall.h"
 #include "common/ids.h"
+#include "common/network_msgtype.h"
 #include "common/network_returncode.h"
+#include "daemon/latency_histogram.h"
 #include "daemon/reconfigure_returncode.h"
 
 BEGIN_HYPERDEX_NAMESPACE
@@ -60,6 +64,9 @@ class daemon;
 // Manage replication.
 class replication_manager
 {
+    public:
+        class chain_batch; // coalesce outgoing CHAIN_* messages
+
     public:
         replication_manager(daemon*);
         ~replication_manager() throw ();
@@ -74,11 +81,16 @@ class replication_manager
                          const configuration& new_config,
                          const server_id& us);
 
-    // Network workers call these methods.
+    // Network workers call these methods.  When "batch" is non-NULL, the
+    // CHAIN_* messages they generate are added to it rather than sent
+    // immediately.
     public:
         // These are called when the client initiates the action.  This implies
-        // that only the point leader should call these methods.
+        // that only the point leader should call these methods.  "addressed"
+        // is the virtual server the message was sent to, which for a bulk
+        // request may differ from the "to" named by each operation.
         void client_atomic(const server_id& from,
+                           const virtual_server_id& addressed,
                            const virtual_server_id& to,
                            uint64_t nonce,
                            bool erase,
@@ -86,7 +98,8 @@ class replication_manager
                            bool fail_if_found,
                            const e::slice& key,
                            const std::vector<attribute_check>& checks,
-                           const std::vector<funcall>& funcs);
+                           const std::vector<funcall>& funcs,
+                           chain_batch* batch);
         // These are called in response to messages from other hosts.
         void chain_op(const virtual_server_id& from,
                       const virtual_server_id& to,
@@ -98,7 +111,8 @@ class replication_manager
                       bool has_value,
                       std::auto_ptr<e::buffer> backing,
                       const e::slice& key,
-                      const std::vector<e::slice>& value);
+                      const std::vector<e::slice>& value,
+                      chain_batch* batch);
         void chain_subspace(const virtual_server_id& from,
                             const virtual_server_id& to,
                             bool retransmission,
@@ -108,16 +122,25 @@ class replication_manager
                             std::auto_ptr<e::buffer> backing,
                             const e::slice& key,
                             const std::vector<e::slice>& value,
-                            const std::vector<uint64_t>& hashes);
+                            const std::vector<uint64_t>& hashes,
+                            chain_batch* batch);
         void chain_ack(const virtual_server_id& from,
                        const virtual_server_id& to,
                        bool retransmission,
                        const region_id& reg_id,
                        uint64_t seq_id,
                        uint64_t version,
-                       const e::slice& key);
+                       const e::slice& key,
+                       chain_batch* batch);
         void chain_gc(const region_id& reg_id, uint64_t seq_id);
         void trip_periodic();
+        // true if no operation is outstanding in any of "regions";
+        // may say false while a retransmit pass holds the queue
+        bool drained(const std::vector<region_id>& regions);
+
+    // Statistics for perf counters
+    public:
+        void collect_stats(std::ostringstream* ret);
 
     private:
         class pending; // state for one pending operation
@@ -126,6 +149,8 @@ class replication_manager
         class key_state_reference; // hold a reference for a single key
         static uint64_t hash(const key_region&);
         typedef e::lockfree_hash_map<key_region, e::intrusive_ptr<key_state>, hash> key_state_map_t;
+        // key_states with outstanding operations, by region
+        typedef std::map<region_id, std::vector<e::intrusive_ptr<key_state> > > retransmit_queue_t;
 
     private:
         replication_manager(const replication_manager&);
@@ -149,18 +174,26 @@ class replication_manager
                           bool retransmission,
                           uint64_t version,
                           const e::slice& key,
-                          e::intrusive_ptr<pending> op);
+                          e::intrusive_ptr<pending> op,
+                          chain_batch* batch);
         bool send_ack(const virtual_server_id& us,
                       const virtual_server_id& to,
                       bool retransmission,
                       const region_id& reg_id,
                       uint64_t seq_id,
                       uint64_t version,
-                      const e::slice& key);
+                      const e::slice& key,
+                      chain_batch* batch);
+        bool send_chain(const virtual_server_id& us,
+                        const virtual_server_id& to,
+                        network_msgtype type,
+                        std::auto_ptr<e::buffer> msg,
+                        chain_batch* batch);
         void respond_to_client(const virtual_server_id& us,
                                const server_id& client,
                                uint64_t nonce,
                                network_returncode ret);
+        void queue_retransmit(e::intrusive_ptr<key_state> ks);
         // thread functions
         void retransmitter();
         void garbage_collector();
@@ -179,10 +212,16 @@ class replication_manager
         po6::threads::cond m_wakeup_garbage_collector;
         po6::threads::cond m_wakeup_reconfigurer;
         bool m_need_retransmit;
+        po6::threads::mutex m_protect_retransmit;
+        retransmit_queue_t m_retransmit_queue;
+        // a pass has taken m_retransmit_queue and not yet handed it back
+        bool m_retransmitting;
         std::list<std::pair<region_id, uint64_t> > m_lower_bounds;
         bool m_need_pause;
         bool m_paused_retransmitter;
         bool m_paused_garbage_collector;
+        // from a client's request to our response, including the chain
+        latency_histogram m_perf_client_atomic;
 };
 
 END_HYPERDEX_NAMESPACE
@@ -0,0 +1,166 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// STL
+#include <algorithm>
+
+// HyperDex
+#include "daemon/communication.h"
+#include "daemon/replication_manager_chain_batch.h"
+
+// Keep a CHAIN_BATCH well below what a single BusyBee message should carry;
+// larger batches are split into several messages.
+#define CHAIN_BATCH_MAX_BYTES (1ULL << 20)
+
+using hyperdex::replication_manager;
+
+replication_manager :: chain_batch :: chain_batch(communication* comm)
+    : m_comm(comm)
+    , m_msgs()
+{
+}
+
+replication_manager :: chain_batch :: ~chain_batch() throw ()
+{
+    flush();
+}
+
+void
+replication_manager :: chain_batch :: append(const virtual_server_id& from,
+                                             const virtual_server_id& to,
+                                             network_msgtype type,
+                                             std::auto_ptr<e::buffer> msg)
+{
+    m_msgs.push_back(message(from, to, type, NULL));
+    m_msgs.back().msg = msg.release();
+}
+
+void
+replication_manager :: chain_batch :: flush()
+{
+    std::vector<message> msgs;
+    msgs.swap(m_msgs);
+    // group by (from, to) while keeping the order within each group, so the
+    // receiver sees operations in the order we generated them
+    std::stable_sort(msgs.begin(), msgs.end());
+    size_t start = 0;
+
+    while (start < msgs.size())
+    {
+        size_t limit = start;
+        size_t bytes = 0;
+
+        while (limit < msgs.size() &&
+               msgs[limit].from == msgs[start].from &&
+               msgs[limit].to == msgs[start].to &&
+               (limit == start || bytes + msgs[limit].msg->size() <= CHAIN_BATCH_MAX_BYTES))
+        {
+            bytes += msgs[limit].msg->size();
+            ++limit;
+        }
+
+        send(&msgs, start, limit);
+        start = limit;
+    }
+}
+
+void
+replication_manager :: chain_batch :: send(std::vector<message>* _msgs,
+                                           size_t start, size_t limit)
+{
+    std::vector<message>& msgs(*_msgs);
+    assert(start < limit);
+
+    if (start + 1 == limit)
+    {
+        std::auto_ptr<e::buffer> msg(msgs[start].msg);
+        msgs[start].msg = NULL;
+        m_comm->send_exact(msgs[start].from, msgs[start].to, msgs[start].type, msg);
+        return;
+    }
+
+    size_t sz = HYPERDEX_HEADER_SIZE_VV
+              + sizeof(uint32_t);
+
+    for (size_t i = start; i < limit; ++i)
+    {
+        assert(msgs[i].msg->size() >= HYPERDEX_HEADER_SIZE_VV);
+        sz += sizeof(uint8_t)
+            + sizeof(uint32_t)
+            + msgs[i].msg->size() - HYPERDEX_HEADER_SIZE_VV;
+    }
+
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_HEADER_SIZE_VV);
+    pa = pa << static_cast<uint32_t>(limit - start);
+
+    for (size_t i = start; i < limit; ++i)
+    {
+        const e::buffer& m(*msgs[i].msg);
+        e::slice body(m.data() + HYPERDEX_HEADER_SIZE_VV,
+                      m.size() - HYPERDEX_HEADER_SIZE_VV);
+        pa = pa << static_cast<uint8_t>(msgs[i].type) << body;
+        delete msgs[i].msg;
+        msgs[i].msg = NULL;
+    }
+
+    m_comm->send_exact(msgs[start].from, msgs[start].to, CHAIN_BATCH, msg);
+}
+
+replication_manager :: chain_batch :: message :: message()
+    : from()
+    , to()
+    , type()
+    , msg()
+{
+}
+
+replication_manager :: chain_batch :: message :: message(const virtual_server_id& f,
+                                                         const virtual_server_id& t,
+                                                         network_msgtype ty,
+                                                         e::buffer* m)
+    : from(f)
+    , to(t)
+    , type(ty)
+    , msg(m)
+{
+}
+
+replication_manager :: chain_batch :: message :: ~message() throw ()
+{
+}
+
+bool
+replication_manager :: chain_batch :: message :: operator < (const message& rhs) const
+{
+    if (from != rhs.from)
+    {
+        return from < rhs.from;
+    }
+
+    return to < rhs.to;
+}
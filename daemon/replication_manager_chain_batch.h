@@ -0,0 +1,90 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_daemon_replication_manager_chain_batch_h_
+#define hyperdex_daemon_replication_manager_chain_batch_h_
+
+// STL
+#include <memory>
+#include <vector>
+
+// HyperDex
+#include "common/network_msgtype.h"
+#include "daemon/replication_manager.h"
+
+BEGIN_HYPERDEX_NAMESPACE
+class communication;
+END_HYPERDEX_NAMESPACE
+
+// Collects the CHAIN_* messages generated while processing a batch of
+// operations so that those headed to the same virtual server leave as a single
+// CHAIN_BATCH message.  Anything still buffered is sent on destruction.
+class hyperdex::replication_manager::chain_batch
+{
+    public:
+        chain_batch(communication* comm);
+        ~chain_batch() throw ();
+
+    public:
+        // "msg" must be packed at HYPERDEX_HEADER_SIZE_VV, as for send_exact
+        void append(const virtual_server_id& from,
+                    const virtual_server_id& to,
+                    network_msgtype type,
+                    std::auto_ptr<e::buffer> msg);
+        void flush();
+
+    private:
+        struct message;
+        void send(std::vector<message>* msgs, size_t start, size_t limit);
+
+    private:
+        chain_batch(const chain_batch&);
+        chain_batch& operator = (const chain_batch&);
+
+    private:
+        communication* m_comm;
+        std::vector<message> m_msgs;
+};
+
+struct hyperdex::replication_manager::chain_batch::message
+{
+    message();
+    message(const virtual_server_id& from,
+            const virtual_server_id& to,
+            network_msgtype type,
+            e::buffer* msg);
+    ~message() throw ();
+    bool operator < (const message& rhs) const;
+
+    virtual_server_id from;
+    virtual_server_id to;
+    network_msgtype type;
+    e::buffer* msg; // owned by the chain_batch
+
+};
+
+#endif // hyperdex_daemon_replication_manager_chain_batch_h_
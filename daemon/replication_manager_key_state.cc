@@ -43,6 +43,7 @@ replication_manager :: key_state :: key_state(const region_id& r, const e::slice
     , m_key(m_key_backing.data(), m_key_backing.size())
     , m_lock()
     , m_marked_garbage(false)
+    , m_queued(false)
     , m_ref(0)
     , m_committable()
     , m_blocked()
@@ -372,6 +373,24 @@ replication_manager :: key_state :: clear_acked_prefix()
     }
 }
 
+bool
+replication_manager :: key_state :: mark_queued()
+{
+    if (m_queued || m_marked_garbage || empty())
+    {
+        return false;
+    }
+
+    m_queued = true;
+    return true;
+}
+
+void
+replication_manager :: key_state :: clear_queued()
+{
+    m_queued = false;
+}
+
 void
 replication_manager :: key_state :: resend_committable(replication_manager* rm,
                                                        const virtual_server_id& us)
@@ -380,14 +399,14 @@ replication_manager :: key_state :: resend_committable(replication_manager* rm,
             it != m_committable.end(); ++it)
     {
         // skip those messages already sent in this version
-        if (it->second->sent_config_version == rm->m_daemon->m_config.version())
+        if (it->second->sent_config_version == rm->m_daemon->m_config->version())
         {
             continue;
         }
 
         it->second->sent = virtual_server_id();
         it->second->sent_config_version = 0;
-        rm->send_message(us, true, it->first, m_key, it->second);
+        rm->send_message(us, true, it->first, m_key, it->second, NULL);
     }
 }
 
@@ -395,7 +414,8 @@ void
 replication_manager :: key_state :: move_operations_between_queues(replication_manager* rm,
                                                                    const virtual_server_id& us,
                                                                    const region_id& ri,
-                                                                   const schema& sc)
+                                                                   const schema& sc,
+                                                                   chain_batch* batch)
 {
     // Apply deferred operations
     while (!m_deferred.empty())
@@ -423,7 +443,7 @@ replication_manager :: key_state :: move_operations_between_queues(replication_m
         if (op->this_old_region == op->this_new_region ||
             op->this_old_region == ri)
         {
-            hash_objects(&rm->m_daemon->m_config, ri, sc, op->has_value, op->value, has_old_value, old_value ? *old_value : op->value, op);
+            hash_objects(&*rm->m_daemon->m_config, ri, sc, op->has_value, op->value, has_old_value, old_value ? *old_value : op->value, op);
 
             if (op->this_old_region != ri && op->this_new_region != ri)
             {
@@ -433,8 +453,8 @@ replication_manager :: key_state :: move_operations_between_queues(replication_m
             }
 
             if (op->recv != virtual_server_id() &&
-                rm->m_daemon->m_config.next_in_region(op->recv) != us &&
-                !rm->m_daemon->m_config.subspace_adjacent(op->recv, us))
+                rm->m_daemon->m_config->next_in_region(op->recv) != us &&
+                !rm->m_daemon->m_config->subspace_adjacent(op->recv, us))
             {
                 LOG(INFO) << "dropping deferred CHAIN_* which didn't come from the right host";
                 m_deferred.pop_front();
@@ -461,7 +481,7 @@ replication_manager :: key_state :: move_operations_between_queues(replication_m
 
         m_committable.push_back(m_blocked.front());
         m_blocked.pop_front();
-        rm->send_message(us, false, version, m_key, op);
+        rm->send_message(us, false, version, m_key, op, batch);
     }
 }
 
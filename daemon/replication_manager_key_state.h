@@ -72,6 +72,12 @@ class hyperdex::replication_manager::key_state
                                   uint64_t version);
         void clear_deferred();
         void clear_acked_prefix();
+        // A key_state sits in the retransmit queue at most once.  Returns
+        // true if the caller must queue it: it has outstanding operations and
+        // is not already queued.
+        bool mark_queued();
+        // The retransmitter took it off the queue
+        void clear_queued();
         void resend_committable(replication_manager* rm,
                                 const virtual_server_id& us);
         // Move operations between the queues in the key_state.  Blocked
@@ -81,7 +87,8 @@ class hyperdex::replication_manager::key_state
         void move_operations_between_queues(replication_manager* rm,
                                             const virtual_server_id& us,
                                             const region_id& ri,
-                                            const schema& sc);
+                                            const schema& sc,
+                                            chain_batch* batch);
 
     private:
         typedef std::list<std::pair<uint64_t, e::intrusive_ptr<pending> > >
@@ -119,6 +126,7 @@ class hyperdex::replication_manager::key_state
         const e::slice m_key;
         po6::threads::mutex m_lock;
         bool m_marked_garbage;
+        bool m_queued;
         size_t m_ref;
         pending_list_t m_committable;
         pending_list_t m_blocked;
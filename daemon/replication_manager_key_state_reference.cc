@@ -83,6 +83,9 @@ replication_manager :: key_state_reference :: unlock()
         m_ks->m_marked_garbage = true;
     }
 
+    // Anything left with outstanding operations goes on the retransmit queue,
+    // so the retransmitter never has to sweep all of m_key_states.
+    bool we_queue = !we_collect && m_ks->mark_queued();
     m_ks->m_lock.unlock();
 
     if (we_collect)
@@ -92,6 +95,11 @@ replication_manager :: key_state_reference :: unlock()
         m_rm->m_key_states.remove(m_ks->kr());
     }
 
+    if (we_queue)
+    {
+        m_rm->queue_retransmit(m_ks);
+    }
+
     m_rm = NULL;
     m_ks = NULL;
     m_locked = false;
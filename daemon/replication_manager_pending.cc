@@ -25,6 +25,9 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+// e
+#include <e/time.h>
+
 // HyperDex
 #include "daemon/replication_manager_pending.h"
 
@@ -52,6 +55,7 @@ replication_manager :: pending :: pending(std::auto_ptr<e::buffer> _backing,
     , acked(false)
     , client(_client)
     , nonce(_nonce)
+    , created(e::time())
     , old_hashes()
     , new_hashes()
     , this_old_region()
@@ -62,6 +62,7 @@ class hyperdex::replication_manager::pending
         bool acked;
         server_id client;
         uint64_t nonce;
+        uint64_t created;
         std::vector<uint64_t> old_hashes;
         std::vector<uint64_t> new_hashes;
         region_id this_old_region;
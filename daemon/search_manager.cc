@@ -29,6 +29,8 @@
 
 // STL
 #include <algorithm>
+#include <list>
+#include <set>
 #include <sstream>
 
 // Google Log
@@ -39,16 +41,37 @@
 #include <e/time.h>
 
 // HyperDex
+#include "common/aggregate.h"
 #include "common/attribute_check.h"
 #include "common/datatypes.h"
+#include "common/funcall.h"
+#include "common/projection.h"
 #include "common/serialization.h"
 #include "daemon/daemon.h"
 #include "daemon/datalayer_iterator.h"
 #include "daemon/search_manager.h"
 
+using hyperdex::configuration;
 using hyperdex::datatype_info;
 using hyperdex::search_manager;
 using hyperdex::reconfigure_returncode;
+using hyperdex::virtual_server_id;
+
+// bounds on what a client may ask of a streaming search
+#define SEARCH_MAX_CREDITS 64
+#define SEARCH_BATCH_MAX_OBJECTS 65536
+#define SEARCH_BATCH_MAX_BYTES (4ULL * 1024ULL * 1024ULL)
+
+// a sorted search that walks the index on its sort attribute gives up and
+// falls back to a full evaluation of the search after visiting this many
+// entries per requested result (plus the slack) without filling the limit
+#define SORTED_SEARCH_WALK_FACTOR 16
+#define SORTED_SEARCH_WALK_SLACK 4096
+
+// the most operations a group_keyop puts in one REQ_BULK_ATOMIC
+#define GROUP_KEYOP_BATCH_SIZE 256
+// a group_keyop pays the I/O scheduler after scanning this many bytes
+#define GROUP_KEYOP_THROTTLE_BYTES (1ULL << 20)
 
 /////////////////////////////// Search Manager ID //////////////////////////////
 
@@ -121,6 +144,11 @@ class search_manager::state
         const std::auto_ptr<e::buffer> backing;
         std::vector<attribute_check> checks;
         e::intrusive_ptr<datalayer::iterator> iter;
+        // limits on each RESP_SEARCH_BATCH of a streaming search
+        uint64_t batch_objects;
+        uint64_t batch_bytes;
+        bool projected;
+        std::vector<uint16_t> projection;
 
     private:
         friend class e::intrusive_ptr<state>;
@@ -141,6 +169,10 @@ search_manager :: state :: state(const region_id& r,
     , backing(msg)
     , checks()
     , iter()
+    , batch_objects(0)
+    , batch_bytes(0)
+    , projected(false)
+    , projection()
     , m_ref(0)
 {
     checks.swap(*c);
@@ -150,11 +182,89 @@ search_manager :: state :: ~state() throw ()
 {
 }
 
+///////////////////////////// Search Manager Group /////////////////////////////
+
+class search_manager::group
+{
+    public:
+        group(const server_id& client,
+              const virtual_server_id& us,
+              uint64_t nonce,
+              network_msgtype resp);
+        ~group() throw ();
+
+    public:
+        const server_id client;
+        const virtual_server_id us;
+        const uint64_t nonce;
+        const network_msgtype resp;
+        // point leaders we sent operations to and await acks from
+        std::set<virtual_server_id> targets;
+        uint64_t sent;
+        uint64_t acked;
+        uint64_t succeeded;
+        // true once every batch is sent; until then "sent" may still grow
+        bool dispatched;
+        // the scan that generates the operations, which may stall between
+        // ticks of the I/O scheduler; only one thread runs it at a time
+        uint64_t id;
+        region_id region;
+        std::vector<attribute_check> checks;
+        uint8_t flags;
+        std::vector<funcall> funcs;
+        e::intrusive_ptr<datalayer::iterator> iter;
+        std::map<server_id, group_batch> batches;
+        uint64_t scanned;
+
+    private:
+        friend class e::intrusive_ptr<group>;
+
+    private:
+        void inc() { __sync_add_and_fetch(&m_ref, 1); }
+        void dec() { if (__sync_sub_and_fetch(&m_ref, 1) == 0) delete this; }
+
+    private:
+        size_t m_ref;
+};
+
+search_manager :: group :: group(const server_id& c,
+                                 const virtual_server_id& u,
+                                 uint64_t n,
+                                 network_msgtype r)
+    : client(c)
+    , us(u)
+    , nonce(n)
+    , resp(r)
+    , targets()
+    , sent(0)
+    , acked(0)
+    , succeeded(0)
+    , dispatched(false)
+    , id(0)
+    , region()
+    , checks()
+    , flags(0)
+    , funcs()
+    , iter()
+    , batches()
+    , scanned(0)
+    , m_ref(0)
+{
+}
+
+search_manager :: group :: ~group() throw ()
+{
+}
+
 //////////////////////////////// Search Manager ////////////////////////////////
 
 search_manager :: search_manager(daemon* d)
     : m_daemon(d)
     , m_searches(10)
+    , m_groups_mtx()
+    , m_groups()
+    , m_stalled_groups()
+    , m_next_group_id(1)
 {
 }
 
@@ -173,12 +283,85 @@ search_manager :: teardown()
 {
 }
 
+// true if the chain "vsi" leads in old_config is any different in new_config
+static bool
+chain_changed(const configuration& old_config,
+              const configuration& new_config,
+              virtual_server_id vsi)
+{
+    if (!new_config.is_point_leader(vsi) ||
+        old_config.get_region_id(vsi) != new_config.get_region_id(vsi))
+    {
+        return true;
+    }
+
+    virtual_server_id next = vsi;
+
+    while (next != virtual_server_id())
+    {
+        if (old_config.get_server_id(next) != new_config.get_server_id(next))
+        {
+            return true;
+        }
+
+        virtual_server_id old_next = old_config.next_in_region(next);
+
+        if (old_next != new_config.next_in_region(next))
+        {
+            return true;
+        }
+
+        next = old_next;
+    }
+
+    return false;
+}
+
 void
-search_manager :: reconfigure(const configuration&,
-                              const configuration&,
-                              const server_id&)
+search_manager :: reconfigure(const configuration& old_config,
+                              const configuration& new_config,
+                              const server_id& us)
 {
     // XXX cleanup dead or old searches
+
+    // A group operation that sent to a chain which has since changed may
+    // never see the rest of its acks:  the operation may have been bounced,
+    // or may have reached a point leader that no longer is one.  Fail it the
+    // way a search fails, and let the client decide what to do about the
+    // partially applied operation.
+    std::vector<e::intrusive_ptr<group> > lost;
+
+    {
+        po6::threads::mutex::hold hold(&m_groups_mtx);
+        std::map<uint64_t, e::intrusive_ptr<group> >::iterator it = m_groups.begin();
+
+        while (it != m_groups.end())
+        {
+            group* g = it->second.get();
+            bool gone = new_config.get_server_id(g->us) != us;
+
+            for (std::set<virtual_server_id>::iterator t = g->targets.begin();
+                    !gone && t != g->targets.end(); ++t)
+            {
+                gone = chain_changed(old_config, new_config, *t);
+            }
+
+            if (gone)
+            {
+                lost.push_back(it->second);
+                m_groups.erase(it++);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < lost.size(); ++i)
+    {
+        respond_group(*lost[i], UINT64_MAX);
+    }
 }
 
 void
@@ -189,38 +372,11 @@ search_manager :: start(const server_id& from,
                         uint64_t search_id,
                         std::vector<attribute_check>* checks)
 {
-    region_id ri(m_daemon->m_config.get_region_id(to));
-    id sid(ri, from, search_id);
-
-    if (m_searches.contains(sid))
+    if (!create(from, to, msg, search_id, checks))
     {
-        LOG(WARNING) << "received request for search " << search_id << " from client "
-                     << from << " but the search is already in progress";
         return;
     }
 
-    e::intrusive_ptr<state> st = new state(ri, msg, checks);
-    std::stable_sort(st->checks.begin(), st->checks.end());
-    datalayer::returncode rc = datalayer::SUCCESS;
-    datalayer::snapshot snap = m_daemon->m_data.make_snapshot();
-    st->iter = m_daemon->m_data.make_search_iterator(snap, ri, st->checks, NULL);
-
-    switch (rc)
-    {
-        case datalayer::SUCCESS:
-            break;
-        case datalayer::NOT_FOUND:
-        case datalayer::BAD_ENCODING:
-        case datalayer::CORRUPTION:
-        case datalayer::IO_ERROR:
-        case datalayer::LEVELDB_ERROR:
-            LOG(ERROR) << "could not make snapshot for search:  " << rc;
-            return;
-        default:
-            abort();
-    }
-
-    m_searches.insert(sid, st);
     next(from, to, nonce, search_id);
 }
 
@@ -230,7 +386,7 @@ search_manager :: next(const server_id& from,
                        uint64_t nonce,
                        uint64_t search_id)
 {
-    region_id ri(m_daemon->m_config.get_region_id(to));
+    region_id ri(m_daemon->m_config->get_region_id(to));
     id sid(ri, from, search_id);
     e::intrusive_ptr<state> st;
 
@@ -274,11 +430,93 @@ search_manager :: stop(const server_id& from,
                        const virtual_server_id& to,
                        uint64_t search_id)
 {
-    region_id ri(m_daemon->m_config.get_region_id(to));
+    region_id ri(m_daemon->m_config->get_region_id(to));
     id sid(ri, from, search_id);
     m_searches.remove(sid);
 }
 
+void
+search_manager :: stream(const server_id& from,
+                         const virtual_server_id& to,
+                         std::auto_ptr<e::buffer> msg,
+                         uint64_t nonce,
+                         uint64_t credits,
+                         uint64_t search_id,
+                         uint64_t batch_objects,
+                         uint64_t batch_bytes,
+                         std::vector<attribute_check>* checks,
+                         const std::vector<uint16_t>* projection)
+{
+    if (credits == 0 || credits > SEARCH_MAX_CREDITS)
+    {
+        LOG(WARNING) << "rejecting search " << search_id << " from client " << from
+                     << " because it asked for " << credits << " batches";
+        reject(from, to, nonce, credits);
+        return;
+    }
+
+    const schema* sc = m_daemon->m_config->get_schema(m_daemon->m_config->get_region_id(to));
+
+    if (projection && (!sc || !validate_projection(*sc, *projection)))
+    {
+        LOG(WARNING) << "rejecting search " << search_id << " from client " << from
+                     << " because its projection is invalid";
+        reject(from, to, nonce, credits);
+        return;
+    }
+
+    e::intrusive_ptr<state> st = create(from, to, msg, search_id, checks);
+
+    if (!st)
+    {
+        reject(from, to, nonce, credits);
+        return;
+    }
+
+    st->batch_objects = std::max(uint64_t(1), std::min(batch_objects, uint64_t(SEARCH_BATCH_MAX_OBJECTS)));
+    st->batch_bytes = std::min(batch_bytes, uint64_t(SEARCH_BATCH_MAX_BYTES));
+
+    if (projection)
+    {
+        st->projected = true;
+        st->projection = *projection;
+    }
+
+    credit(from, to, nonce, credits, search_id);
+}
+
+void
+search_manager :: credit(const server_id& from,
+                         const virtual_server_id& to,
+                         uint64_t nonce,
+                         uint64_t credits,
+                         uint64_t search_id)
+{
+    if (credits > SEARCH_MAX_CREDITS)
+    {
+        LOG(WARNING) << "rejecting credit for search " << search_id << " from client " << from
+                     << " because it granted " << credits << " batches";
+        reject(from, to, nonce, credits);
+        return;
+    }
+
+    region_id ri(m_daemon->m_config->get_region_id(to));
+    id sid(ri, from, search_id);
+    e::intrusive_ptr<state> st;
+    m_searches.lookup(sid, &st);
+
+    // every credit is answered, even those that arrive after the search is
+    // exhausted, so that the client sees a response for each nonce
+    for (uint64_t i = 0; i < credits; ++i)
+    {
+        if (send_batch(from, to, nonce + i, st.get()))
+        {
+            st = NULL;
+            stop(from, to, search_id);
+        }
+    }
+}
+
 namespace hyperdex
 {
 
@@ -411,56 +649,106 @@ search_manager :: sorted_search(const server_id& from,
                                 std::vector<attribute_check>* checks,
                                 uint64_t limit,
                                 uint16_t sort_by,
-                                bool maximize)
+                                bool maximize,
+                                const std::vector<uint16_t>* projection)
 {
-    region_id ri(m_daemon->m_config.get_region_id(to));
+    region_id ri(m_daemon->m_config->get_region_id(to));
     std::stable_sort(checks->begin(), checks->end());
     datalayer::returncode rc = datalayer::SUCCESS;
     datalayer::snapshot snap = m_daemon->m_data.make_snapshot();
-    e::intrusive_ptr<datalayer::iterator> iter;
-    iter = m_daemon->m_data.make_search_iterator(snap, ri, *checks, NULL);
+    const schema* sc = m_daemon->m_config->get_schema(ri);
+    assert(sc);
 
-    switch (rc)
+    if (projection && !validate_projection(*sc, *projection))
     {
-        case datalayer::SUCCESS:
-            break;
-        case datalayer::NOT_FOUND:
-        case datalayer::BAD_ENCODING:
-        case datalayer::CORRUPTION:
-        case datalayer::IO_ERROR:
-        case datalayer::LEVELDB_ERROR:
-            LOG(ERROR) << "could not make snapshot for search:  " << rc;
-            break;
-        default:
-            abort();
+        LOG(WARNING) << "rejecting sorted search from client " << from
+                     << " because its projection is invalid";
+        reject(from, to, nonce, 1);
+        return;
     }
 
-    const schema* sc = m_daemon->m_config.get_schema(ri);
-    assert(sc);
     _sorted_search_params params(sc, sort_by, maximize);
     std::vector<_sorted_search_item> top_n;
     top_n.reserve(limit);
+    bool walked = false;
 
-    while (iter->valid())
+    // If the sort attribute has an ordered index, walk it best-first and stop
+    // as soon as "limit" objects pass the checks.
+    e::intrusive_ptr<datalayer::iterator> ordered;
+    ordered = m_daemon->m_data.make_ordered_iterator(snap, ri, sort_by, maximize);
+
+    if (ordered)
     {
-        top_n.push_back(_sorted_search_item(&params));
-        m_daemon->m_data.get_from_iterator(ri, iter.get(), &top_n.back().key, &top_n.back().value, &top_n.back().version, &top_n.back().ref);
-        std::push_heap(top_n.begin(), top_n.end());
+        uint64_t budget = UINT64_MAX;
 
-        if (top_n.size() > limit)
+        if (limit < (UINT64_MAX - SORTED_SEARCH_WALK_SLACK) / SORTED_SEARCH_WALK_FACTOR)
         {
-            std::pop_heap(top_n.begin(), top_n.end());
-            top_n.pop_back();
+            budget = limit * SORTED_SEARCH_WALK_FACTOR + SORTED_SEARCH_WALK_SLACK;
         }
 
-        iter->next();
+        uint64_t visited = 0;
+        walked = true;
+
+        while (ordered->valid() && top_n.size() < limit)
+        {
+            if (visited >= budget)
+            {
+                walked = false;
+                break;
+            }
+
+            ++visited;
+            top_n.push_back(_sorted_search_item(&params));
+            rc = m_daemon->m_data.get_from_iterator(ri, ordered.get(), &top_n.back().key, &top_n.back().value, &top_n.back().version, &top_n.back().ref);
+
+            if (rc != datalayer::SUCCESS ||
+                passes_attribute_checks(*sc, *checks, top_n.back().key, top_n.back().value) < checks->size())
+            {
+                top_n.pop_back();
+            }
+
+            ordered->next();
+        }
+
+        if (!walked)
+        {
+            top_n.clear();
+        }
+    }
+
+    if (!walked)
+    {
+        e::intrusive_ptr<datalayer::iterator> iter;
+        iter = m_daemon->m_data.make_search_iterator(snap, ri, *checks, NULL);
+
+        while (iter->valid())
+        {
+            top_n.push_back(_sorted_search_item(&params));
+            m_daemon->m_data.get_from_iterator(ri, iter.get(), &top_n.back().key, &top_n.back().value, &top_n.back().version, &top_n.back().ref);
+            std::push_heap(top_n.begin(), top_n.end());
+
+            if (top_n.size() > limit)
+            {
+                std::pop_heap(top_n.begin(), top_n.end());
+                top_n.pop_back();
+            }
+
+            iter->next();
+        }
+
+        std::sort(top_n.begin(), top_n.end(), std::greater<_sorted_search_item>());
     }
 
-    std::sort(top_n.begin(), top_n.end(), std::greater<_sorted_search_item>());
     size_t sz = HYPERDEX_HEADER_SIZE_VC + sizeof(uint64_t) + sizeof(uint64_t);
 
     for (size_t i = 0; i < top_n.size(); ++i)
     {
+        // only now that the order is settled may the sort attribute go
+        if (projection)
+        {
+            apply_projection(*projection, &top_n[i].value);
+        }
+
         sz += pack_size(top_n[i].key) + pack_size(top_n[i].value);
     }
 
@@ -481,69 +769,217 @@ search_manager :: group_keyop(const server_id& from,
                               const virtual_server_id& to,
                               uint64_t nonce,
                               std::vector<attribute_check>* checks,
-                              network_msgtype mt,
-                              const e::slice& remain,
+                              uint8_t flags,
+                              const std::vector<funcall>& _funcs,
                               network_msgtype resp)
 {
-    region_id ri(m_daemon->m_config.get_region_id(to));
+    region_id ri(m_daemon->m_config->get_region_id(to));
+    const schema* sc = m_daemon->m_config->get_schema(ri);
     std::stable_sort(checks->begin(), checks->end());
-    datalayer::returncode rc = datalayer::SUCCESS;
+    std::vector<funcall> funcs(_funcs);
+    std::stable_sort(funcs.begin(), funcs.end());
+    bool erase = !(flags & 128);
+
+    if (validate_attribute_checks(*sc, *checks) != checks->size() ||
+        validate_funcs(*sc, funcs) != funcs.size() ||
+        (erase && !funcs.empty()))
+    {
+        LOG(WARNING) << "dropping group operation from client=" << from
+                     << " because the checks or funcs don't validate";
+        respond_group(group(from, to, nonce, resp), UINT64_MAX);
+        return;
+    }
+
     datalayer::snapshot snap = m_daemon->m_data.make_snapshot();
-    e::intrusive_ptr<datalayer::iterator> iter;
-    iter = m_daemon->m_data.make_search_iterator(snap, ri, *checks, NULL);
-    uint64_t result = 0;
+    e::intrusive_ptr<group> g = new group(from, to, nonce, resp);
+    g->region = ri;
+    g->checks.swap(*checks);
+    g->flags = flags;
+    g->funcs.swap(funcs);
+    g->iter = m_daemon->m_data.make_search_iterator(snap, ri, g->checks, NULL);
 
-    switch (rc)
     {
-        case datalayer::SUCCESS:
-            break;
-        case datalayer::NOT_FOUND:
-        case datalayer::BAD_ENCODING:
-        case datalayer::CORRUPTION:
-        case datalayer::IO_ERROR:
-        case datalayer::LEVELDB_ERROR:
-            LOG(ERROR) << "could not make snapshot for search:  " << rc;
-            result = UINT64_MAX;
-            break;
-        default:
-            abort();
+        po6::threads::mutex::hold hold(&m_groups_mtx);
+        g->id = m_next_group_id++;
+        m_groups.insert(std::make_pair(g->id, g));
     }
 
-    while (iter->valid() && result < UINT64_MAX)
+    scan_group(g);
+}
+
+void
+search_manager :: kick()
+{
+    std::vector<e::intrusive_ptr<group> > stalled;
+
+    {
+        po6::threads::mutex::hold hold(&m_groups_mtx);
+        m_stalled_groups.swap(stalled);
+    }
+
+    for (size_t i = 0; i < stalled.size(); ++i)
+    {
+        scan_group(stalled[i]);
+    }
+}
+
+void
+search_manager :: scan_group(e::intrusive_ptr<group> g)
+{
+    {
+        po6::threads::mutex::hold hold(&m_groups_mtx);
+
+        // reconfigure may have failed the group while it was stalled
+        if (m_groups.find(g->id) == m_groups.end())
+        {
+            return;
+        }
+    }
+
+    // Every operation carries the group's checks, so an object that changed
+    // after our snapshot and no longer matches is left alone (and not
+    // counted).
+    while (g->iter->valid())
     {
+        // A group scan is background work to everyone but its client.  It
+        // runs on a network thread, so rather than wait out the scheduler
+        // it stalls, and the daemon resumes it on a later tick.
+        if (g->scanned >= GROUP_KEYOP_THROTTLE_BYTES)
+        {
+            m_daemon->m_io.charge(io_scheduler::GROUP, g->scanned);
+            g->scanned = 0;
+
+            if (!m_daemon->m_io.admit(io_scheduler::GROUP))
+            {
+                po6::threads::mutex::hold hold(&m_groups_mtx);
+                m_stalled_groups.push_back(g);
+                return;
+            }
+        }
+
         e::slice key;
         std::vector<e::slice> val;
         uint64_t ver;
         datalayer::reference tmp;
-        m_daemon->m_data.get_from_iterator(ri, iter.get(), &key, &val, &ver, &tmp);
-        size_t sz = HYPERDEX_HEADER_SIZE_SV // SV because we imitate a client
-                  + sizeof(uint64_t)
-                  + pack_size(key)
-                  + remain.size();
-        std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
-        e::buffer::packer pa = msg->pack_at(HYPERDEX_HEADER_SIZE_SV);
-        pa = pa << static_cast<uint64_t>(0) << key;
-        pa = pa.copy(remain);
-        virtual_server_id vsi = m_daemon->m_config.point_leader(ri, key);
+        m_daemon->m_data.get_from_iterator(g->region, g->iter.get(), &key, &val, &ver, &tmp);
+        g->scanned += key.size();
 
-        if (vsi != virtual_server_id())
+        for (size_t i = 0; i < val.size(); ++i)
         {
-            m_daemon->m_comm.send(vsi, mt, msg);
+            g->scanned += val[i].size();
         }
-        else
+
+        virtual_server_id vsi = m_daemon->m_config->point_leader(g->region, key);
+
+        if (vsi == virtual_server_id())
         {
             LOG(ERROR) << "group_keyop could not compute point leader (serious bug; please report)";
+            g->iter->next();
+            continue;
         }
 
-        iter->next();
+        group_batch* batch = &g->batches[m_daemon->m_config->get_server_id(vsi)];
+        batch->push_back(std::make_pair(vsi, key.str()));
+
+        if (batch->size() >= GROUP_KEYOP_BATCH_SIZE)
+        {
+            send_group_batch(g->id, g->checks, g->flags, g->funcs, batch);
+        }
+
+        g->iter->next();
     }
 
-    size_t sz = HYPERDEX_HEADER_SIZE_VC
-              + sizeof(uint64_t)
-              + sizeof(uint64_t);
-    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
-    msg->pack_at(HYPERDEX_HEADER_SIZE_VC) << nonce << result;
-    m_daemon->m_comm.send_client(to, from, resp, msg);
+    for (std::map<server_id, group_batch>::iterator it = g->batches.begin();
+            it != g->batches.end(); ++it)
+    {
+        if (!it->second.empty())
+        {
+            send_group_batch(g->id, g->checks, g->flags, g->funcs, &it->second);
+        }
+    }
+
+    m_daemon->m_io.charge(io_scheduler::GROUP, g->scanned);
+    g->scanned = 0;
+    g->iter = NULL;
+    bool done = false;
+
+    {
+        po6::threads::mutex::hold hold(&m_groups_mtx);
+        g->dispatched = true;
+
+        // reconfigure may have already failed the group
+        if (g->acked == g->sent && m_groups.erase(g->id) > 0)
+        {
+            done = true;
+        }
+    }
+
+    if (done)
+    {
+        respond_group(*g, g->succeeded);
+    }
+}
+
+void
+search_manager :: group_keyop_ack(uint64_t group_id, network_returncode result)
+{
+    e::intrusive_ptr<group> g;
+
+    {
+        po6::threads::mutex::hold hold(&m_groups_mtx);
+        std::map<uint64_t, e::intrusive_ptr<group> >::iterator it = m_groups.find(group_id);
+
+        if (it == m_groups.end())
+        {
+            return;
+        }
+
+        ++it->second->acked;
+
+        if (result == NET_SUCCESS)
+        {
+            ++it->second->succeeded;
+        }
+
+        if (!it->second->dispatched || it->second->acked < it->second->sent)
+        {
+            return;
+        }
+
+        g = it->second;
+        m_groups.erase(it);
+    }
+
+    respond_group(*g, g->succeeded);
+}
+
+void
+search_manager :: group_keyop_bounced(uint64_t group_id, uint64_t ops)
+{
+    e::intrusive_ptr<group> g;
+
+    {
+        po6::threads::mutex::hold hold(&m_groups_mtx);
+        std::map<uint64_t, e::intrusive_ptr<group> >::iterator it = m_groups.find(group_id);
+
+        if (it == m_groups.end())
+        {
+            return;
+        }
+
+        // none of the batch's operations ran, so each is a failed ack
+        it->second->acked += ops;
+
+        if (!it->second->dispatched || it->second->acked < it->second->sent)
+        {
+            return;
+        }
+
+        g = it->second;
+        m_groups.erase(it);
+    }
+
+    respond_group(*g, g->succeeded);
 }
 
 void
@@ -552,7 +988,7 @@ search_manager :: count(const server_id& from,
                         uint64_t nonce,
                         std::vector<attribute_check>* checks)
 {
-    region_id ri(m_daemon->m_config.get_region_id(to));
+    region_id ri(m_daemon->m_config->get_region_id(to));
     std::stable_sort(checks->begin(), checks->end());
     datalayer::returncode rc = datalayer::SUCCESS;
     datalayer::snapshot snap = m_daemon->m_data.make_snapshot();
@@ -590,13 +1026,95 @@ search_manager :: count(const server_id& from,
     m_daemon->m_comm.send_client(to, from, RESP_COUNT, msg);
 }
 
+void
+search_manager :: aggregate(const server_id& from,
+                            const virtual_server_id& to,
+                            uint64_t nonce,
+                            std::vector<attribute_check>* checks,
+                            const std::vector<hyperdex::aggregate>& aggs,
+                            uint16_t group_by)
+{
+    region_id ri(m_daemon->m_config->get_region_id(to));
+    const schema* sc = m_daemon->m_config->get_schema(ri);
+    assert(sc);
+    aggregate_groups groups;
+    uint8_t flags = 0;
+    bool valid = validate_group_by(*sc, group_by);
+
+    for (size_t i = 0; valid && i < aggs.size(); ++i)
+    {
+        valid = validate_aggregate(*sc, aggs[i]);
+    }
+
+    // not every client checks the spec the way the C client does
+    if (!valid)
+    {
+        LOG(ERROR) << "rejecting aggregation from client=" << from
+                   << " nonce=" << nonce << " because its aggregates or group-by don't validate";
+        flags |= 0x2;
+    }
+
+    std::stable_sort(checks->begin(), checks->end());
+    datalayer::snapshot snap = m_daemon->m_data.make_snapshot();
+    e::intrusive_ptr<datalayer::iterator> iter;
+
+    if (valid)
+    {
+        iter = m_daemon->m_data.make_search_iterator(snap, ri, *checks, NULL);
+    }
+
+    while (valid && iter->valid())
+    {
+        e::slice key;
+        std::vector<e::slice> value;
+        uint64_t version;
+        datalayer::reference ref;
+        datalayer::returncode rc;
+        rc = m_daemon->m_data.get_from_iterator(ri, iter.get(), &key, &value, &version, &ref);
+
+        if (rc == datalayer::SUCCESS &&
+            !aggregate_object(*sc, aggs, group_by, value, &groups))
+        {
+            // too many groups; the client will fail the whole aggregation
+            flags |= 0x1;
+            groups.clear();
+            break;
+        }
+
+        iter->next();
+    }
+
+    size_t sz = HYPERDEX_HEADER_SIZE_VC
+              + sizeof(uint64_t)
+              + sizeof(uint8_t)
+              + sizeof(uint64_t);
+
+    for (aggregate_groups::iterator it = groups.begin();
+            it != groups.end(); ++it)
+    {
+        sz += sizeof(uint32_t) + it->first.size() + pack_size(it->second);
+    }
+
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_HEADER_SIZE_VC);
+    pa = pa << nonce << flags << static_cast<uint64_t>(groups.size());
+
+    for (aggregate_groups::iterator it = groups.begin();
+            it != groups.end(); ++it)
+    {
+        pa = pa << e::slice(it->first.data(), it->first.size()) << it->second;
+    }
+
+    m_daemon->m_comm.send_client(to, from, RESP_AGGREGATE, msg);
+}
+
 void
 search_manager :: search_describe(const server_id& from,
                                   const virtual_server_id& to,
                                   uint64_t nonce,
                                   std::vector<attribute_check>* checks)
 {
-    region_id ri(m_daemon->m_config.get_region_id(to));
+    region_id ri(m_daemon->m_config->get_region_id(to));
     std::stable_sort(checks->begin(), checks->end());
     datalayer::returncode rc = datalayer::SUCCESS;
     std::ostringstream ostr;
@@ -649,6 +1167,192 @@ search_manager :: search_describe(const server_id& from,
     m_daemon->m_comm.send_client(to, from, RESP_SEARCH_DESCRIBE, msg);
 }
 
+e::intrusive_ptr<search_manager::state>
+search_manager :: create(const server_id& from,
+                         const virtual_server_id& to,
+                         std::auto_ptr<e::buffer> msg,
+                         uint64_t search_id,
+                         std::vector<attribute_check>* checks)
+{
+    region_id ri(m_daemon->m_config->get_region_id(to));
+    id sid(ri, from, search_id);
+
+    if (m_searches.contains(sid))
+    {
+        LOG(WARNING) << "received request for search " << search_id << " from client "
+                     << from << " but the search is already in progress";
+        return NULL;
+    }
+
+    e::intrusive_ptr<state> st = new state(ri, msg, checks);
+    std::stable_sort(st->checks.begin(), st->checks.end());
+    datalayer::snapshot snap = m_daemon->m_data.make_snapshot();
+    st->iter = m_daemon->m_data.make_search_iterator(snap, ri, st->checks, NULL);
+    m_searches.insert(sid, st);
+    return st;
+}
+
+bool
+search_manager :: send_batch(const server_id& from,
+                             const virtual_server_id& to,
+                             uint64_t nonce,
+                             state* st)
+{
+    size_t sz = HYPERDEX_HEADER_SIZE_VC
+              + sizeof(uint64_t)
+              + sizeof(uint8_t)
+              + sizeof(uint64_t);
+    std::list<datalayer::reference> refs;
+    std::vector<std::pair<e::slice, std::vector<e::slice> > > objects;
+    bool done = true;
+
+    if (st)
+    {
+        po6::threads::mutex::hold hold(&st->lock);
+
+        while (st->iter->valid() && objects.size() < st->batch_objects)
+        {
+            e::slice key;
+            std::vector<e::slice> val;
+            uint64_t ver;
+            refs.push_back(datalayer::reference());
+            m_daemon->m_data.get_from_iterator(st->region, st->iter.get(), &key, &val, &ver, &refs.back());
+
+            if (st->projected)
+            {
+                apply_projection(st->projection, &val);
+            }
+
+            size_t obj_sz = pack_size(key) + pack_size(val);
+
+            // leave the object for the next batch; every batch carries at
+            // least one object, whatever its size
+            if (!objects.empty() && sz + obj_sz > st->batch_bytes)
+            {
+                break;
+            }
+
+            objects.push_back(std::make_pair(key, val));
+            sz += obj_sz;
+            st->iter->next();
+        }
+
+        done = !st->iter->valid();
+    }
+
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_HEADER_SIZE_VC);
+    pa = pa << nonce << uint8_t(done ? 1 : 0) << uint64_t(objects.size());
+
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        pa = pa << objects[i].first << objects[i].second;
+    }
+
+    m_daemon->m_comm.send_client(to, from, RESP_SEARCH_BATCH, msg);
+    return done && st;
+}
+
+void
+search_manager :: reject(const server_id& from,
+                         const virtual_server_id& to,
+                         uint64_t nonce,
+                         uint64_t count)
+{
+    // the client expects one response per credit; an absurd count can't be
+    // answered in full, so answer as many as a well-formed request could
+    count = std::max(uint64_t(1), std::min(count, uint64_t(SEARCH_MAX_CREDITS)));
+
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        std::auto_ptr<e::buffer> msg(e::buffer::create(HYPERDEX_HEADER_SIZE_VC + sizeof(uint64_t)));
+        msg->pack_at(HYPERDEX_HEADER_SIZE_VC) << nonce + i;
+        m_daemon->m_comm.send_client(to, from, RESP_SEARCH_DONE, msg);
+    }
+}
+
+void
+search_manager :: send_group_batch(uint64_t group_id,
+                                   const std::vector<attribute_check>& checks,
+                                   uint8_t flags,
+                                   const std::vector<funcall>& funcs,
+                                   group_batch* batch)
+{
+    assert(!batch->empty());
+    const virtual_server_id vto = (*batch)[0].first;
+    size_t sz = HYPERDEX_HEADER_SIZE_SV // SV because we imitate a client
+              + sizeof(uint64_t)
+              + sizeof(uint64_t);
+
+    for (size_t i = 0; i < batch->size(); ++i)
+    {
+        sz += sizeof(uint64_t)
+            + sizeof(uint64_t)
+            + pack_size(e::slice((*batch)[i].second))
+            + sizeof(uint8_t)
+            + pack_size(checks)
+            + pack_size(funcs);
+    }
+
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_HEADER_SIZE_SV);
+    pa = pa << group_id << static_cast<uint64_t>(batch->size());
+
+    // every operation acks with the group's id as its nonce
+    for (size_t i = 0; i < batch->size(); ++i)
+    {
+        pa = pa << (*batch)[i].first << group_id
+                << e::slice((*batch)[i].second) << flags << checks << funcs;
+    }
+
+    const uint64_t ops = batch->size();
+    std::set<virtual_server_id> targets;
+
+    for (size_t i = 0; i < batch->size(); ++i)
+    {
+        targets.insert((*batch)[i].first);
+    }
+
+    batch->clear();
+
+    // count the operations before they go out so that no ack can finish the
+    // group early
+    {
+        po6::threads::mutex::hold hold(&m_groups_mtx);
+        std::map<uint64_t, e::intrusive_ptr<group> >::iterator it = m_groups.find(group_id);
+
+        if (it == m_groups.end())
+        {
+            return;
+        }
+
+        it->second->sent += ops;
+        it->second->targets.insert(targets.begin(), targets.end());
+    }
+
+    if (!m_daemon->m_comm.send(vto, REQ_BULK_ATOMIC, msg))
+    {
+        po6::threads::mutex::hold hold(&m_groups_mtx);
+        std::map<uint64_t, e::intrusive_ptr<group> >::iterator it = m_groups.find(group_id);
+
+        if (it != m_groups.end())
+        {
+            it->second->sent -= ops;
+        }
+    }
+}
+
+void
+search_manager :: respond_group(const group& g, uint64_t result)
+{
+    size_t sz = HYPERDEX_HEADER_SIZE_VC
+              + sizeof(uint64_t)
+              + sizeof(uint64_t);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    msg->pack_at(HYPERDEX_HEADER_SIZE_VC) << g.nonce << result;
+    m_daemon->m_comm.send_client(g.us, g.client, g.resp, msg);
+}
+
 uint64_t
 search_manager :: hash(const id& sid)
 {
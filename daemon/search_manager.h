@@ -28,14 +28,24 @@
 #ifndef hyperdex_daemon_search_manager_h_
 #define hyperdex_daemon_search_manager_h_
 
+// STL
+#include <map>
+#include <vector>
+
+// po6
+#include <po6/threads/mutex.h>
+
 // e
 #include <e/intrusive_ptr.h>
 #include <e/lockfree_hash_map.h>
 
 // HyperDex
 #include "namespace.h"
+#include "common/aggregate.h"
+#include "common/funcall.h"
 #include "common/ids.h"
 #include "common/network_msgtype.h"
+#include "common/network_returncode.h"
 #include "daemon/datalayer.h"
 #include "daemon/reconfigure_returncode.h"
 
@@ -69,24 +79,61 @@ class search_manager
         void stop(const server_id& from,
                   const virtual_server_id& to,
                   uint64_t search_id);
+        // Streaming searches answer each credit, starting with "nonce" and
+        // counting up, with a batch of up to "batch_objects" objects and
+        // "batch_bytes" bytes.  A non-NULL projection limits the attributes
+        // returned for each object.
+        void stream(const server_id& from,
+                    const virtual_server_id& to,
+                    std::auto_ptr<e::buffer> msg,
+                    uint64_t nonce,
+                    uint64_t credits,
+                    uint64_t search_id,
+                    uint64_t batch_objects,
+                    uint64_t batch_bytes,
+                    std::vector<attribute_check>* checks,
+                    const std::vector<uint16_t>* projection);
+        void credit(const server_id& from,
+                    const virtual_server_id& to,
+                    uint64_t nonce,
+                    uint64_t credits,
+                    uint64_t search_id);
         void sorted_search(const server_id& from,
                            const virtual_server_id& to,
                            uint64_t nonce,
                            std::vector<attribute_check>* checks,
                            uint64_t limit,
                            uint16_t sort_by,
-                           bool maximize);
+                           bool maximize,
+                           const std::vector<uint16_t>* projection);
+        // Apply the same REQ_ATOMIC "flags" and "funcs" to every matching
+        // object.  Operations are batched into one REQ_BULK_ATOMIC per point
+        // leader, and the client hears "resp" with the number of operations
+        // that succeeded only after every one of them has been acked.
         void group_keyop(const server_id& from,
                          const virtual_server_id& to,
                          uint64_t nonce,
                          std::vector<attribute_check>* checks,
-                         network_msgtype mt,
-                         const e::slice& remain,
+                         uint8_t flags,
+                         const std::vector<funcall>& funcs,
                          network_msgtype resp);
+        void group_keyop_ack(uint64_t group_id, network_returncode result);
+        // a REQ_BULK_ATOMIC of "ops" operations came back as CONFIGMISMATCH
+        void group_keyop_bounced(uint64_t group_id, uint64_t ops);
+        // resume group operations that stalled on the I/O scheduler
+        void kick();
         void count(const server_id& from,
                    const virtual_server_id& to,
                    uint64_t nonce,
                    std::vector<attribute_check>* checks);
+        // fold the matching objects into partial aggregates, grouped by the
+        // value of "group_by" unless it is 0
+        void aggregate(const server_id& from,
+                       const virtual_server_id& to,
+                       uint64_t nonce,
+                       std::vector<attribute_check>* checks,
+                       const std::vector<hyperdex::aggregate>& aggs,
+                       uint16_t group_by);
         void search_describe(const server_id& from,
                              const virtual_server_id& to,
                              uint64_t nonce,
@@ -95,17 +142,50 @@ class search_manager
     private:
         class id;
         class state;
+        class group;
+        typedef std::vector<std::pair<virtual_server_id, std::string> > group_batch;
 
     private:
         search_manager(const search_manager&);
         search_manager& operator = (const search_manager&);
 
     private:
+        e::intrusive_ptr<state> create(const server_id& from,
+                                       const virtual_server_id& to,
+                                       std::auto_ptr<e::buffer> msg,
+                                       uint64_t search_id,
+                                       std::vector<attribute_check>* checks);
+        // returns true if this batch exhausted the search
+        bool send_batch(const server_id& from,
+                        const virtual_server_id& to,
+                        uint64_t nonce,
+                        state* st);
+        // answer "count" nonces starting at "nonce" with RESP_SEARCH_DONE,
+        // which a client waiting on any other response takes as an error
+        void reject(const server_id& from,
+                    const virtual_server_id& to,
+                    uint64_t nonce,
+                    uint64_t count);
         static uint64_t hash(const id&);
+        // send one REQ_BULK_ATOMIC and count it against the group; clears
+        // the batch
+        void send_group_batch(uint64_t group_id,
+                              const std::vector<attribute_check>& checks,
+                              uint8_t flags,
+                              const std::vector<funcall>& funcs,
+                              group_batch* batch);
+        // scan for the group's operations until done or turned away by the
+        // I/O scheduler, in which case the group waits for kick
+        void scan_group(e::intrusive_ptr<group> g);
+        void respond_group(const group& g, uint64_t result);
 
     private:
         daemon* m_daemon;
         e::lockfree_hash_map<id, e::intrusive_ptr<state>, hash> m_searches;
+        po6::threads::mutex m_groups_mtx;
+        std::map<uint64_t, e::intrusive_ptr<group> > m_groups;
+        std::vector<e::intrusive_ptr<group> > m_stalled_groups;
+        uint64_t m_next_group_id;
 };
 
 END_HYPERDEX_NAMESPACE
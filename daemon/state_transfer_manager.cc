@@ -51,6 +51,7 @@ state_transfer_manager :: state_transfer_manager(daemon* d)
     : m_daemon(d)
     , m_transfers_in()
     , m_transfers_out()
+    , m_bytes_in_flight(0)
     , m_kickstarter(std::tr1::bind(&state_transfer_manager::kickstarter, this))
     , m_block_kickstarter()
     , m_wakeup_kickstarter(&m_block_kickstarter)
@@ -182,6 +183,50 @@ state_transfer_manager :: reconfigure(const configuration&,
     new_config.transfer_out_regions(m_daemon->m_us, &transfers_out);
     std::sort(transfers_out.begin(), transfers_out.end());
     setup_transfer_state("outgoing", &m_daemon->m_data, snap, transfers_out, &m_transfers_out);
+
+    // transfers that ended took their in-flight bytes with them
+    uint64_t bytes_in_flight = 0;
+
+    for (size_t i = 0; i < m_transfers_out.size(); ++i)
+    {
+        po6::threads::mutex::hold hold(&m_transfers_out[i].second->mtx);
+        bytes_in_flight += m_transfers_out[i].second->bytes_in_flight;
+    }
+
+    m_bytes_in_flight = bytes_in_flight;
+}
+
+state_transfer_manager::transfer_in_state*
+state_transfer_manager :: get_transfer_in(const virtual_server_id& from,
+                                          const transfer_id& xid,
+                                          const char* desc)
+{
+    std::vector<std::pair<transfer_id, e::intrusive_ptr<transfer_in_state> > >::iterator it;
+    it = std::lower_bound(m_transfers_in.begin(),
+                          m_transfers_in.end(),
+                          std::make_pair(xid, e::intrusive_ptr<transfer_in_state>()));
+
+    if (it == m_transfers_in.end() || it->first != xid)
+    {
+        LOG(INFO) << "dropping " << desc << " for transfer we don't know about";
+        return NULL;
+    }
+
+    transfer_in_state* tis = it->second.get();
+
+    if (!tis)
+    {
+        return NULL;
+    }
+
+    // xfer is fixed for the lifetime of tis
+    if (tis->xfer.vsrc != from || tis->xfer.id != xid)
+    {
+        LOG(INFO) << "dropping " << desc << " that came from the wrong host";
+        return NULL;
+    }
+
+    return tis;
 }
 
 void
@@ -194,18 +239,46 @@ state_transfer_manager :: xfer_op(const virtual_server_id& from,
                                   const e::slice& key,
                                   const std::vector<e::slice>& value)
 {
-    std::vector<std::pair<transfer_id, e::intrusive_ptr<transfer_in_state> > >::iterator it;
-    it = std::lower_bound(m_transfers_in.begin(),
-                          m_transfers_in.end(),
-                          std::make_pair(xid, e::intrusive_ptr<transfer_in_state>()));
+    transfer_in_state* tis = get_transfer_in(from, xid, "XFER_OP");
 
-    if (it == m_transfers_in.end() || it->first != xid)
+    if (!tis)
     {
-        LOG(INFO) << "dropping XFER_OP for transfer we don't know about";
         return;
     }
 
-    transfer_in_state* tis = it->second.get();
+    po6::threads::mutex::hold hold(&tis->mtx);
+
+    if (seq_no < tis->upper_bound_acked)
+    {
+        return send_ack(tis->xfer, seq_no, false);
+    }
+
+    e::intrusive_ptr<pending> op(new pending());
+    op->seq_no = seq_no;
+    op->has_value = has_value;
+    op->version = version;
+    op->key = key;
+    op->value = value;
+    op->msg.reset(msg.release());
+    queue_op(tis, op);
+
+    if (!tis->cleared_capture)
+    {
+        capture_id cid = m_daemon->m_config->capture_for(tis->xfer.rid);
+        m_daemon->m_data.request_wipe(cid);
+        return;
+    }
+
+    put_to_disk_and_send_acks(tis);
+}
+
+void
+state_transfer_manager :: xfer_batch(const virtual_server_id& from,
+                                     const transfer_id& xid,
+                                     std::auto_ptr<e::buffer> msg,
+                                     e::unpacker up)
+{
+    transfer_in_state* tis = get_transfer_in(from, xid, "XFER_BATCH");
 
     if (!tis)
     {
@@ -213,59 +286,76 @@ state_transfer_manager :: xfer_op(const virtual_server_id& from,
     }
 
     po6::threads::mutex::hold hold(&tis->mtx);
+    tis->batched = true;
+    std::tr1::shared_ptr<e::buffer> backing(msg.release());
+    uint64_t count = 0;
+    up = up >> count;
 
-    if (tis->xfer.vsrc != from || tis->xfer.id != xid)
+    for (uint64_t i = 0; !up.error() && i < count; ++i)
     {
-        LOG(INFO) << "dropping XFER_OP that came from the wrong host";
-        return;
+        e::intrusive_ptr<pending> op(new pending());
+        uint8_t flags = 0;
+        up = up >> flags >> op->seq_no >> op->version >> op->key >> op->value;
+
+        if (up.error())
+        {
+            LOG(WARNING) << "unpack of XFER_BATCH failed; here's some hex:  " << backing->hex();
+            break;
+        }
+
+        op->has_value = flags & 1;
+        op->raw = flags & 2;
+        op->msg = backing;
+
+        if (op->seq_no < tis->upper_bound_acked)
+        {
+            tis->need_ack = true;
+            continue;
+        }
+
+        queue_op(tis, op);
     }
 
-    if (seq_no < tis->upper_bound_acked)
+    if (!tis->cleared_capture)
     {
-        return send_ack(tis->xfer, seq_no);
+        capture_id cid = m_daemon->m_config->capture_for(tis->xfer.rid);
+        m_daemon->m_data.request_wipe(cid);
+        return;
     }
 
+    put_to_disk_and_send_acks(tis);
+}
+
+void
+state_transfer_manager :: queue_op(transfer_in_state* tis,
+                                   e::intrusive_ptr<pending> op)
+{
     std::list<e::intrusive_ptr<pending> >::iterator where_to_put_it;
 
     for (where_to_put_it = tis->queued.begin();
             where_to_put_it != tis->queued.end(); ++where_to_put_it)
     {
-        if ((*where_to_put_it)->seq_no == seq_no)
+        if ((*where_to_put_it)->seq_no == op->seq_no)
         {
             // silently drop it
             return;
         }
 
-        if ((*where_to_put_it)->seq_no > seq_no)
+        if ((*where_to_put_it)->seq_no > op->seq_no)
         {
             break;
         }
     }
 
-    e::intrusive_ptr<pending> op(new pending());
-    op->seq_no = seq_no;
-    op->has_value = has_value;
-    op->version = version;
-    op->key = key;
-    op->value = value;
-    op->msg = msg;
     tis->queued.insert(where_to_put_it, op);
-
-    if (!tis->cleared_capture)
-    {
-        capture_id cid = m_daemon->m_config.capture_for(tis->xfer.rid);
-        m_daemon->m_data.request_wipe(cid);
-        return;
-    }
-
-    put_to_disk_and_send_acks(tis);
 }
 
 void
 state_transfer_manager :: xfer_ack(const server_id& from,
                                    const virtual_server_id& to,
                                    const transfer_id& xid,
-                                   uint64_t seq_no)
+                                   uint64_t seq_no,
+                                   bool cumulative)
 {
     std::vector<std::pair<transfer_id, e::intrusive_ptr<transfer_out_state> > >::iterator _it;
     _it = std::lower_bound(m_transfers_out.begin(),
@@ -274,7 +364,7 @@ state_transfer_manager :: xfer_ack(const server_id& from,
 
     if (_it == m_transfers_out.end() || _it->first != xid)
     {
-        LOG(INFO) << "dropping XFER_OP for transfer we don't know about";
+        LOG(INFO) << "dropping XFER_ACK for transfer we don't know about";
         return;
     }
 
@@ -289,30 +379,32 @@ state_transfer_manager :: xfer_ack(const server_id& from,
 
     if (tos->xfer.dst != from || tos->xfer.vsrc != to || tos->xfer.id != xid)
     {
-        LOG(INFO) << "dropping XFER_OP that came from the wrong host";
+        LOG(INFO) << "dropping XFER_ACK that came from the wrong host";
         return;
     }
 
-    std::list<e::intrusive_ptr<pending> >::iterator it;
+    uint64_t freed = 0;
 
-    for (it = tos->window.begin(); it != tos->window.end(); ++it)
+    for (std::list<e::intrusive_ptr<pending> >::iterator it = tos->window.begin();
+            it != tos->window.end(); ++it)
     {
-        if ((*it)->seq_no == seq_no)
+        if ((*it)->seq_no > seq_no)
         {
             break;
         }
-    }
-
-    if (it != tos->window.end())
-    {
-        (*it)->acked = true;
 
-        if (tos->window_sz < 1024)
+        if (!(*it)->acked && ((*it)->seq_no == seq_no || cumulative))
         {
-            ++tos->window_sz;
+            (*it)->acked = true;
+            freed += (*it)->bytes;
         }
     }
 
+    assert(freed <= tos->bytes_in_flight);
+    tos->bytes_in_flight -= freed;
+    __sync_sub_and_fetch(&m_bytes_in_flight, freed);
+    tos->window_bytes = std::min<uint64_t>(tos->window_bytes + freed, XFER_WINDOW_MAX_BYTES);
+
     while (!tos->window.empty() && (*tos->window.begin())->acked)
     {
         tos->window.pop_front();
@@ -345,6 +437,14 @@ state_transfer_manager :: retransmit(const server_id& id)
     }
 }
 
+void
+state_transfer_manager :: kick()
+{
+    po6::threads::mutex::hold hold(&m_block_kickstarter);
+    m_need_kickstart = true;
+    m_wakeup_kickstarter.broadcast();
+}
+
 void
 state_transfer_manager :: report_wiped(const capture_id& cid)
 {
@@ -362,7 +462,7 @@ state_transfer_manager :: report_wiped(const capture_id& cid)
         transfer_in_state* tis = m_transfers_in[idx].second.get();
 
         if (!tis->cleared_capture &&
-            m_daemon->m_config.capture_for(tis->xfer.rid) == cid)
+            m_daemon->m_config->capture_for(tis->xfer.rid) == cid)
         {
             tis->cleared_capture = true;
             put_to_disk_and_send_acks(tis);
@@ -375,30 +475,56 @@ state_transfer_manager :: report_wiped(const capture_id& cid)
 void
 state_transfer_manager :: transfer_more_state(transfer_out_state* tos)
 {
-    while (tos->window.size() < tos->window_sz)
+    std::vector<pending*> batch;
+    uint64_t batch_bytes = 0;
+    bool stalled = false;
+
+    // Every transfer may keep one window's worth of state in flight; beyond
+    // the first batch, we also respect the limit across all transfers.
+    while (tos->bytes_in_flight < tos->window_bytes &&
+           (tos->window.empty() || m_bytes_in_flight < XFER_SERVER_MAX_BYTES))
     {
+        // the daemon kicks us on the next tick if we're turned away here
+        if (!m_daemon->m_io.admit(io_scheduler::TRANSFER))
+        {
+            stalled = true;
+            break;
+        }
+
+        e::intrusive_ptr<pending> op;
+
         if (tos->state == transfer_out_state::SNAPSHOT_TRANSFER)
         {
-            if (tos->iter->valid())
+            // ship the snapshot as runs of objects exactly as they are
+            // encoded on disk; the log covers everything that came after
+            op = new pending();
+            datalayer::returncode rc;
+            rc = m_daemon->m_data.get_raw_run(tos->snap, tos->xfer.rid,
+                                              &tos->raw_cursor,
+                                              XFER_BATCH_MAX_BYTES,
+                                              &op->value, &op->ref);
+
+            if (rc != datalayer::SUCCESS)
             {
-                e::intrusive_ptr<pending> op(new pending());
-                op->seq_no = tos->next_seq_no;
-                ++tos->next_seq_no;
-                op->has_value = true;
-                m_daemon->m_data.get_from_iterator(tos->xfer.rid, tos->iter.get(), &op->key, &op->value, &op->version, &op->ref);
-
-                tos->window.push_back(op);
-                send_object(tos->xfer, op.get());
-                tos->iter->next();
+                LOG(ERROR) << "state transfer caused error " << rc;
+                stalled = true;
+                break;
             }
-            else
+
+            if (op->value.empty())
             {
                 tos->state = transfer_out_state::LOG_TRANSFER;
+                continue;
             }
+
+            op->seq_no = tos->next_seq_no;
+            ++tos->next_seq_no;
+            op->has_value = true;
+            op->raw = true;
         }
         else if (tos->state == transfer_out_state::LOG_TRANSFER)
         {
-            e::intrusive_ptr<pending> op(new pending());
+            op = new pending();
             datalayer::returncode rc;
             rc = m_daemon->m_data.get_transfer(tos->xfer.rid, tos->log_seq_no,
                                                &op->has_value,
@@ -434,17 +560,45 @@ state_transfer_manager :: transfer_more_state(transfer_out_state* tos)
 
             op->seq_no = tos->next_seq_no;
             ++tos->next_seq_no;
-            tos->window.push_back(op);
-            send_object(tos->xfer, op.get());
             ++tos->log_seq_no;
         }
         else
         {
             abort();
         }
+
+        op->bytes = sizeof(uint8_t)
+                  + sizeof(uint64_t)
+                  + sizeof(uint64_t)
+                  + sizeof(uint32_t) + op->key.size()
+                  + pack_size(op->value);
+        m_daemon->m_io.charge(io_scheduler::TRANSFER, op->bytes);
+        tos->window.push_back(op);
+        tos->bytes_in_flight += op->bytes;
+        __sync_add_and_fetch(&m_bytes_in_flight, op->bytes);
+        batch.push_back(op.get());
+        batch_bytes += op->bytes;
+
+        if (batch.size() >= XFER_BATCH_MAX_OBJECTS ||
+            batch_bytes >= XFER_BATCH_MAX_BYTES)
+        {
+            send_objects(tos->xfer, batch);
+            batch.clear();
+            batch_bytes = 0;
+        }
+    }
+
+    if (!batch.empty())
+    {
+        send_objects(tos->xfer, batch);
     }
 
-    if (tos->window.empty() && m_daemon->m_config.is_transfer_live(tos->xfer.id))
+    if (stalled)
+    {
+        return;
+    }
+
+    if (tos->window.empty() && m_daemon->m_config->is_transfer_live(tos->xfer.id))
     {
         m_daemon->m_coord.transfer_complete(tos->xfer.id);
     }
@@ -457,11 +611,36 @@ state_transfer_manager :: transfer_more_state(transfer_out_state* tos)
 void
 state_transfer_manager :: retransmit(transfer_out_state* tos)
 {
+    std::vector<pending*> batch;
+    uint64_t batch_bytes = 0;
+
     for (std::list<e::intrusive_ptr<pending> >::iterator it = tos->window.begin();
             it != tos->window.end(); ++it)
     {
-        send_object(tos->xfer, it->get());
+        if ((*it)->acked)
+        {
+            continue;
+        }
+
+        batch.push_back(it->get());
+        batch_bytes += (*it)->bytes;
+
+        if (batch.size() >= XFER_BATCH_MAX_OBJECTS ||
+            batch_bytes >= XFER_BATCH_MAX_BYTES)
+        {
+            send_objects(tos->xfer, batch);
+            batch.clear();
+            batch_bytes = 0;
+        }
+    }
+
+    if (!batch.empty())
+    {
+        send_objects(tos->xfer, batch);
     }
+
+    // back off; the window regrows as acks arrive
+    tos->window_bytes = std::max<uint64_t>(tos->window_bytes / 2, XFER_BATCH_MAX_BYTES);
 }
 
 void
@@ -472,10 +651,86 @@ state_transfer_manager :: put_to_disk_and_send_acks(transfer_in_state* tis)
         return;
     }
 
+    std::vector<e::intrusive_ptr<pending> > absent;
+    bool applied = false;
+
     while (!tis->queued.empty() &&
            tis->queued.front()->seq_no == tis->upper_bound_acked)
     {
         e::intrusive_ptr<pending> op = tis->queued.front();
+        applied = true;
+
+        if (op->raw)
+        {
+            // A run writes objects without looking for existing versions,
+            // so clear out whatever the region held before the first run.
+            // Runs never overlap, but the log that follows may touch any
+            // key.
+            put_absent(tis, &absent);
+
+            if (tis->need_del && !tis->known_empty)
+            {
+                datalayer::returncode rc = m_daemon->m_data.clear_region(tis->xfer.rid);
+
+                if (rc != datalayer::SUCCESS)
+                {
+                    LOG(ERROR) << "state transfer caused error " << rc;
+                }
+            }
+
+            tis->need_del = false;
+
+            tis->known_empty = false;
+            datalayer::returncode rc = m_daemon->m_data.put_raw_run(tis->xfer.rid, op->value);
+
+            switch (rc)
+            {
+                case datalayer::SUCCESS:
+                    break;
+                case datalayer::NOT_FOUND:
+                case datalayer::BAD_ENCODING:
+                case datalayer::CORRUPTION:
+                case datalayer::IO_ERROR:
+                case datalayer::LEVELDB_ERROR:
+                    LOG(ERROR) << "state transfer caused error " << rc;
+                    break;
+                default:
+                    LOG(ERROR) << "state transfer caused unknown error";
+                    break;
+            }
+
+            if (!tis->batched)
+            {
+                send_ack(tis->xfer, op->seq_no, false);
+            }
+
+            tis->upper_bound_acked = std::max(tis->upper_bound_acked, op->seq_no + 1);
+            tis->prev = tis->queued.front();
+            tis->queued.pop_front();
+            continue;
+        }
+
+        // If the region started empty and keys are still arriving in sorted
+        // order, nothing can exist for op->key; defer it to one batch write.
+        if (tis->known_empty && op->has_value &&
+            (!tis->prev || tis->prev->key < op->key))
+        {
+            absent.push_back(op);
+
+            if (absent.size() >= XFER_BATCH_MAX_OBJECTS)
+            {
+                put_absent(tis, &absent);
+            }
+
+            tis->upper_bound_acked = std::max(tis->upper_bound_acked, op->seq_no + 1);
+            tis->prev = tis->queued.front();
+            tis->queued.pop_front();
+            continue;
+        }
+
+        // everything deferred must hit the disk before op
+        tis->known_empty = false;
+        put_absent(tis, &absent);
 
         // if we are still processing keys in sorted order, then delete
         // everything less than op->key
@@ -493,29 +748,7 @@ state_transfer_manager :: put_to_disk_and_send_acks(transfer_in_state* tis)
             // We've hit a point where we're now going out of order.  Save this
             // to avoid expensive comparison above, and delete everything
             // leftover in iter after this point.
-            tis->need_del = false;
-
-            while (tis->iter->valid())
-            {
-                datalayer::returncode rc = m_daemon->m_data.uncertain_del(tis->xfer.rid, tis->iter->key());
-                tis->iter->next();
-
-                switch (rc)
-                {
-                    case datalayer::SUCCESS:
-                    case datalayer::NOT_FOUND:
-                        break;
-                    case datalayer::BAD_ENCODING:
-                    case datalayer::CORRUPTION:
-                    case datalayer::IO_ERROR:
-                    case datalayer::LEVELDB_ERROR:
-                        LOG(ERROR) << "state transfer caused error " << rc;
-                        break;
-                    default:
-                        LOG(ERROR) << "state transfer caused unknown error";
-                        break;
-                }
-            }
+            del_remaining(tis);
         }
 
         if (op->has_value)
@@ -559,36 +792,137 @@ state_transfer_manager :: put_to_disk_and_send_acks(transfer_in_state* tis)
             }
         }
 
-        send_ack(tis->xfer, op->seq_no);
+        if (!tis->batched)
+        {
+            send_ack(tis->xfer, op->seq_no, false);
+        }
+
         tis->upper_bound_acked = std::max(tis->upper_bound_acked, op->seq_no + 1);
 
         tis->prev = tis->queued.front();
         tis->queued.pop_front();
     }
+
+    put_absent(tis, &absent);
+
+    if (tis->batched && (applied || tis->need_ack))
+    {
+        send_ack(tis->xfer, tis->upper_bound_acked - 1, true);
+        tis->need_ack = false;
+    }
 }
 
 void
-state_transfer_manager :: send_object(const transfer& xfer,
-                                      pending* op)
+state_transfer_manager :: del_remaining(transfer_in_state* tis)
 {
-    uint8_t flags = (op->has_value ? 1 : 0);
+    tis->need_del = false;
+
+    while (tis->iter->valid())
+    {
+        datalayer::returncode rc = m_daemon->m_data.uncertain_del(tis->xfer.rid, tis->iter->key());
+        tis->iter->next();
+
+        switch (rc)
+        {
+            case datalayer::SUCCESS:
+            case datalayer::NOT_FOUND:
+                break;
+            case datalayer::BAD_ENCODING:
+            case datalayer::CORRUPTION:
+            case datalayer::IO_ERROR:
+            case datalayer::LEVELDB_ERROR:
+                LOG(ERROR) << "state transfer caused error " << rc;
+                break;
+            default:
+                LOG(ERROR) << "state transfer caused unknown error";
+                break;
+        }
+    }
+}
+
+void
+state_transfer_manager :: put_absent(transfer_in_state* tis,
+                                     std::vector<e::intrusive_ptr<pending> >* ops)
+{
+    if (ops->empty())
+    {
+        return;
+    }
+
+    std::vector<e::slice> keys;
+    std::vector<const std::vector<e::slice>*> values;
+    std::vector<uint64_t> versions;
+    keys.reserve(ops->size());
+    values.reserve(ops->size());
+    versions.reserve(ops->size());
+
+    for (size_t i = 0; i < ops->size(); ++i)
+    {
+        keys.push_back((*ops)[i]->key);
+        values.push_back(&(*ops)[i]->value);
+        versions.push_back((*ops)[i]->version);
+    }
+
+    datalayer::returncode rc = m_daemon->m_data.put_absent(tis->xfer.rid, keys, values, versions);
+
+    switch (rc)
+    {
+        case datalayer::SUCCESS:
+            break;
+        case datalayer::NOT_FOUND:
+        case datalayer::BAD_ENCODING:
+        case datalayer::CORRUPTION:
+        case datalayer::IO_ERROR:
+        case datalayer::LEVELDB_ERROR:
+            LOG(ERROR) << "state transfer caused error " << rc;
+            break;
+        default:
+            LOG(ERROR) << "state transfer caused unknown error";
+            break;
+    }
+
+    for (size_t i = 0; !tis->batched && i < ops->size(); ++i)
+    {
+        send_ack(tis->xfer, (*ops)[i]->seq_no, false);
+    }
+
+    ops->clear();
+}
+
+void
+state_transfer_manager :: send_objects(const transfer& xfer,
+                                       const std::vector<pending*>& ops)
+{
+    uint8_t flags = 0;
     size_t sz = HYPERDEX_HEADER_SIZE_VV
               + sizeof(uint8_t)
               + sizeof(uint64_t)
-              + sizeof(uint64_t)
-              + sizeof(uint64_t)
-              + sizeof(uint32_t) + op->key.size()
-              + pack_size(op->value);
+              + sizeof(uint64_t);
+
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        sz += ops[i]->bytes;
+    }
+
     std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
-    msg->pack_at(HYPERDEX_HEADER_SIZE_VV) << flags << xfer.id.get() << op->seq_no
-                                          << op->version << op->key << op->value;
-    m_daemon->m_comm.send(xfer.vsrc, xfer.vdst, XFER_OP, msg);
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_HEADER_SIZE_VV);
+    pa = pa << flags << xfer.id.get() << uint64_t(ops.size());
+
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        uint8_t op_flags = (ops[i]->has_value ? 1 : 0)
+                         | (ops[i]->raw ? 2 : 0);
+        pa = pa << op_flags << ops[i]->seq_no
+                << ops[i]->version << ops[i]->key << ops[i]->value;
+    }
+
+    m_daemon->m_comm.send(xfer.vsrc, xfer.vdst, XFER_BATCH, msg);
 }
 
 void
-state_transfer_manager :: send_ack(const transfer& xfer, uint64_t seq_no)
+state_transfer_manager :: send_ack(const transfer& xfer, uint64_t seq_no, bool cumulative)
 {
-    uint8_t flags = 0;
+    uint8_t flags = (cumulative ? 1 : 0);
     size_t sz = HYPERDEX_HEADER_SIZE_VV
               + sizeof(uint8_t)
               + sizeof(uint64_t)
@@ -616,6 +950,8 @@ state_transfer_manager :: kickstarter()
         return;
     }
 
+    m_daemon->m_config.online();
+
     while (true)
     {
         {
@@ -630,7 +966,9 @@ state_transfer_manager :: kickstarter()
                     m_wakeup_reconfigurer.signal();
                 }
 
+                m_daemon->m_config.offline();
                 m_wakeup_kickstarter.wait();
+                m_daemon->m_config.online();
                 m_paused = false;
             }
 
@@ -675,6 +1013,7 @@ state_transfer_manager :: kickstarter()
         }
     }
 
+    m_daemon->m_config.offline();
     LOG(INFO) << "state transfer thread shutting down";
 }
 
@@ -37,6 +37,7 @@
 #include <po6/threads/thread.h>
 
 // e
+#include <e/buffer.h>
 #include <e/intrusive_ptr.h>
 
 // HyperDex
@@ -72,11 +73,20 @@ class state_transfer_manager
                      std::auto_ptr<e::buffer> msg,
                      const e::slice& key,
                      const std::vector<e::slice>& value);
+        // up is positioned just after the transfer id
+        void xfer_batch(const virtual_server_id& from,
+                        const transfer_id& xid,
+                        std::auto_ptr<e::buffer> msg,
+                        e::unpacker up);
+        // a cumulative ack covers every seq_no up to and including seq_no
         void xfer_ack(const server_id& from,
                       const virtual_server_id& to,
                       const transfer_id& xid,
-                      uint64_t seq_no);
+                      uint64_t seq_no,
+                      bool cumulative);
         void retransmit(const server_id& id);
+        // have another go at every transfer, e.g. once I/O is available
+        void kick();
         void report_wiped(const capture_id& cid);
 
     private:
@@ -89,11 +99,21 @@ class state_transfer_manager
         void transfer_more_state(transfer_out_state* tos);
         void retransmit(transfer_out_state* tos);
         // caller must hold mtx on tis
+        transfer_in_state* get_transfer_in(const virtual_server_id& from,
+                                           const transfer_id& xid,
+                                           const char* desc);
+        // caller must hold mtx on tis
+        void queue_op(transfer_in_state* tis, e::intrusive_ptr<pending> op);
+        // caller must hold mtx on tis
         void put_to_disk_and_send_acks(transfer_in_state* tis);
+        // caller must hold mtx on tis
+        void del_remaining(transfer_in_state* tis);
+        // caller must hold mtx on tis
+        void put_absent(transfer_in_state* tis,
+                        std::vector<e::intrusive_ptr<pending> >* ops);
         // caller must hold mtx on tos
-        // send the last object in tos
-        void send_object(const transfer& xfer, pending* op);
-        void send_ack(const transfer& xfer, uint64_t seq_id);
+        void send_objects(const transfer& xfer, const std::vector<pending*>& ops);
+        void send_ack(const transfer& xfer, uint64_t seq_id, bool cumulative);
         void kickstarter();
         void shutdown();
 
@@ -105,6 +125,7 @@ class state_transfer_manager
         daemon* m_daemon;
         std::vector<std::pair<transfer_id, e::intrusive_ptr<transfer_in_state> > > m_transfers_in;
         std::vector<std::pair<transfer_id, e::intrusive_ptr<transfer_out_state> > > m_transfers_out;
+        uint64_t m_bytes_in_flight;
         po6::threads::thread m_kickstarter;
         po6::threads::mutex m_block_kickstarter;
         po6::threads::cond m_wakeup_kickstarter;
@@ -33,10 +33,12 @@ using hyperdex::state_transfer_manager;
 state_transfer_manager :: state_transfer_manager :: pending :: pending()
     : seq_no(0)
     , has_value(false)
+    , raw(false)
     , version(0)
     , key()
     , value()
     , acked(false)
+    , bytes(0)
     , msg()
     , ref()
     , m_ref(0)
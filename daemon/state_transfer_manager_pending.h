@@ -28,6 +28,9 @@
 #ifndef hyperdex_daemon_state_transfer_manager_pending_h_
 #define hyperdex_daemon_state_transfer_manager_pending_h_
 
+// STL
+#include <tr1/memory>
+
 // HyperDex
 #include "daemon/datalayer.h"
 #include "daemon/state_transfer_manager.h"
@@ -41,11 +44,15 @@ class hyperdex::state_transfer_manager::pending
     public:
         uint64_t seq_no;
         bool has_value;
+        // value holds a run of encoded objects from datalayer::get_raw_run
+        bool raw;
         uint64_t version;
         e::slice key;
         std::vector<e::slice> value;
         bool acked;
-        std::auto_ptr<e::buffer> msg;
+        uint64_t bytes;
+        // shared by every object unpacked from the same XFER_BATCH
+        std::tr1::shared_ptr<e::buffer> msg;
         datalayer::reference ref;
 
     private:
@@ -42,6 +42,9 @@ state_transfer_manager :: transfer_in_state :: transfer_in_state(const transfer&
     , upper_bound_acked(1)
     , queued()
     , need_del(true)
+    , known_empty(false)
+    , batched(false)
+    , need_ack(false)
     , prev()
     , iter()
     , m_ref(0)
@@ -49,6 +52,7 @@ state_transfer_manager :: transfer_in_state :: transfer_in_state(const transfer&
     datalayer::returncode rc;
     iter = data->make_region_iterator(snap, xfer.rid, &rc);
     assert(rc == datalayer::SUCCESS);
+    known_empty = !iter->valid();
 }
 
 state_transfer_manager :: transfer_in_state :: ~transfer_in_state() throw ()
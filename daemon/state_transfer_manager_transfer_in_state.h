@@ -52,6 +52,12 @@ class hyperdex::state_transfer_manager::transfer_in_state
         uint64_t upper_bound_acked;
         std::list<e::intrusive_ptr<pending> > queued;
         bool need_del;
+        // the region was empty when the transfer began, so objects that
+        // arrive in sorted order may be written without a prior read
+        bool known_empty;
+        // the sender batches objects and expects cumulative acks
+        bool batched;
+        bool need_ack;
         e::intrusive_ptr<pending> prev;
         e::intrusive_ptr<datalayer::iterator> iter;
 
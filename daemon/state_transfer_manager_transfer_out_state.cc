@@ -26,28 +26,26 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 // HyperDex
-#include "daemon/datalayer_iterator.h"
 #include "daemon/state_transfer_manager_pending.h"
 #include "daemon/state_transfer_manager_transfer_out_state.h"
 
 using hyperdex::state_transfer_manager;
 
 state_transfer_manager :: transfer_out_state :: transfer_out_state(const transfer& _xfer,
-                                                                   datalayer* data,
-                                                                   datalayer::snapshot snap)
+                                                                   datalayer*,
+                                                                   datalayer::snapshot _snap)
     : xfer(_xfer)
     , mtx()
     , state(SNAPSHOT_TRANSFER)
     , next_seq_no(1)
     , window()
-    , window_sz(1)
-    , iter()
+    , bytes_in_flight(0)
+    , window_bytes(XFER_BATCH_MAX_BYTES)
+    , snap(_snap)
+    , raw_cursor()
     , log_seq_no(1)
     , m_ref(0)
 {
-    datalayer::returncode rc;
-    iter = data->make_region_iterator(snap, xfer.rid, &rc);
-    assert(rc == datalayer::SUCCESS);
 }
 
 state_transfer_manager :: transfer_out_state :: ~transfer_out_state() throw ()
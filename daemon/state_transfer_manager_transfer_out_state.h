@@ -30,6 +30,7 @@
 
 // STL
 #include <list>
+#include <string>
 #include <tr1/memory>
 
 // po6
@@ -44,6 +45,16 @@
 
 using hyperdex::state_transfer_manager;
 
+// Objects are sent in batches of at most this many objects/bytes.  The window
+// starts at one batch and grows with every byte acked (halving on
+// retransmission) up to a fixed limit.  Across all transfers, the server will
+// not exceed XFER_SERVER_MAX_BYTES in flight except to keep each transfer
+// moving.
+#define XFER_BATCH_MAX_OBJECTS 1024
+#define XFER_BATCH_MAX_BYTES (1ULL << 20)
+#define XFER_WINDOW_MAX_BYTES (64ULL << 20)
+#define XFER_SERVER_MAX_BYTES (256ULL << 20)
+
 class state_transfer_manager::transfer_out_state
 {
     public:
@@ -58,9 +69,12 @@ class state_transfer_manager::transfer_out_state
         enum { SNAPSHOT_TRANSFER, LOG_TRANSFER } state;
         uint64_t next_seq_no;
         std::list<e::intrusive_ptr<pending> > window;
-        size_t window_sz;
-        // transfer from the snapshot
-        e::intrusive_ptr<datalayer::iterator> iter;
+        // bytes sent but not yet acked, and the limit on the same
+        uint64_t bytes_in_flight;
+        uint64_t window_bytes;
+        // transfer from the snapshot, as runs of encoded objects
+        datalayer::snapshot snap;
+        std::string raw_cursor;
         // transfer from the log of new operations
         uint64_t log_seq_no;
 
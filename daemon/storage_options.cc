@@ -0,0 +1,300 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#define __STDC_LIMIT_MACROS
+
+// C
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// STL
+#include <fstream>
+
+// HyperDex
+#include "daemon/storage_options.h"
+
+using hyperdex::storage_options;
+
+#define OPTIONS_FILE "hyperdex.options"
+
+#define SET_BLOCK_CACHE_SIZE    (1U << 0)
+#define SET_WRITE_BUFFER_SIZE   (1U << 1)
+#define SET_BLOCK_SIZE          (1U << 2)
+#define SET_BLOOM_BITS          (1U << 3)
+#define SET_MAX_OPEN_FILES      (1U << 4)
+#define SET_COMPRESSION         (1U << 5)
+#define SET_OBJECT_CACHE_SIZE   (1U << 6)
+
+namespace
+{
+
+bool
+parse_size(const std::string& value, uint64_t* size)
+{
+    if (value.empty())
+    {
+        return false;
+    }
+
+    char* end = NULL;
+    errno = 0;
+    unsigned long long x = strtoull(value.c_str(), &end, 10);
+
+    if (errno != 0 || end == value.c_str())
+    {
+        return false;
+    }
+
+    uint64_t shift = 0;
+
+    switch (*end)
+    {
+        case '\0':
+            break;
+        case 'k': case 'K':
+            shift = 10;
+            ++end;
+            break;
+        case 'm': case 'M':
+            shift = 20;
+            ++end;
+            break;
+        case 'g': case 'G':
+            shift = 30;
+            ++end;
+            break;
+        default:
+            return false;
+    }
+
+    if (*end != '\0' || (x << shift) >> shift != x)
+    {
+        return false;
+    }
+
+    *size = x << shift;
+    return true;
+}
+
+std::string
+trim(const std::string& s)
+{
+    const char* ws = " \t\r\n";
+    size_t start = s.find_first_not_of(ws);
+
+    if (start == std::string::npos)
+    {
+        return std::string();
+    }
+
+    size_t end = s.find_last_not_of(ws);
+    return s.substr(start, end - start + 1);
+}
+
+} // namespace
+
+storage_options :: storage_options()
+    : block_cache_size(8ULL * 1024ULL * 1024ULL)
+    , write_buffer_size(64ULL * 1024ULL * 1024ULL)
+    , block_size(4096)
+    , bloom_bits(10)
+    , max_open_files(1000)
+    , compression(true)
+    , object_cache_size(0)
+    , m_set(0)
+{
+}
+
+storage_options :: ~storage_options() throw ()
+{
+}
+
+bool
+storage_options :: set(const std::string& name, const std::string& value)
+{
+    uint64_t x = 0;
+
+    if (name == "compression")
+    {
+        if (value == "snappy")
+        {
+            compression = true;
+        }
+        else if (value == "none")
+        {
+            compression = false;
+        }
+        else
+        {
+            return false;
+        }
+
+        m_set |= SET_COMPRESSION;
+        return true;
+    }
+
+    if (!parse_size(value, &x))
+    {
+        return false;
+    }
+
+    if (name == "block-cache-size")
+    {
+        block_cache_size = x;
+        m_set |= SET_BLOCK_CACHE_SIZE;
+    }
+    else if (name == "write-buffer-size" && x > 0)
+    {
+        write_buffer_size = x;
+        m_set |= SET_WRITE_BUFFER_SIZE;
+    }
+    else if (name == "block-size" && x > 0)
+    {
+        block_size = x;
+        m_set |= SET_BLOCK_SIZE;
+    }
+    else if (name == "bloom-bits" && x <= 64)
+    {
+        bloom_bits = x;
+        m_set |= SET_BLOOM_BITS;
+    }
+    else if (name == "max-open-files" && x >= 64 && x <= INT32_MAX)
+    {
+        max_open_files = x;
+        m_set |= SET_MAX_OPEN_FILES;
+    }
+    else if (name == "object-cache-size")
+    {
+        object_cache_size = x;
+        m_set |= SET_OBJECT_CACHE_SIZE;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void
+storage_options :: override_with(const storage_options& other)
+{
+    if (other.m_set & SET_BLOCK_CACHE_SIZE)
+    {
+        block_cache_size = other.block_cache_size;
+    }
+
+    if (other.m_set & SET_WRITE_BUFFER_SIZE)
+    {
+        write_buffer_size = other.write_buffer_size;
+    }
+
+    if (other.m_set & SET_BLOCK_SIZE)
+    {
+        block_size = other.block_size;
+    }
+
+    if (other.m_set & SET_BLOOM_BITS)
+    {
+        bloom_bits = other.bloom_bits;
+    }
+
+    if (other.m_set & SET_MAX_OPEN_FILES)
+    {
+        max_open_files = other.max_open_files;
+    }
+
+    if (other.m_set & SET_COMPRESSION)
+    {
+        compression = other.compression;
+    }
+
+    if (other.m_set & SET_OBJECT_CACHE_SIZE)
+    {
+        object_cache_size = other.object_cache_size;
+    }
+
+    m_set |= other.m_set;
+}
+
+bool
+storage_options :: load(const po6::pathname& dir)
+{
+    po6::pathname path = po6::join(dir, OPTIONS_FILE);
+    std::ifstream fin(path.get());
+
+    if (!fin)
+    {
+        return true;
+    }
+
+    std::string line;
+
+    while (std::getline(fin, line))
+    {
+        line = trim(line.substr(0, line.find('#')));
+
+        if (line.empty())
+        {
+            continue;
+        }
+
+        size_t eq = line.find('=');
+
+        if (eq == std::string::npos ||
+            !set(trim(line.substr(0, eq)), trim(line.substr(eq + 1))))
+        {
+            return false;
+        }
+    }
+
+    return fin.eof();
+}
+
+bool
+storage_options :: save(const po6::pathname& dir) const
+{
+    po6::pathname path = po6::join(dir, OPTIONS_FILE);
+    std::ofstream fout(path.get(), std::ios::out | std::ios::trunc);
+    fout << "# storage engine options; overridden by the command line\n"
+         << *this;
+    fout.flush();
+    return fout.good();
+}
+
+std::ostream&
+hyperdex :: operator << (std::ostream& lhs, const storage_options& rhs)
+{
+    return lhs << "block-cache-size=" << rhs.block_cache_size << "\n"
+               << "write-buffer-size=" << rhs.write_buffer_size << "\n"
+               << "block-size=" << rhs.block_size << "\n"
+               << "bloom-bits=" << rhs.bloom_bits << "\n"
+               << "max-open-files=" << rhs.max_open_files << "\n"
+               << "compression=" << (rhs.compression ? "snappy" : "none") << "\n"
+               << "object-cache-size=" << rhs.object_cache_size << "\n";
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_daemon_storage_options_h_
+#define hyperdex_daemon_storage_options_h_
+
+// C
+#include <stdint.h>
+
+// STL
+#include <iostream>
+#include <string>
+
+// po6
+#include <po6/pathname.h>
+
+// HyperDex
+#include "namespace.h"
+
+// Tunable parameters of the storage engine.  Options may be given on the
+// command line or read from the data directory; those given on the command
+// line take precedence and are saved to the data directory so that they
+// persist across restarts.
+
+BEGIN_HYPERDEX_NAMESPACE
+
+class storage_options
+{
+    public:
+        storage_options();
+        ~storage_options() throw ();
+
+    public:
+        // set the option "name" from its textual form.  Sizes may carry a
+        // k, m, or g suffix.  Returns false if the option is unknown or the
+        // value is malformed.
+        bool set(const std::string& name, const std::string& value);
+        // every option explicitly set in "other" takes precedence over ours
+        void override_with(const storage_options& other);
+        // true if any option has been explicitly set
+        bool any_set() const { return m_set != 0; }
+        // read/write the options file in "dir".  A missing file is not an
+        // error and leaves the defaults in place.
+        bool load(const po6::pathname& dir);
+        bool save(const po6::pathname& dir) const;
+
+    public:
+        uint64_t block_cache_size;
+        uint64_t write_buffer_size;
+        uint64_t block_size;
+        uint64_t bloom_bits;
+        uint64_t max_open_files;
+        bool compression;
+        // bytes of decoded objects to cache in front of LevelDB; 0 disables
+        uint64_t object_cache_size;
+
+    private:
+        uint32_t m_set;
+};
+
+std::ostream&
+operator << (std::ostream& lhs, const storage_options& rhs);
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_daemon_storage_options_h_
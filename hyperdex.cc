@@ -43,6 +43,7 @@ main(int argc, const char* argv[])
     cmds.push_back(e::subcommand("daemon",                "Start a new HyperDex daemon"));
     cmds.push_back(e::subcommand("add-space",             "Create a new HyperDex space"));
     cmds.push_back(e::subcommand("validate-space",        "Validate a HyperDex space description"));
+    cmds.push_back(e::subcommand("bulk-load",             "Load objects directly into a stopped daemon's data directory"));
     // XXX cmds.push_back(e::subcommand("add-space",             "Create a new space"));
     // XXX cmds.push_back(e::subcommand("rm-space",              "Remove an existing space"));
     // XXX cmds.push_back(e::subcommand("initialize-cluster",    "One time initialization of a HyperDex coordinator"));
@@ -104,6 +104,16 @@ enum hyperpredicate
     HYPERPREDICATE_CONTAINS      = 9737
 };
 
+/* Aggregate occupies [9856, 9920) */
+enum hyperaggregate
+{
+    HYPERAGGREGATE_COUNT = 9856,
+    HYPERAGGREGATE_SUM   = 9857,
+    HYPERAGGREGATE_MIN   = 9858,
+    HYPERAGGREGATE_MAX   = 9859,
+    HYPERAGGREGATE_AVG   = 9860
+};
+
 #ifdef __cplusplus
 } /* extern "C" */
 
@@ -114,6 +124,8 @@ std::ostream&
 operator << (std::ostream& lhs, hyperdatatype rhs);
 std::ostream&
 operator << (std::ostream& lhs, hyperpredicate rhs);
+std::ostream&
+operator << (std::ostream& lhs, hyperaggregate rhs);
 
 #endif /* __cplusplus */
 #endif /* hyperdex_h_ */
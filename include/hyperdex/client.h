@@ -62,6 +62,20 @@ struct hyperdex_client_map_attribute
     enum hyperdatatype value_datatype;
 };
 
+struct hyperdex_client_key
+{
+    const char* key;
+    size_t key_sz;
+};
+
+struct hyperdex_client_object
+{
+    const char* key;
+    size_t key_sz;
+    const struct hyperdex_client_attribute* attrs;
+    size_t attrs_sz;
+};
+
 struct hyperdex_client_attribute_check
 {
     const char* attr; /* NULL-terminated */
@@ -71,6 +85,12 @@ struct hyperdex_client_attribute_check
     enum hyperpredicate predicate;
 };
 
+struct hyperdex_client_aggregate_spec
+{
+    const char* attr; /* NULL-terminated; ignored for HYPERAGGREGATE_COUNT */
+    enum hyperaggregate op;
+};
+
 /* HyperClient returncode occupies [8448, 8576) */
 enum hyperdex_client_returncode
 {
@@ -119,6 +139,21 @@ hyperdex_client_get(struct hyperdex_client* client,
                     enum hyperdex_client_returncode* status,
                     const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
 
+int64_t
+hyperdex_client_get_partial(struct hyperdex_client* client,
+                            const char* space,
+                            const char* key, size_t key_sz,
+                            const char** attrnames, size_t attrnames_sz,
+                            enum hyperdex_client_returncode* status,
+                            const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
+
+int64_t
+hyperdex_client_get_many(struct hyperdex_client* client,
+                         const char* space,
+                         const struct hyperdex_client_key* keys, size_t keys_sz,
+                         enum hyperdex_client_returncode* status,
+                         const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
+
 int64_t
 hyperdex_client_put(struct hyperdex_client* client,
                     const char* space,
@@ -126,6 +161,12 @@ hyperdex_client_put(struct hyperdex_client* client,
                     const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
                     enum hyperdex_client_returncode* status);
 
+int64_t
+hyperdex_client_bulk_put(struct hyperdex_client* client,
+                         const char* space,
+                         const struct hyperdex_client_object* objects, size_t objects_sz,
+                         enum hyperdex_client_returncode* status);
+
 int64_t
 hyperdex_client_cond_put(struct hyperdex_client* client,
                          const char* space,
@@ -581,6 +622,14 @@ hyperdex_client_search(struct hyperdex_client* client,
                        enum hyperdex_client_returncode* status,
                        const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
 
+int64_t
+hyperdex_client_search_partial(struct hyperdex_client* client,
+                               const char* space,
+                               const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                               const char** attrnames, size_t attrnames_sz,
+                               enum hyperdex_client_returncode* status,
+                               const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
+
 int64_t
 hyperdex_client_search_describe(struct hyperdex_client* client,
                                 const char* space,
@@ -598,12 +647,47 @@ hyperdex_client_sorted_search(struct hyperdex_client* client,
                               enum hyperdex_client_returncode* status,
                               const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
 
+int64_t
+hyperdex_client_sorted_search_partial(struct hyperdex_client* client,
+                                      const char* space,
+                                      const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                      const char** attrnames, size_t attrnames_sz,
+                                      const char* sort_by,
+                                      uint64_t limit,
+                                      int maxmin,
+                                      enum hyperdex_client_returncode* status,
+                                      const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
+
 int64_t
 hyperdex_client_group_del(struct hyperdex_client* client,
                           const char* space,
                           const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
                           enum hyperdex_client_returncode* status);
 
+int64_t
+hyperdex_client_group_put(struct hyperdex_client* client,
+                          const char* space,
+                          const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                          const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
+                          enum hyperdex_client_returncode* status,
+                          uint64_t* count);
+
+int64_t
+hyperdex_client_group_atomic_add(struct hyperdex_client* client,
+                                 const char* space,
+                                 const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                 const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
+                                 enum hyperdex_client_returncode* status,
+                                 uint64_t* count);
+
+int64_t
+hyperdex_client_group_atomic_sub(struct hyperdex_client* client,
+                                 const char* space,
+                                 const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                 const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
+                                 enum hyperdex_client_returncode* status,
+                                 uint64_t* count);
+
 int64_t
 hyperdex_client_count(struct hyperdex_client* client,
                       const char* space,
@@ -611,6 +695,15 @@ hyperdex_client_count(struct hyperdex_client* client,
                       enum hyperdex_client_returncode* status,
                       uint64_t* count);
 
+int64_t
+hyperdex_client_aggregate(struct hyperdex_client* client,
+                          const char* space,
+                          const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                          const struct hyperdex_client_aggregate_spec* aggs, size_t aggs_sz,
+                          const char* group_by,
+                          enum hyperdex_client_returncode* status,
+                          const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
+
 int64_t
 hyperdex_client_loop(struct hyperdex_client* client, int timeout,
                      enum hyperdex_client_returncode* status);
@@ -58,10 +58,24 @@ class Client
                     hyperdex_client_returncode* status,
                     const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
             { return hyperdex_client_get(m_cl, space, key, key_sz, status, attrs, attrs_sz); }
+        int64_t get_partial(const char* space, const char* key, size_t key_sz,
+                            const char** attrnames, size_t attrnames_sz,
+                            hyperdex_client_returncode* status,
+                            const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+            { return hyperdex_client_get_partial(m_cl, space, key, key_sz, attrnames, attrnames_sz, status, attrs, attrs_sz); }
+        int64_t get_many(const char* space,
+                         const struct hyperdex_client_key* keys, size_t keys_sz,
+                         hyperdex_client_returncode* status,
+                         const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+            { return hyperdex_client_get_many(m_cl, space, keys, keys_sz, status, attrs, attrs_sz); }
         int64_t put(const char* space, const char* key, size_t key_sz,
                     const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
                     hyperdex_client_returncode* status)
             { return hyperdex_client_put(m_cl, space, key, key_sz, attrs, attrs_sz, status); }
+        int64_t bulk_put(const char* space,
+                         const struct hyperdex_client_object* objects, size_t objects_sz,
+                         hyperdex_client_returncode* status)
+            { return hyperdex_client_bulk_put(m_cl, space, objects, objects_sz, status); }
         int64_t cond_put(const char* space, const char* key, size_t key_sz,
                          const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
                          const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
@@ -335,6 +349,12 @@ class Client
                        enum hyperdex_client_returncode* status,
                        const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
             { return hyperdex_client_search(m_cl, space, checks, checks_sz, status, attrs, attrs_sz); }
+        int64_t search_partial(const char* space,
+                               const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                               const char** attrnames, size_t attrnames_sz,
+                               enum hyperdex_client_returncode* status,
+                               const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+            { return hyperdex_client_search_partial(m_cl, space, checks, checks_sz, attrnames, attrnames_sz, status, attrs, attrs_sz); }
         int64_t search_describe(const char* space,
                                 const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
                                 enum hyperdex_client_returncode* status, const char** str)
@@ -345,14 +365,43 @@ class Client
                               enum hyperdex_client_returncode* status,
                               const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
             { return hyperdex_client_sorted_search(m_cl, space, checks, checks_sz, sort_by, limit, maximize, status, attrs, attrs_sz); }
+        int64_t sorted_search_partial(const char* space,
+                                      const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                      const char** attrnames, size_t attrnames_sz,
+                                      const char* sort_by, uint64_t limit, int maximize,
+                                      enum hyperdex_client_returncode* status,
+                                      const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+            { return hyperdex_client_sorted_search_partial(m_cl, space, checks, checks_sz, attrnames, attrnames_sz, sort_by, limit, maximize, status, attrs, attrs_sz); }
         int64_t group_del(const char* space,
                           const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
                           enum hyperdex_client_returncode* status)
             { return hyperdex_client_group_del(m_cl, space, checks, checks_sz, status); }
+        int64_t group_put(const char* space,
+                          const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                          const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
+                          enum hyperdex_client_returncode* status, uint64_t* count)
+            { return hyperdex_client_group_put(m_cl, space, checks, checks_sz, attrs, attrs_sz, status, count); }
+        int64_t group_atomic_add(const char* space,
+                                 const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                 const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
+                                 enum hyperdex_client_returncode* status, uint64_t* count)
+            { return hyperdex_client_group_atomic_add(m_cl, space, checks, checks_sz, attrs, attrs_sz, status, count); }
+        int64_t group_atomic_sub(const char* space,
+                                 const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                 const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
+                                 enum hyperdex_client_returncode* status, uint64_t* count)
+            { return hyperdex_client_group_atomic_sub(m_cl, space, checks, checks_sz, attrs, attrs_sz, status, count); }
         int64_t count(const char* space,
                       const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
                       enum hyperdex_client_returncode* status, uint64_t* result)
             { return hyperdex_client_count(m_cl, space, checks, checks_sz, status, result); }
+        int64_t aggregate(const char* space,
+                          const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                          const struct hyperdex_client_aggregate_spec* aggs, size_t aggs_sz,
+                          const char* group_by,
+                          enum hyperdex_client_returncode* status,
+                          const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+            { return hyperdex_client_aggregate(m_cl, space, checks, checks_sz, aggs, aggs_sz, group_by, status, attrs, attrs_sz); }
 
     public:
         int64_t loop(int timeout, hyperdex_client_returncode* status)
@@ -73,6 +73,18 @@ hyperdex_ds_arena_destroy(struct hyperdex_ds_arena* arena);
 struct hyperdex_client_attribute*
 hyperdex_ds_allocate_attribute(struct hyperdex_ds_arena* arena, size_t sz);
 
+const char**
+hyperdex_ds_allocate_attribute_names(struct hyperdex_ds_arena* arena, size_t sz);
+
+struct hyperdex_client_key*
+hyperdex_ds_allocate_key(struct hyperdex_ds_arena* arena, size_t sz);
+
+struct hyperdex_client_object*
+hyperdex_ds_allocate_object(struct hyperdex_ds_arena* arena, size_t sz);
+
+struct hyperdex_client_aggregate_spec*
+hyperdex_ds_allocate_aggregate_spec(struct hyperdex_ds_arena* arena, size_t sz);
+
 struct hyperdex_client_attribute_check*
 hyperdex_ds_allocate_attribute_check(struct hyperdex_ds_arena* arena, size_t sz);
 
@@ -63,11 +63,13 @@ class HyperDexCluster(object):
         self.daemons = daemons
         self.clean = clean
         self.base = base
+        self.env = None
+        self.started_daemons = 0
 
     def setup(self):
         if self.base is None:
             self.base = tempfile.mkdtemp(prefix='hyperdex-test-')
-        env = {'GLOG_logtostderr': '',
+        self.env = env = {'GLOG_logtostderr': '',
                'GLOG_minloglevel': '0',
                'HYPERDEX_EXEC_PATH': PATH,
                'HYPERDEX_COORD_LIB': os.path.join(PATH, '.libs/libhyperdex-coordinator'),
@@ -85,7 +87,10 @@ class HyperDexCluster(object):
             proc = subprocess.Popen(cmd, stdout=stdout, stderr=subprocess.STDOUT, env=env, cwd=cwd)
             self.processes.append(proc)
         time.sleep(1) # XXX use a barrier tool on cluster
-        for i in range(self.daemons):
+        self.add_daemons(self.daemons)
+
+    def add_daemons(self, count):
+        for i in range(self.started_daemons, self.started_daemons + count):
             cmd = ['/usr/bin/env', 'hyperdex', 'daemon', '-t', '1',
                    '--foreground', '--listen', 'localhost', '--listen-port', str(2012 + i),
                    '--coordinator', 'localhost', '--coordinator-port', '1982']
@@ -94,8 +99,9 @@ class HyperDexCluster(object):
                 raise RuntimeError('environment already exists (at least partially)')
             os.makedirs(cwd)
             stdout = open(os.path.join(cwd, 'hyperdex-test-runner.log'), 'w')
-            proc = subprocess.Popen(cmd, stdout=stdout, stderr=subprocess.STDOUT, env=env, cwd=cwd)
+            proc = subprocess.Popen(cmd, stdout=stdout, stderr=subprocess.STDOUT, env=self.env, cwd=cwd)
             self.processes.append(proc)
+        self.started_daemons += count
         time.sleep(1) # XXX use a barrier tool on cluster
 
     def cleanup(self):
@@ -0,0 +1,107 @@
+# Copyright (c) 2013, Cornell University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+#     * Redistributions of source code must retain the above copyright notice,
+#       this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the name of HyperDex nor the names of its contributors may be
+#       used to endorse or promote products derived from this software without
+#       specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+# SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+# CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+# OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+from __future__ import absolute_import
+from __future__ import print_function
+from __future__ import unicode_literals
+from __future__ import with_statement
+
+
+import sys
+import time
+
+import argparse
+
+import runner
+
+import hyperdex.admin
+import hyperdex.client
+
+
+KEYS = {'int': lambda i: i * 7919 - 500000,
+        'float': lambda i: i * 0.5 - 250.0,
+        'string': lambda i: b'key%08i' % i}
+
+
+def transfers_done(adm):
+    # every region has two replicas and no transfer is outstanding
+    regions = 0
+    for line in adm.dump_config().split('\n'):
+        line = line.strip()
+        if line.startswith('transfer'):
+            return False
+        if line.startswith('region'):
+            regions += 1
+            if line.count('(id=') != 2:
+                return False
+    return regions > 0
+
+
+def main(argv):
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--key', default='int', choices=sorted(KEYS.keys()))
+    parser.add_argument('--objects', default=1000, type=int)
+    args = parser.parse_args(argv)
+    mkkey = KEYS[args.key]
+    hdc = runner.HyperDexCluster(1, 1)
+    try:
+        hdc.setup()
+        adm = hyperdex.admin.Admin('localhost', 1982)
+        adm.add_space(b'space transfer key %s k attributes int v subspace v '
+                      b'tolerate 1 failures' % args.key.encode('ascii'))
+        time.sleep(1) # XXX use a barrier tool on cluster
+        c = hyperdex.client.Client('localhost', 1982)
+        for i in range(args.objects):
+            c.put(b'transfer', mkkey(i), {b'v': i})
+        # the second daemon is filled by state transfer from the first, and
+        # becomes the tail that serves reads once the transfer goes live
+        hdc.add_daemons(1)
+        for x in range(60):
+            if transfers_done(adm):
+                break
+            time.sleep(1)
+        else:
+            print('state transfer did not complete')
+            return 1
+        failed = 0
+        for i in range(args.objects):
+            obj = c.get(b'transfer', mkkey(i))
+            if obj != {b'v': i}:
+                print('get %r returned %r' % (mkkey(i), obj))
+                failed += 1
+            # the search goes through the index on v that the transfer rebuilt
+            found = [o[b'k'] for o in c.search(b'transfer', {b'v': i})]
+            if found != [mkkey(i)]:
+                print('search v=%i returned keys %r' % (i, found))
+                failed += 1
+        return 1 if failed else 0
+    finally:
+        hdc.cleanup()
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
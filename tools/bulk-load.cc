@@ -0,0 +1,781 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#define __STDC_LIMIT_MACROS
+
+// C
+#include <cstdlib>
+#include <cstring>
+
+// STL
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <tr1/memory>
+#include <utility>
+#include <vector>
+
+// LevelDB
+#include <hyperleveldb/db.h>
+#include <hyperleveldb/filter_policy.h>
+#include <hyperleveldb/write_batch.h>
+
+// e
+#include <e/buffer.h>
+#include <e/endian.h>
+#include <e/popt.h>
+
+// HyperDex
+#include "common/coordinator_link.h"
+#include "common/datatypes.h"
+#include "common/hash.h"
+#include "daemon/datalayer_encodings.h"
+#include "daemon/index_stats.h"
+#include "daemon/storage_options.h"
+#include "tools/common.h"
+
+// Load objects straight into the data directory of a stopped daemon.  Every
+// object is routed through the space's hyperspace mapping exactly as a put
+// would be, and written (along with its index entries) to each region the
+// daemon replicates.  An object that already exists is overwritten the way a
+// put overwrites it:  its stale index entries are removed and its version is
+// advanced.  Writes are buffered, sorted, and handed to LevelDB in large
+// batches so that the resulting tables are built from sorted runs rather
+// than from the random order of the input.
+
+#define BULK_LOAD_DEFAULT_BATCH_MB 64
+
+using hyperdex::configuration;
+using hyperdex::coordinator_link;
+using hyperdex::datatype_info;
+using hyperdex::index_stats;
+using hyperdex::index_stats_delta;
+using hyperdex::region;
+using hyperdex::region_id;
+using hyperdex::schema;
+using hyperdex::server_id;
+using hyperdex::space;
+using hyperdex::storage_options;
+using hyperdex::subspace;
+
+enum read_result
+{
+    READ_OBJECT,
+    READ_EOF,
+    READ_ERROR
+};
+
+// Buffers the entries of many write batches so they may be written in
+// sorted order.
+class sorted_batch : public leveldb::WriteBatch::Handler
+{
+    public:
+        sorted_batch() : m_entries(), m_bytes(0) {}
+        virtual ~sorted_batch() throw () {}
+
+    public:
+        virtual void Put(const leveldb::Slice& key, const leveldb::Slice& value);
+        virtual void Delete(const leveldb::Slice& key);
+        uint64_t bytes() const { return m_bytes; }
+        bool flush(leveldb::DB* db);
+
+    private:
+        // key, and value or NULL for a delete
+        typedef std::pair<std::string, std::tr1::shared_ptr<std::string> > entry;
+        static bool compare(const entry& lhs, const entry& rhs)
+        { return lhs.first < rhs.first; }
+
+    private:
+        sorted_batch(const sorted_batch&);
+        sorted_batch& operator = (const sorted_batch&);
+
+    private:
+        std::vector<entry> m_entries;
+        uint64_t m_bytes;
+};
+
+void
+sorted_batch :: Put(const leveldb::Slice& key, const leveldb::Slice& value)
+{
+    std::tr1::shared_ptr<std::string> v(new std::string(value.ToString()));
+    m_entries.push_back(std::make_pair(key.ToString(), v));
+    m_bytes += key.size() + value.size();
+}
+
+void
+sorted_batch :: Delete(const leveldb::Slice& key)
+{
+    m_entries.push_back(std::make_pair(key.ToString(), std::tr1::shared_ptr<std::string>()));
+    m_bytes += key.size();
+}
+
+bool
+sorted_batch :: flush(leveldb::DB* db)
+{
+    // stable so that the last write to a duplicated key still wins
+    std::stable_sort(m_entries.begin(), m_entries.end(), compare);
+    leveldb::WriteBatch updates;
+
+    for (size_t i = 0; i < m_entries.size(); ++i)
+    {
+        if (m_entries[i].second)
+        {
+            updates.Put(m_entries[i].first, *m_entries[i].second);
+        }
+        else
+        {
+            updates.Delete(m_entries[i].first);
+        }
+    }
+
+    leveldb::WriteOptions wopts;
+    wopts.sync = false;
+    leveldb::Status st = db->Write(wopts, &updates);
+    m_entries.clear();
+    m_bytes = 0;
+
+    if (!st.ok())
+    {
+        std::cerr << "could not write to LevelDB: " << st.ToString() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static bool
+parse_csv_line(const std::string& line, std::vector<std::string>* fields)
+{
+    fields->clear();
+    fields->push_back(std::string());
+    bool quoted = false;
+
+    for (size_t i = 0; i < line.size(); ++i)
+    {
+        char c = line[i];
+
+        if (quoted)
+        {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+            {
+                fields->back().push_back('"');
+                ++i;
+            }
+            else if (c == '"')
+            {
+                quoted = false;
+            }
+            else
+            {
+                fields->back().push_back(c);
+            }
+        }
+        else if (c == '"' && fields->back().empty())
+        {
+            quoted = true;
+        }
+        else if (c == ',')
+        {
+            fields->push_back(std::string());
+        }
+        else if (c != '\r' || i + 1 != line.size())
+        {
+            fields->back().push_back(c);
+        }
+    }
+
+    return !quoted;
+}
+
+static bool
+parse_csv_value(hyperdatatype type, const std::string& in, std::string* out)
+{
+    if (type == HYPERDATATYPE_STRING)
+    {
+        *out = in;
+        return true;
+    }
+
+    if (in.empty())
+    {
+        out->clear();
+        return true;
+    }
+
+    char* end = NULL;
+
+    if (type == HYPERDATATYPE_INT64)
+    {
+        int64_t num = strtoll(in.c_str(), &end, 0);
+        out->resize(sizeof(int64_t));
+        e::pack64le(num, &(*out)[0]);
+    }
+    else if (type == HYPERDATATYPE_FLOAT)
+    {
+        double num = strtod(in.c_str(), &end);
+        out->resize(sizeof(double));
+        e::packdoublele(num, &(*out)[0]);
+    }
+    else
+    {
+        return false;
+    }
+
+    return end && *end == '\0';
+}
+
+// The first line names the attributes, in any order; the key is required and
+// attributes that are not named take their default values.
+static bool
+read_csv_header(const schema& sc, std::istream& in, std::vector<uint16_t>* columns)
+{
+    std::string line;
+    std::vector<std::string> fields;
+
+    if (!std::getline(in, line) || !parse_csv_line(line, &fields))
+    {
+        std::cerr << "could not read the CSV header" << std::endl;
+        return false;
+    }
+
+    std::vector<bool> seen(sc.attrs_sz, false);
+
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+        uint16_t attr = sc.lookup_attr(fields[i].c_str());
+
+        if (attr >= sc.attrs_sz)
+        {
+            std::cerr << "CSV header names unknown attribute \"" << fields[i] << "\"" << std::endl;
+            return false;
+        }
+
+        if (seen[attr])
+        {
+            std::cerr << "CSV header names attribute \"" << fields[i] << "\" twice" << std::endl;
+            return false;
+        }
+
+        if (sc.attrs[attr].type != HYPERDATATYPE_STRING &&
+            sc.attrs[attr].type != HYPERDATATYPE_INT64 &&
+            sc.attrs[attr].type != HYPERDATATYPE_FLOAT)
+        {
+            std::cerr << "attribute \"" << fields[i] << "\" cannot be given in CSV; "
+                      << "use the binary format for containers" << std::endl;
+            return false;
+        }
+
+        seen[attr] = true;
+        columns->push_back(attr);
+    }
+
+    if (!seen[0])
+    {
+        std::cerr << "CSV header does not name the key \"" << sc.attrs[0].name << "\"" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static read_result
+read_csv(const schema& sc,
+         const std::vector<uint16_t>& columns,
+         std::istream& in,
+         uint64_t* lineno,
+         std::vector<std::string>* attrs)
+{
+    std::string line;
+    std::vector<std::string> fields;
+
+    do
+    {
+        if (!std::getline(in, line))
+        {
+            return in.eof() ? READ_EOF : READ_ERROR;
+        }
+
+        ++*lineno;
+    }
+    while (line.empty() || line == "\r");
+
+    if (!parse_csv_line(line, &fields) || fields.size() != columns.size())
+    {
+        std::cerr << "line " << *lineno << ": malformed CSV record" << std::endl;
+        return READ_ERROR;
+    }
+
+    attrs->assign(sc.attrs_sz, std::string());
+
+    for (size_t i = 0; i < columns.size(); ++i)
+    {
+        if (!parse_csv_value(sc.attrs[columns[i]].type, fields[i], &(*attrs)[columns[i]]))
+        {
+            std::cerr << "line " << *lineno << ": invalid value for attribute \""
+                      << sc.attrs[columns[i]].name << "\"" << std::endl;
+            return READ_ERROR;
+        }
+    }
+
+    return READ_OBJECT;
+}
+
+// Each object is every attribute, the key first and the rest in schema order,
+// as a 32-bit big-endian length followed by the attribute in HyperDex's own
+// encoding.
+static read_result
+read_binary(const schema& sc,
+            std::istream& in,
+            std::vector<std::string>* attrs)
+{
+    attrs->assign(sc.attrs_sz, std::string());
+
+    for (size_t i = 0; i < sc.attrs_sz; ++i)
+    {
+        char buf[sizeof(uint32_t)];
+
+        if (!in.read(buf, sizeof(uint32_t)))
+        {
+            if (i == 0 && in.gcount() == 0 && in.eof())
+            {
+                return READ_EOF;
+            }
+
+            std::cerr << "truncated binary record" << std::endl;
+            return READ_ERROR;
+        }
+
+        uint32_t sz;
+        e::unpack32be(buf, &sz);
+        (*attrs)[i].resize(sz);
+
+        if (sz > 0 && !in.read(&(*attrs)[i][0], sz))
+        {
+            std::cerr << "truncated binary record" << std::endl;
+            return READ_ERROR;
+        }
+    }
+
+    return READ_OBJECT;
+}
+
+static bool
+read_state(leveldb::DB* db, server_id* us)
+{
+    leveldb::ReadOptions ropts;
+    ropts.verify_checksums = true;
+    std::string backing;
+    leveldb::Status st = db->Get(ropts, leveldb::Slice("state", 5), &backing);
+
+    if (st.IsNotFound())
+    {
+        std::cerr << "the data directory does not hold the state of a cleanly "
+                  << "stopped daemon" << std::endl;
+        return false;
+    }
+    else if (!st.ok())
+    {
+        std::cerr << "could not read the daemon's state: " << st.ToString() << std::endl;
+        return false;
+    }
+
+    uint64_t id;
+    e::unpacker up(backing.data(), backing.size());
+    up = up >> id;
+
+    if (up.error())
+    {
+        std::cerr << "the daemon's saved state is invalid" << std::endl;
+        return false;
+    }
+
+    *us = server_id(id);
+    return true;
+}
+
+static const region*
+covering_region(const subspace& ss, const std::vector<uint64_t>& hashes)
+{
+    for (size_t r = 0; r < ss.regions.size(); ++r)
+    {
+        bool matches = true;
+
+        for (size_t a = 0; matches && a < ss.attrs.size(); ++a)
+        {
+            matches = ss.regions[r].lower_coord[a] <= hashes[ss.attrs[a]] &&
+                      hashes[ss.attrs[a]] <= ss.regions[r].upper_coord[a];
+        }
+
+        if (matches)
+        {
+            return &ss.regions[r];
+        }
+    }
+
+    return NULL;
+}
+
+static bool
+replicated_by(const region& reg, const server_id& us)
+{
+    for (size_t i = 0; i < reg.replicas.size(); ++i)
+    {
+        if (reg.replicas[i].si == us)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int
+main(int argc, const char* argv[])
+{
+    hyperdex::connect_opts conn;
+    const char* data = ".";
+    const char* space = NULL;
+    const char* format = "csv";
+    long batch_mb = BULK_LOAD_DEFAULT_BATCH_MB;
+    bool compact = false;
+    e::argparser ap;
+    ap.autohelp();
+    ap.option_string("[OPTIONS] <input-file> [<input-file> ...]");
+    ap.arg().name('D', "data")
+            .description("the data directory of the stopped daemon (default: .)")
+            .metavar("dir").as_string(&data);
+    ap.arg().name('s', "space")
+            .description("the space to load objects into")
+            .metavar("space").as_string(&space);
+    ap.arg().name('f', "format")
+            .description("the format of the input: \"csv\" or \"binary\" (default: csv)")
+            .metavar("fmt").as_string(&format);
+    ap.arg().name('b', "batch-size")
+            .description("megabytes of sorted writes to buffer between writes (default: 64)")
+            .metavar("MB").as_long(&batch_mb);
+    ap.arg().name('C', "compact")
+            .description("compact the loaded data into sorted tables before exiting")
+            .set_true(&compact);
+    ap.add("Connect to a cluster:", conn.parser());
+
+    if (!ap.parse(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (!conn.validate())
+    {
+        std::cerr << "invalid host:port specification\n" << std::endl;
+        ap.usage();
+        return EXIT_FAILURE;
+    }
+
+    if (!space)
+    {
+        std::cerr << "must specify the space to load" << std::endl;
+        ap.usage();
+        return EXIT_FAILURE;
+    }
+
+    bool binary = strcmp(format, "binary") == 0;
+
+    if (!binary && strcmp(format, "csv") != 0)
+    {
+        std::cerr << "unknown input format \"" << format << "\"" << std::endl;
+        ap.usage();
+        return EXIT_FAILURE;
+    }
+
+    if (batch_mb <= 0)
+    {
+        std::cerr << "batch size must be positive" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (ap.args_sz() == 0)
+    {
+        std::cerr << "must specify at least one input file" << std::endl;
+        ap.usage();
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        coordinator_link cl(conn.host(), conn.port());
+        replicant_returncode rc;
+
+        if (!cl.ensure_configuration(&rc))
+        {
+            std::cerr << "could not fetch the configuration: " << cl.error().msg() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        const configuration* config = cl.config();
+        const hyperdex::space* sp = config->get_space(space);
+
+        if (!sp)
+        {
+            std::cerr << "space \"" << space << "\" does not exist" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        const schema* sc = &sp->sc;
+
+        // open the daemon's LevelDB the way the daemon itself would; LevelDB's
+        // lock keeps us from loading into a running daemon
+        po6::pathname path(data);
+        storage_options so;
+
+        if (!so.load(path))
+        {
+            std::cerr << "could not parse the storage options saved in " << data << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::auto_ptr<const leveldb::FilterPolicy> policy;
+
+        if (so.bloom_bits > 0)
+        {
+            policy.reset(leveldb::NewBloomFilterPolicy(so.bloom_bits));
+        }
+
+        leveldb::Options opts;
+        opts.write_buffer_size = so.write_buffer_size;
+        opts.max_open_files = so.max_open_files;
+        opts.block_size = so.block_size;
+        opts.compression = so.compression ? leveldb::kSnappyCompression
+                                          : leveldb::kNoCompression;
+        opts.create_if_missing = false;
+        opts.filter_policy = policy.get();
+        leveldb::DB* tmp_db;
+        leveldb::Status st = leveldb::DB::Open(opts, data, &tmp_db);
+
+        if (!st.ok())
+        {
+            std::cerr << "could not open LevelDB: " << st.ToString() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::auto_ptr<leveldb::DB> db(tmp_db);
+        server_id us;
+
+        if (!read_state(db.get(), &us))
+        {
+            return EXIT_FAILURE;
+        }
+
+        // the index statistics are advisory; keep them current if we can
+        index_stats stats;
+        std::string sbacking;
+        st = db->Get(leveldb::ReadOptions(), leveldb::Slice("stats", 5), &sbacking);
+
+        if (st.ok() && !stats.deserialize(e::slice(sbacking)))
+        {
+            std::cerr << "discarding invalid index statistics" << std::endl;
+        }
+
+        sorted_batch sorted;
+        const uint64_t batch_bytes = static_cast<uint64_t>(batch_mb) * 1024ULL * 1024ULL;
+        std::vector<std::string> attrs;
+        std::vector<e::slice> value(sc->attrs_sz - 1);
+        std::vector<uint64_t> hashes(sc->attrs_sz);
+        std::vector<char> scratch1;
+        std::vector<char> scratch2;
+        // object keys written since the last flush, which reads can't see yet
+        std::set<std::string> pending;
+        uint64_t objects = 0;
+        uint64_t stored = 0;
+
+        for (size_t f = 0; f < ap.args_sz(); ++f)
+        {
+            std::ifstream fin(ap.args()[f], binary ? std::ios::in | std::ios::binary
+                                                   : std::ios::in);
+
+            if (!fin)
+            {
+                std::cerr << "could not open " << ap.args()[f] << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            std::vector<uint16_t> columns;
+            uint64_t lineno = 1;
+
+            if (!binary && !read_csv_header(*sc, fin, &columns))
+            {
+                return EXIT_FAILURE;
+            }
+
+            while (true)
+            {
+                read_result rr = binary ? read_binary(*sc, fin, &attrs)
+                                        : read_csv(*sc, columns, fin, &lineno, &attrs);
+
+                if (rr == READ_EOF)
+                {
+                    break;
+                }
+                else if (rr == READ_ERROR)
+                {
+                    std::cerr << "could not read " << ap.args()[f] << std::endl;
+                    return EXIT_FAILURE;
+                }
+
+                e::slice key(attrs[0].data(), attrs[0].size());
+
+                for (size_t i = 0; i < sc->attrs_sz; ++i)
+                {
+                    e::slice attr(attrs[i].data(), attrs[i].size());
+                    datatype_info* di = datatype_info::lookup(sc->attrs[i].type);
+
+                    if (!di->validate(attr))
+                    {
+                        std::cerr << "object " << objects << ": invalid value for attribute \""
+                                  << sc->attrs[i].name << "\"" << std::endl;
+                        return EXIT_FAILURE;
+                    }
+
+                    if (i > 0)
+                    {
+                        value[i - 1] = attr;
+                    }
+                }
+
+                ++objects;
+                hyperdex::hash(*sc, key, value, &hashes.front());
+
+                // write the object to every region of every subspace we hold,
+                // whether or not the region has a live point leader
+                for (size_t s = 0; s < sp->subspaces.size(); ++s)
+                {
+                    const subspace& ss(sp->subspaces[s]);
+                    const region* reg = covering_region(ss, hashes);
+
+                    if (!reg || !replicated_by(*reg, us))
+                    {
+                        continue;
+                    }
+
+                    leveldb::Slice lkey;
+                    hyperdex::encode_key(reg->id, sc->attrs[0].type, key, &scratch1, &lkey);
+                    std::string skey(lkey.data(), lkey.size());
+
+                    // the same key earlier in the input; make it visible
+                    if (pending.find(skey) != pending.end())
+                    {
+                        if (!sorted.flush(db.get()))
+                        {
+                            return EXIT_FAILURE;
+                        }
+
+                        pending.clear();
+                    }
+
+                    std::string obacking;
+                    st = db->Get(leveldb::ReadOptions(), leveldb::Slice(skey), &obacking);
+                    std::vector<e::slice> old_value;
+                    uint64_t old_version = 0;
+                    bool found = false;
+
+                    if (st.ok())
+                    {
+                        if (hyperdex::decode_value(e::slice(obacking.data(), obacking.size()),
+                                                   &old_value, &old_version) != hyperdex::datalayer::SUCCESS)
+                        {
+                            std::cerr << "existing object " << objects << " does not decode" << std::endl;
+                            return EXIT_FAILURE;
+                        }
+
+                        found = true;
+                    }
+                    else if (!st.IsNotFound())
+                    {
+                        std::cerr << "could not read from LevelDB: " << st.ToString() << std::endl;
+                        return EXIT_FAILURE;
+                    }
+
+                    leveldb::WriteBatch updates;
+                    leveldb::Slice lval;
+                    hyperdex::encode_value(value, old_version + 1, &scratch2, &lval);
+                    updates.Put(leveldb::Slice(skey), lval);
+                    // stats are saved only after every batch is ingested
+                    index_stats_delta delta;
+                    hyperdex::create_index_changes(*sc, ss, reg->id, key,
+                                                   found ? &old_value : NULL,
+                                                   &value, &updates, &delta);
+                    stats.apply(delta);
+                    updates.Iterate(&sorted);
+                    pending.insert(skey);
+                    ++stored;
+                }
+
+                if (sorted.bytes() >= batch_bytes)
+                {
+                    if (!sorted.flush(db.get()))
+                    {
+                        return EXIT_FAILURE;
+                    }
+
+                    pending.clear();
+                }
+            }
+        }
+
+        if (!sorted.flush(db.get()))
+        {
+            return EXIT_FAILURE;
+        }
+
+        std::string tbacking;
+        stats.serialize(&tbacking);
+        leveldb::WriteOptions wopts;
+        wopts.sync = true;
+        st = db->Put(wopts, leveldb::Slice("stats", 5), tbacking);
+
+        if (!st.ok())
+        {
+            std::cerr << "could not save index statistics: " << st.ToString() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (compact)
+        {
+            db->CompactRange(NULL, NULL);
+        }
+
+        std::cout << "read " << objects << " objects; stored "
+                  << stored << " region copies on server " << us << std::endl;
+        return EXIT_SUCCESS;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}